@@ -0,0 +1,193 @@
+/**
+ * @file backlight_check.cpp
+ * @brief Checks Backlight against a fake /sys/class/backlight
+ *
+ * A temporary class directory holds a device without max_brightness,
+ * which must be skipped, and a panel with max_brightness 1023. Checked:
+ *
+ *  - the level at init matches the brightness left in the file
+ *  - the curve runs from 0 to max_brightness, rises monotonically and
+ *    puts level 128 at CIE lightness 50 (18.4% of max)
+ *  - setting a level twice writes once
+ *  - fades end at the target, call done once, move in one direction and
+ *    stay within the write rate
+ *  - a fade replaced midway continues from the current level and never
+ *    calls the first done
+ *  - without a device, fades finish at once
+ *
+ * Exits with status 1 if any step differs.
+ *
+ * Usage: touchdown-backlight-check
+ */
+
+#include "touchdown/drivers/backlight.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using touchdown::EventLoop;
+using touchdown::drivers::Backlight;
+
+constexpr uint32_t MAX_BRIGHTNESS = 1023;
+
+int failures = 0;
+
+void check(const char* step, bool ok, const std::string& detail) {
+    std::printf("  %-34s %-4s %s\n", step, ok ? "ok" : "FAIL", detail.c_str());
+    if (!ok) failures++;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    std::getline(file, value);
+    return value;
+}
+
+// Levels reported through the callback during one fade
+struct Fade {
+    std::vector<uint8_t> levels;
+    uint64_t writes = 0;
+    uint64_t elapsed_ms = 0;
+    int done = 0;
+};
+
+// Runs a fade to completion, or for at most limit_ms. fade must outlive
+// the fade, which keeps counting into it if it is left running.
+void run_fade(EventLoop& loop, Backlight& backlight, uint8_t level, uint32_t duration_ms,
+              Fade& fade, uint32_t limit_ms = 0) {
+    backlight.set_level_callback([&fade](uint8_t level) { fade.levels.push_back(level); });
+
+    uint64_t writes = backlight.get_write_count();
+    uint64_t start_us = EventLoop::now_us();
+
+    EventLoop::TimerId limit = loop.add_timer([&loop]() { loop.stop(); });
+    loop.arm_timer(limit, limit_ms > 0 ? limit_ms : duration_ms + 500, 0);
+    backlight.fade_to(level, duration_ms, [&]() {
+        fade.done++;
+        loop.stop();
+    });
+    if (backlight.is_fading()) loop.run();
+    loop.remove_timer(limit);
+
+    fade.elapsed_ms = (EventLoop::now_us() - start_us) / 1000;
+    fade.writes = backlight.get_write_count() - writes;
+    backlight.set_level_callback(nullptr);
+}
+
+bool monotonic(const std::vector<uint8_t>& levels, bool rising) {
+    for (size_t i = 1; i < levels.size(); i++) {
+        if (rising ? levels[i] < levels[i - 1] : levels[i] > levels[i - 1]) return false;
+    }
+    return true;
+}
+
+std::string describe(const Fade& fade, const std::string& file) {
+    return std::to_string(fade.writes) + " writes in " + std::to_string(fade.elapsed_ms) +
+           " ms, file " + file + ", done " + std::to_string(fade.done) + "x";
+}
+
+} // namespace
+
+int main() {
+    char dir[] = "/tmp/touchdown-backlight-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    std::string root = dir;
+    std::string broken = root + "/aaa-no-max";
+    std::string panel = root + "/panel";
+    mkdir(broken.c_str(), 0755);
+    mkdir(panel.c_str(), 0755);
+    std::ofstream(broken + "/brightness") << "0\n";
+    std::ofstream(panel + "/max_brightness") << MAX_BRIGHTNESS << "\n";
+    std::ofstream(panel + "/brightness") << "512\n";
+    std::string brightness = panel + "/brightness";
+
+    EventLoop loop;
+    if (!loop.init()) return 2;
+
+    {
+        Backlight backlight;
+        bool ret = backlight.init(loop, root);
+        uint8_t level = backlight.get_level();
+        check("init skips a device without max", ret && backlight.is_available(),
+              "level " + std::to_string(level));
+        check("level matches the file", level > 0 && backlight.to_raw(level) >= 512 &&
+              backlight.to_raw(level - 1) < 512,
+              "raw " + std::to_string(backlight.to_raw(level)) + " for 512");
+
+        bool rising = true;
+        for (int i = 1; i < 256; i++) rising = rising && backlight.to_raw(i) >= backlight.to_raw(i - 1);
+        double mid = backlight.to_raw(128) * 100.0 / MAX_BRIGHTNESS;
+        check("curve", rising && backlight.to_raw(0) == 0 && backlight.to_raw(1) >= 1 &&
+              backlight.to_raw(255) == MAX_BRIGHTNESS && std::fabs(mid - 18.4) < 0.5,
+              "level 128 at " + std::to_string(mid).substr(0, 4) + "% of max");
+
+        uint64_t writes = backlight.get_write_count();
+        backlight.set_level(255);
+        backlight.set_level(255);
+        writes = backlight.get_write_count() - writes;
+        check("set level 255 twice", writes == 1 && read_file(brightness) == "1023",
+              std::to_string(writes) + " write, file " + read_file(brightness));
+
+        // 60 Hz: a write every 16 ms at most
+        Fade out;
+        run_fade(loop, backlight, 0, 200, out);
+        check("fade out, 200 ms at 60 Hz", out.done == 1 && read_file(brightness) == "0" &&
+              out.writes <= 200 / 16 + 1 && monotonic(out.levels, false) &&
+              out.elapsed_ms >= 200, describe(out, read_file(brightness)));
+
+        backlight.set_max_rate(20);
+        Fade in;
+        run_fade(loop, backlight, 255, 500, in);
+        check("fade in, 500 ms at 20 Hz", in.done == 1 && read_file(brightness) == "1023" &&
+              in.writes <= 500 / 50 + 1 && monotonic(in.levels, true) &&
+              in.elapsed_ms >= 500, describe(in, read_file(brightness)));
+
+        // Stopped by the limit halfway, then replaced
+        backlight.set_max_rate(60);
+        Fade first;
+        Fade second;
+        run_fade(loop, backlight, 0, 400, first, 200);
+        uint8_t halfway = backlight.get_level();
+        run_fade(loop, backlight, 255, 100, second);
+        bool continued = !second.levels.empty() && second.levels.front() >= halfway &&
+                         monotonic(second.levels, true);
+        check("fade replaced midway", first.done == 0 && second.done == 1 && continued &&
+              halfway > 0 && halfway < 255 && read_file(brightness) == "1023",
+              "from level " + std::to_string(halfway) + ", " + describe(second, read_file(brightness)));
+    }
+
+    {
+        std::string empty = root + "/empty";
+        mkdir(empty.c_str(), 0755);
+
+        Backlight backlight;
+        bool ret = backlight.init(loop, empty);
+        int done = 0;
+        backlight.fade_to(200, 500, [&done]() { done++; });
+        check("no device", !ret && !backlight.is_fading() && done == 1 && backlight.get_level() == 200,
+              "fade finished at once, level " + std::to_string(backlight.get_level()));
+        rmdir(empty.c_str());
+    }
+
+    unlink((broken + "/brightness").c_str());
+    unlink((panel + "/max_brightness").c_str());
+    unlink(brightness.c_str());
+    rmdir(broken.c_str());
+    rmdir(panel.c_str());
+    rmdir(root.c_str());
+
+    std::printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
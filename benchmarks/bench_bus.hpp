@@ -0,0 +1,164 @@
+/**
+ * @file bench_bus.hpp
+ * @brief Private dbus-daemon for benchmarks
+ */
+
+#ifndef TOUCHDOWN_BENCHMARKS_BENCH_BUS_HPP
+#define TOUCHDOWN_BENCHMARKS_BENCH_BUS_HPP
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace touchdown {
+namespace bench {
+
+// Exit status of a check that cannot run here; ctest reports it as skipped
+constexpr int EXIT_SKIP = 77;
+
+/**
+ * @brief Whether an executable of that name is in PATH
+ */
+inline bool in_path(const std::string& program) {
+    const char* path = std::getenv("PATH");
+    std::string dirs = path ? path : "";
+
+    size_t start = 0;
+    while (start <= dirs.size()) {
+        size_t end = dirs.find(':', start);
+        if (end == std::string::npos) end = dirs.size();
+        std::string dir = end > start ? dirs.substr(start, end - start) : ".";
+        if (access((dir + "/" + program).c_str(), X_OK) == 0) return true;
+        start = end + 1;
+    }
+    return false;
+}
+
+/**
+ * @brief Whether dbus-daemon and dbus-send are in PATH; says so if not
+ *
+ * Checks on a private bus exit with EXIT_SKIP without them, so a CI
+ * image without D-Bus skips them rather than failing.
+ */
+inline bool have_dbus_tools() {
+    if (in_path("dbus-daemon") && in_path("dbus-send")) return true;
+    std::fprintf(stderr, "dbus-daemon or dbus-send not in PATH, skipping\n");
+    return false;
+}
+
+/**
+ * @brief dbus-daemon started for the lifetime of a benchmark
+ *
+ * Services connect to the system bus, so DBUS_SYSTEM_BUS_ADDRESS is
+ * pointed at the private daemon; processes forked afterwards inherit it.
+ */
+class PrivateBus {
+public:
+    PrivateBus() = default;
+    ~PrivateBus() { stop(); }
+
+    PrivateBus(const PrivateBus&) = delete;
+    PrivateBus& operator=(const PrivateBus&) = delete;
+
+    bool start() {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) < 0) return false;
+
+        pid_ = fork();
+        if (pid_ < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            return false;
+        }
+
+        if (pid_ == 0) {
+            // dbus-daemon writes its address to fd 3
+            dup2(fds[1], 3);
+            execlp("dbus-daemon", "dbus-daemon", "--session", "--nofork",
+                   "--print-address=3", static_cast<char*>(nullptr));
+            _exit(127);
+        }
+
+        ::close(fds[1]);
+
+        char buf[256];
+        size_t len = 0;
+        while (len < sizeof(buf) - 1) {
+            ssize_t n = ::read(fds[0], buf + len, sizeof(buf) - 1 - len);
+            if (n <= 0) break;
+            len += static_cast<size_t>(n);
+            if (buf[len - 1] == '\n') break;
+        }
+        ::close(fds[0]);
+
+        while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == '\0')) len--;
+        if (len == 0) {
+            stop();
+            return false;
+        }
+
+        address_.assign(buf, len);
+        setenv("DBUS_SYSTEM_BUS_ADDRESS", address_.c_str(), 1);
+        return true;
+    }
+
+    void stop() {
+        if (pid_ > 0) {
+            kill(pid_, SIGTERM);
+            waitpid(pid_, nullptr, 0);
+            pid_ = -1;
+        }
+    }
+
+    const std::string& get_address() const { return address_; }
+    pid_t get_pid() const { return pid_; }
+
+private:
+    pid_t pid_ = -1;
+    std::string address_;
+};
+
+/**
+ * @brief Wait until a name is owned on the bus set up by PrivateBus
+ *
+ * The sd-bus backend requests its name asynchronously, once the loop
+ * runs, so a service can report ready before calls to it are routed.
+ * Polls GetNameOwner with dbus-send, which comes with dbus-daemon.
+ */
+inline bool wait_for_name(const std::string& name, int timeout_ms = 5000) {
+    constexpr int POLL_MS = 5;
+    std::string arg = "string:" + name;
+
+    for (int waited = 0; waited < timeout_ms; waited += POLL_MS) {
+        pid_t pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            int null_fd = open("/dev/null", O_WRONLY);
+            dup2(null_fd, 1);
+            dup2(null_fd, 2);
+            execlp("dbus-send", "dbus-send", "--system", "--print-reply",
+                   "--dest=org.freedesktop.DBus", "/org/freedesktop/DBus",
+                   "org.freedesktop.DBus.GetNameOwner", arg.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return false;
+        if (WEXITSTATUS(status) == 0) return true;
+        if (WEXITSTATUS(status) == 127) return false;  // No dbus-send
+
+        struct timespec pause = {0, POLL_MS * 1000000L};
+        nanosleep(&pause, nullptr);
+    }
+    return false;
+}
+
+} // namespace bench
+} // namespace touchdown
+
+#endif // TOUCHDOWN_BENCHMARKS_BENCH_BUS_HPP
@@ -0,0 +1,272 @@
+/**
+ * @file button_timing_check.cpp
+ * @brief Injects power button presses through uinput and checks the gestures
+ *
+ * A virtual KEY_POWER device is created with /dev/uinput and picked up
+ * by ButtonDriver the same way as the real button, by capability, with
+ * the driver held to the virtual device's name. Each
+ * scenario writes press/release pairs with known gaps. It checks the
+ * gestures the driver classifies, and that it times them from the kernel
+ * event timestamps:
+ *
+ *  - every RELEASE duration is within 2 ms of the measured hold
+ *  - every event's sample time is within 2 ms of when it was written
+ *  - SINGLE_PRESS never fires before the double-press window has closed
+ *
+ * Holds of 480 and 520 ms sit on either side of the 500 ms long-press
+ * threshold.
+ *
+ * Needs write access to /dev/uinput; runs beside the device's own power
+ * button. Exits with status 1 on a mismatch, 77 (skipped) if uinput is
+ * unavailable and 2 if the driver cannot start.
+ *
+ * Usage: touchdown-button-timing-check
+ */
+
+#include "touchdown/drivers/button_driver.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+using touchdown::ButtonEvent;
+using touchdown::ButtonEventType;
+using touchdown::EventLoop;
+
+constexpr uint32_t DOUBLE_PRESS_WINDOW_MS = 300;
+constexpr uint32_t LONG_PRESS_THRESHOLD_MS = 500;
+constexpr uint64_t TOLERANCE_US = 2000;
+constexpr const char* DEVICE_NAME = "touchdown-button-timing-check";
+constexpr int EXIT_SKIP = 77;  // ctest reports it as skipped
+
+const char* type_name(ButtonEventType type) {
+    switch (type) {
+        case ButtonEventType::SINGLE_PRESS: return "single";
+        case ButtonEventType::DOUBLE_PRESS: return "double";
+        case ButtonEventType::LONG_PRESS: return "long";
+        case ButtonEventType::RELEASE: return "release";
+    }
+    return "?";
+}
+
+uint64_t diff_us(uint64_t a, uint64_t b) {
+    return a > b ? a - b : b - a;
+}
+
+class VirtualButton {
+public:
+    VirtualButton() : fd_(-1) {}
+
+    ~VirtualButton() {
+        if (fd_ >= 0) {
+            ioctl(fd_, UI_DEV_DESTROY);
+            close(fd_);
+        }
+    }
+
+    bool create() {
+        fd_ = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd_ < 0) return false;
+
+        struct uinput_setup setup = {};
+        setup.id.bustype = BUS_VIRTUAL;
+        std::strncpy(setup.name, DEVICE_NAME, UINPUT_MAX_NAME_SIZE - 1);
+
+        return ioctl(fd_, UI_SET_EVBIT, EV_KEY) == 0 &&
+               ioctl(fd_, UI_SET_KEYBIT, KEY_POWER) == 0 &&
+               ioctl(fd_, UI_DEV_SETUP, &setup) == 0 &&
+               ioctl(fd_, UI_DEV_CREATE) == 0;
+    }
+
+    // Returns the monotonic time just before the write; the kernel
+    // stamps the event while handling it
+    uint64_t set(bool pressed) {
+        struct input_event events[2] = {};
+        events[0].type = EV_KEY;
+        events[0].code = KEY_POWER;
+        events[0].value = pressed ? 1 : 0;
+        events[1].type = EV_SYN;
+        events[1].code = SYN_REPORT;
+
+        uint64_t written_us = EventLoop::now_us();
+        if (write(fd_, events, sizeof(events)) != sizeof(events)) {
+            std::fprintf(stderr, "uinput write failed: %s\n", std::strerror(errno));
+        }
+        return written_us;
+    }
+
+private:
+    int fd_;
+};
+
+class Recorder {
+public:
+    void add(const ButtonEvent& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back({event, EventLoop::now_us()});
+        cond_.notify_all();
+    }
+
+    struct Entry {
+        ButtonEvent event;
+        uint64_t received_us;
+    };
+
+    // Waits until count events arrived, or the timeout passed
+    std::vector<Entry> take(size_t count, uint32_t timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                       [&]() { return events_.size() >= count; });
+        std::vector<Entry> events;
+        events.swap(events_);
+        return events;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<Entry> events_;
+};
+
+struct Press {
+    uint32_t hold_ms;
+    uint32_t gap_ms;  // Until the next press
+};
+
+struct Expected {
+    ButtonEventType type;
+    size_t press;  // Index of the press whose release it follows
+};
+
+void sleep_until_us(uint64_t deadline_us) {
+    uint64_t now_us = EventLoop::now_us();
+    if (deadline_us > now_us) {
+        std::this_thread::sleep_for(std::chrono::microseconds(deadline_us - now_us));
+    }
+}
+
+bool run(const char* name, VirtualButton& button, Recorder& recorder,
+         const std::vector<Press>& presses, const std::vector<Expected>& expected) {
+    std::vector<uint64_t> down_us;
+    std::vector<uint64_t> up_us;
+
+    uint64_t next_us = EventLoop::now_us();
+    for (const Press& press : presses) {
+        sleep_until_us(next_us);
+        down_us.push_back(button.set(true));
+        sleep_until_us(down_us.back() + press.hold_ms * 1000ULL);
+        up_us.push_back(button.set(false));
+        next_us = up_us.back() + press.gap_ms * 1000ULL;
+    }
+
+    // Room for the double-press window to close
+    std::vector<Recorder::Entry> events = recorder.take(expected.size(), DOUBLE_PRESS_WINDOW_MS + 500);
+
+    bool ok = events.size() == expected.size();
+    std::printf("%s:\n", name);
+    for (size_t i = 0; i < std::max(events.size(), expected.size()); i++) {
+        if (i >= events.size()) {
+            std::printf("  missing %s\n", type_name(expected[i].type));
+            ok = false;
+            continue;
+        }
+
+        const ButtonEvent& event = events[i].event;
+        if (i >= expected.size()) {
+            std::printf("  unexpected %s\n", type_name(event.type));
+            ok = false;
+            continue;
+        }
+
+        size_t press = expected[i].press;
+        bool match = event.type == expected[i].type;
+        std::printf("  %-8s", type_name(event.type));
+
+        switch (event.type) {
+            case ButtonEventType::RELEASE:
+            case ButtonEventType::LONG_PRESS: {
+                uint64_t hold_us = up_us[press] - down_us[press];
+                uint64_t error_us = diff_us(event.duration_ms * 1000ULL, hold_us);
+                std::printf(" held %6.1f ms, reported %5u ms", hold_us / 1000.0, event.duration_ms);
+                match = match && error_us <= TOLERANCE_US;
+                break;
+            }
+            case ButtonEventType::SINGLE_PRESS: {
+                // Stamped with the release; fires once the window closes
+                uint64_t deadline_us = event.sample_us + DOUBLE_PRESS_WINDOW_MS * 1000ULL;
+                int64_t late_us = static_cast<int64_t>(events[i].received_us - deadline_us);
+                std::printf(" window closed, delivered %+.1f ms after", late_us / 1000.0);
+                match = match && late_us >= 0;
+                break;
+            }
+            case ButtonEventType::DOUBLE_PRESS:
+                if (press > 0) {
+                    std::printf(" %5.1f ms between releases",
+                                (up_us[press] - up_us[press - 1]) / 1000.0);
+                }
+                break;
+        }
+
+        uint64_t stamp_error_us = diff_us(event.sample_us, up_us[press]);
+        std::printf(", stamp off by %.2f ms %s\n", stamp_error_us / 1000.0,
+                    match && stamp_error_us <= TOLERANCE_US ? "" : "  <-- FAIL");
+        ok = ok && match && stamp_error_us <= TOLERANCE_US;
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    VirtualButton button;
+    if (!button.create()) {
+        std::fprintf(stderr, "Cannot create a uinput device: %s\n", std::strerror(errno));
+        return EXIT_SKIP;
+    }
+
+    // Let udev create the node before the driver looks for it
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    Recorder recorder;
+    touchdown::drivers::ButtonDriver driver;
+    driver.set_double_press_window_ms(DOUBLE_PRESS_WINDOW_MS);
+    driver.set_long_press_threshold_ms(LONG_PRESS_THRESHOLD_MS);
+    driver.set_device_name(DEVICE_NAME);
+    driver.set_button_callback([&recorder](const ButtonEvent& event) { recorder.add(event); });
+    if (!driver.init()) {
+        std::fprintf(stderr, "Button driver failed to start\n");
+        return 2;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    using T = ButtonEventType;
+    bool ok = true;
+    ok &= run("short press", button, recorder, {{120, 0}},
+              {{T::RELEASE, 0}, {T::SINGLE_PRESS, 0}});
+    ok &= run("just below long press", button, recorder, {{480, 0}},
+              {{T::RELEASE, 0}, {T::SINGLE_PRESS, 0}});
+    ok &= run("just above long press", button, recorder, {{520, 0}},
+              {{T::LONG_PRESS, 0}, {T::RELEASE, 0}});
+    ok &= run("long press", button, recorder, {{800, 0}},
+              {{T::LONG_PRESS, 0}, {T::RELEASE, 0}});
+    ok &= run("double press", button, recorder, {{80, 120}, {80, 0}},
+              {{T::RELEASE, 0}, {T::DOUBLE_PRESS, 1}, {T::RELEASE, 1}});
+
+    driver.deinit();
+
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
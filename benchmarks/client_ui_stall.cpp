@@ -0,0 +1,253 @@
+/**
+ * @file client_ui_stall.cpp
+ * @brief UI loop stalls while SystemClient calls go to a slow service
+ *
+ * Starts a private bus and forks a stand-in power service that sleeps
+ * for a fixed delay in every handler. The parent plays the shell: one
+ * EventLoop with a frame timer at the LVGL refresh period, and the
+ * SystemClient attached to its connection. Every frame it tops up
+ * PIPELINE outstanding SetBrightness/GetPowerState calls. Reported:
+ * the largest gap between frames, and how long replies took.
+ *
+ * A call that waited for its reply would hold up a frame by at least
+ * the service delay. The benchmark exits nonzero when the worst frame
+ * is late by half the delay or more, so it can gate CI, and with
+ * status 77 (skipped) without dbus-daemon in PATH.
+ *
+ * Usage: touchdown-client-ui-stall [seconds] [service delay ms]
+ */
+
+#include "bench_bus.hpp"
+#include "touchdown/client/system_client.hpp"
+#include "touchdown/dbus/power_interface.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t FRAME_MS = 16;
+constexpr int PIPELINE = 4;
+
+using touchdown::EventLoop;
+using touchdown::client::SystemClient;
+using touchdown::services::DBusInterface;
+using touchdown::services::Message;
+using touchdown::services::MethodError;
+using touchdown::services::PowerStub;
+
+class SlowPowerService : public PowerStub {
+public:
+    explicit SlowPowerService(uint32_t delay_ms)
+        : PowerStub("org.touchdown.Power")
+        , delay_us_(delay_ms * 1000) {}
+
+private:
+    void handle_set_power_state(Message&, const std::string&, SetPowerStateDone done) override {
+        usleep(delay_us_);
+        done({});
+    }
+
+    MethodError handle_get_power_state(Message&, std::string& state) override {
+        usleep(delay_us_);
+        state = "active";
+        return {};
+    }
+
+    MethodError handle_set_screen_timeout(Message&, uint32_t) override {
+        usleep(delay_us_);
+        return {};
+    }
+
+    MethodError handle_reset_idle_timer(Message&) override {
+        usleep(delay_us_);
+        return {};
+    }
+
+    MethodError handle_set_brightness(Message&, uint8_t) override {
+        usleep(delay_us_);
+        return {};
+    }
+
+    MethodError handle_frame_ready(Message&) override {
+        usleep(delay_us_);
+        return {};
+    }
+
+    MethodError handle_report_frame_stats(Message&, uint32_t, uint32_t, uint32_t, uint32_t,
+                                          uint32_t) override {
+        usleep(delay_us_);
+        return {};
+    }
+
+    useconds_t delay_us_;
+};
+
+// Stands in for the shell's own connection
+class UiConnection : public DBusInterface {
+public:
+    UiConnection() : DBusInterface("org.touchdown.BenchUi", "/org/touchdown/BenchUi") {}
+};
+
+class UiLoop {
+public:
+    UiLoop(EventLoop& loop, uint32_t seconds) : loop_(loop), seconds_(seconds) {}
+
+    void run() {
+        frame_timer_ = loop_.add_timer([this]() { on_frame(); });
+        loop_.arm_timer(frame_timer_, FRAME_MS, FRAME_MS);
+
+        EventLoop::TimerId end = loop_.add_timer([this]() { loop_.stop(); });
+        loop_.arm_timer(end, seconds_ * 1000);
+
+        last_frame_us_ = EventLoop::now_us();
+        loop_.run();
+    }
+
+    uint64_t get_frames() const { return frames_; }
+    uint64_t get_max_gap_us() const { return max_gap_us_; }
+    uint64_t get_errors() const { return errors_; }
+    std::vector<uint64_t>& get_reply_us() { return reply_us_; }
+
+private:
+    void on_frame() {
+        uint64_t now = EventLoop::now_us();
+        max_gap_us_ = std::max(max_gap_us_, now - last_frame_us_);
+        last_frame_us_ = now;
+        frames_++;
+
+        auto* power = SystemClient::instance().power();
+        while (power && in_flight_ < PIPELINE) {
+            send(*power);
+        }
+    }
+
+    void send(touchdown::services::PowerProxy& power) {
+        uint64_t start = EventLoop::now_us();
+        in_flight_++;
+
+        if (next_call_++ % 2 == 0) {
+            power.set_brightness(static_cast<uint8_t>(next_call_), [this, start](const char* error) {
+                complete(start, error);
+            });
+        } else {
+            power.get_power_state([this, start](const char* error, const std::string&) {
+                complete(start, error);
+            });
+        }
+    }
+
+    void complete(uint64_t start_us, const char* error) {
+        in_flight_--;
+        if (error) {
+            errors_++;
+            return;
+        }
+        reply_us_.push_back(EventLoop::now_us() - start_us);
+    }
+
+    EventLoop& loop_;
+    uint32_t seconds_;
+    EventLoop::TimerId frame_timer_ = EventLoop::INVALID_TIMER;
+    uint64_t last_frame_us_ = 0;
+    uint64_t max_gap_us_ = 0;
+    uint64_t frames_ = 0;
+    int in_flight_ = 0;
+    unsigned next_call_ = 0;
+    uint64_t errors_ = 0;
+    std::vector<uint64_t> reply_us_;
+};
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 3;
+    int delay_ms = argc > 2 ? std::atoi(argv[2]) : 100;
+    if (seconds <= 0 || delay_ms <= 0) {
+        std::fprintf(stderr, "Usage: %s [seconds] [service delay ms]\n", argv[0]);
+        return 2;
+    }
+
+    if (!touchdown::bench::have_dbus_tools()) return touchdown::bench::EXIT_SKIP;
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        return 1;
+    }
+
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return 1;
+
+    pid_t service_pid = fork();
+    if (service_pid == 0) {
+        close(ready[0]);
+        EventLoop loop;
+        SlowPowerService service(static_cast<uint32_t>(delay_ms));
+        if (!loop.init() || !service.init(loop)) _exit(1);
+        char byte = 1;
+        if (write(ready[1], &byte, 1) != 1) _exit(1);
+        close(ready[1]);
+        loop.run();
+        _exit(0);
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool started = service_pid > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+    started = started && touchdown::bench::wait_for_name("org.touchdown.Power");
+    if (!started) {
+        std::fprintf(stderr, "Slow service failed to start\n");
+        return 1;
+    }
+
+    EventLoop loop;
+    UiConnection connection;
+    if (!loop.init() || !connection.init(loop)) {
+        kill(service_pid, SIGKILL);
+        waitpid(service_pid, nullptr, 0);
+        return 1;
+    }
+    SystemClient::instance().attach(connection);
+
+    UiLoop ui(loop, static_cast<uint32_t>(seconds));
+    ui.run();
+
+    SystemClient::instance().detach();
+    kill(service_pid, SIGKILL);  // Blocked in a handler most of the time
+    waitpid(service_pid, nullptr, 0);
+
+    std::vector<uint64_t>& replies = ui.get_reply_us();
+    std::sort(replies.begin(), replies.end());
+
+    uint64_t budget_us = (FRAME_MS + static_cast<uint64_t>(delay_ms) / 2) * 1000;
+    bool stalled = ui.get_max_gap_us() >= budget_us;
+
+    std::printf("backend=%s service delay=%d ms pipeline=%d seconds=%d\n",
+                DBusInterface::get_backend_name(), delay_ms, PIPELINE, seconds);
+    std::printf("  frames   %6llu  max gap %6llu us  (frame %u ms, budget %llu us)\n",
+                static_cast<unsigned long long>(ui.get_frames()),
+                static_cast<unsigned long long>(ui.get_max_gap_us()),
+                FRAME_MS,
+                static_cast<unsigned long long>(budget_us));
+    std::printf("  replies  %6zu  p50 %6llu us  p99 %6llu us  errors %llu\n",
+                replies.size(),
+                static_cast<unsigned long long>(percentile(replies, 0.50)),
+                static_cast<unsigned long long>(percentile(replies, 0.99)),
+                static_cast<unsigned long long>(ui.get_errors()));
+
+    if (stalled) {
+        std::fprintf(stderr, "UI loop stalled for %llu us\n",
+                     static_cast<unsigned long long>(ui.get_max_gap_us()));
+        return 1;
+    }
+    return replies.empty() ? 1 : 0;
+}
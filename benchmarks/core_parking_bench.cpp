@@ -0,0 +1,241 @@
+/**
+ * @file core_parking_bench.cpp
+ * @brief Parks and unparks CPUs and checks pinned threads get their mask back
+ *
+ * Each cycle takes the CPUs offline with CpuHotplug::park() and brings
+ * them back with unpark(), first concurrently and then one after another,
+ * and reports how long the return took. A thread pinned to the last
+ * parked CPU must have its affinity restored after every cycle.
+ *
+ * Without a root, the cycles run against a fake tree in a temporary
+ * directory. There the kernel's migration of the pinned thread is
+ * simulated by widening its mask after park(); the timings only cover
+ * the file writes. Against /sys/devices/system/cpu (as root, on the
+ * device) the CPUs really go offline, and the timings are the wake
+ * latency the power service sees.
+ *
+ * Usage: touchdown-core-parking-bench [cycles] [sysfs_root] [cpus]
+ *        cpus as in sysfs, e.g. 1-3; defaults to all CPUs but cpu0
+ */
+
+#include "touchdown/drivers/cpu_hotplug.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+using touchdown::drivers::CpuHotplug;
+using touchdown::drivers::HotplugResult;
+
+struct Timing {
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    uint64_t cycles = 0;
+};
+
+std::vector<unsigned> parse_cpus(const std::string& value) {
+    std::vector<unsigned> cpus;
+    std::istringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        unsigned first = 0;
+        unsigned last = 0;
+        if (std::sscanf(item.c_str(), "%u-%u", &first, &last) == 2) {
+            for (unsigned cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        } else if (std::sscanf(item.c_str(), "%u", &first) == 1) {
+            cpus.push_back(first);
+        }
+    }
+    return cpus;
+}
+
+std::string make_fake_tree(const std::vector<unsigned>& cpus) {
+    char dir[] = "/tmp/touchdown-cpu-XXXXXX";
+    if (!mkdtemp(dir)) return "";
+
+    for (unsigned cpu : cpus) {
+        std::string path = std::string(dir) + "/cpu" + std::to_string(cpu);
+        mkdir(path.c_str(), 0755);
+        std::ofstream(path + "/online") << "1\n";
+    }
+    return dir;
+}
+
+void remove_fake_tree(const std::string& root, const std::vector<unsigned>& cpus) {
+    for (unsigned cpu : cpus) {
+        std::string path = root + "/cpu" + std::to_string(cpu);
+        unlink((path + "/online").c_str());
+        rmdir(path.c_str());
+    }
+    rmdir(root.c_str());
+}
+
+char read_online(const std::string& root, unsigned cpu) {
+    std::ifstream file(root + "/cpu" + std::to_string(cpu) + "/online");
+    char state = '?';
+    file >> state;
+    return state;
+}
+
+// Sleeps until stopped; its tid is what gets pinned
+class PinnedThread {
+public:
+    explicit PinnedThread(unsigned cpu) : tid_(0), stop_(false) {
+        thread_ = std::thread([this]() {
+            tid_ = static_cast<pid_t>(syscall(SYS_gettid));
+            while (!stop_) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        });
+        while (tid_ == 0) std::this_thread::yield();
+
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(cpu, &mask);
+        pinned_ = sched_setaffinity(tid_, sizeof(mask), &mask) == 0;
+    }
+
+    ~PinnedThread() {
+        stop_ = true;
+        thread_.join();
+    }
+
+    bool is_pinned() const { return pinned_; }
+
+    // What the kernel does when the thread's only CPU goes offline
+    void widen() {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++) CPU_SET(cpu, &mask);
+        sched_setaffinity(tid_, sizeof(mask), &mask);
+    }
+
+    bool has_only(unsigned cpu) const {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        sched_getaffinity(tid_, sizeof(mask), &mask);
+        return CPU_COUNT(&mask) == 1 && CPU_ISSET(cpu, &mask);
+    }
+
+private:
+    std::thread thread_;
+    std::atomic<pid_t> tid_;
+    std::atomic<bool> stop_;
+    bool pinned_;
+};
+
+bool run_cycles(const std::string& root, const std::vector<unsigned>& cpus, bool parallel,
+                int cycles, bool fake, Timing& timing) {
+    CpuHotplug hotplug;
+    hotplug.set_cpus(cpus);
+    hotplug.set_parallel(parallel);
+    if (!hotplug.init(root)) {
+        std::fprintf(stderr, "No CPU to park under %s\n", root.c_str());
+        return false;
+    }
+
+    // Only pinnable if this machine really has the CPU
+    unsigned pin_cpu = cpus.back();
+    PinnedThread pinned(pin_cpu);
+
+    bool ok = true;
+    for (int i = 0; i < cycles; i++) {
+        HotplugResult parked;
+        HotplugResult back;
+        if (!hotplug.park(parked)) ok = false;
+        if (fake) {
+            for (unsigned cpu : cpus) {
+                if (read_online(root, cpu) != '0') {
+                    std::fprintf(stderr, "cpu%u not written offline\n", cpu);
+                    ok = false;
+                }
+            }
+            if (pinned.is_pinned()) pinned.widen();
+        }
+
+        if (!hotplug.unpark(back)) ok = false;
+        if (fake) {
+            for (unsigned cpu : cpus) {
+                if (read_online(root, cpu) != '1') {
+                    std::fprintf(stderr, "cpu%u not written online\n", cpu);
+                    ok = false;
+                }
+            }
+        }
+        if (pinned.is_pinned() && !pinned.has_only(pin_cpu)) {
+            std::fprintf(stderr, "Thread pinned to cpu%u not re-pinned (cycle %d)\n", pin_cpu, i);
+            ok = false;
+        }
+
+        timing.total_us += back.elapsed_us;
+        timing.max_us = std::max(timing.max_us, back.elapsed_us);
+        timing.cycles++;
+    }
+
+    if (!pinned.is_pinned()) {
+        std::printf("cpu%u not present here, affinity not checked\n", pin_cpu);
+    }
+    return ok;
+}
+
+void print(const char* name, const Timing& timing) {
+    if (timing.cycles == 0) return;
+    std::printf("  %-10s mean %8llu us  max %8llu us\n", name,
+                static_cast<unsigned long long>(timing.total_us / timing.cycles),
+                static_cast<unsigned long long>(timing.max_us));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int cycles = argc > 1 ? std::atoi(argv[1]) : 20;
+    std::string root = argc > 2 ? argv[2] : "";
+
+    std::vector<unsigned> cpus;
+    if (argc > 3) {
+        cpus = parse_cpus(argv[3]);
+    } else {
+        for (unsigned cpu = 1; cpu < std::max(std::thread::hardware_concurrency(), 2u); cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cycles <= 0 || cpus.empty()) {
+        std::fprintf(stderr, "Usage: %s [cycles] [sysfs_root] [cpus]\n", argv[0]);
+        return 2;
+    }
+
+    bool fake = root.empty();
+    if (fake) {
+        root = make_fake_tree(cpus);
+        if (root.empty()) {
+            std::fprintf(stderr, "Cannot create a fake tree\n");
+            return 1;
+        }
+    }
+
+    Timing parallel;
+    Timing sequential;
+    bool ok = run_cycles(root, cpus, true, cycles, fake, parallel);
+    ok = run_cycles(root, cpus, false, cycles, fake, sequential) && ok;
+
+    std::printf("%zu CPUs, %d cycles under %s%s\n", cpus.size(), cycles, root.c_str(),
+                fake ? " (fake)" : "");
+    std::printf("back online:\n");
+    print("parallel", parallel);
+    print("sequential", sequential);
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+
+    if (fake) {
+        remove_fake_tree(root, cpus);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file cpufreq_check.cpp
+ * @brief Checks CpufreqManager against a fake cpufreq tree
+ *
+ * Two policies with different cpuinfo ranges are created in a temporary
+ * directory. Each step applies settings or a floor and compares what the
+ * files hold afterwards, and how many writes were issued, against the
+ * expected result:
+ *
+ *  - settings that are already in place cause no writes
+ *  - a governor a policy does not offer is refused without a write
+ *  - limits are clamped to each policy's cpuinfo range
+ *  - the floor raises scaling_min_freq but stays below scaling_max_freq
+ *  - zero limits restore the values found at init
+ *
+ * Exits with status 1 if any step differs.
+ *
+ * Usage: touchdown-cpufreq-check
+ */
+
+#include "touchdown/drivers/cpufreq.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using touchdown::drivers::CpufreqManager;
+using touchdown::drivers::CpufreqSettings;
+
+const char* const FILES[] = {
+    "scaling_governor", "scaling_min_freq", "scaling_max_freq", "cpuinfo_min_freq",
+    "cpuinfo_max_freq", "scaling_available_governors",
+};
+
+struct PolicyState {
+    std::string governor;
+    std::string min_khz;
+    std::string max_khz;
+};
+
+void write_file(const std::string& path, const std::string& value) {
+    std::ofstream(path) << value << "\n";
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    std::getline(file, value);
+    return value;
+}
+
+void add_policy(const std::string& root, const std::string& name, uint32_t min_khz, uint32_t max_khz) {
+    std::string base = root + "/" + name;
+    mkdir(base.c_str(), 0755);
+    write_file(base + "/scaling_governor", "schedutil");
+    write_file(base + "/scaling_min_freq", std::to_string(min_khz));
+    write_file(base + "/scaling_max_freq", std::to_string(max_khz));
+    write_file(base + "/cpuinfo_min_freq", std::to_string(min_khz));
+    write_file(base + "/cpuinfo_max_freq", std::to_string(max_khz));
+    write_file(base + "/scaling_available_governors", "performance schedutil powersave");
+}
+
+void remove_tree(const std::string& root, const std::vector<std::string>& policies) {
+    for (const std::string& name : policies) {
+        for (const char* file : FILES) {
+            unlink((root + "/" + name + "/" + file).c_str());
+        }
+        rmdir((root + "/" + name).c_str());
+    }
+    rmdir(root.c_str());
+}
+
+class Checker {
+public:
+    Checker(const std::string& root, const std::vector<std::string>& policies, CpufreqManager& cpufreq)
+        : root_(root), policies_(policies), cpufreq_(cpufreq), writes_(0) {}
+
+    void check(const char* step, bool returned, bool expected_return, uint64_t expected_writes,
+               const std::vector<PolicyState>& expected) {
+        uint64_t writes = cpufreq_.get_write_count() - writes_;
+        writes_ = cpufreq_.get_write_count();
+
+        bool ok = returned == expected_return && writes == expected_writes;
+        std::string got;
+        for (size_t i = 0; i < policies_.size(); i++) {
+            std::string base = root_ + "/" + policies_[i] + "/";
+            PolicyState state = {read_file(base + "scaling_governor"),
+                                 read_file(base + "scaling_min_freq"),
+                                 read_file(base + "scaling_max_freq")};
+            got += " " + state.governor + " " + state.min_khz + "-" + state.max_khz;
+            ok = ok && state.governor == expected[i].governor &&
+                 state.min_khz == expected[i].min_khz && state.max_khz == expected[i].max_khz;
+        }
+
+        std::printf("  %-32s %-4s %llu writes,%s\n", step, ok ? "ok" : "FAIL",
+                    static_cast<unsigned long long>(writes), got.c_str());
+        if (!ok) {
+            std::string want;
+            for (const PolicyState& state : expected) {
+                want += " " + state.governor + " " + state.min_khz + "-" + state.max_khz;
+            }
+            std::printf("    expected %s, %llu writes,%s\n", expected_return ? "success" : "failure",
+                        static_cast<unsigned long long>(expected_writes), want.c_str());
+            failures++;
+        }
+    }
+
+    int failures = 0;
+
+private:
+    std::string root_;
+    std::vector<std::string> policies_;
+    CpufreqManager& cpufreq_;
+    uint64_t writes_;
+};
+
+} // namespace
+
+int main() {
+    char dir[] = "/tmp/touchdown-cpufreq-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    std::string root = dir;
+    std::vector<std::string> policies = {"policy0", "policy4"};
+    add_policy(root, "policy0", 300000, 1500000);
+    add_policy(root, "policy4", 500000, 2000000);
+
+    int failures = 0;
+    {
+        CpufreqManager cpufreq;
+        bool ret = cpufreq.init(root);
+        Checker checker(root, policies, cpufreq);
+        checker.check("init", ret && cpufreq.get_policy_count() == 2, true, 0,
+                      {{"schedutil", "300000", "1500000"}, {"schedutil", "500000", "2000000"}});
+
+        ret = cpufreq.apply({"schedutil", 0, 0});
+        checker.check("apply what is there", ret, true, 0,
+                      {{"schedutil", "300000", "1500000"}, {"schedutil", "500000", "2000000"}});
+
+        ret = cpufreq.apply({"powersave", 600000, 1200000});
+        checker.check("powersave 600-1200 MHz", ret, true, 6,
+                      {{"powersave", "600000", "1200000"}, {"powersave", "600000", "1200000"}});
+
+        ret = cpufreq.apply({"powersave", 600000, 1200000});
+        checker.check("same again", ret, true, 0,
+                      {{"powersave", "600000", "1200000"}, {"powersave", "600000", "1200000"}});
+
+        ret = cpufreq.apply({"turbo", 600000, 1200000});
+        checker.check("unknown governor", ret, false, 0,
+                      {{"powersave", "600000", "1200000"}, {"powersave", "600000", "1200000"}});
+
+        ret = cpufreq.apply({"", 100000, 9000000});
+        checker.check("limits beyond cpuinfo", ret, true, 4,
+                      {{"powersave", "300000", "1500000"}, {"powersave", "500000", "2000000"}});
+
+        ret = cpufreq.set_floor(1000000);
+        checker.check("floor 1000 MHz", ret, true, 2,
+                      {{"powersave", "1000000", "1500000"}, {"powersave", "1000000", "2000000"}});
+
+        ret = cpufreq.apply({"", 0, 1200000});
+        checker.check("max 1200 MHz under the floor", ret, true, 2,
+                      {{"powersave", "1000000", "1200000"}, {"powersave", "1000000", "1200000"}});
+
+        ret = cpufreq.set_floor(1800000);
+        checker.check("floor above max", ret, true, 2,
+                      {{"powersave", "1200000", "1200000"}, {"powersave", "1200000", "1200000"}});
+
+        ret = cpufreq.set_floor(0);
+        checker.check("floor removed", ret, true, 2,
+                      {{"powersave", "300000", "1200000"}, {"powersave", "500000", "1200000"}});
+
+        ret = cpufreq.apply({"schedutil", 0, 0});
+        checker.check("back to the initial values", ret, true, 4,
+                      {{"schedutil", "300000", "1500000"}, {"schedutil", "500000", "2000000"}});
+
+        failures = checker.failures;
+    }
+
+    remove_tree(root, policies);
+    std::printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
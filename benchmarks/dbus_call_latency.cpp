@@ -0,0 +1,179 @@
+/**
+ * @file dbus_call_latency.cpp
+ * @brief Method-call round trip latency through DBusInterface
+ *
+ * Starts a private bus, forks an echo service and times sequential
+ * Echo(s) → s calls from a client, one outstanding call at a time, so
+ * the figures are per-call latency through the backend this binary was
+ * linked against. Run the sd-bus and libdbus builds back to back to
+ * compare them.
+ *
+ * Usage: touchdown-dbus-bench-<backend> [calls] [payload bytes]
+ */
+
+#include "bench_bus.hpp"
+#include "touchdown/services/dbus_interface.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr const char* BENCH_SERVICE = "org.touchdown.Bench";
+constexpr const char* BENCH_PATH = "/org/touchdown/Bench";
+constexpr const char* BENCH_INTERFACE = "org.touchdown.Bench";
+constexpr int WARMUP_CALLS = 100;
+
+using touchdown::EventLoop;
+using touchdown::services::DBusInterface;
+using touchdown::services::Message;
+
+class EchoService : public DBusInterface {
+public:
+    EchoService() : DBusInterface(BENCH_SERVICE, BENCH_PATH) {
+        register_method(BENCH_INTERFACE, "Echo", "s", "s",
+            [](Message& msg) {
+                std::string payload;
+                if (!msg.read(payload)) return Message();
+                Message reply = msg.new_method_return();
+                reply.append(payload);
+                return reply;
+            });
+    }
+};
+
+class EchoClient : public DBusInterface {
+public:
+    EchoClient() : DBusInterface("org.touchdown.BenchClient", "/org/touchdown/BenchClient") {}
+
+    bool run(EventLoop& loop, int calls, const std::string& payload) {
+        warmup_ = WARMUP_CALLS;
+        remaining_ = calls + WARMUP_CALLS;
+        payload_ = payload;
+        samples_.reserve(calls);
+        if (!send_next()) return false;
+        loop.run();
+        return !failed_;
+    }
+
+    std::vector<uint64_t>& get_samples() { return samples_; }
+
+private:
+    bool send_next() {
+        Message msg = new_method_call(BENCH_SERVICE, BENCH_PATH, BENCH_INTERFACE, "Echo");
+        if (!msg || !msg.append(payload_)) return false;
+
+        uint64_t start = EventLoop::now_us();
+        return call_method_async(std::move(msg), [this, start](Message& reply) {
+            uint64_t elapsed = EventLoop::now_us() - start;
+            if (!reply || reply.is_error()) {
+                std::fprintf(stderr, "Echo failed: %s\n",
+                             reply ? reply.get_error_name() : "not sent");
+                failed_ = true;
+                loop_->stop();
+                return;
+            }
+
+            if (warmup_ > 0) {
+                warmup_--;
+            } else {
+                samples_.push_back(elapsed);
+            }
+            if (--remaining_ == 0 || !send_next()) {
+                loop_->stop();
+            }
+        });
+    }
+
+    int warmup_ = 0;
+    int remaining_ = 0;
+    bool failed_ = false;
+    std::string payload_;
+    std::vector<uint64_t> samples_;
+};
+
+int run_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+    loop.add_signal(SIGINT, on_signal);
+
+    EchoService service;
+    if (!service.init(loop)) return 1;
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    loop.run();
+    return 0;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int calls = argc > 1 ? std::atoi(argv[1]) : 10000;
+    size_t payload_size = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16;
+    if (calls <= 0) {
+        std::fprintf(stderr, "Usage: %s [calls] [payload bytes]\n", argv[0]);
+        return 2;
+    }
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        return 1;
+    }
+
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return 1;
+
+    pid_t service_pid = fork();
+    if (service_pid < 0) return 1;
+    if (service_pid == 0) {
+        close(ready[0]);
+        _exit(run_service(ready[1]));
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool service_ready = read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+    service_ready = service_ready && touchdown::bench::wait_for_name(BENCH_SERVICE);
+
+    int status = 1;
+    if (service_ready) {
+        EventLoop loop;
+        EchoClient client;
+        if (loop.init() && client.init(loop) &&
+            client.run(loop, calls, std::string(payload_size, 'x'))) {
+            std::vector<uint64_t>& samples = client.get_samples();
+            std::sort(samples.begin(), samples.end());
+
+            uint64_t total = 0;
+            for (uint64_t sample : samples) total += sample;
+
+            std::printf("backend=%s calls=%zu payload=%zu\n",
+                        DBusInterface::get_backend_name(), samples.size(), payload_size);
+            std::printf("  mean %8.1f us\n", static_cast<double>(total) / samples.size());
+            std::printf("  p50  %8llu us\n", static_cast<unsigned long long>(percentile(samples, 0.50)));
+            std::printf("  p99  %8llu us\n", static_cast<unsigned long long>(percentile(samples, 0.99)));
+            std::printf("  max  %8llu us\n", static_cast<unsigned long long>(samples.back()));
+            status = 0;
+        }
+    } else {
+        std::fprintf(stderr, "Echo service failed to start\n");
+    }
+
+    kill(service_pid, SIGTERM);
+    waitpid(service_pid, nullptr, 0);
+    return status;
+}
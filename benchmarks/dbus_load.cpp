@@ -0,0 +1,365 @@
+/**
+ * @file dbus_load.cpp
+ * @brief Load test of the power and input services on a private bus
+ *
+ * Starts a private bus, runs PowerService and InputService against it
+ * with no hardware (a scripted touch controller keeps dragging), and
+ * forks N clients. Each client keeps one call outstanding, cycling
+ * through GetPowerState, GetLastTouch and GetLastButton. It also
+ * subscribes to the touch signals and mirrors the Input properties.
+ * Reported: call throughput and round-trip latency, and signal
+ * throughput and sample-to-client delay.
+ *
+ * Needs only dbus-daemon in PATH, no system bus or root. Run it
+ * unprivileged: the power service sets the CPU governor at startup
+ * when it can. Exits with status 77 (skipped) without dbus-daemon.
+ *
+ * Usage: touchdown-dbus-load [clients] [seconds]
+ */
+
+#include "bench_bus.hpp"
+#include "scripted_touch_bus.hpp"
+#include "touchdown/services/power_service.hpp"
+#include "touchdown/services/input_service.hpp"
+#include "touchdown/drivers/touch_driver.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/core/utils.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t WARMUP_MS = 500;
+constexpr uint64_t DRAIN_MS = 200;   // Replies to calls sent just before the end
+
+using touchdown::EventLoop;
+using touchdown::Utils;
+using touchdown::services::DBusInterface;
+using touchdown::services::InputProxy;
+using touchdown::services::PowerProxy;
+
+// Sent from each client to the parent, followed by the samples
+struct ClientReport {
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t signals;
+    uint64_t property_updates;
+    uint64_t call_samples;     // uint32_t round trip, us
+    uint64_t signal_samples;   // uint32_t sample to client, ms
+};
+
+bool write_all(int fd, const void* data, size_t len) {
+    auto* p = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t len) {
+    auto* p = static_cast<uint8_t*>(data);
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+class LoadClient : public DBusInterface {
+public:
+    explicit LoadClient(int index)
+        : DBusInterface("org.touchdown.BenchLoad" + std::to_string(index), "/org/touchdown/BenchLoad")
+        , power_(*this)
+        , input_(*this) {}
+
+    void run(EventLoop& loop, uint64_t seconds) {
+        uint64_t now = EventLoop::now_us();
+        measure_from_us_ = now + WARMUP_MS * 1000;
+        measure_until_us_ = measure_from_us_ + seconds * 1000000;
+
+        input_.on_touch_moved([this](const auto& samples) {
+            for (const auto& sample : samples) record_signal(std::get<3>(sample));
+        });
+        input_.on_touch_event([this](const auto& sample) { record_signal(std::get<3>(sample)); });
+        input_.watch_properties([this]() {
+            if (measuring()) report_.property_updates++;
+        });
+
+        EventLoop::TimerId end = loop.add_timer([&loop]() { loop.stop(); });
+        loop.arm_timer_at(end, measure_until_us_ + DRAIN_MS * 1000);
+
+        send_next();
+        loop.run();
+    }
+
+    bool send_report(int fd) {
+        report_.call_samples = call_us_.size();
+        report_.signal_samples = signal_ms_.size();
+        return write_all(fd, &report_, sizeof(report_)) &&
+               write_all(fd, call_us_.data(), call_us_.size() * sizeof(uint32_t)) &&
+               write_all(fd, signal_ms_.data(), signal_ms_.size() * sizeof(uint32_t));
+    }
+
+private:
+    bool measuring() const {
+        uint64_t now = EventLoop::now_us();
+        return now >= measure_from_us_ && now < measure_until_us_;
+    }
+
+    void record_signal(uint32_t timestamp_ms) {
+        if (!measuring()) return;
+        report_.signals++;
+        signal_ms_.push_back(Utils::get_timestamp_ms() - timestamp_ms);
+    }
+
+    void complete(uint64_t start_us, const char* error) {
+        if (start_us >= measure_from_us_ && start_us < measure_until_us_) {
+            if (error) {
+                report_.errors++;
+            } else {
+                report_.calls++;
+                call_us_.push_back(static_cast<uint32_t>(EventLoop::now_us() - start_us));
+            }
+        }
+        if (EventLoop::now_us() < measure_until_us_) {
+            send_next();
+        }
+    }
+
+    void send_next() {
+        uint64_t start = EventLoop::now_us();
+        switch (next_call_++ % 3) {
+            case 0:
+                power_.get_power_state([this, start](const char* error, const std::string&) {
+                    complete(start, error);
+                });
+                break;
+            case 1:
+                input_.get_last_touch([this, start](const char* error, int16_t, int16_t, uint32_t) {
+                    complete(start, error);
+                });
+                break;
+            default:
+                input_.get_last_button([this, start](const char* error, uint32_t, uint32_t, uint16_t) {
+                    complete(start, error);
+                });
+                break;
+        }
+    }
+
+    PowerProxy power_;
+    InputProxy input_;
+    unsigned next_call_ = 0;
+    uint64_t measure_from_us_ = 0;
+    uint64_t measure_until_us_ = 0;
+    ClientReport report_ = {};
+    std::vector<uint32_t> call_us_;
+    std::vector<uint32_t> signal_ms_;
+};
+
+int run_input_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::drivers::TouchDriver touch;
+    touch.init(std::make_unique<touchdown::bench::ScriptedTouchBus>());
+
+    touchdown::services::InputService service;
+    if (!service.init(loop, &touch, nullptr)) return 1;
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+int run_power_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::services::PowerService service;
+    if (!service.init(loop)) return 1;
+    service.set_screen_timeout(0);  // Stay ACTIVE for the whole run
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+int run_client(int index, uint64_t seconds, int report_fd) {
+    EventLoop loop;
+    LoadClient client(index);
+    if (!loop.init() || !client.init(loop)) return 1;
+
+    client.run(loop, seconds);
+    return client.send_report(report_fd) ? 0 : 1;
+}
+
+pid_t start_service(int (*run)(int)) {
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        _exit(run(ready[1]));
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool ok = pid > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+
+    if (!ok && pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+    return pid;
+}
+
+uint64_t percentile(const std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int clients = argc > 1 ? std::atoi(argv[1]) : 8;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (clients <= 0 || seconds <= 0) {
+        std::fprintf(stderr, "Usage: %s [clients] [seconds]\n", argv[0]);
+        return 2;
+    }
+
+    if (!touchdown::bench::have_dbus_tools()) return touchdown::bench::EXIT_SKIP;
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        return 1;
+    }
+
+    // Input first: the power service attaches to its activity page
+    pid_t input_pid = start_service(run_input_service);
+    if (input_pid > 0 && !touchdown::bench::wait_for_name("org.touchdown.Input")) {
+        kill(input_pid, SIGTERM);
+        waitpid(input_pid, nullptr, 0);
+        input_pid = -1;
+    }
+    pid_t power_pid = input_pid > 0 ? start_service(run_power_service) : -1;
+    if (power_pid > 0 && !touchdown::bench::wait_for_name("org.touchdown.Power")) {
+        kill(power_pid, SIGTERM);
+        waitpid(power_pid, nullptr, 0);
+        power_pid = -1;
+    }
+    if (input_pid < 0 || power_pid < 0) {
+        std::fprintf(stderr, "Services failed to start\n");
+        if (input_pid > 0) {
+            kill(input_pid, SIGTERM);
+            waitpid(input_pid, nullptr, 0);
+        }
+        return 1;
+    }
+
+    std::vector<pid_t> client_pids;
+    std::vector<int> report_fds;
+    for (int i = 0; i < clients; i++) {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) < 0) break;
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            _exit(run_client(i, seconds, fds[1]));
+        }
+        close(fds[1]);
+        if (pid < 0) {
+            close(fds[0]);
+            break;
+        }
+        client_pids.push_back(pid);
+        report_fds.push_back(fds[0]);
+    }
+
+    ClientReport total = {};
+    std::vector<uint32_t> call_us;
+    std::vector<uint32_t> signal_ms;
+    int failed = clients - static_cast<int>(client_pids.size());
+
+    for (int fd : report_fds) {
+        ClientReport report;
+        if (!read_all(fd, &report, sizeof(report))) {
+            failed++;
+            close(fd);
+            continue;
+        }
+
+        size_t calls_at = call_us.size();
+        size_t signals_at = signal_ms.size();
+        call_us.resize(calls_at + report.call_samples);
+        signal_ms.resize(signals_at + report.signal_samples);
+        if (!read_all(fd, call_us.data() + calls_at, report.call_samples * sizeof(uint32_t)) ||
+            !read_all(fd, signal_ms.data() + signals_at, report.signal_samples * sizeof(uint32_t))) {
+            failed++;
+        }
+        close(fd);
+
+        total.calls += report.calls;
+        total.errors += report.errors;
+        total.signals += report.signals;
+        total.property_updates += report.property_updates;
+    }
+
+    for (pid_t pid : client_pids) {
+        waitpid(pid, nullptr, 0);
+    }
+    kill(power_pid, SIGTERM);
+    kill(input_pid, SIGTERM);
+    waitpid(power_pid, nullptr, 0);
+    waitpid(input_pid, nullptr, 0);
+
+    std::sort(call_us.begin(), call_us.end());
+    std::sort(signal_ms.begin(), signal_ms.end());
+
+    std::printf("backend=%s clients=%d seconds=%d\n", DBusInterface::get_backend_name(), clients, seconds);
+    std::printf("  calls    %8llu  %9.1f/s  p50 %6llu us  p99 %6llu us  max %6llu us  errors %llu\n",
+                static_cast<unsigned long long>(total.calls),
+                static_cast<double>(total.calls) / seconds,
+                static_cast<unsigned long long>(percentile(call_us, 0.50)),
+                static_cast<unsigned long long>(percentile(call_us, 0.99)),
+                static_cast<unsigned long long>(call_us.empty() ? 0 : call_us.back()),
+                static_cast<unsigned long long>(total.errors));
+    std::printf("  signals  %8llu  %9.1f/s  p50 %6llu ms  p99 %6llu ms  (sample to client)\n",
+                static_cast<unsigned long long>(total.signals),
+                static_cast<double>(total.signals) / seconds,
+                static_cast<unsigned long long>(percentile(signal_ms, 0.50)),
+                static_cast<unsigned long long>(percentile(signal_ms, 0.99)));
+    std::printf("  property updates %llu\n", static_cast<unsigned long long>(total.property_updates));
+
+    if (failed > 0) {
+        std::fprintf(stderr, "%d client(s) failed\n", failed);
+        return 1;
+    }
+    return total.calls > 0 ? 0 : 1;
+}
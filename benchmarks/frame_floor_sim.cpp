@@ -0,0 +1,255 @@
+/**
+ * @file frame_floor_sim.cpp
+ * @brief Replays a recorded frame trace through the frame floor controller
+ *
+ * The shell writes a trace when debug.frame_trace_file is set: one line
+ * per rendered frame with its start time and render time. Record it with
+ * the CPU held at one clock (userspace or performance governor) and pass
+ * that clock as trace_khz. Each frame's work is then taken as
+ * render_us * trace_khz cycles, and replaying it at another clock
+ * scales its render time accordingly. Memory stalls do not scale like
+ * that, so misses at low clocks are somewhat overstated.
+ *
+ * Every trace is replayed at the governor clock alone, at the highest
+ * floor throughout, and with the FrameFloorController raising the floor
+ * from the same once-a-second reports the shell sends. Floor changes
+ * take effect from the next frame; the real service adds a sysfs write
+ * on its worker thread. Frame start times are kept as recorded, even
+ * when a slower replay would have delayed them.
+ *
+ * The trace also marks each interaction start ("press" lines). From
+ * those, the input boost is replayed as the power service runs it: the
+ * floor goes to boost_khz for boost_ms, at most once per
+ * boost_interval_ms. It is replayed alone and together with the frame
+ * floor. Alongside the misses, the boosted replays report the boosts,
+ * the time at boost and the mean render time of the first frame after
+ * each press, which is what the boost is for.
+ *
+ * Tune with the same values as power.frame_floor_* and
+ * power.input_boost_* in shell.conf.
+ *
+ * Usage: touchdown-frame-floor-sim <trace> <trace_khz> [governor_khz]
+ *                                  [min_khz] [max_khz] [step_khz]
+ *                                  [boost_khz] [boost_ms] [boost_interval_ms]
+ */
+
+#include "touchdown/core/frame_feedback.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t REPORT_INTERVAL_US = 1000000;  // As sent by the shell
+
+using touchdown::FrameFloorConfig;
+using touchdown::FrameFloorController;
+using touchdown::FrameReport;
+using touchdown::FrameStats;
+
+struct Frame {
+    uint64_t start_us;
+    uint64_t render_us;
+};
+
+struct Boost {
+    uint32_t khz = 0;  // 0 = no input boost
+    uint32_t duration_ms = 200;
+    uint32_t interval_ms = 500;
+};
+
+struct Result {
+    uint64_t frames = 0;
+    uint64_t missed = 0;
+    uint64_t raises = 0;
+    uint64_t floor_changes = 0;
+    double busy_khz_us = 0;  // Clock weighted by replayed render time
+    double busy_us = 0;
+    uint64_t boosts = 0;
+    uint64_t boost_us = 0;
+    uint64_t first_frames = 0;  // First frame after each press
+    uint64_t first_render_us = 0;
+};
+
+bool load_trace(const char* path, std::vector<Frame>& frames, std::vector<uint64_t>& presses,
+                uint32_t& deadline_us) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        if (line[0] == '#') {
+            // "# start_us render_us, deadline 33000 us"
+            const char* deadline = std::strstr(line.c_str(), "deadline ");
+            if (deadline) deadline_us = static_cast<uint32_t>(std::strtoul(deadline + 9, nullptr, 10));
+            continue;
+        }
+
+        std::istringstream fields(line);
+        if (line.compare(0, 6, "press ") == 0) {
+            std::string tag;
+            uint64_t press_us;
+            if (fields >> tag >> press_us) presses.push_back(press_us);
+            continue;
+        }
+
+        Frame frame;
+        if (fields >> frame.start_us >> frame.render_us) {
+            frames.push_back(frame);
+        }
+    }
+    return !frames.empty();
+}
+
+// controller == nullptr replays at max(governor_khz, fixed_floor_khz)
+Result replay(const std::vector<Frame>& trace, const std::vector<uint64_t>& presses,
+              uint32_t trace_khz, uint32_t governor_khz, uint32_t fixed_floor_khz,
+              const FrameFloorConfig& config, FrameFloorController* controller,
+              const Boost& boost) {
+    Result result;
+    FrameStats stats(config.deadline_us);
+    uint32_t floor_khz = fixed_floor_khz;
+
+    size_t next_press = 0;
+    bool first_pending = false;
+    uint64_t boost_start_us = 0;
+    uint64_t boost_end_us = 0;
+
+    for (const Frame& frame : trace) {
+        // Presses up to this frame, boosting as PowerService::start_input_boost()
+        for (; next_press < presses.size() && presses[next_press] <= frame.start_us; next_press++) {
+            uint64_t press_us = presses[next_press];
+            first_pending = true;
+            if (boost.khz == 0 || press_us < boost_end_us) continue;
+            if (result.boosts > 0 && press_us - boost_start_us < boost.interval_ms * 1000ULL) continue;
+
+            boost_start_us = press_us;
+            boost_end_us = press_us + boost.duration_ms * 1000ULL;
+            result.boosts++;
+            result.boost_us += boost.duration_ms * 1000ULL;
+        }
+
+        uint32_t khz = std::max(governor_khz, floor_khz);
+        if (frame.start_us < boost_end_us) khz = std::max(khz, boost.khz);
+        uint64_t render_us = frame.render_us * trace_khz / khz;
+
+        if (first_pending) {
+            first_pending = false;
+            result.first_frames++;
+            result.first_render_us += render_us;
+        }
+
+        result.frames++;
+        if (render_us > config.deadline_us) result.missed++;
+        result.busy_khz_us += static_cast<double>(khz) * render_us;
+        result.busy_us += render_us;
+
+        stats.add(frame.start_us, render_us);
+
+        FrameReport report;
+        if (controller && stats.take(frame.start_us + render_us, REPORT_INTERVAL_US, report)) {
+            uint32_t next_khz = controller->update(report);
+            if (next_khz != floor_khz) result.floor_changes++;
+            floor_khz = next_khz;
+        }
+    }
+
+    // A boost still running at the end of the trace counts up to there
+    if (boost_end_us > trace.back().start_us) {
+        result.boost_us -= boost_end_us - std::max(trace.back().start_us, boost_start_us);
+    }
+
+    if (controller) result.raises = controller->get_raise_count();
+    return result;
+}
+
+void print(const char* name, const Result& result, uint64_t trace_us) {
+    double mean_khz = result.busy_us > 0 ? result.busy_khz_us / result.busy_us : 0;
+    std::printf("  %-20s %7llu %6.2f%%  %9.0f  %6llu  %6llu  %7.2f", name,
+                static_cast<unsigned long long>(result.missed),
+                result.frames > 0 ? result.missed * 100.0 / result.frames : 0.0,
+                mean_khz,
+                static_cast<unsigned long long>(result.floor_changes),
+                static_cast<unsigned long long>(result.raises),
+                result.first_frames > 0 ? result.first_render_us / 1000.0 / result.first_frames : 0.0);
+    if (result.boosts > 0) {
+        std::printf("  %6llu  %6.1f s (%.1f%%)", static_cast<unsigned long long>(result.boosts),
+                    result.boost_us / 1e6, trace_us > 0 ? result.boost_us * 100.0 / trace_us : 0.0);
+    }
+    std::printf("\n");
+}
+
+uint32_t arg_value(int argc, char* argv[], int index, uint32_t default_value) {
+    return argc > index ? static_cast<uint32_t>(std::strtoul(argv[index], nullptr, 10)) : default_value;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <trace> <trace_khz> [governor_khz] [min_khz] [max_khz] [step_khz]\n"
+                     "       [boost_khz] [boost_ms] [boost_interval_ms]\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t trace_khz = arg_value(argc, argv, 2, 0);
+
+    FrameFloorConfig config;
+    uint32_t governor_khz = arg_value(argc, argv, 3, trace_khz / 2);
+    config.min_khz = arg_value(argc, argv, 4, governor_khz);
+    config.max_khz = arg_value(argc, argv, 5, trace_khz);
+    config.step_khz = arg_value(argc, argv, 6, config.step_khz);
+    Boost boost;
+    boost.khz = arg_value(argc, argv, 7, config.max_khz);
+    boost.duration_ms = arg_value(argc, argv, 8, boost.duration_ms);
+    boost.interval_ms = arg_value(argc, argv, 9, boost.interval_ms);
+    if (trace_khz == 0 || governor_khz == 0 || config.max_khz == 0) {
+        std::fprintf(stderr, "Clocks must be nonzero\n");
+        return 2;
+    }
+
+    std::vector<Frame> trace;
+    std::vector<uint64_t> presses;
+    if (!load_trace(argv[1], trace, presses, config.deadline_us)) {
+        std::fprintf(stderr, "No frames in %s\n", argv[1]);
+        return 1;
+    }
+
+    FrameFloorController controller(config);
+    Boost none;
+    none.khz = 0;
+
+    Result governor = replay(trace, presses, trace_khz, governor_khz, 0, config, nullptr, none);
+    Result fixed = replay(trace, presses, trace_khz, governor_khz, config.max_khz, config, nullptr, none);
+    Result feedback = replay(trace, presses, trace_khz, governor_khz, 0, config, &controller, none);
+
+    uint64_t trace_us = trace.back().start_us - trace.front().start_us;
+    std::printf("trace=%s frames=%zu (%llu s) presses=%zu recorded at %u kHz, deadline %u us\n",
+                argv[1], trace.size(), static_cast<unsigned long long>(trace_us / 1000000),
+                presses.size(), trace_khz, config.deadline_us);
+    std::printf("governor %u kHz, floor %u-%u kHz in %u kHz steps, boost %u kHz for %u ms every %u ms\n",
+                governor_khz, config.min_khz, config.max_khz, config.step_khz,
+                boost.khz, boost.duration_ms, boost.interval_ms);
+    std::printf("  %-20s %7s %7s  %9s  %6s  %6s  %7s  %6s  %s\n", "policy", "missed", "", "mean kHz",
+                "moves", "raises", "1st ms", "boosts", "at boost");
+    print("governor only", governor, trace_us);
+    print("fixed floor", fixed, trace_us);
+    print("frame floor", feedback, trace_us);
+
+    if (presses.empty()) {
+        std::printf("  no press lines in the trace, input boost not replayed\n");
+        return 0;
+    }
+    Result boosted = replay(trace, presses, trace_khz, governor_khz, 0, config, nullptr, boost);
+    FrameFloorController boosted_controller(config);
+    Result both = replay(trace, presses, trace_khz, governor_khz, 0, config, &boosted_controller, boost);
+    print("input boost", boosted, trace_us);
+    print("boost + frame floor", both, trace_us);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file input_discovery_bench.cpp
+ * @brief Times finding the power button: node scan against sysfs capabilities
+ *
+ * "scan" is the discovery the button driver used before: open
+ * /dev/input/event0..9 in turn and ask each for its name with
+ * EVIOCGNAME until one is called "Power Button". Every open wakes the
+ * driver behind that node; a node that is still being probed blocks
+ * until the probe is done.
+ *
+ * "sysfs" is InputDeviceMonitor: read /sys/class/input once, without
+ * opening a device, and pick the first node with KEY_POWER.
+ *
+ * Both run the given number of times, alternating, and the mean and
+ * worst time of each are printed. Startup also used to wait for
+ * systemd-udev-settle.service. That wait only exists at boot and is not
+ * measured here. Take it on the device with
+ * `systemd-analyze critical-chain touchdown-input.service`.
+ *
+ * Usage: touchdown-input-discovery-bench [iterations]
+ */
+
+#include "touchdown/drivers/input_device_monitor.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+using touchdown::EventLoop;
+
+struct Timing {
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    int runs = 0;
+    std::string found;
+
+    void add(uint64_t us) {
+        total_us += us;
+        max_us = std::max(max_us, us);
+        runs++;
+    }
+};
+
+// The button driver's discovery before capability lookup
+std::string scan_nodes() {
+    for (int i = 0; i < 10; i++) {
+        std::string device = "/dev/input/event" + std::to_string(i);
+        int fd = open(device.c_str(), O_RDONLY | O_NONBLOCK);
+        if (fd < 0) continue;
+
+        char name[256] = {0};
+        bool match = false;
+        if (ioctl(fd, EVIOCGNAME(sizeof(name)), name) >= 0) {
+            std::string device_name(name);
+            match = device_name.find("Power Button") != std::string::npos ||
+                    device_name.find("touchdown-button") != std::string::npos;
+        }
+        close(fd);
+        if (match) return device;
+    }
+    return "";
+}
+
+std::string read_sysfs() {
+    EventLoop loop;
+    touchdown::drivers::InputDeviceMonitor devices;
+    if (!loop.init() || !devices.init(loop)) return "";
+
+    const touchdown::drivers::InputDeviceInfo* info = devices.find_by_key(KEY_POWER);
+    return info ? info->node : "";
+}
+
+void print(const char* name, const Timing& timing) {
+    if (timing.runs == 0) return;
+    std::printf("  %-6s mean %8.1f us  max %8llu us  found %s\n", name,
+                static_cast<double>(timing.total_us) / timing.runs,
+                static_cast<unsigned long long>(timing.max_us),
+                timing.found.empty() ? "nothing" : timing.found.c_str());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    Timing scan;
+    Timing sysfs;
+    for (int i = 0; i < iterations; i++) {
+        uint64_t start_us = EventLoop::now_us();
+        scan.found = scan_nodes();
+        scan.add(EventLoop::now_us() - start_us);
+
+        start_us = EventLoop::now_us();
+        sysfs.found = read_sysfs();
+        sysfs.add(EventLoop::now_us() - start_us);
+    }
+
+    std::printf("power button discovery, %d iterations:\n", iterations);
+    print("scan", scan);
+    print("sysfs", sysfs);
+    return 0;
+}
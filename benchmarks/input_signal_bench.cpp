@@ -0,0 +1,266 @@
+/**
+ * @file input_signal_bench.cpp
+ * @brief Touch signal rate and CPU cost of the input service during a drag
+ *
+ * Runs InputService on a private bus with a scripted touch controller,
+ * which it samples at 100 Hz while the finger is down (600 ms drags with
+ * 200 ms lifts). A client subscribes to TouchMoved and TouchEvent and
+ * counts messages and samples per second. The utime and stime of the
+ * service, the bus daemon and the client are read from /proc/<pid>/stat
+ * at the start and the end of the window.
+ *
+ * The same run is repeated with every drag sample sent in a TouchMoved
+ * of its own, to show what the per-frame batching saves. Each mode runs
+ * in a fresh service.
+ *
+ * Needs only dbus-daemon in PATH, no system bus or root. CPU time has
+ * the kernel's tick resolution (usually 10 ms), so use a few seconds.
+ *
+ * Usage: touchdown-input-signal-bench [seconds]
+ */
+
+#include "bench_bus.hpp"
+#include "scripted_touch_bus.hpp"
+#include "touchdown/services/input_service.hpp"
+#include "touchdown/drivers/touch_driver.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+
+constexpr uint64_t WARMUP_MS = 500;
+
+using touchdown::EventLoop;
+using touchdown::services::DBusInterface;
+using touchdown::services::InputProxy;
+
+// Sent from each run to the parent
+struct RunReport {
+    uint64_t messages;
+    uint64_t samples;
+    uint64_t service_ticks;
+    uint64_t bus_ticks;
+    uint64_t client_ticks;
+    bool ok;
+};
+
+// Clock ticks of the three processes at one point
+struct CpuSample {
+    uint64_t service = 0;
+    uint64_t bus = 0;
+    uint64_t client = 0;
+};
+
+// utime + stime of a process, in clock ticks
+bool read_cpu_ticks(pid_t pid, uint64_t& ticks) {
+    // The command name may hold spaces; the fields start after its ')'
+    std::ifstream stat_file("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    std::getline(stat_file, stat);
+    size_t end = stat.rfind(')');
+    if (end == std::string::npos) return false;
+
+    std::istringstream fields(stat.substr(end + 2));
+    std::string field;
+    ticks = 0;
+    // state is field 3; utime and stime are 14 and 15
+    int index = 3;
+    for (; index <= 15 && fields >> field; index++) {
+        if (index >= 14) ticks += std::strtoull(field.c_str(), nullptr, 10);
+    }
+    return index > 15;
+}
+
+class SignalCounter : public DBusInterface {
+public:
+    SignalCounter() : DBusInterface("org.touchdown.BenchSignals", "/org/touchdown/BenchSignals")
+                    , input_(*this) {}
+
+    void subscribe() {
+        input_.on_touch_moved([this](const auto& samples) { count(samples.size()); });
+        input_.on_touch_event([this](const auto&) { count(1); });
+    }
+
+    void set_counting(bool counting) { counting_ = counting; }
+    uint64_t messages() const { return messages_; }
+    uint64_t samples() const { return samples_; }
+
+private:
+    void count(size_t samples) {
+        if (!counting_) return;
+        messages_++;
+        samples_ += samples;
+    }
+
+    InputProxy input_;
+    bool counting_ = false;
+    uint64_t messages_ = 0;
+    uint64_t samples_ = 0;
+};
+
+bool per_sample = false;  // Each drag sample in a TouchMoved of its own
+pid_t bus_pid = -1;
+
+bool read_cpu(pid_t service_pid, CpuSample& sample) {
+    return read_cpu_ticks(service_pid, sample.service) && read_cpu_ticks(bus_pid, sample.bus) &&
+           read_cpu_ticks(getpid(), sample.client);
+}
+
+int run_input_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::drivers::TouchDriver touch;
+    touch.init(std::make_unique<touchdown::bench::ScriptedTouchBus>());
+
+    touchdown::services::InputService service;
+    if (per_sample) service.set_move_batch_interval(0);
+    if (!service.init(loop, &touch, nullptr)) return 1;
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+pid_t start_service(int (*run)(int)) {
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        _exit(run(ready[1]));
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool ok = pid > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+
+    if (!ok && pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+    return pid;
+}
+
+void wait(EventLoop& loop, EventLoop::TimerId timer, uint64_t ms) {
+    loop.arm_timer(timer, static_cast<uint32_t>(ms));
+    loop.run();
+}
+
+// One mode, with a service of its own: libdbus keeps one connection per
+// process, and the client must not exist before the service is forked
+RunReport run_once(int seconds) {
+    RunReport report = {};
+
+    pid_t pid = start_service(run_input_service);
+    if (pid < 0) return report;
+    if (!touchdown::bench::wait_for_name("org.touchdown.Input")) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+        return report;
+    }
+
+    EventLoop loop;
+    SignalCounter counter;
+    if (loop.init() && counter.init(loop)) {
+        EventLoop::TimerId timer = loop.add_timer([&loop]() { loop.stop(); });
+        counter.subscribe();
+        wait(loop, timer, WARMUP_MS);
+
+        CpuSample before;
+        CpuSample after;
+        bool sampled = read_cpu(pid, before);
+        counter.set_counting(true);
+        wait(loop, timer, static_cast<uint64_t>(seconds) * 1000);
+        counter.set_counting(false);
+        sampled = read_cpu(pid, after) && sampled;
+
+        report.messages = counter.messages();
+        report.samples = counter.samples();
+        report.service_ticks = after.service - before.service;
+        report.bus_ticks = after.bus - before.bus;
+        report.client_ticks = after.client - before.client;
+        report.ok = sampled && report.samples > 0;
+    }
+
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return report;
+}
+
+bool in_child(int seconds, RunReport& report) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) return false;
+
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        RunReport result = run_once(seconds);
+        _exit(write(fds[1], &result, sizeof(result)) == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+
+    bool ok = pid > 0 && read(fds[0], &report, sizeof(report)) == sizeof(report);
+    close(fds[0]);
+    if (pid > 0) waitpid(pid, nullptr, 0);
+    return ok && report.ok;
+}
+
+void print(const char* mode, const RunReport& report, int seconds) {
+    double tick_ms = 1000.0 / sysconf(_SC_CLK_TCK);
+    std::printf("  %-12s %6.1f msgs/s %6.1f samples/s  cpu ms: service %5.0f, bus %5.0f, "
+                "client %5.0f\n", mode,
+                static_cast<double>(report.messages) / seconds,
+                static_cast<double>(report.samples) / seconds, report.service_ticks * tick_ms,
+                report.bus_ticks * tick_ms, report.client_ticks * tick_ms);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (seconds <= 0) {
+        std::fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+        return 2;
+    }
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        return 2;
+    }
+    bus_pid = bus.get_pid();
+
+    RunReport batched;
+    bool ok = in_child(seconds, batched);
+
+    RunReport unbatched;
+    per_sample = true;
+    ok = ok && in_child(seconds, unbatched);
+
+    if (!ok) {
+        std::fprintf(stderr, "Input service did not start or sent no touch signals\n");
+        return 2;
+    }
+
+    std::printf("backend=%s, input service dragging at 100 Hz for %d s:\n",
+                DBusInterface::get_backend_name(), seconds);
+    print("per frame", batched, seconds);
+    print("per sample", unbatched, seconds);
+    return 0;
+}
@@ -0,0 +1,325 @@
+/**
+ * @file input_trace_replay.cpp
+ * @brief Replays a scripted drag through the input ring into the latency tracer
+ *
+ * Runs InputService on a private bus with a scripted touch controller
+ * (600 ms drags, 200 ms lifts, sampled at 100 Hz), opens its event ring
+ * the way the shell does and traces every event read from it. The
+ * shell's side is stood in for: the ring wakeup runs the UI step at
+ * once, drag positions not yet read are replaced (and their traces
+ * cancelled), each UI step consumes the queued samples and invalidates,
+ * and a frame is flushed at most every LV_DISP_DEF_REFR_PERIOD.
+ *
+ * Prints the per-stage latencies, then fails on a regression:
+ *
+ *  - events lost on the ring, or trace ids out of sequence
+ *  - a trace neither completed nor cancelled, e.g. closed as unchanged
+ *  - publish to dispatch, or sample to flush, over budget at p99
+ *
+ * Needs only dbus-daemon in PATH, no system bus or root. Exits with
+ * status 1 on a regression, and 77 (skipped) without dbus-daemon.
+ *
+ * Usage: touchdown-input-trace-replay [seconds]
+ */
+
+#include "bench_bus.hpp"
+#include "scripted_touch_bus.hpp"
+#include "touchdown/services/input_service.hpp"
+#include "touchdown/drivers/touch_driver.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/core/input_ring.hpp"
+#include "touchdown/core/latency_tracer.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace {
+
+constexpr uint32_t REFRESH_MS = 33;         // LV_DISP_DEF_REFR_PERIOD
+constexpr uint32_t OPEN_RING_TIMEOUT_MS = 5000;
+
+// Woken per publish, the stand-in reads an event well within a poll period
+constexpr uint64_t DISPATCH_BUDGET_US = 5000;
+// Sampled at most a refresh period before the next frame, plus scheduling
+constexpr uint64_t TOTAL_BUDGET_US = (REFRESH_MS + 10) * 1000;
+
+using touchdown::EventLoop;
+using touchdown::InputEvent;
+using touchdown::InputRingReader;
+using touchdown::LatencyHistogram;
+using touchdown::LatencyTracer;
+using touchdown::TouchEventType;
+using touchdown::TraceStage;
+using touchdown::services::DBusInterface;
+using touchdown::services::InputProxy;
+
+int run_input_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::drivers::TouchDriver touch;
+    touch.init(std::make_unique<touchdown::bench::ScriptedTouchBus>());
+
+    touchdown::services::InputService service;
+    if (!service.init(loop, &touch, nullptr)) return 1;
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+pid_t start_service(int (*run)(int)) {
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        _exit(run(ready[1]));
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool ok = pid > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+
+    if (!ok && pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+    return pid;
+}
+
+// The shell's part of the trace: ring reads, pointer samples and frames
+class ReplayShell : public DBusInterface {
+public:
+    ReplayShell(EventLoop& loop)
+        : DBusInterface("org.touchdown.BenchReplay", "/org/touchdown/BenchReplay")
+        , loop_(loop)
+        , input_(*this)
+        , wake_fd_(-1)
+        , ui_timer_(EventLoop::INVALID_TIMER)
+        , stop_timer_(EventLoop::INVALID_TIMER) {}
+
+    ~ReplayShell() {
+        if (wake_fd_ >= 0) close(wake_fd_);
+    }
+
+    bool start() {
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0 || !init(loop_)) return false;
+
+        loop_.add_fd(wake_fd_, EPOLLIN, [this](uint32_t) { on_ring_ready(); });
+        ui_timer_ = loop_.add_timer([this]() { on_ui_step(); });
+        stop_timer_ = loop_.add_timer([this]() { loop_.stop(); });
+
+        input_.open_event_ring(wake_fd_, [this](const char* error, int ring_fd) {
+            if (!error && ring_.attach(ring_fd)) attached_ = true;
+            loop_.stop();
+        }, OPEN_RING_TIMEOUT_MS);
+        wait(OPEN_RING_TIMEOUT_MS + 1000);
+        return attached_;
+    }
+
+    void wait(uint32_t ms) {
+        loop_.arm_timer(stop_timer_, ms);
+        loop_.run();
+    }
+
+    // The service has stopped: hand over what is left and flush it
+    void finish() {
+        on_ring_ready();
+        next_refresh_us_ = 0;
+        on_ui_step();
+    }
+
+    uint64_t read_count() const { return read_; }
+    uint64_t cancelled_count() const { return cancelled_; }
+    uint64_t out_of_sequence_count() const { return out_of_sequence_; }
+    uint64_t lost_count() const { return ring_.get_lost_count(); }
+
+private:
+    void on_ring_ready() {
+        uint64_t value;
+        if (read(wake_fd_, &value, sizeof(value)) < 0) {
+            // Already drained
+        }
+        if (drain() > 0) loop_.arm_timer(ui_timer_, 0);
+    }
+
+    size_t drain() {
+        size_t handled = 0;
+        InputEvent event;
+        while (ring_.read(event)) {
+            read_++;
+            if (last_trace_id_ != 0 && event.trace_id != last_trace_id_ + 1) {
+                out_of_sequence_++;
+            }
+            last_trace_id_ = event.trace_id;
+
+            LatencyTracer::instance().begin(event, EventLoop::now_us());
+            queue(event);
+            handled++;
+        }
+        return handled;
+    }
+
+    void queue(const InputEvent& event) {
+        // Only the latest position of a drag reaches LVGL, as in the shell
+        bool move = event.kind == InputEvent::Kind::TOUCH &&
+                    event.touch.type == TouchEventType::MOVE;
+        if (move && !pending_.empty() && pending_.back().second) {
+            LatencyTracer::instance().cancel(pending_.back().first);
+            cancelled_++;
+            pending_.back().first = event.trace_id;
+        } else {
+            pending_.emplace_back(event.trace_id, move);
+        }
+    }
+
+    // One lv_timer_handler() run: pointer reads, then the refresh if due
+    void on_ui_step() {
+        LatencyTracer& tracer = LatencyTracer::instance();
+        drain();
+
+        uint64_t now = EventLoop::now_us();
+        for (const auto& sample : pending_) {
+            tracer.mark_consumed(sample.first, now);
+        }
+        if (!pending_.empty()) {
+            tracer.mark_invalidated(EventLoop::now_us());
+            dirty_ = true;
+        }
+        pending_.clear();
+
+        if (dirty_ && now >= next_refresh_us_) {
+            tracer.mark_flushed(EventLoop::now_us());
+            dirty_ = false;
+            next_refresh_us_ = now + REFRESH_MS * 1000;
+        }
+        tracer.end_handling();
+
+        if (dirty_) {
+            loop_.arm_timer(ui_timer_, static_cast<uint32_t>((next_refresh_us_ - now + 999) / 1000));
+        }
+    }
+
+    EventLoop& loop_;
+    InputProxy input_;
+    InputRingReader ring_;
+    int wake_fd_;
+    bool attached_ = false;
+    EventLoop::TimerId ui_timer_;
+    EventLoop::TimerId stop_timer_;
+
+    std::deque<std::pair<uint32_t, bool>> pending_;  // Trace id, drag position
+    bool dirty_ = false;
+    uint64_t next_refresh_us_ = 0;
+
+    uint64_t read_ = 0;
+    uint64_t cancelled_ = 0;
+    uint64_t out_of_sequence_ = 0;
+    uint32_t last_trace_id_ = 0;
+};
+
+const char* stage_names[] = {
+    "sample", "post", "publish", "dispatch", "consumed", "invalidate", "flush"
+};
+
+void print_histogram(const char* from, const char* to, const LatencyHistogram& h) {
+    std::printf("  %-10s -> %-10s p50 %6llu us  p99 %6llu us  max %6llu us\n", from, to,
+                static_cast<unsigned long long>(h.percentile_us(50)),
+                static_cast<unsigned long long>(h.percentile_us(99)),
+                static_cast<unsigned long long>(h.max_us()));
+}
+
+int failures = 0;
+
+void check(const char* step, uint64_t value, const char* relation, uint64_t limit) {
+    bool ok = relation[0] == '=' ? value == limit
+            : relation[0] == '>' ? value > limit : value <= limit;
+    std::printf("  %-34s %-4s %llu\n", step, ok ? "ok" : "FAIL",
+                static_cast<unsigned long long>(value));
+    if (!ok) {
+        std::printf("    expected %s %llu\n", relation, static_cast<unsigned long long>(limit));
+        failures++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (seconds <= 0) {
+        std::fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+        return 2;
+    }
+
+    if (!touchdown::bench::have_dbus_tools()) return touchdown::bench::EXIT_SKIP;
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        return 2;
+    }
+
+    // Forked before this process connects: libdbus keeps one connection
+    pid_t pid = start_service(run_input_service);
+    LatencyTracer& tracer = LatencyTracer::instance();
+    tracer.enable();
+
+    EventLoop loop;
+    ReplayShell shell(loop);
+    if (pid < 0 || !touchdown::bench::wait_for_name("org.touchdown.Input") || !loop.init() ||
+        !shell.start()) {
+        std::fprintf(stderr, "Input service failed to start or gave no event ring\n");
+        if (pid > 0) {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+        return 2;
+    }
+
+    shell.wait(static_cast<uint32_t>(seconds) * 1000);
+
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    shell.finish();
+
+    std::printf("backend=%s, scripted drag at 100 Hz for %d s, frames every %u ms:\n",
+                DBusInterface::get_backend_name(), seconds, REFRESH_MS);
+    for (size_t i = 1; i < static_cast<size_t>(TraceStage::COUNT); i++) {
+        print_histogram(stage_names[i - 1], stage_names[i],
+                        tracer.get_stage_histogram(static_cast<TraceStage>(i)));
+    }
+    print_histogram("sample", "flush", tracer.get_total_histogram());
+
+    uint64_t read = shell.read_count();
+    uint64_t completed = tracer.get_total_histogram().count();
+    uint64_t accounted = completed + shell.cancelled_count();
+    uint64_t dispatch_p99 = tracer.get_stage_histogram(TraceStage::DISPATCH).percentile_us(99);
+    uint64_t total_p99 = tracer.get_total_histogram().percentile_us(99);
+
+    std::printf("checks:\n");
+    check("events read", read, ">", 0);
+    check("lost on the ring", shell.lost_count(), "==", 0);
+    check("trace ids out of sequence", shell.out_of_sequence_count(), "==", 0);
+    check("completed", completed, ">", 0);
+    check("completed or cancelled", accounted, "==", read);
+    check("no visible change", tracer.get_expired_count(), "==", 0);
+    check("publish -> dispatch p99 (us)", dispatch_p99, "<=", DISPATCH_BUDGET_US);
+    check("sample -> flush p99 (us)", total_p99, "<=", TOTAL_BUDGET_US);
+
+    std::printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file latency_tracer_check.cpp
+ * @brief Checks which input traces the latency tracer completes
+ *
+ * Drives LatencyTracer with hand-made events and timestamps, in the order
+ * the shell calls it (begin, mark_consumed, mark_invalidated,
+ * end_handling, mark_flushed), and compares the traces it completes and
+ * the ones it closes as having no visible change:
+ *
+ *  - an invalidation before the event was consumed is not its doing
+ *  - a consumed trace that invalidated nothing is closed at end_handling
+ *  - an open trace older than a second is dropped by the next begin
+ *  - a cancelled trace never completes, consumed or not
+ *
+ * Then fills a histogram with known latencies and compares percentiles,
+ * which report the upper bound of their 250 us bucket.
+ *
+ * Exits with status 1 if any step differs.
+ *
+ * Usage: touchdown-latency-tracer-check
+ */
+
+#include "touchdown/core/latency_tracer.hpp"
+#include <cstdio>
+
+namespace {
+
+using touchdown::InputEvent;
+using touchdown::LatencyHistogram;
+using touchdown::LatencyTracer;
+using touchdown::TouchEventType;
+using touchdown::TraceStage;
+
+constexpr uint64_t EXPIRY_US = 1000000;
+
+// A drag sample sampled at t_us, then posted, published and read 100 us apart
+InputEvent make_event(uint32_t trace_id, uint64_t t_us) {
+    InputEvent event = {};
+    event.kind = InputEvent::Kind::TOUCH;
+    event.touch.type = TouchEventType::MOVE;
+    event.touch.sample_us = t_us;
+    event.posted_us = t_us + 100;
+    event.published_us = t_us + 200;
+    event.trace_id = trace_id;
+    return event;
+}
+
+void begin(uint32_t trace_id, uint64_t t_us) {
+    LatencyTracer::instance().begin(make_event(trace_id, t_us), t_us + 300);
+}
+
+int failures = 0;
+
+void check(const char* step, uint64_t completed, uint64_t expired) {
+    LatencyTracer& tracer = LatencyTracer::instance();
+    uint64_t got_completed = tracer.get_total_histogram().count();
+    uint64_t got_expired = tracer.get_expired_count();
+
+    bool ok = got_completed == completed && got_expired == expired;
+    std::printf("  %-34s %-4s completed %llu, no change %llu\n", step, ok ? "ok" : "FAIL",
+                static_cast<unsigned long long>(got_completed),
+                static_cast<unsigned long long>(got_expired));
+    if (!ok) {
+        std::printf("    expected completed %llu, no change %llu\n",
+                    static_cast<unsigned long long>(completed),
+                    static_cast<unsigned long long>(expired));
+        failures++;
+    }
+    tracer.reset();
+}
+
+void check_value(const char* step, uint64_t value, uint64_t expected) {
+    bool ok = value == expected;
+    std::printf("  %-34s %-4s %llu us\n", step, ok ? "ok" : "FAIL",
+                static_cast<unsigned long long>(value));
+    if (!ok) {
+        std::printf("    expected %llu us\n", static_cast<unsigned long long>(expected));
+        failures++;
+    }
+}
+
+void check_traces() {
+    LatencyTracer& tracer = LatencyTracer::instance();
+
+    std::printf("traces:\n");
+
+    // Sampled at 1000, consumed at 1400, invalidated at 2000, flushed at 9000
+    begin(1, 1000);
+    tracer.mark_consumed(1, 1400);
+    tracer.mark_invalidated(2000);
+    tracer.end_handling();
+    tracer.mark_flushed(9000);
+    uint64_t total_max = tracer.get_total_histogram().max_us();
+    uint64_t total_p50 = tracer.get_total_histogram().percentile_us(50);
+    uint64_t flush_max = tracer.get_stage_histogram(TraceStage::FLUSH).max_us();
+    uint64_t consumed_max = tracer.get_stage_histogram(TraceStage::CONSUMED).max_us();
+    check("consumed, invalidated, flushed", 1, 0);
+    check_value("  sample -> flush", total_max, 8000);
+    check_value("  sample -> flush p50 bucket", total_p50, 8250);
+    check_value("  dispatch -> consumed", consumed_max, 100);
+    check_value("  invalidate -> flush", flush_max, 7000);
+
+    // The frame was already being drawn for something else
+    begin(1, 1000);
+    tracer.mark_invalidated(1500);
+    tracer.mark_consumed(1, 1600);
+    tracer.end_handling();
+    tracer.mark_flushed(9000);
+    check("invalidated before consumed", 0, 1);
+
+    // Only the consumed one was handled when the invalidation came
+    begin(1, 1000);
+    begin(2, 1100);
+    tracer.mark_consumed(1, 1500);
+    tracer.mark_invalidated(2000);
+    tracer.end_handling();
+    tracer.mark_flushed(9000);
+    tracer.mark_consumed(2, 40000);
+    tracer.end_handling();
+    tracer.mark_flushed(45000);
+    check("queued while another invalidated", 1, 1);
+
+    // Nothing changed; a later clock tick is not attributed to it
+    begin(1, 1000);
+    tracer.mark_consumed(1, 1500);
+    tracer.end_handling();
+    tracer.mark_invalidated(2000);
+    tracer.mark_flushed(9000);
+    check("unchanged at end_handling", 0, 1);
+
+    // Never consumed: dropped by the first begin a second later
+    begin(1, 1000);
+    begin(2, 1000 + EXPIRY_US + 1);
+    tracer.mark_consumed(2, 1000 + EXPIRY_US + 500);
+    tracer.mark_invalidated(1000 + EXPIRY_US + 1000);
+    tracer.end_handling();
+    tracer.mark_flushed(1000 + EXPIRY_US + 8000);
+    check("unconsumed, expired after 1 s", 1, 1);
+
+    // A drag position replaced before LVGL read it
+    begin(1, 1000);
+    begin(2, 1100);
+    tracer.cancel(1);
+    tracer.mark_consumed(2, 1500);
+    tracer.mark_invalidated(2000);
+    tracer.end_handling();
+    tracer.mark_flushed(9000);
+    check("cancelled before consumed", 1, 0);
+
+    begin(1, 1000);
+    tracer.mark_consumed(1, 1500);
+    tracer.cancel(1);
+    tracer.mark_invalidated(2000);
+    tracer.end_handling();
+    tracer.mark_flushed(9000);
+    check("cancelled after consumed", 0, 0);
+}
+
+void check_histogram() {
+    std::printf("histogram:\n");
+
+    LatencyHistogram histogram;
+    check_value("empty p50", histogram.percentile_us(50), 0);
+
+    // 90 samples at 1 ms, 9 at 10 ms and one past the last bucket
+    for (int i = 0; i < 90; i++) histogram.add(1000);
+    for (int i = 0; i < 9; i++) histogram.add(10000);
+    histogram.add(200000);
+
+    check_value("p50", histogram.percentile_us(50), 1250);
+    check_value("p90", histogram.percentile_us(90), 10250);
+    check_value("p99, overflow reports max", histogram.percentile_us(99), 200000);
+    check_value("max", histogram.max_us(), 200000);
+
+    // A bucket holds [n * 250, (n + 1) * 250)
+    histogram.reset();
+    histogram.add(250);
+    check_value("bucket boundary", histogram.percentile_us(50), 500);
+}
+
+} // namespace
+
+int main() {
+    LatencyTracer::instance().enable();
+
+    check_traces();
+    check_histogram();
+
+    std::printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
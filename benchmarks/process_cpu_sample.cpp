@@ -0,0 +1,111 @@
+/**
+ * @file process_cpu_sample.cpp
+ * @brief CPU time and wakeups of a running process over a window
+ *
+ * Reads utime and stime from /proc/<pid>/stat, and the context switches
+ * of every thread from /proc/<pid>/task/<tid>/status, at the start and
+ * the end of the window. Prints the CPU time in ms per minute and the
+ * voluntary context switches per second.
+ *
+ * Meant for comparing builds on the device, e.g. the shell with the
+ * screen off. Switch the screen off, wait for the shell to settle, then
+ * sample `pidof touchdown-shell` for a minute on each build. A parked
+ * shell also logs its own figure when the screen comes back on.
+ *
+ * Usage: touchdown-process-cpu-sample <pid> [seconds]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace {
+
+struct Sample {
+    uint64_t cpu_ticks = 0;
+    uint64_t voluntary = 0;
+    uint64_t involuntary = 0;
+    int threads = 0;
+    bool ok = false;
+};
+
+Sample read_sample(pid_t pid) {
+    Sample sample;
+    std::string proc = "/proc/" + std::to_string(pid);
+
+    // The command name may hold spaces; the fields start after its ')'
+    std::ifstream stat_file(proc + "/stat");
+    std::string stat;
+    std::getline(stat_file, stat);
+    size_t end = stat.rfind(')');
+    if (end == std::string::npos) return sample;
+
+    std::istringstream fields(stat.substr(end + 2));
+    std::string field;
+    uint64_t utime = 0;
+    uint64_t stime = 0;
+    // state is field 3; utime and stime are 14 and 15
+    for (int index = 3; index <= 15 && fields >> field; index++) {
+        if (index == 14) utime = std::strtoull(field.c_str(), nullptr, 10);
+        if (index == 15) stime = std::strtoull(field.c_str(), nullptr, 10);
+    }
+    sample.cpu_ticks = utime + stime;
+
+    DIR* dir = opendir((proc + "/task").c_str());
+    if (!dir) return sample;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+
+        std::ifstream status(proc + "/task/" + entry->d_name + "/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("voluntary_ctxt_switches:", 0) == 0) {
+                sample.voluntary += std::strtoull(line.c_str() + 24, nullptr, 10);
+            } else if (line.rfind("nonvoluntary_ctxt_switches:", 0) == 0) {
+                sample.involuntary += std::strtoull(line.c_str() + 27, nullptr, 10);
+            }
+        }
+        sample.threads++;
+    }
+    closedir(dir);
+
+    sample.ok = true;
+    return sample;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    pid_t pid = argc > 1 ? static_cast<pid_t>(std::atoi(argv[1])) : 0;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 60;
+    if (pid <= 0 || seconds <= 0) {
+        std::fprintf(stderr, "Usage: %s <pid> [seconds]\n", argv[0]);
+        return 2;
+    }
+
+    Sample before = read_sample(pid);
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    Sample after = read_sample(pid);
+    if (!before.ok || !after.ok) {
+        std::fprintf(stderr, "Cannot read /proc/%d\n", static_cast<int>(pid));
+        return 2;
+    }
+
+    double tick_ms = 1000.0 / sysconf(_SC_CLK_TCK);
+    double cpu_ms = (after.cpu_ticks - before.cpu_ticks) * tick_ms;
+    uint64_t voluntary = after.voluntary - before.voluntary;
+    uint64_t involuntary = after.involuntary - before.involuntary;
+
+    std::printf("pid %d over %d s, %d threads:\n", static_cast<int>(pid), seconds, after.threads);
+    std::printf("  cpu        %8.0f ms (%.1f ms/min, %.0f ms resolution)\n", cpu_ms,
+                cpu_ms * 60 / seconds, tick_ms);
+    std::printf("  wakeups    %8llu (%.2f/s), %llu preempted\n",
+                static_cast<unsigned long long>(voluntary), static_cast<double>(voluntary) / seconds,
+                static_cast<unsigned long long>(involuntary));
+    return 0;
+}
@@ -0,0 +1,322 @@
+/**
+ * @file property_watch_bench.cpp
+ * @brief Bus messages spent watching the power state for an hour
+ *
+ * Starts a private bus and PowerService, then replays an hour of use in
+ * compressed time: the screen is switched off and on again once a
+ * minute (60 cycles) through SetPowerState. Two clients watch the state:
+ *
+ *  - "poll" calls GetPowerState once a simulated second (3600 calls)
+ *  - "mirror" uses PowerProxy::watch_properties: one GetAll, then a
+ *    PropertiesChanged signal for each change
+ *
+ * Each client counts the messages it sends and receives. A call is two
+ * messages, its reply included. The mirror's subscription is counted
+ * as an AddMatch call and reply. Its signals also carry the Brightness
+ * changes that come with switching the screen.
+ *
+ * The mirror must have seen every state change. The poller can miss a
+ * change that is undone between two polls, so it only has to end in
+ * the final state.
+ *
+ * Needs only dbus-daemon in PATH, no system bus or root.
+ *
+ * Usage: touchdown-property-watch-bench [seconds per simulated hour]
+ */
+
+#include "bench_bus.hpp"
+#include "touchdown/services/power_service.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+constexpr uint64_t SIMULATED_S = 3600;
+constexpr uint64_t POLL_INTERVAL_S = 1;
+constexpr uint64_t SCREEN_CYCLE_S = 60;
+constexpr uint64_t START_DELAY_MS = 500;
+constexpr uint64_t DRAIN_MS = 500;   // Replies and signals for the last changes
+
+// Shortest real time between two state changes. The service spaces its
+// PropertiesChanged signals 100 ms apart; closer changes would be
+// coalesced, which an hour at real speed never sees.
+constexpr uint64_t MIN_CHANGE_GAP_MS = 200;
+
+using touchdown::EventLoop;
+using touchdown::services::DBusInterface;
+using touchdown::services::PowerProxy;
+
+// Sent from each client to the parent
+struct ClientReport {
+    uint64_t sent;
+    uint64_t received;
+    uint64_t changes_seen;  // Power state differing from the previous one
+    uint64_t errors;
+    char final_state[16];
+};
+
+class WatchClient : public DBusInterface {
+public:
+    WatchClient(const std::string& name, uint64_t start_us, uint64_t end_us)
+        : DBusInterface("org.touchdown.BenchWatch" + name, "/org/touchdown/BenchWatch")
+        , power_(*this)
+        , start_us_(start_us)
+        , end_us_(end_us) {}
+
+    void poll(EventLoop& loop, uint64_t interval_us) {
+        EventLoop::TimerId tick = EventLoop::INVALID_TIMER;
+        uint64_t next_us = start_us_;
+        tick = loop.add_timer([&, interval_us]() {
+            report_.sent++;
+            power_.get_power_state([this](const char* error, const std::string& state) {
+                report_.received++;
+                if (error) {
+                    report_.errors++;
+                    return;
+                }
+                see(state);
+            });
+
+            next_us += interval_us;
+            if (next_us < end_us_) loop.arm_timer_at(tick, next_us);
+        });
+        loop.arm_timer_at(tick, next_us);
+        run(loop);
+    }
+
+    void mirror(EventLoop& loop) {
+        EventLoop::TimerId start = loop.add_timer([this]() {
+            // AddMatch and GetAll, each with its reply
+            report_.sent += 2;
+            report_.received += 2;
+            power_.watch_properties([this]() {
+                // The first update is the GetAll reply
+                if (updates_++ > 0) report_.received++;
+                see(power_.get_power_state_property());
+            });
+        });
+        loop.arm_timer_at(start, start_us_);
+        run(loop);
+    }
+
+    bool send_report(int fd) {
+        std::snprintf(report_.final_state, sizeof(report_.final_state), "%s", state_.c_str());
+        return write(fd, &report_, sizeof(report_)) == sizeof(report_);
+    }
+
+private:
+    void run(EventLoop& loop) {
+        EventLoop::TimerId end = loop.add_timer([&loop]() { loop.stop(); });
+        loop.arm_timer_at(end, end_us_ + DRAIN_MS * 1000);
+        loop.run();
+    }
+
+    void see(const std::string& state) {
+        if (!state_.empty() && state != state_) report_.changes_seen++;
+        state_ = state;
+    }
+
+    PowerProxy power_;
+    uint64_t start_us_;
+    uint64_t end_us_;
+    uint64_t updates_ = 0;
+    std::string state_;
+    ClientReport report_ = {};
+};
+
+// Switches the screen off and on again once per simulated minute
+class Driver : public DBusInterface {
+public:
+    Driver() : DBusInterface("org.touchdown.BenchWatchDriver", "/org/touchdown/BenchWatchDriver")
+             , power_(*this) {}
+
+    uint64_t run(EventLoop& loop, uint64_t start_us, uint64_t end_us, uint64_t half_cycle_us) {
+        // Between polls, and clear of the mirror's GetAll
+        uint64_t next_us = start_us + half_cycle_us / 2;
+        EventLoop::TimerId toggle = EventLoop::INVALID_TIMER;
+        toggle = loop.add_timer([&]() {
+            screen_off_ = !screen_off_;
+            changes_++;
+            power_.set_power_state(screen_off_ ? "screen_off" : "active", [this](const char* error) {
+                if (error) errors_++;
+            });
+
+            next_us += half_cycle_us;
+            if (next_us < end_us) loop.arm_timer_at(toggle, next_us);
+        });
+        loop.arm_timer_at(toggle, next_us);
+
+        EventLoop::TimerId end = loop.add_timer([&loop]() { loop.stop(); });
+        loop.arm_timer_at(end, end_us + DRAIN_MS * 1000);
+        loop.run();
+        return changes_;
+    }
+
+    uint64_t get_errors() const { return errors_; }
+    const char* get_final_state() const { return screen_off_ ? "screen_off" : "active"; }
+
+private:
+    PowerProxy power_;
+    bool screen_off_ = false;
+    uint64_t changes_ = 0;
+    uint64_t errors_ = 0;
+};
+
+int run_power_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::services::PowerService service;
+    if (!service.init(loop)) return 1;
+    service.set_screen_timeout(0);  // Only the driver changes the state
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+pid_t start_service(int (*run)(int)) {
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        _exit(run(ready[1]));
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool ok = pid > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+
+    if (!ok && pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+    return pid;
+}
+
+// Forks a client; its report is read from the returned fd
+int start_client(bool polling, uint64_t start_us, uint64_t end_us, uint64_t poll_us, pid_t& pid) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) return -1;
+
+    pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        EventLoop loop;
+        WatchClient client(polling ? "Poll" : "Mirror", start_us, end_us);
+        if (!loop.init() || !client.init(loop)) _exit(1);
+
+        if (polling) {
+            client.poll(loop, poll_us);
+        } else {
+            client.mirror(loop);
+        }
+        _exit(client.send_report(fds[1]) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        return -1;
+    }
+    return fds[0];
+}
+
+bool print(const char* name, int fd, uint64_t changes, const char* final_state, bool every_change) {
+    ClientReport report = {};
+    bool ok = fd >= 0 && read(fd, &report, sizeof(report)) == sizeof(report);
+    if (fd >= 0) close(fd);
+    if (!ok) {
+        std::printf("  %-7s failed\n", name);
+        return false;
+    }
+
+    uint64_t messages = report.sent + report.received;
+    std::printf("  %-7s %6llu messages (%llu sent, %llu received), %llu of %llu changes seen, "
+                "ends %s, %llu errors\n",
+                name, static_cast<unsigned long long>(messages),
+                static_cast<unsigned long long>(report.sent),
+                static_cast<unsigned long long>(report.received),
+                static_cast<unsigned long long>(report.changes_seen),
+                static_cast<unsigned long long>(changes), report.final_state,
+                static_cast<unsigned long long>(report.errors));
+
+    return report.errors == 0 && std::string(report.final_state) == final_state &&
+           (!every_change || report.changes_seen == changes);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 60;
+    if (seconds <= 0) {
+        std::fprintf(stderr, "Usage: %s [seconds per simulated hour]\n", argv[0]);
+        return 2;
+    }
+
+    // Simulated seconds to real microseconds
+    uint64_t scale_us = static_cast<uint64_t>(seconds) * 1000000 / SIMULATED_S;
+    if (scale_us * SCREEN_CYCLE_S / 2 < MIN_CHANGE_GAP_MS * 1000) {
+        std::fprintf(stderr, "Too fast: state changes would be coalesced\n");
+        return 2;
+    }
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        return 1;
+    }
+
+    pid_t power_pid = start_service(run_power_service);
+    if (power_pid > 0 && !touchdown::bench::wait_for_name("org.touchdown.Power")) {
+        kill(power_pid, SIGTERM);
+        waitpid(power_pid, nullptr, 0);
+        power_pid = -1;
+    }
+    if (power_pid < 0) {
+        std::fprintf(stderr, "Power service failed to start\n");
+        return 1;
+    }
+
+    uint64_t start_us = EventLoop::now_us() + START_DELAY_MS * 1000;
+    uint64_t end_us = start_us + SIMULATED_S * scale_us;
+
+    pid_t poll_pid = -1;
+    pid_t mirror_pid = -1;
+    int poll_fd = start_client(true, start_us, end_us, POLL_INTERVAL_S * scale_us, poll_pid);
+    int mirror_fd = start_client(false, start_us, end_us, 0, mirror_pid);
+
+    EventLoop loop;
+    Driver driver;
+    uint64_t changes = 0;
+    if (loop.init() && driver.init(loop)) {
+        changes = driver.run(loop, start_us, end_us, SCREEN_CYCLE_S / 2 * scale_us);
+    }
+
+    std::printf("backend=%s, one hour in %d s, %llu power state changes\n",
+                DBusInterface::get_backend_name(), seconds, static_cast<unsigned long long>(changes));
+    bool ok = print("poll", poll_fd, changes, driver.get_final_state(), false);
+    ok = print("mirror", mirror_fd, changes, driver.get_final_state(), true) && ok;
+
+    if (poll_pid > 0) waitpid(poll_pid, nullptr, 0);
+    if (mirror_pid > 0) waitpid(mirror_pid, nullptr, 0);
+    kill(power_pid, SIGTERM);
+    waitpid(power_pid, nullptr, 0);
+
+    if (changes == 0 || driver.get_errors() > 0) {
+        std::fprintf(stderr, "Driver could not change the power state\n");
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file scripted_touch_bus.hpp
+ * @brief Fake CST816S for running the input service without hardware
+ */
+
+#ifndef TOUCHDOWN_BENCHMARKS_SCRIPTED_TOUCH_BUS_HPP
+#define TOUCHDOWN_BENCHMARKS_SCRIPTED_TOUCH_BUS_HPP
+
+#include "touchdown/drivers/i2c_bus.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/core/types.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace touchdown {
+namespace bench {
+
+/**
+ * @brief I2C bus answering touch register reads with a repeating drag
+ *
+ * The finger goes down, circles the centre of the display for DRAG_MS
+ * and lifts for LIFT_MS, driven by the clock so the sample rate is
+ * whatever the input service polls at. Register writes (power modes)
+ * are accepted and ignored.
+ */
+class ScriptedTouchBus : public drivers::I2CBus {
+public:
+    static constexpr uint64_t DRAG_MS = 600;
+    static constexpr uint64_t LIFT_MS = 200;
+    static constexpr int RADIUS = 80;
+
+    ScriptedTouchBus() : start_us_(EventLoop::now_us()) {}
+
+    bool write_register(uint8_t /* reg */, uint8_t /* value */) override {
+        return true;
+    }
+
+    bool read_registers(uint8_t reg, uint8_t* buf, size_t len) override {
+        // 0x01 gesture, 0x02 touch count, 0x03-0x06 XH XL YH YL
+        uint8_t regs[8] = {};
+
+        uint64_t t_ms = (EventLoop::now_us() - start_us_) / 1000 % (DRAG_MS + LIFT_MS);
+        if (t_ms < DRAG_MS) {
+            double angle = 2.0 * M_PI * static_cast<double>(t_ms) / DRAG_MS;
+            int x = DisplayConfig::CENTER_X + static_cast<int>(RADIUS * std::cos(angle));
+            int y = DisplayConfig::CENTER_Y + static_cast<int>(RADIUS * std::sin(angle));
+
+            regs[2] = 1;
+            regs[3] = static_cast<uint8_t>((x >> 8) & 0x0F);
+            regs[4] = static_cast<uint8_t>(x & 0xFF);
+            regs[5] = static_cast<uint8_t>((y >> 8) & 0x0F);
+            regs[6] = static_cast<uint8_t>(y & 0xFF);
+        }
+
+        if (reg + len > sizeof(regs)) return false;
+        std::memcpy(buf, regs + reg, len);
+        return true;
+    }
+
+private:
+    uint64_t start_us_;
+};
+
+} // namespace bench
+} // namespace touchdown
+
+#endif // TOUCHDOWN_BENCHMARKS_SCRIPTED_TOUCH_BUS_HPP
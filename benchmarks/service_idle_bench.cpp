@@ -0,0 +1,236 @@
+/**
+ * @file service_idle_bench.cpp
+ * @brief Wakeups of an idle power service
+ *
+ * Starts PowerService on a private bus and leaves it alone, first with
+ * the screen on and then, after SetPowerState("screen_off"), with the
+ * screen off. For each phase it reads the context switches of every
+ * thread of the service from /proc/<pid>/task/<tid>/status, so a wakeup
+ * is counted whichever thread takes it: the loop, the worker pool or a
+ * driver thread.
+ *
+ * The screen timeout is set beyond the run, so the idle timer is armed
+ * but does not fire. The watchdog timer only exists when WATCHDOG_USEC
+ * is set; export it to include the pings, e.g. WATCHDOG_USEC=30000000.
+ *
+ * With --thermal the service also polls a fake thermal zone in /tmp at
+ * the shipped 2 s interval, as it does on the device while the screen is
+ * on. Each poll is a timer wakeup plus a worker job.
+ *
+ * Needs only dbus-daemon in PATH, no system bus or root.
+ *
+ * Usage: touchdown-service-idle-bench [seconds per phase] [--thermal]
+ */
+
+#include "bench_bus.hpp"
+#include "touchdown/services/power_service.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr uint64_t SETTLE_MS = 1000;  // Startup work and the switch itself
+constexpr uint32_t THERMAL_POLL_MS = 2000;  // thermal.poll_ms in power.conf
+
+using touchdown::EventLoop;
+using touchdown::services::DBusInterface;
+using touchdown::services::PowerProxy;
+
+struct Switches {
+    uint64_t voluntary = 0;
+    uint64_t involuntary = 0;
+    int threads = 0;
+};
+
+// Context switches summed over the threads of a process
+Switches read_switches(pid_t pid) {
+    Switches switches;
+    std::string task_dir = "/proc/" + std::to_string(pid) + "/task";
+    DIR* dir = opendir(task_dir.c_str());
+    if (!dir) return switches;
+
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+
+        std::ifstream status(task_dir + "/" + entry->d_name + "/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("voluntary_ctxt_switches:", 0) == 0) {
+                switches.voluntary += std::strtoull(line.c_str() + 24, nullptr, 10);
+            } else if (line.rfind("nonvoluntary_ctxt_switches:", 0) == 0) {
+                switches.involuntary += std::strtoull(line.c_str() + 27, nullptr, 10);
+            }
+        }
+        switches.threads++;
+    }
+    closedir(dir);
+    return switches;
+}
+
+void measure(const char* phase, pid_t pid, int seconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MS));
+
+    Switches before = read_switches(pid);
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    Switches after = read_switches(pid);
+
+    uint64_t voluntary = after.voluntary - before.voluntary;
+    uint64_t involuntary = after.involuntary - before.involuntary;
+    std::printf("  %-10s %6llu wakeups in %d s (%.3f/s), %llu preempted, %d threads\n", phase,
+                static_cast<unsigned long long>(voluntary), seconds,
+                static_cast<double>(voluntary) / seconds,
+                static_cast<unsigned long long>(involuntary), after.threads);
+}
+
+class Switcher : public DBusInterface {
+public:
+    Switcher() : DBusInterface("org.touchdown.BenchIdle", "/org/touchdown/BenchIdle")
+               , power_(*this) {}
+
+    bool screen_off(EventLoop& loop) {
+        bool ok = false;
+        power_.set_power_state("screen_off", [&](const char* error) {
+            ok = !error;
+            loop.stop();
+        });
+        loop.run();
+        return ok;
+    }
+
+private:
+    PowerProxy power_;
+};
+
+int idle_seconds = 0;
+std::string thermal_root;  // Empty: no thermal zones
+
+bool make_thermal_zone() {
+    char dir[] = "/tmp/touchdown-idle-XXXXXX";
+    if (!mkdtemp(dir)) return false;
+    thermal_root = dir;
+
+    std::string zone = thermal_root + "/thermal_zone0";
+    mkdir(zone.c_str(), 0755);
+    std::ofstream(zone + "/type") << "cpu-thermal\n";
+    std::ofstream(zone + "/temp") << "40000\n";
+    return true;
+}
+
+void remove_thermal_zone() {
+    std::string command = "rm -rf '" + thermal_root + "'";
+    if (thermal_root.rfind("/tmp/touchdown-idle-", 0) == 0 && std::system(command.c_str()) != 0) {
+        std::fprintf(stderr, "Cannot remove %s\n", thermal_root.c_str());
+    }
+}
+
+int run_power_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::services::PowerService service;
+    if (!thermal_root.empty()) {
+        service.set_thermal(touchdown::ThermalConfig(), thermal_root, {"cpu-thermal"},
+                            THERMAL_POLL_MS, "");
+    }
+    if (!service.init(loop)) return 1;
+    // Armed, but not due before the run is over
+    service.set_screen_timeout((idle_seconds * 2 + 10) * 1000);
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+pid_t start_service(int (*run)(int)) {
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        _exit(run(ready[1]));
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool ok = pid > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+
+    if (!ok && pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+    return pid;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    idle_seconds = argc > 1 ? std::atoi(argv[1]) : 10;
+    bool thermal = argc > 2 && std::strcmp(argv[2], "--thermal") == 0;
+    if (idle_seconds <= 0 || (argc > 2 && !thermal)) {
+        std::fprintf(stderr, "Usage: %s [seconds per phase] [--thermal]\n", argv[0]);
+        return 2;
+    }
+    if (thermal && !make_thermal_zone()) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        if (thermal) remove_thermal_zone();
+        return 1;
+    }
+
+    pid_t power_pid = start_service(run_power_service);
+    if (power_pid > 0 && !touchdown::bench::wait_for_name("org.touchdown.Power")) {
+        kill(power_pid, SIGTERM);
+        waitpid(power_pid, nullptr, 0);
+        power_pid = -1;
+    }
+    if (power_pid < 0) {
+        std::fprintf(stderr, "Power service failed to start\n");
+        if (thermal) remove_thermal_zone();
+        return 1;
+    }
+
+    const char* watchdog = std::getenv("WATCHDOG_USEC");
+    std::string zones = thermal ? ", thermal zone every " + std::to_string(THERMAL_POLL_MS) + " ms"
+                                : ", no thermal zone";
+    if (watchdog) {
+        std::printf("power service idle, WATCHDOG_USEC=%s%s:\n", watchdog, zones.c_str());
+    } else {
+        std::printf("power service idle, no watchdog%s:\n", zones.c_str());
+    }
+    measure("screen on", power_pid, idle_seconds);
+
+    EventLoop loop;
+    Switcher switcher;
+    bool ok = loop.init() && switcher.init(loop) && switcher.screen_off(loop);
+    if (ok) {
+        measure("screen off", power_pid, idle_seconds);
+    } else {
+        std::fprintf(stderr, "Could not switch the screen off\n");
+    }
+
+    kill(power_pid, SIGTERM);
+    waitpid(power_pid, nullptr, 0);
+    if (thermal) remove_thermal_zone();
+    return ok ? 0 : 1;
+}
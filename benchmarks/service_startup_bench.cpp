@@ -0,0 +1,261 @@
+/**
+ * @file service_startup_bench.cpp
+ * @brief Startup time of the power service and what it holds open
+ *
+ * Each run forks a fresh PowerService on a private bus and times three
+ * points from the fork: init() returning, the bus name being owned, and
+ * the first GetPowerState reply reaching a client. Once the reply is in,
+ * it reads the service's resident memory from /proc/<pid>/status and
+ * checks /proc/<pid>/fd and /proc/<pid>/maps for DRM or framebuffer
+ * devices, which the power service must never open.
+ *
+ * Ownership is polled with dbus-send, so the second point includes up
+ * to one poll and a dbus-send start; the first reply is the figure that
+ * counts for clients.
+ *
+ * The panel is reached through PanelController: with no
+ * /sys/class/backlight device and no shell on the bus, init() does no
+ * sysfs writes. Exits with status 1 if a device node was open.
+ *
+ * Needs only dbus-daemon and dbus-send in PATH, no system bus or root.
+ *
+ * Usage: touchdown-service-startup-bench [runs]
+ */
+
+#include "bench_bus.hpp"
+#include "touchdown/services/power_service.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+
+namespace {
+
+constexpr uint32_t REPLY_TIMEOUT_MS = 5000;
+
+using touchdown::EventLoop;
+using touchdown::services::DBusInterface;
+using touchdown::services::PowerProxy;
+
+// Sent from each run to the parent
+struct RunReport {
+    uint64_t init_us;   // Fork to init() returning
+    uint64_t name_us;   // Fork to the name being owned
+    uint64_t reply_us;  // Fork to the first reply at a client
+    uint64_t rss_kb;
+    int device_fds;     // Open /dev/dri or /dev/fb nodes
+    int device_maps;    // Mapped ones
+    bool ok;
+};
+
+bool is_display_device(const std::string& path) {
+    return path.rfind("/dev/dri/", 0) == 0 || path.rfind("/dev/fb", 0) == 0;
+}
+
+int count_device_fds(pid_t pid) {
+    std::string fd_dir = "/proc/" + std::to_string(pid) + "/fd";
+    DIR* dir = opendir(fd_dir.c_str());
+    if (!dir) return -1;
+
+    int count = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+
+        char target[PATH_MAX];
+        ssize_t len = readlink((fd_dir + "/" + entry->d_name).c_str(), target, sizeof(target) - 1);
+        if (len <= 0) continue;
+        target[len] = '\0';
+        if (is_display_device(target)) count++;
+    }
+    closedir(dir);
+    return count;
+}
+
+int count_device_maps(pid_t pid) {
+    std::ifstream maps("/proc/" + std::to_string(pid) + "/maps");
+    std::string line;
+    int count = 0;
+    while (std::getline(maps, line)) {
+        size_t path = line.find('/');
+        if (path != std::string::npos && is_display_device(line.substr(path))) count++;
+    }
+    return count;
+}
+
+uint64_t read_rss_kb(pid_t pid) {
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) return std::strtoull(line.c_str() + 6, nullptr, 10);
+    }
+    return 0;
+}
+
+class StartupClient : public DBusInterface {
+public:
+    StartupClient() : DBusInterface("org.touchdown.BenchStartup", "/org/touchdown/BenchStartup")
+                    , power_(*this) {}
+
+    bool get_power_state(EventLoop& loop) {
+        bool ok = false;
+        EventLoop::TimerId timeout = loop.add_timer([&loop]() { loop.stop(); });
+        loop.arm_timer(timeout, REPLY_TIMEOUT_MS);
+        power_.get_power_state([&](const char* error, const std::string&) {
+            ok = !error;
+            loop.stop();
+        });
+        loop.run();
+        loop.remove_timer(timeout);
+        return ok;
+    }
+
+private:
+    PowerProxy power_;
+};
+
+int run_power_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::services::PowerService service;
+    if (!service.init(loop)) return 1;
+
+    uint64_t init_done_us = EventLoop::now_us();
+    if (write(ready_fd, &init_done_us, sizeof(init_done_us)) != sizeof(init_done_us)) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+// One start, in a process of its own: libdbus keeps one connection per
+// process, and the client must not exist before the service is forked
+RunReport run_once() {
+    RunReport report = {};
+
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return report;
+
+    uint64_t fork_us = EventLoop::now_us();
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        _exit(run_power_service(ready[1]));
+    }
+    close(ready[1]);
+
+    uint64_t init_done_us = 0;
+    bool started = pid > 0 && read(ready[0], &init_done_us, sizeof(init_done_us)) == sizeof(init_done_us);
+    close(ready[0]);
+    if (!started) {
+        if (pid > 0) {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+        return report;
+    }
+
+    bool owned = touchdown::bench::wait_for_name("org.touchdown.Power");
+    uint64_t owned_us = EventLoop::now_us();
+
+    EventLoop loop;
+    StartupClient client;
+    bool replied = owned && loop.init() && client.init(loop) && client.get_power_state(loop);
+    uint64_t replied_us = EventLoop::now_us();
+
+    report.init_us = init_done_us - fork_us;
+    report.name_us = owned_us - fork_us;
+    report.reply_us = replied_us - fork_us;
+    report.rss_kb = read_rss_kb(pid);
+    report.device_fds = count_device_fds(pid);
+    report.device_maps = count_device_maps(pid);
+    report.ok = replied && report.device_fds >= 0;
+
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return report;
+}
+
+bool in_child(RunReport& report) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) return false;
+
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        RunReport result = run_once();
+        _exit(write(fds[1], &result, sizeof(result)) == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+
+    bool ok = pid > 0 && read(fds[0], &report, sizeof(report)) == sizeof(report);
+    close(fds[0]);
+    if (pid > 0) waitpid(pid, nullptr, 0);
+    return ok && report.ok;
+}
+
+uint64_t median(std::vector<uint64_t> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int runs = argc > 1 ? std::atoi(argv[1]) : 10;
+    if (runs <= 0) {
+        std::fprintf(stderr, "Usage: %s [runs]\n", argv[0]);
+        return 2;
+    }
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        return 2;
+    }
+
+    std::vector<uint64_t> init_us;
+    std::vector<uint64_t> name_us;
+    std::vector<uint64_t> reply_us;
+    std::vector<uint64_t> rss_kb;
+    int device_fds = 0;
+    int device_maps = 0;
+
+    for (int i = 0; i < runs; i++) {
+        RunReport report;
+        if (!in_child(report)) {
+            std::fprintf(stderr, "Run %d: power service did not answer\n", i + 1);
+            return 2;
+        }
+        init_us.push_back(report.init_us);
+        name_us.push_back(report.name_us);
+        reply_us.push_back(report.reply_us);
+        rss_kb.push_back(report.rss_kb);
+        device_fds += report.device_fds;
+        device_maps += report.device_maps;
+    }
+
+    std::printf("backend=%s, power service started %d times, median (max) from fork:\n",
+                DBusInterface::get_backend_name(), runs);
+    std::printf("  init() returned   %8.1f ms (%.1f)\n", median(init_us) / 1000.0,
+                *std::max_element(init_us.begin(), init_us.end()) / 1000.0);
+    std::printf("  name owned        %8.1f ms (%.1f)\n", median(name_us) / 1000.0,
+                *std::max_element(name_us.begin(), name_us.end()) / 1000.0);
+    std::printf("  first reply       %8.1f ms (%.1f)\n", median(reply_us) / 1000.0,
+                *std::max_element(reply_us.begin(), reply_us.end()) / 1000.0);
+    std::printf("  resident          %8llu kB\n", static_cast<unsigned long long>(median(rss_kb)));
+    std::printf("  display devices   %d open, %d mapped\n", device_fds, device_maps);
+
+    bool ok = device_fds == 0 && device_maps == 0;
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
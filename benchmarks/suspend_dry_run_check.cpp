@@ -0,0 +1,365 @@
+/**
+ * @file suspend_dry_run_check.cpp
+ * @brief Runs the SUSPENDED state of the power service against a fake sysfs
+ *
+ * PowerService is started on a private bus with power.suspend pointed at
+ * a temporary tree. It holds power/state, power/wakeup_count, and
+ * power/wakeup for two wake sources: a touch controller with wakeup
+ * disabled and a button with it enabled. A third configured wake source
+ * has no power/wakeup at all. Each cycle calls SetPowerState("suspended")
+ * and checks:
+ *
+ *  - the call is answered without error
+ *  - PowerStateChanged reports suspended, then active
+ *  - Resumed is emitted, with a time no later than its arrival
+ *  - "freeze" was written to power/state and the wakeup count written back
+ *  - each wake source's power/wakeup is as it was before
+ *
+ * A second service gets a tree whose power/state does not offer
+ * "freeze". It must fall back to screen_off without writing, and
+ * ResetIdleTimer, which wakes from the same states as input, must
+ * bring it back.
+ *
+ * In a dry run the write to power/state returns at once, so the wake
+ * sources cannot be seen enabled while "suspended". The reported delay
+ * runs from that return to the client receiving Resumed. Wake to first
+ * frame needs the shell and the panel, and is not measured here.
+ *
+ * Needs only dbus-daemon in PATH, no system bus or root. Exits with
+ * status 1 on a mismatch, and 77 (skipped) without dbus-daemon.
+ *
+ * Usage: touchdown-suspend-dry-run-check [cycles]
+ */
+
+#include "bench_bus.hpp"
+#include "touchdown/services/power_service.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr uint32_t CYCLE_TIMEOUT_MS = 5000;
+constexpr uint32_t NO_SUSPEND_WAIT_MS = 1000;
+
+using touchdown::EventLoop;
+using touchdown::services::DBusInterface;
+using touchdown::services::PowerProxy;
+
+const char* const TOUCH = "bus/i2c/devices/1-0015";
+const char* const BUTTON = "bus/platform/devices/gpio-keys";
+const char* const MISSING = "bus/i2c/devices/1-0038";
+
+int failures = 0;
+
+void check(const char* step, bool ok, const std::string& detail) {
+    std::printf("  %-32s %-4s %s\n", step, ok ? "ok" : "FAIL", detail.c_str());
+    if (!ok) failures++;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    std::getline(file, value);
+    return value;
+}
+
+void write_file(const std::string& path, const std::string& value) {
+    std::ofstream(path) << value << "\n";
+}
+
+void make_dirs(const std::string& path) {
+    for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+    mkdir(path.c_str(), 0755);
+}
+
+std::string make_tree(const std::string& states) {
+    char dir[] = "/tmp/touchdown-sleep-XXXXXX";
+    if (!mkdtemp(dir)) return "";
+
+    std::string root = dir;
+    make_dirs(root + "/power");
+    write_file(root + "/power/state", states);
+    write_file(root + "/power/wakeup_count", "42");
+    make_dirs(root + "/" + TOUCH + "/power");
+    write_file(root + "/" + TOUCH + "/power/wakeup", "disabled");
+    make_dirs(root + "/" + BUTTON + "/power");
+    write_file(root + "/" + BUTTON + "/power/wakeup", "enabled");
+    return root;
+}
+
+void remove_tree(const std::string& root) {
+    std::string command = "rm -rf '" + root + "'";
+    if (root.rfind("/tmp/touchdown-sleep-", 0) == 0 && std::system(command.c_str()) != 0) {
+        std::fprintf(stderr, "Cannot remove %s\n", root.c_str());
+    }
+}
+
+// Service configuration, set before the fork
+std::string sleep_root;
+
+int run_power_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::services::PowerService service;
+    service.set_suspend(sleep_root, "freeze", {TOUCH, BUTTON, MISSING});
+    if (!service.init(loop)) return 1;
+    service.set_screen_timeout(0);
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+pid_t start_service(int (*run)(int)) {
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        _exit(run(ready[1]));
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool ok = pid > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+
+    if (!ok && pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+    return pid;
+}
+
+void stop_service(pid_t pid) {
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+}
+
+// What a client saw during one SetPowerState("suspended")
+struct Cycle {
+    bool replied = false;
+    std::string error;
+    std::vector<std::string> states;
+    uint64_t resumed_us = 0;
+    uint64_t received_us = 0;
+};
+
+class SuspendClient : public DBusInterface {
+public:
+    SuspendClient(EventLoop& loop)
+        : DBusInterface("org.touchdown.BenchSuspend", "/org/touchdown/BenchSuspend")
+        , loop_(loop)
+        , power_(*this)
+        , cycle_(nullptr)
+        , timeout_(EventLoop::INVALID_TIMER) {}
+
+    bool start() {
+        if (!init(loop_)) return false;
+
+        timeout_ = loop_.add_timer([this]() { loop_.stop(); });
+        power_.on_resumed([this](uint64_t resumed_us) {
+            if (!cycle_) return;
+            cycle_->resumed_us = resumed_us;
+            cycle_->received_us = EventLoop::now_us();
+            finish_if_done();
+        });
+
+        // The signal, not the property: PropertiesChanged would coalesce
+        // a dry run's suspended and active into one
+        power_.on_power_state_changed([this](const std::string& state) {
+            if (!cycle_) return;
+            cycle_->states.push_back(state);
+            finish_if_done();
+        });
+        return true;
+    }
+
+    // Suspends and waits until the service is back, or wait_ms passed
+    void suspend(Cycle& cycle, uint32_t wait_ms) {
+        expect_resumed_ = true;
+        cycle_ = &cycle;
+        power_.set_power_state("suspended", [this, &cycle](const char* error) {
+            cycle.replied = true;
+            if (error) cycle.error = error;
+            if (cycle_) finish_if_done();
+        });
+        loop_.arm_timer(timeout_, wait_ms);
+        loop_.run();
+        loop_.disarm_timer(timeout_);
+        cycle_ = nullptr;
+    }
+
+    // Reports user activity and waits for active. Input from the input
+    // service takes the same SCREEN_OFF check, through its eventfd
+    void report_activity(Cycle& cycle, uint32_t wait_ms) {
+        expect_resumed_ = false;
+        cycle_ = &cycle;
+        power_.reset_idle_timer([this, &cycle](const char* error) {
+            cycle.replied = true;
+            if (error) cycle.error = error;
+            if (cycle_) finish_if_done();
+        });
+        loop_.arm_timer(timeout_, wait_ms);
+        loop_.run();
+        loop_.disarm_timer(timeout_);
+        cycle_ = nullptr;
+    }
+
+private:
+    // The reply and the signals travel separately and may come in any order
+    void finish_if_done() {
+        if (cycle_->replied && (cycle_->resumed_us != 0 || !expect_resumed_) &&
+            !cycle_->states.empty() && cycle_->states.back() == "active") {
+            loop_.stop();
+        }
+    }
+
+    EventLoop& loop_;
+    PowerProxy power_;
+    Cycle* cycle_;
+    bool expect_resumed_ = true;
+    EventLoop::TimerId timeout_;
+};
+
+std::string join(const std::vector<std::string>& states) {
+    std::string text;
+    for (const std::string& state : states) text += (text.empty() ? "" : " -> ") + state;
+    return text.empty() ? "(no change)" : text;
+}
+
+void check_suspend(int cycles) {
+    sleep_root = make_tree("freeze mem");
+    pid_t pid = start_service(run_power_service);
+
+    EventLoop loop;
+    SuspendClient client(loop);
+    if (pid < 0 || !touchdown::bench::wait_for_name("org.touchdown.Power") || !loop.init() ||
+        !client.start()) {
+        check("service with a fake tree", false, "did not start");
+        if (pid > 0) stop_service(pid);
+        remove_tree(sleep_root);
+        return;
+    }
+
+    uint64_t total_delay_us = 0;
+    for (int i = 0; i < cycles; i++) {
+        write_file(sleep_root + "/power/state", "freeze mem");
+
+        Cycle cycle;
+        client.suspend(cycle, CYCLE_TIMEOUT_MS);
+        uint64_t delay_us = cycle.received_us - cycle.resumed_us;
+        total_delay_us += delay_us;
+
+        std::string label = "cycle " + std::to_string(i + 1);
+        check((label + ": call answered").c_str(), cycle.replied && cycle.error.empty(),
+              cycle.error.empty() ? "" : cycle.error);
+        check((label + ": state").c_str(),
+              cycle.states == std::vector<std::string>{"suspended", "active"}, join(cycle.states));
+        check((label + ": Resumed").c_str(),
+              cycle.resumed_us != 0 && cycle.received_us >= cycle.resumed_us,
+              cycle.resumed_us ? std::to_string(delay_us) + " us from resume to client" : "not received");
+
+        std::string state = read_file(sleep_root + "/power/state");
+        std::string count = read_file(sleep_root + "/power/wakeup_count");
+        check((label + ": power/state").c_str(), state == "freeze" && count == "42",
+              "state " + state + ", wakeup_count " + count);
+
+        std::string touch = read_file(sleep_root + "/" + TOUCH + "/power/wakeup");
+        std::string button = read_file(sleep_root + "/" + BUTTON + "/power/wakeup");
+        check((label + ": wake sources").c_str(), touch == "disabled" && button == "enabled",
+              "touch " + touch + ", button " + button);
+    }
+    std::printf("  mean resume to client: %.0f us\n", static_cast<double>(total_delay_us) / cycles);
+
+    stop_service(pid);
+    remove_tree(sleep_root);
+}
+
+void check_unsupported() {
+    sleep_root = make_tree("mem");
+    pid_t pid = start_service(run_power_service);
+
+    EventLoop loop;
+    SuspendClient client(loop);
+    if (pid < 0 || !touchdown::bench::wait_for_name("org.touchdown.Power") || !loop.init() ||
+        !client.start()) {
+        check("service without freeze", false, "did not start");
+        if (pid > 0) stop_service(pid);
+        remove_tree(sleep_root);
+        return;
+    }
+
+    Cycle cycle;
+    client.suspend(cycle, NO_SUSPEND_WAIT_MS);
+    std::string state = read_file(sleep_root + "/power/state");
+    check("no freeze: screen off instead", cycle.replied && cycle.error.empty() &&
+          cycle.states == std::vector<std::string>{"suspended", "screen_off"} &&
+          cycle.resumed_us == 0 && state == "mem", join(cycle.states) + ", power/state " + state);
+
+    Cycle wake;
+    client.report_activity(wake, CYCLE_TIMEOUT_MS);
+    check("no freeze: input wakes it", wake.replied && wake.error.empty() &&
+          wake.states == std::vector<std::string>{"active"}, join(wake.states));
+
+    stop_service(pid);
+    remove_tree(sleep_root);
+}
+
+// libdbus keeps one connection per process, and a service forked after
+// it was opened would share it, so each check runs in a process of its own
+bool in_child(const std::function<void()>& run) {
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        run();
+        std::fflush(stdout);
+        _exit(failures == 0 ? 0 : 1);
+    }
+
+    int status = 0;
+    return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+           WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int cycles = argc > 1 ? std::atoi(argv[1]) : 3;
+    if (cycles <= 0) {
+        std::fprintf(stderr, "Usage: %s [cycles]\n", argv[0]);
+        return 2;
+    }
+
+    if (!touchdown::bench::have_dbus_tools()) return touchdown::bench::EXIT_SKIP;
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        return 2;
+    }
+
+    std::printf("suspend dry run, %d cycles:\n", cycles);
+    bool ok = in_child([cycles]() { check_suspend(cycles); });
+    ok = in_child(check_unsupported) && ok;
+
+    std::printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file thermal_quota_check.cpp
+ * @brief Checks the app slice CPU quota across thermal levels and screen off
+ *
+ * PowerService runs on a private bus with a fake thermal zone polled
+ * every 100 ms and a stand-in systemctl first in PATH, which appends its
+ * arguments to a log instead of touching systemd. Each step changes the
+ * zone's temperature or the power state and compares the quota the
+ * service set since the previous step:
+ *
+ *  - hot: the slice is capped at 30%
+ *  - screen off: the cap is lifted, and nothing is set while off
+ *  - back on, still hot: capped again once a sample is in
+ *  - cooled down: the cap is lifted
+ *  - screen off hot, back on cool: no cap on the way
+ *
+ * Needs only dbus-daemon and dbus-send in PATH, no system bus or root.
+ * Exits with status 1 on a mismatch, and 77 (skipped) without them.
+ *
+ * Usage: touchdown-thermal-quota-check
+ */
+
+#include "bench_bus.hpp"
+#include "touchdown/services/power_service.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr uint32_t POLL_MS = 100;
+constexpr uint32_t SETTLE_MS = 600;  // Several polls and the systemctl run
+constexpr int32_t HOT_MC = 75000;
+constexpr int32_t COOL_MC = 40000;
+
+using touchdown::EventLoop;
+using touchdown::services::DBusInterface;
+using touchdown::services::PowerProxy;
+
+std::string root;
+
+std::string zone_temp() { return root + "/thermal/thermal_zone0/temp"; }
+std::string quota_log() { return root + "/systemctl.log"; }
+
+void set_temp(int32_t temp_mc) {
+    std::ofstream(zone_temp()) << temp_mc << "\n";
+}
+
+// Quota values set since the last call, as "30%" or "" for none
+std::vector<std::string> take_quotas() {
+    static size_t seen = 0;
+    std::ifstream log(quota_log());
+    std::vector<std::string> quotas;
+    std::string line;
+    for (size_t i = 0; std::getline(log, line); i++) {
+        if (i < seen) continue;
+        seen = i + 1;
+        size_t quota = line.find("CPUQuota=");
+        quotas.push_back(quota == std::string::npos ? "?" + line : line.substr(quota + 9));
+    }
+    return quotas;
+}
+
+std::string join(const std::vector<std::string>& quotas) {
+    std::string text;
+    for (const std::string& quota : quotas) {
+        text += (text.empty() ? "" : ", ") + (quota.empty() ? std::string("none") : quota);
+    }
+    return text.empty() ? "(nothing set)" : text;
+}
+
+bool make_tree() {
+    char dir[] = "/tmp/touchdown-quota-XXXXXX";
+    if (!mkdtemp(dir)) return false;
+    root = dir;
+
+    mkdir((root + "/bin").c_str(), 0755);
+    mkdir((root + "/thermal").c_str(), 0755);
+    mkdir((root + "/thermal/thermal_zone0").c_str(), 0755);
+    std::ofstream(root + "/thermal/thermal_zone0/type") << "cpu-thermal\n";
+    set_temp(HOT_MC);
+
+    std::string systemctl = root + "/bin/systemctl";
+    std::ofstream(systemctl) << "#!/bin/sh\necho \"$*\" >> '" << quota_log() << "'\n";
+    chmod(systemctl.c_str(), 0755);
+
+    std::string path = root + "/bin:" + (std::getenv("PATH") ? std::getenv("PATH") : "");
+    setenv("PATH", path.c_str(), 1);
+    return true;
+}
+
+void remove_tree() {
+    std::string command = "rm -rf '" + root + "'";
+    if (root.rfind("/tmp/touchdown-quota-", 0) == 0 && std::system(command.c_str()) != 0) {
+        std::fprintf(stderr, "Cannot remove %s\n", root.c_str());
+    }
+}
+
+int run_power_service(int ready_fd) {
+    EventLoop loop;
+    if (!loop.init()) return 1;
+
+    auto on_signal = [&loop](int) { loop.stop(); };
+    loop.add_signal(SIGTERM, on_signal);
+
+    touchdown::ThermalConfig thermal;
+    touchdown::services::PowerService service;
+    service.set_thermal(thermal, root + "/thermal", {"cpu-thermal"}, POLL_MS, "touchdown-apps.slice");
+    service.set_thermal_response(touchdown::ThermalLevel::HOT, {false, 30});
+    service.set_thermal_response(touchdown::ThermalLevel::CRITICAL, {false, 15});
+    if (!service.init(loop)) return 1;
+    service.set_screen_timeout(0);
+
+    char ready = 1;
+    if (write(ready_fd, &ready, 1) != 1) return 1;
+    close(ready_fd);
+
+    service.run();
+    return 0;
+}
+
+pid_t start_service(int (*run)(int)) {
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ready[0]);
+        _exit(run(ready[1]));
+    }
+    close(ready[1]);
+
+    char byte = 0;
+    bool ok = pid > 0 && read(ready[0], &byte, 1) == 1;
+    close(ready[0]);
+
+    if (!ok && pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+        return -1;
+    }
+    return pid;
+}
+
+class QuotaClient : public DBusInterface {
+public:
+    QuotaClient(EventLoop& loop)
+        : DBusInterface("org.touchdown.BenchQuota", "/org/touchdown/BenchQuota")
+        , loop_(loop)
+        , power_(*this)
+        , timer_(EventLoop::INVALID_TIMER) {}
+
+    bool start() {
+        if (!init(loop_)) return false;
+        timer_ = loop_.add_timer([this]() { loop_.stop(); });
+        return true;
+    }
+
+    bool set_power_state(const std::string& state) {
+        bool ok = false;
+        power_.set_power_state(state, [&](const char* error) {
+            ok = !error;
+            loop_.stop();
+        });
+        loop_.arm_timer(timer_, 5000);
+        loop_.run();
+        return ok;
+    }
+
+    // Keeps the connection serviced while the power service works
+    void wait(uint32_t ms) {
+        loop_.arm_timer(timer_, ms);
+        loop_.run();
+    }
+
+private:
+    EventLoop& loop_;
+    PowerProxy power_;
+    EventLoop::TimerId timer_;
+};
+
+int failures = 0;
+
+void check(const char* step, const std::vector<std::string>& expected) {
+    std::vector<std::string> quotas = take_quotas();
+    bool ok = quotas == expected;
+    std::printf("  %-32s %-4s %s\n", step, ok ? "ok" : "FAIL", join(quotas).c_str());
+    if (!ok) {
+        std::printf("    expected %s\n", join(expected).c_str());
+        failures++;
+    }
+}
+
+} // namespace
+
+int main() {
+    if (!touchdown::bench::have_dbus_tools()) return touchdown::bench::EXIT_SKIP;
+
+    if (!make_tree()) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+
+    touchdown::bench::PrivateBus bus;
+    if (!bus.start()) {
+        std::fprintf(stderr, "Failed to start dbus-daemon\n");
+        remove_tree();
+        return 2;
+    }
+
+    pid_t pid = start_service(run_power_service);
+    EventLoop loop;
+    QuotaClient client(loop);
+    if (pid < 0 || !touchdown::bench::wait_for_name("org.touchdown.Power") || !loop.init() ||
+        !client.start()) {
+        std::fprintf(stderr, "Power service failed to start\n");
+        if (pid > 0) {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+        remove_tree();
+        return 2;
+    }
+
+    std::printf("app slice quota, zone polled every %u ms:\n", POLL_MS);
+    client.wait(SETTLE_MS);
+    check("hot", {"30%"});
+
+    bool ok = client.set_power_state("screen_off");
+    client.wait(SETTLE_MS);
+    check("screen off", {""});
+
+    ok = client.set_power_state("active") && ok;
+    client.wait(SETTLE_MS);
+    check("on again, still hot", {"30%"});
+
+    set_temp(COOL_MC);
+    client.wait(SETTLE_MS);
+    check("cooled down", {""});
+
+    set_temp(HOT_MC);
+    client.wait(SETTLE_MS);
+    ok = client.set_power_state("screen_off") && ok;
+    set_temp(COOL_MC);
+    client.wait(SETTLE_MS);
+    ok = client.set_power_state("active") && ok;
+    client.wait(SETTLE_MS);
+    check("off hot, on cool", {"30%", ""});
+
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    check("service stopped", {});
+    remove_tree();
+
+    if (!ok) {
+        std::printf("  SetPowerState failed\n");
+        failures++;
+    }
+    std::printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
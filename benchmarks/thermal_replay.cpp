@@ -0,0 +1,247 @@
+/**
+ * @file thermal_replay.cpp
+ * @brief Replays a temperature trace through the thermal governor
+ *
+ * A trace has one sample per line: milliseconds since the start and the
+ * temperature in millidegrees, as read from a thermal zone's temp file.
+ * Without a trace, a synthetic one is generated: 20 minutes of idle,
+ * sustained load and cool-down, sampled every 2 s, with sensor noise
+ * that lingers around each threshold.
+ *
+ * Every sample is written to a fake thermal_zone0/temp and read back
+ * through drivers::ThermalZones, as the power service does, before it
+ * goes to the ThermalGovernor. The trace is replayed twice: with the
+ * configured hysteresis and without any, to show the flapping it saves.
+ *
+ * The replay fails (exit status 1) if a level is ever below what the
+ * sample reached, or above it once the sample is hysteresis below the
+ * level's threshold.
+ *
+ * Usage: touchdown-thermal-replay [trace] [warm_mc] [hot_mc] [critical_mc]
+ *                                 [hysteresis_mc]
+ */
+
+#include "touchdown/core/thermal_governor.hpp"
+#include "touchdown/drivers/thermal_zones.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using touchdown::ThermalConfig;
+using touchdown::ThermalGovernor;
+using touchdown::ThermalLevel;
+using touchdown::THERMAL_LEVEL_COUNT;
+
+struct Sample {
+    uint64_t time_ms;
+    int32_t temp_mc;
+};
+
+struct Result {
+    uint64_t changes = 0;
+    uint64_t level_ms[THERMAL_LEVEL_COUNT] = {};
+    uint64_t violations = 0;
+};
+
+bool load_trace(const char* path, std::vector<Sample>& samples) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        Sample sample;
+        if (fields >> sample.time_ms >> sample.temp_mc) {
+            samples.push_back(sample);
+        }
+    }
+    return !samples.empty();
+}
+
+// Idle, a game for ten minutes, idle again; first-order heating towards
+// each phase's steady temperature plus deterministic sensor noise
+std::vector<Sample> synthetic_trace() {
+    struct Phase {
+        uint64_t duration_ms;
+        double steady_c;
+    };
+    const Phase phases[] = {
+        {120000, 48.0},
+        {600000, 81.0},
+        {480000, 45.0},
+    };
+    constexpr uint64_t POLL_MS = 2000;
+    constexpr double TAU_MS = 90000.0;
+
+    std::vector<Sample> samples;
+    double temp_c = 45.0;
+    uint64_t time_ms = 0;
+    uint32_t seed = 12345;
+
+    for (const Phase& phase : phases) {
+        for (uint64_t t = 0; t < phase.duration_ms; t += POLL_MS) {
+            temp_c += (phase.steady_c - temp_c) * (1.0 - std::exp(-double(POLL_MS) / TAU_MS));
+
+            seed = seed * 1103515245 + 12345;
+            double noise_c = (static_cast<int>((seed >> 16) % 3001) - 1500) / 1000.0;
+
+            // The BCM2835 sensor reports in steps of about half a degree
+            int32_t temp_mc = static_cast<int32_t>(std::lround((temp_c + noise_c) * 2.0) * 500);
+            samples.push_back({time_ms, temp_mc});
+            time_ms += POLL_MS;
+        }
+    }
+    return samples;
+}
+
+int32_t threshold(const ThermalConfig& config, ThermalLevel level) {
+    switch (level) {
+        case ThermalLevel::WARM: return config.warm_mc;
+        case ThermalLevel::HOT: return config.hot_mc;
+        case ThermalLevel::CRITICAL: return config.critical_mc;
+        default: return 0;
+    }
+}
+
+// Highest level whose threshold the sample reached
+ThermalLevel reached(const ThermalConfig& config, int32_t temp_mc) {
+    ThermalLevel level = ThermalLevel::NORMAL;
+    for (size_t i = 1; i < THERMAL_LEVEL_COUNT; i++) {
+        if (temp_mc >= threshold(config, static_cast<ThermalLevel>(i))) {
+            level = static_cast<ThermalLevel>(i);
+        }
+    }
+    return level;
+}
+
+Result replay(const std::vector<Sample>& samples, const ThermalConfig& config,
+              const std::string& zone_dir) {
+    touchdown::drivers::ThermalZones zones;
+    if (!zones.init(zone_dir)) {
+        std::fprintf(stderr, "Cannot open the fake thermal zone\n");
+        std::exit(1);
+    }
+
+    ThermalGovernor governor(config);
+    Result result;
+    ThermalLevel level = ThermalLevel::NORMAL;
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        std::ofstream(zone_dir + "/thermal_zone0/temp") << samples[i].temp_mc << '\n';
+
+        int32_t temp_mc = 0;
+        if (!zones.read(temp_mc) || temp_mc != samples[i].temp_mc) {
+            std::fprintf(stderr, "Read %d back for %d\n", temp_mc, samples[i].temp_mc);
+            result.violations++;
+            continue;
+        }
+
+        ThermalLevel previous = level;
+        level = governor.update(temp_mc);
+        if (level != previous) result.changes++;
+
+        // Never below what the sample reached; never held once clearly below
+        if (level < reached(config, temp_mc)) {
+            result.violations++;
+        }
+        if (level != ThermalLevel::NORMAL &&
+            temp_mc < threshold(config, level) - config.hysteresis_mc) {
+            result.violations++;
+        }
+
+        if (i + 1 < samples.size()) {
+            result.level_ms[static_cast<size_t>(level)] += samples[i + 1].time_ms - samples[i].time_ms;
+        }
+    }
+    return result;
+}
+
+void print(const char* name, const Result& result, uint64_t total_ms) {
+    std::printf("  %-16s %7llu", name, static_cast<unsigned long long>(result.changes));
+    for (size_t i = 0; i < THERMAL_LEVEL_COUNT; i++) {
+        std::printf("  %7.1f%%", total_ms > 0 ? result.level_ms[i] * 100.0 / total_ms : 0.0);
+    }
+    std::printf("\n");
+}
+
+int32_t arg_mc(int argc, char* argv[], int index, int32_t fallback) {
+    return argc > index ? static_cast<int32_t>(std::atoi(argv[index])) : fallback;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<Sample> trace;
+    const char* source = "synthetic";
+    if (argc > 1 && std::string(argv[1]) != "-") {
+        source = argv[1];
+        if (!load_trace(argv[1], trace)) {
+            std::fprintf(stderr, "No samples in %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        trace = synthetic_trace();
+    }
+
+    ThermalConfig config;
+    config.warm_mc = arg_mc(argc, argv, 2, config.warm_mc);
+    config.hot_mc = arg_mc(argc, argv, 3, config.hot_mc);
+    config.critical_mc = arg_mc(argc, argv, 4, config.critical_mc);
+    config.hysteresis_mc = arg_mc(argc, argv, 5, config.hysteresis_mc);
+    if (!(config.warm_mc < config.hot_mc && config.hot_mc < config.critical_mc)) {
+        std::fprintf(stderr, "Thresholds must rise: warm < hot < critical\n");
+        return 2;
+    }
+
+    // The zone the power service would poll
+    char dir[] = "/tmp/touchdown-thermal-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::fprintf(stderr, "Cannot create a fake thermal zone\n");
+        return 1;
+    }
+    std::string zone_dir = dir;
+    mkdir((zone_dir + "/thermal_zone0").c_str(), 0755);
+    std::ofstream(zone_dir + "/thermal_zone0/type") << "cpu-thermal\n";
+    std::ofstream(zone_dir + "/thermal_zone0/temp") << "0\n";
+
+    ThermalConfig flat = config;
+    flat.hysteresis_mc = 0;
+
+    Result with = replay(trace, config, zone_dir);
+    Result without = replay(trace, flat, zone_dir);
+
+    unlink((zone_dir + "/thermal_zone0/temp").c_str());
+    unlink((zone_dir + "/thermal_zone0/type").c_str());
+    rmdir((zone_dir + "/thermal_zone0").c_str());
+    rmdir(dir);
+
+    uint64_t total_ms = trace.back().time_ms - trace.front().time_ms;
+    auto hottest = std::max_element(trace.begin(), trace.end(),
+        [](const Sample& a, const Sample& b) { return a.temp_mc < b.temp_mc; });
+    std::printf("trace=%s samples=%zu (%llu s), hottest %.1f C\n", source, trace.size(),
+                static_cast<unsigned long long>(total_ms / 1000), hottest->temp_mc / 1000.0);
+    std::printf("thresholds warm %.1f, hot %.1f, critical %.1f C, hysteresis %.1f C\n",
+                config.warm_mc / 1000.0, config.hot_mc / 1000.0, config.critical_mc / 1000.0,
+                config.hysteresis_mc / 1000.0);
+    std::printf("  %-16s %7s  %8s  %8s  %8s  %8s\n", "policy", "changes", "normal", "warm", "hot",
+                "critical");
+    print("hysteresis", with, total_ms);
+    print("no hysteresis", without, total_ms);
+
+    if (with.violations > 0) {
+        std::printf("FAILED: %llu samples at the wrong level\n",
+                    static_cast<unsigned long long>(with.violations));
+        return 1;
+    }
+    std::printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file touch_power_check.cpp
+ * @brief Checks the CST816S register writes for every power mode switch
+ *
+ * The touch driver runs on a recording fake I2C bus. Each step switches
+ * the power mode and compares the register writes against the expected
+ * sequence: 0xE5 (sleep mode), 0xF9 (auto-sleep time), 0xFA (IRQ
+ * control) and 0xFE (disable auto-sleep). A bus that fails its writes
+ * must leave the driver in its previous mode, so that the next switch
+ * starts again from there. A failed write at init or of the auto-sleep
+ * time must not let the next switch to the same mode be skipped.
+ *
+ * No reset line is configured, so leaving STANDBY must fail without
+ * touching the bus; the reset itself needs a GPIO chip.
+ *
+ * Exits with status 1 if any step differs.
+ *
+ * Usage: touchdown-touch-power-check
+ */
+
+#include "touchdown/drivers/touch_driver.hpp"
+#include "touchdown/drivers/i2c_bus.hpp"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using touchdown::drivers::I2CBus;
+using touchdown::drivers::TouchDriver;
+using touchdown::drivers::TouchPowerMode;
+
+using Write = std::pair<uint8_t, uint8_t>;
+
+// Records register writes; reads report no touch
+class RecordingBus : public I2CBus {
+public:
+    explicit RecordingBus(std::vector<Write>& writes) : writes_(writes), failing_(false) {}
+
+    void set_failing(bool failing) { failing_ = failing; }
+
+    bool write_register(uint8_t reg, uint8_t value) override {
+        if (failing_) return false;
+        writes_.emplace_back(reg, value);
+        return true;
+    }
+
+    bool read_registers(uint8_t /* reg */, uint8_t* buf, size_t len) override {
+        for (size_t i = 0; i < len; i++) buf[i] = 0;
+        return true;
+    }
+
+private:
+    std::vector<Write>& writes_;
+    bool failing_;
+};
+
+const char* mode_name(TouchPowerMode mode) {
+    switch (mode) {
+        case TouchPowerMode::ACTIVE: return "active";
+        case TouchPowerMode::AUTO_SLEEP: return "auto_sleep";
+        case TouchPowerMode::WAKE_ON_TOUCH: return "wake_on_touch";
+        case TouchPowerMode::STANDBY: return "standby";
+    }
+    return "?";
+}
+
+std::string format(const std::vector<Write>& writes) {
+    std::string text;
+    char item[16];
+    for (const Write& write : writes) {
+        std::snprintf(item, sizeof(item), "%s%02X=%02X", text.empty() ? "" : " ",
+                      write.first, write.second);
+        text += item;
+    }
+    return text.empty() ? "(none)" : text;
+}
+
+int failures = 0;
+
+void check(const char* step, bool returned, bool expected_return, TouchPowerMode mode,
+           TouchPowerMode expected_mode, std::vector<Write>& writes,
+           const std::vector<Write>& expected) {
+    bool ok = returned == expected_return && mode == expected_mode && writes == expected;
+    std::printf("  %-34s %-4s %s\n", step, ok ? "ok" : "FAIL", format(writes).c_str());
+    if (!ok) {
+        std::printf("    expected %s, mode %s, writes %s\n", expected_return ? "success" : "failure",
+                    mode_name(expected_mode), format(expected).c_str());
+        std::printf("    got      %s, mode %s\n", returned ? "success" : "failure",
+                    mode_name(mode));
+        failures++;
+    }
+    writes.clear();
+}
+
+} // namespace
+
+int main() {
+    std::vector<Write> writes;
+    auto owned = std::make_unique<RecordingBus>(writes);
+    RecordingBus* bus = owned.get();
+
+    TouchDriver touch;
+    // Registers unwritten at init: ACTIVE is not taken as already set
+    bus->set_failing(true);
+    touch.init(std::move(owned));
+    check("init, bus failing", true, true, touch.get_power_mode(), TouchPowerMode::ACTIVE, writes,
+          {});
+
+    bus->set_failing(false);
+    bool ret = touch.set_power_mode(TouchPowerMode::ACTIVE);
+    check("unprogrammed -> active", ret, true, touch.get_power_mode(), TouchPowerMode::ACTIVE,
+          writes, {{0xFE, 0x01}, {0xFA, 0x60}});
+
+    // The same mode again is not a switch
+    ret = touch.set_power_mode(TouchPowerMode::ACTIVE);
+    check("active -> active", ret, true, touch.get_power_mode(), TouchPowerMode::ACTIVE, writes,
+          {});
+
+    ret = touch.set_power_mode(TouchPowerMode::AUTO_SLEEP);
+    check("active -> auto_sleep", ret, true, touch.get_power_mode(), TouchPowerMode::AUTO_SLEEP,
+          writes, {{0xF9, 0x05}, {0xFE, 0x00}, {0xFA, 0x60}});
+
+    ret = touch.set_auto_sleep_timeout_s(10);
+    check("auto_sleep timeout 10 s", ret, true, touch.get_power_mode(),
+          TouchPowerMode::AUTO_SLEEP, writes, {{0xF9, 0x0A}});
+
+    // A lost timeout write is redone by switching to AUTO_SLEEP again
+    bus->set_failing(true);
+    ret = touch.set_auto_sleep_timeout_s(20);
+    check("auto_sleep timeout, bus failing", ret, false, touch.get_power_mode(),
+          TouchPowerMode::AUTO_SLEEP, writes, {});
+
+    bus->set_failing(false);
+    ret = touch.set_power_mode(TouchPowerMode::AUTO_SLEEP);
+    check("auto_sleep -> auto_sleep, redone", ret, true, touch.get_power_mode(),
+          TouchPowerMode::AUTO_SLEEP, writes, {{0xF9, 0x14}, {0xFE, 0x00}, {0xFA, 0x60}});
+
+    ret = touch.set_power_mode(TouchPowerMode::WAKE_ON_TOUCH);
+    check("auto_sleep -> wake_on_touch", ret, true, touch.get_power_mode(),
+          TouchPowerMode::WAKE_ON_TOUCH, writes, {{0xF9, 0x01}, {0xFE, 0x00}, {0xFA, 0x40}});
+
+    ret = touch.set_power_mode(TouchPowerMode::ACTIVE);
+    check("wake_on_touch -> active", ret, true, touch.get_power_mode(), TouchPowerMode::ACTIVE,
+          writes, {{0xFE, 0x01}, {0xFA, 0x60}});
+
+    // A failed switch keeps the old mode and is redone in full
+    bus->set_failing(true);
+    ret = touch.set_power_mode(TouchPowerMode::STANDBY);
+    check("active -> standby, bus failing", ret, false, touch.get_power_mode(),
+          TouchPowerMode::ACTIVE, writes, {});
+
+    bus->set_failing(false);
+    ret = touch.set_power_mode(TouchPowerMode::STANDBY);
+    check("active -> standby", ret, true, touch.get_power_mode(), TouchPowerMode::STANDBY, writes,
+          {{0xE5, 0x03}});
+
+    // Deep sleep ignores I2C; without a reset line it cannot be left
+    ret = touch.set_power_mode(TouchPowerMode::ACTIVE);
+    check("standby -> active, no reset line", ret, false, touch.get_power_mode(),
+          TouchPowerMode::STANDBY, writes, {});
+
+    std::printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
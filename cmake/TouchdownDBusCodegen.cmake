@@ -0,0 +1,41 @@
+# D-Bus stub and proxy generation from introspection XML
+#
+#   touchdown_dbus_codegen(<target> <xml>...)
+#
+# Generates touchdown/dbus/<name>_interface.hpp under
+# TOUCHDOWN_DBUS_GENERATED_DIR for each file, where <name> is the last
+# component of the file name in snake case (org.touchdown.Power.xml ->
+# power_interface.hpp). <target> builds them; targets that include the
+# headers add a dependency on it.
+
+set(TOUCHDOWN_DBUS_CODEGEN ${CMAKE_SOURCE_DIR}/scripts/td-dbus-codegen.py)
+set(TOUCHDOWN_DBUS_GENERATED_DIR ${CMAKE_BINARY_DIR}/generated)
+
+function(touchdown_dbus_codegen target)
+    if(NOT Python3_Interpreter_FOUND)
+        message(FATAL_ERROR "td-dbus-codegen needs a Python 3 interpreter")
+    endif()
+
+    set(headers)
+    foreach(xml ${ARGN})
+        get_filename_component(xml_path ${xml} ABSOLUTE)
+        get_filename_component(xml_name ${xml} NAME)
+
+        string(REGEX REPLACE "\\.xml$" "" interface ${xml_name})
+        string(REGEX REPLACE "^.*\\." "" name ${interface})
+        string(REGEX REPLACE "([a-z0-9])([A-Z])" "\\1_\\2" name ${name})
+        string(TOLOWER ${name} name)
+
+        set(header ${TOUCHDOWN_DBUS_GENERATED_DIR}/touchdown/dbus/${name}_interface.hpp)
+        add_custom_command(
+            OUTPUT ${header}
+            COMMAND ${Python3_EXECUTABLE} ${TOUCHDOWN_DBUS_CODEGEN} --output ${header} ${xml_path}
+            DEPENDS ${xml_path} ${TOUCHDOWN_DBUS_CODEGEN}
+            COMMENT "Generating D-Bus stubs for ${interface}"
+            VERBATIM
+        )
+        list(APPEND headers ${header})
+    endforeach()
+
+    add_custom_target(${target} DEPENDS ${headers})
+endfunction()
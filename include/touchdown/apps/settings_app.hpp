@@ -7,6 +7,7 @@
 #define TOUCHDOWN_APPS_SETTINGS_APP_HPP
 
 #include "touchdown/app/app.hpp"
+#include "touchdown/client/system_client.hpp"
 #include <vector>
 #include <functional>
 
@@ -44,6 +45,9 @@ private:
     std::vector<lv_obj_t*> items_;
     lv_style_t item_style_;
     std::vector<std::function<void()>> callbacks_;
+    
+    // Replies to calls still in flight when the app closes are dropped
+    client::CallbackGuard guard_;
 };
 
 } // namespace apps
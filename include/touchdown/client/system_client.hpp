@@ -0,0 +1,97 @@
+/**
+ * @file system_client.hpp
+ * @brief Typed, non-blocking access to the system services for apps
+ */
+
+#ifndef TOUCHDOWN_CLIENT_SYSTEM_CLIENT_HPP
+#define TOUCHDOWN_CLIENT_SYSTEM_CLIENT_HPP
+
+#include "touchdown/services/dbus_interface.hpp"
+#include "touchdown/dbus/power_interface.hpp"
+#include "touchdown/dbus/input_interface.hpp"
+#include <memory>
+#include <utility>
+
+namespace touchdown {
+namespace client {
+
+/**
+ * @brief Proxies for org.touchdown.Power and org.touchdown.Input
+ *
+ * The shell attaches its own bus connection at startup, so every app
+ * shares that one connection rather than opening another. Calls never
+ * wait: each one is queued on the connection and returns, and several
+ * may be in flight at once. Replies and signals are dispatched by the
+ * shell's event loop, the same thread that runs LVGL, so callbacks may
+ * touch widgets directly. The Python module, loaded in an app's own
+ * process, attaches a connection of its own instead.
+ *
+ * The proxies are null until attach() and after detach(); apps must check.
+ */
+class SystemClient {
+public:
+    static SystemClient& instance();
+
+    /**
+     * @brief Use an existing connection; it must outlive detach()
+     */
+    void attach(services::DBusInterface& bus);
+
+    /**
+     * @brief Drop the proxies, just before the connection is destroyed
+     *
+     * Signal handlers registered through the proxies belong to the
+     * connection and cannot be removed, so detach only together with it.
+     */
+    void detach();
+
+    bool is_attached() const { return bus_ != nullptr; }
+
+    /**
+     * @brief org.touchdown.Power, or nullptr if not attached
+     */
+    services::PowerProxy* power() { return power_.get(); }
+
+    /**
+     * @brief org.touchdown.Input, or nullptr if not attached
+     */
+    services::InputProxy* input() { return input_.get(); }
+
+private:
+    SystemClient() = default;
+
+    services::DBusInterface* bus_ = nullptr;
+    std::unique_ptr<services::PowerProxy> power_;
+    std::unique_ptr<services::InputProxy> input_;
+};
+
+/**
+ * @brief Drops callbacks whose owner has gone away
+ *
+ * An app can be closed while one of its calls is still in flight. Make
+ * the guard a member and pass callbacks through wrap(); once the guard is
+ * destroyed, late replies are ignored instead of reaching a dead object.
+ */
+class CallbackGuard {
+public:
+    CallbackGuard() : alive_(std::make_shared<bool>(true)) {}
+
+    CallbackGuard(const CallbackGuard&) = delete;
+    CallbackGuard& operator=(const CallbackGuard&) = delete;
+
+    template <typename F>
+    auto wrap(F callback) const {
+        std::weak_ptr<bool> alive = alive_;
+        return [alive, callback](auto&&... args) {
+            if (alive.lock()) callback(std::forward<decltype(args)>(args)...);
+        };
+    }
+
+private:
+    std::shared_ptr<bool> alive_;
+};
+
+} // namespace client
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CLIENT_SYSTEM_CLIENT_HPP
@@ -0,0 +1,96 @@
+/**
+ * @file activity_page.hpp
+ * @brief Shared page with the time of the last user input
+ */
+
+#ifndef TOUCHDOWN_CORE_ACTIVITY_PAGE_HPP
+#define TOUCHDOWN_CORE_ACTIVITY_PAGE_HPP
+
+#include "touchdown/core/event_queue.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace touchdown {
+
+/**
+ * @brief Snapshot of user activity
+ */
+struct ActivityRecord {
+    uint64_t last_activity_us;   // CLOCK_MONOTONIC time of the last input event
+    uint64_t touch_count;        // Touch events since the page was created
+    uint64_t button_count;       // Button events since the page was created
+};
+
+/**
+ * @brief Layout of the page as mapped by every process
+ *
+ * The record is guarded by a seqlock: odd while the writer updates it.
+ */
+struct ActivityPageLayout {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> sequence;
+    ActivityRecord record;
+};
+
+/**
+ * @brief Writer side, owned by the input service
+ */
+class ActivityPage {
+public:
+    ActivityPage();
+    ~ActivityPage();
+
+    bool create();
+    void destroy();
+
+    /**
+     * @brief Record an input event (single writer thread only)
+     */
+    void record(InputEvent::Kind kind, uint64_t timestamp_us);
+
+    /**
+     * @brief memfd to hand to readers; sealed so it can only be mapped read-only
+     */
+    int get_fd() const { return fd_; }
+
+private:
+    int fd_;
+    size_t size_;
+    ActivityPageLayout* page_;
+};
+
+/**
+ * @brief Reader side: a lock-free snapshot without any IPC round trip
+ */
+class ActivityPageReader {
+public:
+    ActivityPageReader();
+    ~ActivityPageReader();
+
+    /**
+     * @brief Map the page read-only
+     * @param fd Page fd; ownership is taken
+     */
+    bool attach(int fd);
+    void detach();
+
+    bool is_attached() const { return page_ != nullptr; }
+
+    /**
+     * @brief Take a consistent snapshot of the record
+     * @return false if not attached, or if the writer stayed mid-update
+     *         (stopped or killed between its stores); record is then unusable
+     */
+    bool read(ActivityRecord& record) const;
+
+private:
+    int fd_;
+    size_t size_;
+    const ActivityPageLayout* page_;
+};
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_ACTIVITY_PAGE_HPP
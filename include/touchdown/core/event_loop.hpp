@@ -0,0 +1,163 @@
+/**
+ * @file event_loop.hpp
+ * @brief epoll-based reactor shared by the shell and services
+ */
+
+#ifndef TOUCHDOWN_CORE_EVENT_LOOP_HPP
+#define TOUCHDOWN_CORE_EVENT_LOOP_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <atomic>
+
+namespace touchdown {
+
+/**
+ * @brief Single-threaded reactor built on epoll, timerfd, eventfd and signalfd
+ *
+ * All callbacks run on the thread calling run(). Only post() and stop()
+ * may be called from other threads. With no armed timers and no pending
+ * work the loop blocks in epoll_wait indefinitely.
+ */
+class EventLoop {
+public:
+    using FdCallback = std::function<void(uint32_t events)>;
+    using TimerCallback = std::function<void()>;
+    using SignalCallback = std::function<void(int signo)>;
+    using Task = std::function<void()>;
+    using TimerId = int;
+
+    static constexpr TimerId INVALID_TIMER = -1;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Create epoll, wakeup eventfd and signalfd
+     */
+    bool init();
+
+    /**
+     * @brief Dispatch events until stop() is called
+     */
+    void run();
+
+    /**
+     * @brief Dispatch one batch of ready events
+     * @param timeout_ms Maximum time to block (-1 = forever)
+     */
+    void run_once(int timeout_ms = -1);
+
+    /**
+     * @brief Ask run() to return (thread-safe)
+     */
+    void stop();
+
+    /**
+     * @brief Queue a task to run on the loop thread (thread-safe)
+     */
+    void post(Task task);
+
+    /**
+     * @brief Watch a file descriptor
+     * @param events EPOLLIN/EPOLLOUT/... mask
+     */
+    bool add_fd(int fd, uint32_t events, FdCallback callback);
+
+    /**
+     * @brief Change the event mask of a watched descriptor
+     */
+    bool modify_fd(int fd, uint32_t events);
+
+    /**
+     * @brief Stop watching a descriptor (does not close it)
+     */
+    void remove_fd(int fd);
+
+    /**
+     * @brief Create a timer, initially disarmed
+     */
+    TimerId add_timer(TimerCallback callback);
+
+    /**
+     * @brief Arm a timer relative to now
+     * @param delay_ms First expiry
+     * @param interval_ms Repeat period (0 = one-shot)
+     */
+    void arm_timer(TimerId id, uint32_t delay_ms, uint32_t interval_ms = 0);
+
+    /**
+     * @brief Arm a one-shot timer at an absolute CLOCK_MONOTONIC time
+     */
+    void arm_timer_at(TimerId id, uint64_t deadline_us);
+
+    /**
+     * @brief Disarm a timer without removing it
+     */
+    void disarm_timer(TimerId id);
+
+    /**
+     * @brief Disarm and destroy a timer
+     */
+    void remove_timer(TimerId id);
+
+    /**
+     * @brief Route a signal through the loop instead of an async handler
+     *
+     * Blocks the signal for the calling thread; call before spawning
+     * threads so they inherit the mask.
+     */
+    bool add_signal(int signo, SignalCallback callback);
+
+    /**
+     * @brief epoll fd, readable while run_once(0) has something to dispatch
+     *
+     * For driving this loop from another one, e.g. a Python app's.
+     */
+    int get_fd() const { return epoll_fd_; }
+
+    /**
+     * @brief Number of times epoll_wait has returned
+     */
+    uint64_t wakeup_count() const { return wakeups_; }
+
+    /**
+     * @brief Current CLOCK_MONOTONIC time in microseconds
+     */
+    static uint64_t now_us();
+
+private:
+    struct Timer {
+        int fd;
+        TimerCallback callback;
+    };
+
+    void handle_wakeup();
+    void handle_signal();
+    void run_posted();
+
+    int epoll_fd_;
+    int wake_fd_;
+    int signal_fd_;
+    std::atomic<bool> running_;
+    uint64_t wakeups_;
+
+    std::map<int, std::shared_ptr<FdCallback>> fd_callbacks_;
+    std::map<TimerId, Timer> timers_;
+    std::map<int, SignalCallback> signal_callbacks_;
+    TimerId next_timer_id_;
+
+    std::mutex posted_mutex_;
+    std::vector<Task> posted_;
+};
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_EVENT_LOOP_HPP
@@ -0,0 +1,175 @@
+/**
+ * @file event_queue.hpp
+ * @brief Lock-free hand-off of input events to the UI thread
+ */
+
+#ifndef TOUCHDOWN_CORE_EVENT_QUEUE_HPP
+#define TOUCHDOWN_CORE_EVENT_QUEUE_HPP
+
+#include "touchdown/core/types.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace touchdown {
+
+/**
+ * @brief Bounded lock-free multi-producer single-consumer queue
+ *
+ * Each slot carries a sequence number (Vyukov's bounded queue), so
+ * producers only contend on a single atomic increment and never block.
+ * push() fails when the queue is full.
+ */
+template<typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    MpscQueue() : enqueue_pos_(0), dequeue_pos_(0) {
+        for (size_t i = 0; i < Capacity; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Enqueue from any thread
+     * @return false if the queue is full
+     */
+    bool push(const T& value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;) {
+            cell = &cells_[pos & (Capacity - 1)];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue on the consumer thread
+     * @return false if the queue is empty
+     */
+    bool pop(T& value) {
+        Cell* cell = &cells_[dequeue_pos_ & (Capacity - 1)];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+
+        if (seq != dequeue_pos_ + 1) {
+            return false;  // Empty, or the producer hasn't finished writing
+        }
+
+        value = cell->value;
+        cell->sequence.store(dequeue_pos_ + Capacity, std::memory_order_release);
+        dequeue_pos_++;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    Cell cells_[Capacity];
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) size_t dequeue_pos_;
+};
+
+/**
+ * @brief Input event as queued for the UI thread
+ */
+struct InputEvent {
+    enum class Kind : uint8_t {
+        TOUCH,
+        BUTTON
+    };
+
+    Kind kind;
+    TouchPoint touch;       // Valid for TOUCH, original driver timestamp kept
+    ButtonEvent button;     // Valid for BUTTON, original driver timestamp kept
+    uint64_t posted_us;     // CLOCK_MONOTONIC time the driver posted it
+    uint64_t published_us;  // Time the input service wrote it to the event ring
+    uint32_t trace_id;      // Assigned by the input service, follows the event to the screen
+};
+
+/**
+ * @brief Queue that marshals driver callbacks onto an event loop thread
+ *
+ * Drivers post from their own threads; the loop thread is woken through an
+ * eventfd (at most once per batch) and runs the handler for each event.
+ */
+class InputEventQueue {
+public:
+    using Handler = std::function<void(const InputEvent&)>;
+
+    InputEventQueue();
+    ~InputEventQueue();
+
+    /**
+     * @brief Register the wakeup eventfd with the consumer's loop
+     */
+    bool init(EventLoop& loop, Handler handler);
+
+    /**
+     * @brief Post a touch event (any thread)
+     */
+    bool post(const TouchPoint& point);
+
+    /**
+     * @brief Post a button event (any thread)
+     */
+    bool post(const ButtonEvent& event);
+
+    /**
+     * @brief Dispatch every queued event (consumer thread only)
+     */
+    void drain();
+
+    /**
+     * @brief Queueing delay statistics, in microseconds
+     */
+    uint64_t get_dispatched_count() const { return dispatched_; }
+    uint64_t get_max_delay_us() const { return max_delay_us_; }
+    uint64_t get_total_delay_us() const { return total_delay_us_; }
+    uint64_t get_dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t CAPACITY = 256;
+
+    bool post(InputEvent& event);
+    void wake();
+
+    MpscQueue<InputEvent, CAPACITY> queue_;
+    EventLoop* loop_;
+    int wake_fd_;
+    Handler handler_;
+
+    std::atomic<bool> wake_pending_;
+    std::atomic<uint64_t> dropped_;
+
+    // Consumer-side statistics
+    uint64_t dispatched_;
+    uint64_t max_delay_us_;
+    uint64_t total_delay_us_;
+};
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_EVENT_QUEUE_HPP
@@ -0,0 +1,110 @@
+/**
+ * @file frame_feedback.hpp
+ * @brief Frame-time reports and the CPU frequency floor they drive
+ */
+
+#ifndef TOUCHDOWN_CORE_FRAME_FEEDBACK_HPP
+#define TOUCHDOWN_CORE_FRAME_FEEDBACK_HPP
+
+#include <cstdint>
+
+namespace touchdown {
+
+/**
+ * @brief Rendering over one reporting window
+ */
+struct FrameReport {
+    uint32_t frames = 0;     // Frames rendered
+    uint32_t missed = 0;     // Frames that took longer than the deadline
+    uint32_t busy_us = 0;    // Time spent rendering
+    uint32_t max_us = 0;     // Slowest frame
+    uint32_t window_us = 0;  // First frame of the window to the report
+};
+
+/**
+ * @brief Collects rendered frames into reports
+ *
+ * A window opens with the first frame after the previous report, so a
+ * UI at rest produces nothing to send.
+ */
+class FrameStats {
+public:
+    explicit FrameStats(uint32_t deadline_us);
+
+    /**
+     * @brief Count a frame that took render_us, rendered at start_us
+     */
+    void add(uint64_t start_us, uint64_t render_us);
+
+    /**
+     * @brief Close the window once it has lasted interval_us
+     * @return true if report was filled and a new window begins
+     */
+    bool take(uint64_t now_us, uint64_t interval_us, FrameReport& report);
+
+    uint32_t get_deadline_us() const { return deadline_us_; }
+
+private:
+    uint32_t deadline_us_;
+    uint64_t window_start_us_;
+    FrameReport current_;
+};
+
+/**
+ * @brief Tuning of FrameFloorController
+ */
+struct FrameFloorConfig {
+    uint32_t deadline_us = 33000;  // LV_DISP_DEF_REFR_PERIOD
+    uint32_t min_khz = 0;   // First floor set; stepping below it drops the floor
+    uint32_t max_khz = 0;   // Highest floor, 0 disables the controller
+    uint32_t step_khz = 100000;
+    uint32_t raise_percent = 90;  // Slowest frame above this share of the deadline raises
+    uint32_t lower_percent = 60;  // Slowest frame below it, for hold_reports in a row, lowers
+    uint32_t hold_reports = 3;
+};
+
+/**
+ * @brief Lowest CPU frequency floor that keeps frames within their deadline
+ *
+ * Fed one FrameReport per window. A missed frame, or a slowest frame
+ * close to the deadline, raises the floor at once: one step per missed
+ * frame, up to MAX_RAISE_STEPS. The floor only comes down one step at a
+ * time after several windows with plenty of headroom, so the clock
+ * settles just above where frames start to miss instead of oscillating
+ * around it. Pure logic with no clock or I/O, so recorded traces can be
+ * replayed through it.
+ */
+class FrameFloorController {
+public:
+    static constexpr uint32_t MAX_RAISE_STEPS = 4;
+
+    explicit FrameFloorController(const FrameFloorConfig& config = FrameFloorConfig());
+
+    void configure(const FrameFloorConfig& config);
+
+    bool is_enabled() const { return config_.max_khz > 0; }
+
+    /**
+     * @brief Account for one window
+     * @return The new floor in kHz, 0 for none
+     */
+    uint32_t update(const FrameReport& report);
+
+    /**
+     * @brief Drop the floor, e.g. when the screen goes off
+     */
+    void reset();
+
+    uint32_t get_floor_khz() const { return floor_khz_; }
+    uint64_t get_raise_count() const { return raises_; }
+
+private:
+    FrameFloorConfig config_;
+    uint32_t floor_khz_;
+    uint32_t quiet_reports_;
+    uint64_t raises_;
+};
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_FRAME_FEEDBACK_HPP
@@ -0,0 +1,123 @@
+/**
+ * @file input_ring.hpp
+ * @brief Shared-memory broadcast ring for input events
+ */
+
+#ifndef TOUCHDOWN_CORE_INPUT_RING_HPP
+#define TOUCHDOWN_CORE_INPUT_RING_HPP
+
+#include "touchdown/core/event_queue.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace touchdown {
+
+/**
+ * @brief Layout of the ring as mapped by every process
+ *
+ * One producer, any number of readers. Each slot is a seqlock: the
+ * sequence is odd while the producer writes it and 2 * index + 2 once
+ * the event at that index is complete. Readers never write, so a slow
+ * or dead reader cannot stall the producer; it just loses old events.
+ */
+struct InputRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t slot_size;
+    alignas(64) std::atomic<uint64_t> write_index;
+};
+
+struct InputRingSlot {
+    std::atomic<uint64_t> sequence;
+    InputEvent event;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Ring indices must be lock-free to be shared between processes");
+static_assert(std::is_trivially_copyable<InputEvent>::value,
+              "Ring events are copied between processes");
+
+/**
+ * @brief Producer side: owns the memfd and publishes events
+ */
+class InputRing {
+public:
+    InputRing();
+    ~InputRing();
+
+    /**
+     * @brief Create and map the ring
+     * @param capacity Number of slots, must be a power of two
+     */
+    bool create(uint32_t capacity = 256);
+
+    /**
+     * @brief Unmap and close the ring
+     */
+    void destroy();
+
+    /**
+     * @brief Publish an event to every reader (single producer thread only)
+     */
+    void publish(const InputEvent& event);
+
+    /**
+     * @brief memfd to hand to readers; sealed so it can only be mapped read-only
+     */
+    int get_fd() const { return fd_; }
+
+private:
+    int fd_;
+    size_t size_;
+    InputRingHeader* header_;
+    InputRingSlot* slots_;
+};
+
+/**
+ * @brief Reader side: maps a ring received from the producer
+ */
+class InputRingReader {
+public:
+    InputRingReader();
+    ~InputRingReader();
+
+    /**
+     * @brief Map the ring read-only and start at the current write position
+     * @param fd Ring fd; ownership is taken
+     */
+    bool attach(int fd);
+
+    /**
+     * @brief Unmap the ring
+     */
+    void detach();
+
+    bool is_attached() const { return header_ != nullptr; }
+
+    /**
+     * @brief Read the next event
+     * @return false when caught up with the producer
+     */
+    bool read(InputEvent& event);
+
+    /**
+     * @brief Events overwritten before this reader got to them
+     */
+    uint64_t get_lost_count() const { return lost_; }
+
+private:
+    int fd_;
+    size_t size_;
+    const InputRingHeader* header_;
+    const InputRingSlot* slots_;
+    uint32_t capacity_;
+    uint64_t read_index_;
+    uint64_t lost_;
+};
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_INPUT_RING_HPP
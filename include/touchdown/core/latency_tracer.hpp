@@ -0,0 +1,152 @@
+/**
+ * @file latency_tracer.hpp
+ * @brief Input-to-photon latency tracing
+ */
+
+#ifndef TOUCHDOWN_CORE_LATENCY_TRACER_HPP
+#define TOUCHDOWN_CORE_LATENCY_TRACER_HPP
+
+#include "touchdown/core/event_queue.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace touchdown {
+
+/**
+ * @brief Points an input event passes on its way to the screen
+ */
+enum class TraceStage : uint8_t {
+    SAMPLE,      // Kernel timestamp of the IRQ edge or evdev event
+    POST,        // Driver callback posted it to the input service queue
+    PUBLISH,     // Input service wrote it to the event ring
+    DISPATCH,    // Shell read it from the ring
+    CONSUMED,    // LVGL's pointer read took it, or the shell's handler started
+    INVALIDATE,  // First LVGL invalidation while it was being handled
+    FLUSH,       // Last area of the first frame containing the change flushed
+    COUNT
+};
+
+/**
+ * @brief Fixed-bucket latency histogram (250 us buckets up to 100 ms)
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t BUCKET_US = 250;
+    static constexpr size_t BUCKETS = 400;
+
+    LatencyHistogram();
+
+    void add(uint64_t latency_us);
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t max_us() const { return max_us_; }
+
+    /**
+     * @brief Upper bound of the bucket containing the given percentile
+     */
+    uint64_t percentile_us(double percentile) const;
+
+private:
+    uint32_t buckets_[BUCKETS + 1];  // Last bucket collects overflow
+    uint64_t count_;
+    uint64_t max_us_;
+};
+
+/**
+ * @brief Follows traced input events through the shell to the display
+ *
+ * Disabled by default; every hook is a single branch until enabled.
+ * Only used from the shell's UI thread. Each completed trace adds one
+ * sample to a histogram per stage (time since the previous stage) and
+ * to the end-to-end histogram (SAMPLE to FLUSH).
+ *
+ * An invalidation is only credited to traces consumed and still being
+ * handled, i.e. before the next end_handling(). A trace that changed
+ * nothing by then is closed as having no visible change, so later clock
+ * ticks and animations are not attributed to it.
+ */
+class LatencyTracer {
+public:
+    static LatencyTracer& instance();
+
+    /**
+     * @brief Enable tracing
+     * @param trace_file If not empty, every completed trace is appended here
+     */
+    void enable(const std::string& trace_file = "");
+
+    bool is_enabled() const { return enabled_; }
+
+    /**
+     * @brief Start a trace for an event read from the input ring
+     */
+    void begin(const InputEvent& event, uint64_t now_us);
+
+    /**
+     * @brief The event is about to be handled; opens its handling window
+     */
+    void mark_consumed(uint32_t trace_id, uint64_t now_us);
+
+    /**
+     * @brief Drop a trace whose event will never be handled on its own
+     *
+     * E.g. a drag position replaced by a newer one before LVGL read it.
+     */
+    void cancel(uint32_t trace_id);
+
+    void mark_invalidated(uint64_t now_us);
+
+    /**
+     * @brief Close the handling windows, after the lv_timer_handler()
+     *        run that handled the consumed events
+     */
+    void end_handling();
+
+    void mark_flushed(uint64_t now_us);
+
+    /**
+     * @brief Log per-stage histograms and write them to the trace file
+     */
+    void dump();
+
+    /**
+     * @brief Drop open traces and clear the histograms; stays enabled
+     */
+    void reset();
+
+    /**
+     * @brief Traces closed with no visible change, or dropped as stale
+     */
+    uint64_t get_expired_count() const { return expired_; }
+
+    const LatencyHistogram& get_stage_histogram(TraceStage stage) const {
+        return stages_[static_cast<size_t>(stage)];
+    }
+    const LatencyHistogram& get_total_histogram() const { return total_; }
+
+private:
+    LatencyTracer();
+
+    struct Trace {
+        uint32_t id;
+        uint64_t stamps[static_cast<size_t>(TraceStage::COUNT)];
+        bool handling;  // Consumed, and its window is still open
+    };
+
+    void complete(const Trace& trace);
+    void expire(uint64_t now_us);
+
+    bool enabled_;
+    std::vector<Trace> open_;
+    LatencyHistogram stages_[static_cast<size_t>(TraceStage::COUNT)];
+    LatencyHistogram total_;
+    uint64_t expired_;
+    std::ofstream trace_file_;
+};
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_LATENCY_TRACER_HPP
@@ -0,0 +1,38 @@
+/**
+ * @file process.hpp
+ * @brief Starting external programs from processes that run an EventLoop
+ */
+
+#ifndef TOUCHDOWN_CORE_PROCESS_HPP
+#define TOUCHDOWN_CORE_PROCESS_HPP
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace touchdown {
+
+/**
+ * @brief Start a program with every signal unblocked and at its default
+ *
+ * The EventLoop blocks the signals it reads from its signalfd, and
+ * WorkerPool threads block all of them. A blocked mask survives fork()
+ * and exec, so a child started with plain fork()/exec or system() would
+ * never see SIGTERM. This uses posix_spawnp() with an empty mask instead.
+ *
+ * @param argv Program (looked up in PATH) and its arguments
+ * @return Child pid, or -1 if it could not be started
+ */
+pid_t spawn_process(const std::vector<std::string>& argv);
+
+/**
+ * @brief spawn_process() and wait for the child to exit
+ *
+ * Blocks; call it from a worker, not the loop thread.
+ * @return Exit status, or -1 if it could not be started or was killed
+ */
+int run_process(const std::vector<std::string>& argv);
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_PROCESS_HPP
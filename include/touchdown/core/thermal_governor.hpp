@@ -0,0 +1,96 @@
+/**
+ * @file thermal_governor.hpp
+ * @brief Thermal levels from zone temperatures
+ */
+
+#ifndef TOUCHDOWN_CORE_THERMAL_GOVERNOR_HPP
+#define TOUCHDOWN_CORE_THERMAL_GOVERNOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace touchdown {
+
+/**
+ * @brief How hard the system backs off to stay cool
+ *
+ * Each level adds to the one below. By default WARM drops visual
+ * effects; HOT also lowers the refresh rate, stops raising CPU clocks
+ * and caps apps; CRITICAL goes further on each. What a level does is
+ * configured per process; the levels themselves come from the power
+ * service.
+ */
+enum class ThermalLevel : uint8_t {
+    NORMAL,
+    WARM,
+    HOT,
+    CRITICAL
+};
+
+constexpr size_t THERMAL_LEVEL_COUNT = 4;
+
+/**
+ * @brief "normal", "warm", "hot" or "critical"
+ */
+const char* thermal_level_name(ThermalLevel level);
+
+/**
+ * @return false if name is not a level
+ */
+bool parse_thermal_level(const std::string& name, ThermalLevel& level);
+
+/**
+ * @brief Thresholds of ThermalGovernor, in millidegrees Celsius
+ *
+ * The defaults stay below 80 C, where the Raspberry Pi firmware starts
+ * capping the ARM clock: backing off in software first keeps the frame
+ * rate predictable instead of halving it unannounced.
+ */
+struct ThermalConfig {
+    int32_t warm_mc = 65000;
+    int32_t hot_mc = 72000;
+    int32_t critical_mc = 78000;
+    int32_t hysteresis_mc = 3000;  // How far below a threshold to drop back
+};
+
+/**
+ * @brief Maps temperature samples to a ThermalLevel with hysteresis
+ *
+ * Reaching a threshold raises the level at once, possibly by several
+ * steps. A level is only left once the temperature is hysteresis_mc
+ * below its threshold, so a sensor hovering at a threshold does not
+ * flip the UI back and forth. Pure logic with no clock or I/O, so
+ * temperature traces can be replayed through it.
+ */
+class ThermalGovernor {
+public:
+    explicit ThermalGovernor(const ThermalConfig& config = ThermalConfig());
+
+    void configure(const ThermalConfig& config);
+
+    /**
+     * @brief Account for one sample
+     * @return The level after it
+     */
+    ThermalLevel update(int32_t temp_mc);
+
+    /**
+     * @brief Back to NORMAL without a sample
+     */
+    void reset();
+
+    ThermalLevel get_level() const { return level_; }
+    uint64_t get_change_count() const { return changes_; }
+
+private:
+    int32_t threshold(ThermalLevel level) const;
+
+    ThermalConfig config_;
+    ThermalLevel level_;
+    uint64_t changes_;
+};
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_THERMAL_GOVERNOR_HPP
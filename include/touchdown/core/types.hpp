@@ -48,6 +48,7 @@ struct TouchPoint {
     int16_t y;
     TouchEventType type;
     uint32_t timestamp_ms;
+    uint64_t sample_us = 0;  // CLOCK_MONOTONIC time the kernel saw the input, 0 if unknown
 };
 
 /**
@@ -67,6 +68,7 @@ struct ButtonEvent {
     ButtonEventType type;
     uint32_t timestamp_ms;
     uint16_t duration_ms;
+    uint64_t sample_us = 0;  // CLOCK_MONOTONIC time the kernel saw the input, 0 if unknown
 };
 
 /**
@@ -0,0 +1,85 @@
+/**
+ * @file worker_pool.hpp
+ * @brief Threads for blocking work that must stay off the event loop
+ */
+
+#ifndef TOUCHDOWN_CORE_WORKER_POOL_HPP
+#define TOUCHDOWN_CORE_WORKER_POOL_HPP
+
+#include "touchdown/core/event_loop.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace touchdown {
+
+/**
+ * @brief Fixed set of threads running jobs for one EventLoop
+ *
+ * Jobs run in submission order; with a single thread they also complete
+ * in that order. Each job's completion callback is posted back to the
+ * loop, so only the job itself runs off the loop thread. The threads
+ * block every signal, leaving them to the loop's signalfd.
+ */
+class WorkerPool {
+public:
+    using Job = std::function<void()>;
+    using Done = std::function<void()>;
+
+    WorkerPool();
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Start the threads
+     */
+    bool init(EventLoop& loop, size_t threads = 1);
+
+    /**
+     * @brief Queue a job
+     * @param done Run on the loop thread once the job has returned
+     */
+    void submit(Job job, Done done = nullptr);
+
+    /**
+     * @brief Finish queued jobs and join the threads
+     *
+     * Completion callbacks of jobs that finish during shutdown are still
+     * posted, and run only if the loop runs again.
+     */
+    void shutdown();
+
+    /**
+     * @brief Jobs queued or running
+     */
+    size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        Job job;
+        Done done;
+    };
+
+    void worker();
+
+    EventLoop* loop_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Entry> queue_;
+    bool stopping_;
+
+    std::atomic<size_t> pending_;
+};
+
+} // namespace touchdown
+
+#endif // TOUCHDOWN_CORE_WORKER_POOL_HPP
@@ -0,0 +1,119 @@
+/**
+ * @file backlight.hpp
+ * @brief Backlight level and fades through sysfs
+ */
+
+#ifndef TOUCHDOWN_DRIVERS_BACKLIGHT_HPP
+#define TOUCHDOWN_DRIVERS_BACKLIGHT_HPP
+
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/drivers/sysfs_attribute.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace touchdown {
+namespace drivers {
+
+/**
+ * @brief A /sys/class/backlight device driven from an event loop
+ *
+ * Levels are 0-255 on a perceptual scale: each level maps to a raw
+ * brightness through the CIE 1931 lightness curve, so equal steps look
+ * equal and the low end is not a jump from off to dim. The brightness
+ * file stays open and the raw value last written is remembered, so only
+ * changes cost a syscall.
+ *
+ * Fades run from a timer at no more than the maximum write rate, moving
+ * linearly in level, without the UI drawing anything. Starting a fade
+ * or setting a level mid-fade continues from the current level.
+ *
+ * Without a device, levels are still tracked and fades finish at once.
+ */
+class Backlight {
+public:
+    static constexpr const char* DEFAULT_ROOT = "/sys/class/backlight";
+    static constexpr uint32_t DEFAULT_MAX_RATE_HZ = 60;
+
+    using LevelCallback = std::function<void(uint8_t level)>;
+
+    Backlight();
+    ~Backlight();
+
+    Backlight(const Backlight&) = delete;
+    Backlight& operator=(const Backlight&) = delete;
+
+    /**
+     * @brief Open the first device under root with a usable max_brightness
+     * @param root /sys/class/backlight, or a fake tree in tests
+     * @return false without a device
+     */
+    bool init(EventLoop& loop, const std::string& root = DEFAULT_ROOT);
+
+    /**
+     * @brief Upper bound on writes per second during a fade
+     */
+    void set_max_rate(uint32_t hz);
+
+    /**
+     * @brief Called whenever the level changes, including every fade step
+     */
+    void set_level_callback(LevelCallback callback) { level_callback_ = std::move(callback); }
+
+    /**
+     * @brief Jump to a level, cancelling any fade
+     */
+    void set_level(uint8_t level);
+
+    /**
+     * @brief Move to a level over duration_ms
+     * @param done Called once the level is reached; not if the fade is
+     *             replaced or cancelled first
+     */
+    void fade_to(uint8_t level, uint32_t duration_ms, std::function<void()> done = nullptr);
+
+    uint8_t get_level() const { return level_; }
+    bool is_fading() const { return fading_; }
+    bool is_available() const { return brightness_.is_open(); }
+
+    /**
+     * @brief Raw brightness a level maps to
+     */
+    uint32_t to_raw(uint8_t level) const { return curve_[level]; }
+
+    /**
+     * @brief Brightness writes actually issued since init()
+     */
+    uint64_t get_write_count() const { return writes_; }
+
+private:
+    void on_fade_timer();
+    void stop_fade();
+    void apply(uint8_t level);
+    void build_curve();
+
+    EventLoop* loop_;
+    SysfsAttribute brightness_;
+    uint32_t max_brightness_;
+    std::array<uint32_t, 256> curve_;
+    uint32_t written_;  // Raw value in the file
+    uint64_t writes_;
+    uint8_t level_;
+    LevelCallback level_callback_;
+
+    // Fade in progress
+    bool fading_;
+    uint8_t fade_from_;
+    uint8_t fade_to_;
+    uint64_t fade_start_us_;
+    uint64_t fade_duration_us_;
+    uint32_t interval_ms_;
+    std::function<void()> fade_done_;
+    EventLoop::TimerId fade_timer_;
+};
+
+} // namespace drivers
+} // namespace touchdown
+
+#endif // TOUCHDOWN_DRIVERS_BACKLIGHT_HPP
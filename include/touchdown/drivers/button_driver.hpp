@@ -8,12 +8,15 @@
 
 #include "touchdown/core/types.hpp"
 #include <memory>
+#include <string>
 #include <thread>
 #include <atomic>
 
 namespace touchdown {
 namespace drivers {
 
+struct InputDeviceInfo;
+
 class ButtonDriver {
 public:
     ButtonDriver();
@@ -21,11 +24,22 @@ public:
     
     /**
      * @brief Initialize button driver
+     *
+     * Succeeds even if the button device is not present yet; it is opened
+     * when it appears and reopened after being re-plugged.
+     *
      * @param gpio_pin GPIO pin number
      * @return true on success
      */
     bool init(int gpio_pin = 23);
     
+    /**
+     * @brief Only take the KEY_POWER device with this kernel name
+     *
+     * Call before init(). Empty (the default) takes the first one found.
+     */
+    void set_device_name(const std::string& name);
+    
     /**
      * @brief Clean up button resources
      */
@@ -44,19 +58,23 @@ public:
     
 private:
     void monitor_thread();
-    void process_button_event(bool pressed);
+    bool is_button(const InputDeviceInfo& info) const;
+    bool open_device(const InputDeviceInfo& info);
+    void close_device();
+    void read_events();
+    void process_button_event(bool pressed, uint64_t timestamp_us);
+    void on_double_press_timeout();
     
     class Impl;
     std::unique_ptr<Impl> impl_;
     ButtonCallback button_callback_;
     
     std::thread monitor_thread_;
-    std::atomic<bool> running_;
     
-    // Button state
+    // Button state (CLOCK_MONOTONIC timestamps from the input events)
     bool last_state_;
-    uint32_t press_start_time_;
-    uint32_t last_press_time_;
+    uint64_t press_start_us_;
+    uint64_t last_press_us_;
     bool waiting_for_double_;
     
     // Configuration
@@ -0,0 +1,128 @@
+/**
+ * @file cpu_hotplug.hpp
+ * @brief Parking secondary CPUs through sysfs hotplug
+ */
+
+#ifndef TOUCHDOWN_DRIVERS_CPU_HOTPLUG_HPP
+#define TOUCHDOWN_DRIVERS_CPU_HOTPLUG_HPP
+
+#include "touchdown/drivers/sysfs_attribute.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <sys/types.h>
+
+namespace touchdown {
+namespace drivers {
+
+/**
+ * @brief Outcome of one CpuHotplug::park() or unpark()
+ */
+struct HotplugResult {
+    size_t cpus = 0;           // CPUs switched
+    size_t failed = 0;         // CPUs whose write failed
+    uint64_t elapsed_us = 0;   // All writes, from the first to the last return
+    uint64_t slowest_us = 0;   // Longest single write
+    size_t rehomed = 0;        // Threads given their affinity back
+};
+
+/**
+ * @brief Takes chosen CPUs offline and brings them back
+ *
+ * park() writes 0 to cpuN/online for each configured CPU; unpark() writes
+ * 1, one thread per CPU so a slow bring-up does not delay the others.
+ * cpu0 usually has no online file and is never parked.
+ *
+ * Taking a CPU offline breaks the affinity of every thread that may only
+ * run on offline CPUs: the kernel moves it and widens its mask, and does
+ * not narrow it again when the CPU returns. park() records those threads
+ * first, and unpark() restores their masks once the CPUs are back.
+ *
+ * The root defaults to /sys/devices/system/cpu. Any other directory
+ * holding cpuN/online files is a dry run: the writes land in plain files.
+ * is_dry_run() holds only if none of the opened files is on sysfs.
+ *
+ * Not thread-safe; use it from one thread at a time.
+ */
+class CpuHotplug {
+public:
+    static constexpr const char* DEFAULT_ROOT = "/sys/devices/system/cpu";
+
+    CpuHotplug();
+    ~CpuHotplug();
+
+    CpuHotplug(const CpuHotplug&) = delete;
+    CpuHotplug& operator=(const CpuHotplug&) = delete;
+
+    /**
+     * @brief CPUs that park() takes offline; call before init()
+     */
+    void set_cpus(const std::vector<unsigned>& cpus) { requested_ = cpus; }
+
+    /**
+     * @brief Bring CPUs back one after another instead of in parallel
+     */
+    void set_parallel(bool parallel) { parallel_ = parallel; }
+
+    /**
+     * @brief Open cpuN/online of every configured CPU
+     * @param root /sys/devices/system/cpu, or a fake tree
+     * @return false if none of them can be switched
+     */
+    bool init(const std::string& root = DEFAULT_ROOT);
+
+    /**
+     * @brief Take the configured CPUs offline
+     * @return false if any write failed
+     */
+    bool park(HotplugResult& result);
+
+    /**
+     * @brief Bring every configured CPU that is offline back online
+     *
+     * Also brings back CPUs found offline by init(), e.g. left parked
+     * by a previous run.
+     * @return false if any write failed
+     */
+    bool unpark(HotplugResult& result);
+
+    bool is_available() const { return !cpus_.empty(); }
+    bool is_dry_run() const { return dry_run_; }
+    size_t get_cpu_count() const { return cpus_.size(); }
+
+    /**
+     * @brief Whether the given CPU is one that park() takes offline
+     */
+    bool is_parkable(unsigned cpu) const;
+
+private:
+    struct Cpu {
+        unsigned id = 0;
+        SysfsAttribute file;
+        bool online = true;
+        uint64_t write_us = 0;  // Duration of the last write
+        bool write_ok = false;
+    };
+
+    struct PinnedThread {
+        pid_t tid;
+        cpu_set_t mask;
+    };
+
+    bool write_online(Cpu& cpu, bool online);
+    void save_pinned_threads();
+    size_t restore_pinned_threads();
+
+    std::vector<unsigned> requested_;
+    std::vector<Cpu> cpus_;
+    std::vector<PinnedThread> pinned_;
+    bool parallel_;
+    bool dry_run_;
+};
+
+} // namespace drivers
+} // namespace touchdown
+
+#endif // TOUCHDOWN_DRIVERS_CPU_HOTPLUG_HPP
@@ -0,0 +1,121 @@
+/**
+ * @file cpufreq.hpp
+ * @brief cpufreq policy control through sysfs
+ */
+
+#ifndef TOUCHDOWN_DRIVERS_CPUFREQ_HPP
+#define TOUCHDOWN_DRIVERS_CPUFREQ_HPP
+
+#include "touchdown/drivers/sysfs_attribute.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace touchdown {
+namespace drivers {
+
+/**
+ * @brief What to apply to every cpufreq policy
+ *
+ * An empty governor is left as it is; a zero limit means the value the
+ * policy had when it was found. Frequencies are clamped to each policy's
+ * cpuinfo range.
+ */
+struct CpufreqSettings {
+    std::string governor;
+    uint32_t min_khz = 0;
+    uint32_t max_khz = 0;
+};
+
+/**
+ * @brief Governor and frequency limits of all cpufreq policies
+ *
+ * Policies are discovered once as root/policy*, and their attribute files
+ * stay open. The manager remembers what each file holds, so apply() only
+ * writes values that differ. Switching governors restarts kernel threads,
+ * and even a no-op write costs a syscall.
+ *
+ * Not thread-safe; use it from one thread at a time.
+ */
+class CpufreqManager {
+public:
+    static constexpr const char* DEFAULT_ROOT = "/sys/devices/system/cpu/cpufreq";
+
+    CpufreqManager();
+    ~CpufreqManager();
+
+    CpufreqManager(const CpufreqManager&) = delete;
+    CpufreqManager& operator=(const CpufreqManager&) = delete;
+
+    /**
+     * @brief Discover policies and open their attributes
+     * @param root Directory holding policy*, a fake tree in tests
+     * @return false if no policy could be opened
+     */
+    bool init(const std::string& root = DEFAULT_ROOT);
+
+    /**
+     * @brief Close all attribute files
+     */
+    void close();
+
+    /**
+     * @brief Bring every policy to the given settings
+     * @return false if any write failed
+     */
+    bool apply(const CpufreqSettings& settings);
+
+    /**
+     * @brief Temporarily raise scaling_min_freq of every policy
+     *
+     * The floor is applied on top of the configured minimum and capped by
+     * the configured maximum; 0 removes it and restores the minimum.
+     * @return false if any write failed
+     */
+    bool set_floor(uint32_t khz);
+
+    /**
+     * @brief Number of policies found by init()
+     */
+    size_t get_policy_count() const { return policies_.size(); }
+
+    /**
+     * @brief sysfs writes actually issued since init()
+     */
+    uint64_t get_write_count() const { return writes_; }
+
+private:
+    struct Attribute {
+        SysfsAttribute file;
+        std::string value;  // Last read or written
+    };
+
+    struct Policy {
+        std::string name;
+        Attribute governor;
+        Attribute min_khz;
+        Attribute max_khz;
+        uint32_t initial_min_khz = 0;  // As found by init()
+        uint32_t initial_max_khz = 0;
+        uint32_t base_min_khz = 0;  // From the last settings applied
+        uint32_t base_max_khz = 0;
+        uint32_t cpuinfo_min_khz = 0;
+        uint32_t cpuinfo_max_khz = 0;
+        std::vector<std::string> governors;  // Empty if the list is unreadable
+    };
+
+    bool open_attribute(const std::string& path, Attribute& attribute);
+    bool write_attribute(Policy& policy, Attribute& attribute, const std::string& value);
+    bool write_limits(Policy& policy);
+    static uint32_t clamp(const Policy& policy, uint32_t khz);
+
+    std::vector<Policy> policies_;
+    uint32_t floor_khz_;
+    uint64_t writes_;
+};
+
+} // namespace drivers
+} // namespace touchdown
+
+#endif // TOUCHDOWN_DRIVERS_CPUFREQ_HPP
@@ -36,11 +36,6 @@ public:
      */
     lv_display_t* get_display() { return display_; }
     
-    /**
-     * @brief Set display brightness (0-255)
-     */
-    void set_brightness(uint8_t brightness);
-    
     /**
      * @brief Turn display on/off
      */
@@ -51,9 +46,16 @@ public:
      */
     bool is_point_safe(int16_t x, int16_t y);
     
+    /**
+     * @brief Frames handed to the display since init()
+     */
+    uint64_t get_frame_count() const;
+    
 private:
     static void flush_cb(lv_display_t* disp, const lv_area_t* area, unsigned char* color_p);
+    static void invalidate_cb(lv_event_t* e);
     void flush_display(const lv_area_t* area, unsigned char* color_p);
+    void commit_frame();
     
     class Impl;
     std::unique_ptr<Impl> impl_;
@@ -0,0 +1,69 @@
+/**
+ * @file i2c_bus.hpp
+ * @brief Register-level I2C bus access used by the touch driver
+ */
+
+#ifndef TOUCHDOWN_DRIVERS_I2C_BUS_HPP
+#define TOUCHDOWN_DRIVERS_I2C_BUS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace touchdown {
+namespace drivers {
+
+/**
+ * @brief Register access to a single I2C slave
+ *
+ * Drivers talk to their controller through this interface so the
+ * transport can be replaced (e.g. by a recording fake) without touching
+ * the register logic.
+ */
+class I2CBus {
+public:
+    virtual ~I2CBus() = default;
+
+    /**
+     * @brief Write a single 8-bit register
+     */
+    virtual bool write_register(uint8_t reg, uint8_t value) = 0;
+
+    /**
+     * @brief Read consecutive registers starting at reg
+     */
+    virtual bool read_registers(uint8_t reg, uint8_t* buf, size_t len) = 0;
+};
+
+/**
+ * @brief I2C bus backed by a Linux i2c-dev character device
+ */
+class LinuxI2CBus : public I2CBus {
+public:
+    LinuxI2CBus();
+    ~LinuxI2CBus() override;
+
+    /**
+     * @brief Open the adapter and bind the slave address
+     * @param device I2C device path (e.g., "/dev/i2c-1")
+     * @param address 7-bit slave address
+     * @return true on success
+     */
+    bool open(const std::string& device, uint8_t address);
+
+    /**
+     * @brief Close the adapter
+     */
+    void close();
+
+    bool write_register(uint8_t reg, uint8_t value) override;
+    bool read_registers(uint8_t reg, uint8_t* buf, size_t len) override;
+
+private:
+    int fd_;
+};
+
+} // namespace drivers
+} // namespace touchdown
+
+#endif // TOUCHDOWN_DRIVERS_I2C_BUS_HPP
@@ -0,0 +1,86 @@
+/**
+ * @file input_device_monitor.hpp
+ * @brief evdev device discovery with hotplug notifications
+ */
+
+#ifndef TOUCHDOWN_DRIVERS_INPUT_DEVICE_MONITOR_HPP
+#define TOUCHDOWN_DRIVERS_INPUT_DEVICE_MONITOR_HPP
+
+#include "touchdown/core/event_loop.hpp"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace touchdown {
+namespace drivers {
+
+/**
+ * @brief Cached description of an evdev node, read from sysfs
+ */
+struct InputDeviceInfo {
+    std::string node;                 // e.g. "/dev/input/event2"
+    std::string name;                 // Device name as reported by the kernel
+    std::vector<uint64_t> key_bits;   // EV_KEY capability bitmap
+
+    bool has_key(unsigned int code) const;
+};
+
+/**
+ * @brief Enumerates input devices once and tracks add/remove
+ *
+ * Capabilities are read from /sys/class/input without opening any device
+ * node. Afterwards an inotify watch on /dev/input keeps the cache current,
+ * so devices that appear late or are re-plugged are reported through the
+ * callbacks on the owning event loop.
+ */
+class InputDeviceMonitor {
+public:
+    using DeviceCallback = std::function<void(const InputDeviceInfo&)>;
+
+    InputDeviceMonitor();
+    ~InputDeviceMonitor();
+
+    /**
+     * @brief Enumerate devices and start watching for hotplug
+     */
+    bool init(EventLoop& loop);
+
+    /**
+     * @brief Stop watching and drop the cache
+     */
+    void deinit();
+
+    /**
+     * @brief Find the first cached device with the given key capability
+     */
+    const InputDeviceInfo* find_by_key(unsigned int code) const;
+
+    /**
+     * @brief Get all cached devices
+     */
+    std::vector<InputDeviceInfo> get_devices() const;
+
+    void set_device_added_callback(DeviceCallback callback);
+    void set_device_removed_callback(DeviceCallback callback);
+
+private:
+    void enumerate();
+    bool probe(const std::string& event_name, InputDeviceInfo& info) const;
+    void handle_inotify();
+    void on_node_added(const std::string& event_name);
+    void on_node_removed(const std::string& event_name);
+
+    EventLoop* loop_;
+    int inotify_fd_;
+
+    std::map<std::string, InputDeviceInfo> devices_;  // Keyed by "eventN"
+    DeviceCallback added_callback_;
+    DeviceCallback removed_callback_;
+};
+
+} // namespace drivers
+} // namespace touchdown
+
+#endif // TOUCHDOWN_DRIVERS_INPUT_DEVICE_MONITOR_HPP
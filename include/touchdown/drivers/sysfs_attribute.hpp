@@ -0,0 +1,82 @@
+/**
+ * @file sysfs_attribute.hpp
+ * @brief An open sysfs attribute file, or its stand-in in a fake tree
+ */
+
+#ifndef TOUCHDOWN_DRIVERS_SYSFS_ATTRIBUTE_HPP
+#define TOUCHDOWN_DRIVERS_SYSFS_ATTRIBUTE_HPP
+
+#include <string>
+
+namespace touchdown {
+namespace drivers {
+
+/**
+ * @brief A sysfs attribute kept open for repeated reads and writes
+ *
+ * Reads and writes go to offset 0, as sysfs expects. The drivers take
+ * their sysfs root as a parameter, so checks can point them at a
+ * directory of plain files instead. open() notes whether the file is on
+ * sysfs; a plain file is truncated after each write, so it holds only
+ * the last value as the attribute would.
+ *
+ * Movable, not copyable; the file is closed on destruction.
+ */
+class SysfsAttribute {
+public:
+    SysfsAttribute();
+    ~SysfsAttribute();
+
+    SysfsAttribute(SysfsAttribute&& other) noexcept;
+    SysfsAttribute& operator=(SysfsAttribute&& other) noexcept;
+
+    SysfsAttribute(const SysfsAttribute&) = delete;
+    SysfsAttribute& operator=(const SysfsAttribute&) = delete;
+
+    /**
+     * @brief Open the file, closing any previous one
+     * @param flags O_RDONLY, O_WRONLY or O_RDWR; O_CLOEXEC is added
+     * @return false with errno set if it cannot be opened
+     */
+    bool open(const std::string& path, int flags);
+
+    void close();
+
+    bool is_open() const { return fd_ >= 0; }
+
+    /**
+     * @brief Whether the file is a plain file rather than on sysfs
+     */
+    bool is_fake() const { return fake_; }
+
+    /**
+     * @brief Contents without trailing spaces and newlines
+     * @return false if the read failed; value is then empty
+     */
+    bool read(std::string& value) const;
+
+    /**
+     * @brief Write the whole value in one call
+     * @return false with errno set on a failed or short write
+     */
+    bool write(const std::string& value);
+
+    /**
+     * @brief Open, read and close a file
+     */
+    static bool read_file(const std::string& path, std::string& value);
+
+    /**
+     * @brief Open, write and close a file
+     */
+    static bool write_file(const std::string& path, const std::string& value);
+
+private:
+    int fd_;
+    bool fake_;
+};
+
+} // namespace drivers
+} // namespace touchdown
+
+#endif // TOUCHDOWN_DRIVERS_SYSFS_ATTRIBUTE_HPP
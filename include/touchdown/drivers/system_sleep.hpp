@@ -0,0 +1,86 @@
+/**
+ * @file system_sleep.hpp
+ * @brief System suspend through /sys/power
+ */
+
+#ifndef TOUCHDOWN_DRIVERS_SYSTEM_SLEEP_HPP
+#define TOUCHDOWN_DRIVERS_SYSTEM_SLEEP_HPP
+
+#include "touchdown/drivers/sysfs_attribute.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace touchdown {
+namespace drivers {
+
+/**
+ * @brief Outcome of one SystemSleep::suspend()
+ */
+struct SleepResult {
+    bool ok = false;          // The kernel suspended and resumed
+    uint64_t resumed_us = 0;  // CLOCK_MONOTONIC when the write returned
+    uint64_t slept_us = 0;    // Time spent suspended (CLOCK_BOOTTIME only)
+};
+
+/**
+ * @brief Suspends the system until a wake source fires
+ *
+ * suspend() writes the configured state ("freeze" for s2idle, or "mem")
+ * to power/state, which returns only after resume, so call it from a
+ * worker thread. Before that, the given devices have power/wakeup
+ * enabled, and the wakeup_count handshake makes the kernel refuse to
+ * suspend if a wake event arrived since it was read. The devices'
+ * previous wakeup settings are restored after resume.
+ *
+ * The root defaults to /sys. Any other directory holding the same files
+ * is a dry run: the writes land in plain files and return at once.
+ */
+class SystemSleep {
+public:
+    static constexpr const char* DEFAULT_ROOT = "/sys";
+
+    SystemSleep();
+    ~SystemSleep();
+
+    SystemSleep(const SystemSleep&) = delete;
+    SystemSleep& operator=(const SystemSleep&) = delete;
+
+    /**
+     * @brief Check that the state is supported and open power/state
+     * @param root sysfs mount point, or a fake tree
+     * @param state Written to power/state: "freeze" or "mem"
+     */
+    bool init(const std::string& root = DEFAULT_ROOT, const std::string& state = "freeze");
+
+    /**
+     * @brief Devices allowed to wake the system
+     * @param devices Device directories relative to the root, e.g.
+     *                "bus/i2c/devices/1-0015"; each needs power/wakeup
+     */
+    void set_wakeup_devices(const std::vector<std::string>& devices);
+
+    /**
+     * @brief Suspend; blocks until the system has resumed
+     * @return result.ok
+     */
+    bool suspend(SleepResult& result);
+
+    bool is_available() const { return state_file_.is_open(); }
+    bool is_dry_run() const { return state_file_.is_fake(); }
+
+private:
+    bool enable_wakeups(std::vector<std::string>& previous);
+    void restore_wakeups(const std::vector<std::string>& previous);
+    bool claim_wakeup_count();
+
+    std::string root_;
+    std::string state_;
+    std::vector<std::string> wakeup_devices_;
+    SysfsAttribute state_file_;
+};
+
+} // namespace drivers
+} // namespace touchdown
+
+#endif // TOUCHDOWN_DRIVERS_SYSTEM_SLEEP_HPP
@@ -0,0 +1,65 @@
+/**
+ * @file thermal_zones.hpp
+ * @brief Temperature of sysfs thermal zones
+ */
+
+#ifndef TOUCHDOWN_DRIVERS_THERMAL_ZONES_HPP
+#define TOUCHDOWN_DRIVERS_THERMAL_ZONES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace touchdown {
+namespace drivers {
+
+/**
+ * @brief The hottest of a set of thermal zones
+ *
+ * Zones are discovered once as root/thermal_zone*, optionally only those
+ * whose type is listed, and their temp files stay open. Reading a zone
+ * may make the driver sample the sensor, so poll from a worker.
+ *
+ * Not thread-safe; use it from one thread at a time.
+ */
+class ThermalZones {
+public:
+    static constexpr const char* DEFAULT_ROOT = "/sys/class/thermal";
+
+    ThermalZones();
+    ~ThermalZones();
+
+    ThermalZones(const ThermalZones&) = delete;
+    ThermalZones& operator=(const ThermalZones&) = delete;
+
+    /**
+     * @brief Discover zones and open their temp files
+     * @param root /sys/class/thermal, or a fake tree
+     * @param types Zone types to watch (e.g. cpu-thermal); empty for all
+     * @return false if no zone could be opened
+     */
+    bool init(const std::string& root = DEFAULT_ROOT,
+              const std::vector<std::string>& types = std::vector<std::string>());
+
+    /**
+     * @brief Highest temperature of all zones, in millidegrees Celsius
+     * @return false if no zone could be read
+     */
+    bool read(int32_t& temp_mc);
+
+    size_t get_zone_count() const { return zones_.size(); }
+
+private:
+    struct Zone {
+        std::string name;
+        int fd = -1;
+    };
+
+    std::vector<Zone> zones_;
+};
+
+} // namespace drivers
+} // namespace touchdown
+
+#endif // TOUCHDOWN_DRIVERS_THERMAL_ZONES_HPP
@@ -10,10 +10,23 @@
 #include "lvgl.h"
 #include <memory>
 #include <functional>
+#include <string>
 
 namespace touchdown {
 namespace drivers {
 
+class I2CBus;
+
+/**
+ * @brief CST816S power modes
+ */
+enum class TouchPowerMode {
+    ACTIVE,          // Full-rate scanning, auto-sleep disabled
+    AUTO_SLEEP,      // Controller drops to low-power scan after the auto-sleep timeout
+    WAKE_ON_TOUCH,   // Low-power scan, IRQ on touch only, host polling stopped
+    STANDBY          // Deep sleep, leaving it requires a controller reset
+};
+
 class TouchDriver {
 public:
     TouchDriver();
@@ -24,19 +37,56 @@ public:
      * @param device I2C device path (e.g., "/dev/i2c-1")
      * @param address I2C address (default: 0x15)
      * @return true on success
+     *
+     * Only programs the controller; call create_input_device() to have
+     * LVGL poll it, or drive sampling with poll()/handle_irq().
      */
     bool init(const std::string& device = "/dev/i2c-1", uint8_t address = 0x15);
     
+    /**
+     * @brief Initialize controller on an already opened bus
+     */
+    bool init(std::unique_ptr<I2CBus> bus);
+    
     /**
      * @brief Clean up touch resources
      */
     void deinit();
     
+    /**
+     * @brief Create an LVGL pointer device that samples the controller
+     */
+    bool create_input_device();
+    
     /**
      * @brief Get LVGL input device
      */
     lv_indev_t* get_input_device() { return indev_; }
     
+    /**
+     * @brief Request the controller's interrupt line for edge events
+     * @param chip GPIO chip path (e.g., "/dev/gpiochip0")
+     * @param line Line offset on the chip
+     */
+    bool enable_irq(const std::string& chip, uint32_t line);
+    
+    /**
+     * @brief fd that becomes readable on a touch interrupt, -1 if none
+     */
+    int get_irq_fd() const;
+    
+    /**
+     * @brief Acknowledge pending interrupts and sample the controller
+     * @return true while a touch is held
+     */
+    bool handle_irq();
+    
+    /**
+     * @brief Sample the controller once, emitting touch callbacks
+     * @return true while a touch is held
+     */
+    bool poll();
+    
     /**
      * @brief Register callback for touch events
      */
@@ -47,13 +97,44 @@ public:
      */
     void set_sensitivity(uint8_t sensitivity);
     
+    /**
+     * @brief Switch the controller power mode
+     * @return true if all register writes succeeded
+     */
+    bool set_power_mode(TouchPowerMode mode);
+    
+    /**
+     * @brief Get current controller power mode
+     */
+    TouchPowerMode get_power_mode() const { return power_mode_; }
+    
+    /**
+     * @brief Set idle time before the controller auto-sleeps (1-255 s)
+     * @return false if the controller is auto-sleeping and the write failed;
+     *         the value is kept, and the next set_power_mode(AUTO_SLEEP)
+     *         writes it again
+     */
+    bool set_auto_sleep_timeout_s(uint8_t seconds);
+    
+    /**
+     * @brief Configure the reset line used to leave STANDBY
+     * @param chip GPIO chip path (e.g., "/dev/gpiochip0")
+     * @param line Line offset on the chip
+     */
+    void set_reset_gpio(const std::string& chip, uint32_t line);
+    
 private:
     static void read_cb(lv_indev_t* indev, lv_indev_data_t* data);
     void read_touch(lv_indev_data_t* data);
+    bool sample();
     
     // Gesture detection
     void detect_gestures(const TouchPoint& point);
     
+    // Power management
+    bool write_power_registers(TouchPowerMode mode);
+    bool reset_controller();
+    
     class Impl;
     std::unique_ptr<Impl> impl_;
     lv_indev_t* indev_;
@@ -64,6 +145,11 @@ private:
     TouchPoint last_point_;
     bool touch_active_;
     uint32_t press_start_time_;
+    
+    // Power state; not programmed until a switch has written the registers
+    TouchPowerMode power_mode_;
+    bool power_mode_programmed_;
+    uint8_t auto_sleep_timeout_s_;
 };
 
 } // namespace drivers
@@ -40,6 +40,15 @@ public:
      */
     bool init();
     
+    /**
+     * @brief systemd slice that Python apps are started in
+     *
+     * Each app gets a transient scope in it, so the slice's CPUQuota
+     * applies. Empty starts them as plain children of the shell.
+     * C++ apps run inside the shell and are never in the slice.
+     */
+    void set_app_slice(const std::string& slice) { app_slice_ = slice; }
+    
     /**
      * @brief Launch an app by ID
      * @param app_id App identifier
@@ -58,6 +67,16 @@ public:
      */
     bool resume_app(const std::string& app_id);
     
+    /**
+     * @brief Pause every running app, e.g. while the screen is off
+     */
+    void pause_all();
+    
+    /**
+     * @brief Resume the apps paused by pause_all()
+     */
+    void resume_all();
+    
     /**
      * @brief Terminate an app
      */
@@ -117,6 +136,8 @@ private:
     
     std::map<std::string, ManagedApp> apps_;
     std::string active_app_id_;
+    std::vector<std::string> parked_apps_;  // Paused by pause_all()
+    std::string app_slice_;
     app::AppRegistry& registry_;
 };
 
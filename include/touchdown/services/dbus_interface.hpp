@@ -6,78 +6,293 @@
 #ifndef TOUCHDOWN_SERVICES_DBUS_INTERFACE_HPP
 #define TOUCHDOWN_SERVICES_DBUS_INTERFACE_HPP
 
-#include <dbus/dbus.h>
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/services/dbus_message.hpp"
 #include <string>
+#include <map>
 #include <memory>
 #include <functional>
-#include <map>
 
 namespace touchdown {
 namespace services {
 
+/**
+ * @brief Method of an interface description
+ */
+struct MethodInfo {
+    const char* name;
+    const char* signature;  // Arguments
+    const char* result;     // Reply
+};
+
+/**
+ * @brief Read-only property of an interface description
+ */
+struct PropertyInfo {
+    const char* name;
+    const char* signature;
+};
+
+/**
+ * @brief Static description of an interface, emitted by td-dbus-codegen
+ */
+struct InterfaceInfo {
+    const char* name;
+    const MethodInfo* methods;
+    size_t method_count;
+    int (*lookup)(const char* member);  // Index into methods, -1 if unknown
+    const PropertyInfo* properties;
+    size_t property_count;              // At most 64
+    const char* introspection;          // <interface> element
+};
+
+class DBusInterface;
+
+/**
+ * @brief Reply to a method call, sent after its handler has returned
+ *
+ * Obtained from DBusInterface::defer_reply() while handling the call, for
+ * work that would otherwise block the event loop. Copies share the call
+ * and the first send() answers it; if the last copy goes away unsent the
+ * caller gets org.freedesktop.DBus.Error.Failed rather than a timeout.
+ * Loop thread only; once the DBusInterface is gone, sending does nothing.
+ */
+class DeferredReply {
+public:
+    DeferredReply() = default;
+
+    explicit operator bool() const { return state_ != nullptr; }
+
+    /**
+     * @brief Create the reply for the caller to fill in
+     */
+    Message new_method_return() const;
+
+    /**
+     * @brief Answer the call; an empty Message is sent as Failed
+     */
+    void send(Message reply);
+
+    /**
+     * @brief Answer the call with an error
+     */
+    void send_error(const char* name, const char* text);
+
+private:
+    friend class DBusInterface;
+    struct State;
+
+    explicit DeferredReply(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief Handling time of one exported method
+ */
+struct MethodStats {
+    uint64_t calls = 0;
+    uint64_t total_us = 0;     // Call received until reply sent
+    uint64_t max_us = 0;
+    uint64_t loop_us = 0;      // Spent in the handler, blocking the loop
+    uint64_t loop_max_us = 0;
+    uint64_t deferred = 0;     // Calls answered through a DeferredReply
+};
+
+/**
+ * @brief Bus connection, exported object and name owned by a service
+ *
+ * Built against sd-bus or libdbus (TOUCHDOWN_DBUS_BACKEND); services only
+ * see this class and Message, so they are identical on both.
+ */
 class DBusInterface {
 public:
     DBusInterface(const std::string& service_name, const std::string& object_path);
     virtual ~DBusInterface();
-    
+
     /**
-     * @brief Initialize D-Bus connection
+     * @brief Initialize D-Bus connection and attach it to the event loop
+     *
+     * The connection's sockets and timeouts are registered with the loop,
+     * so messages are read, written and dispatched as soon as the socket
+     * is ready.
      */
-    bool init();
-    
+    bool init(EventLoop& loop);
+
     /**
-     * @brief Process D-Bus messages (call in main loop)
+     * @brief Send signal
      */
-    void process();
-    
+    void send_signal(const std::string& interface, const std::string& name,
+                     const std::string& arg = "");
+
     /**
-     * @brief Send signal
+     * @brief Call a method on another service without waiting for a reply
      */
-    void send_signal(const std::string& interface, const std::string& name, 
+    void call_method(const std::string& destination, const std::string& path,
+                     const std::string& interface, const std::string& method,
                      const std::string& arg = "");
-    
+
     /**
      * @brief Notify systemd of readiness
      */
     void notify_ready();
-    
+
     /**
      * @brief Send watchdog keepalive
      */
     void send_watchdog();
-    
+
+    /**
+     * @brief Ping the systemd watchdog from the loop at half its timeout
+     *
+     * Uses WATCHDOG_USEC from the unit's WatchdogSec. Without one (run by
+     * hand, or in a benchmark) no timer is created at all.
+     * @return Ping interval in milliseconds, or 0 if the watchdog is off
+     */
+    uint32_t start_watchdog();
+
+    /**
+     * @brief Name of the backend this library was built with
+     */
+    static const char* get_backend_name();
+
+    using SignalHandler = std::function<void(Message&)>;
+    using ReplyHandler = std::function<void(Message&)>;
+
+    /**
+     * @brief Subscribe to a signal from any sender
+     *
+     * The match rule is queued without waiting for the bus to confirm it.
+     */
+    void register_signal_handler(const std::string& interface, const std::string& name,
+                                 SignalHandler handler);
+
+    /**
+     * @brief Create a method call for the caller to fill in
+     */
+    Message new_method_call(const std::string& destination, const std::string& path,
+                            const std::string& interface, const std::string& method);
+
+    /**
+     * @brief Send a method call and handle the reply on the event loop
+     *
+     * The handler receives the reply, an error message, or an empty
+     * Message if the call could not be sent. A null handler sends the
+     * call with NO_REPLY_EXPECTED set.
+     */
+    bool call_method_async(Message msg, ReplyHandler handler, int timeout_ms = -1);
+
+    /**
+     * @brief Handling time per exported method, keyed by member name
+     */
+    const std::map<std::string, MethodStats>& get_method_stats() const { return method_stats_; }
+
+    /**
+     * @brief Log get_method_stats(), one line per method
+     */
+    void log_method_stats() const;
+
 protected:
-    using MethodHandler = std::function<DBusMessage*(DBusMessage*)>;
-    
+    using MethodHandler = std::function<Message(Message&)>;
+    using InterfaceDispatcher = std::function<Message(int method, Message&)>;
+    using PropertyGetter = std::function<bool(int property, Message& msg)>;
+
+    // Minimum spacing of PropertiesChanged signals per interface
+    static constexpr uint32_t PROPERTIES_CHANGED_INTERVAL_MS = 100;
+
+    // Handlers holding the loop longer than this are logged as they happen
+    static constexpr uint32_t SLOW_METHOD_MS = 20;
+
     /**
      * @brief Register a method handler
+     * @param signature Argument signature, calls with any other are rejected
+     * @param result Reply signature, used for introspection
+     *
+     * The handler returns the reply (or an error); an empty Message is
+     * answered with org.freedesktop.DBus.Error.Failed.
+     */
+    void register_method(const std::string& interface, const std::string& method,
+                         const std::string& signature, const std::string& result,
+                         MethodHandler handler);
+
+    /**
+     * @brief Export a generated interface
+     *
+     * Calls are resolved with the interface's lookup function and passed
+     * to the dispatcher with the method's index in info.methods. The
+     * interface also appears in Introspect replies. Its properties are
+     * served through org.freedesktop.DBus.Properties, with the getter
+     * appending the current value of info.properties[property].
+     */
+    void register_interface(const InterfaceInfo& info, InterfaceDispatcher dispatcher,
+                            PropertyGetter getter = nullptr);
+
+    /**
+     * @brief Announce that a property of an exported interface changed
+     *
+     * Changes are coalesced into one PropertiesChanged per interface,
+     * carrying the values current when it is sent: at the end of this
+     * loop iteration, or PROPERTIES_CHANGED_INTERVAL_MS after the
+     * previous signal if that is later.
+     */
+    void notify_property_changed(const InterfaceInfo& info, int property);
+
+    /**
+     * @brief Answer the call being handled later
+     *
+     * Only valid inside a method handler, for the call it was given. The
+     * handler's return value is then ignored and nothing is sent until
+     * the returned DeferredReply is.
      */
-    void register_method(const std::string& interface, const std::string& method, 
-                        MethodHandler handler);
-    
+    DeferredReply defer_reply(Message& call);
+
     /**
-     * @brief Handle incoming method calls
+     * @brief Create a signal on this object for the caller to fill in
      */
-    virtual DBusMessage* handle_message(DBusMessage* msg);
-    
+    Message new_signal(const std::string& interface, const std::string& name);
+
+    /**
+     * @brief Queue a message for sending
+     *
+     * As much as the socket accepts is written right away; anything left
+     * is written from the loop once the socket becomes writable.
+     */
+    void send_message(Message msg);
+
     std::string service_name_;
     std::string object_path_;
-    DBusConnection* connection_;
-    
+    EventLoop* loop_;
+
 private:
-    struct MethodKey {
-        std::string interface;
-        std::string method;
-        
-        bool operator<(const MethodKey& other) const {
-            return std::tie(interface, method) < std::tie(other.interface, other.method);
-        }
+    friend class DeferredReply;
+
+    // Around each method handler, from the backends: end_method() records
+    // the call and returns true if the handler deferred its reply
+    void begin_method();
+    bool end_method(const char* member);
+    void record_method(const std::string& member, uint64_t total_us, uint64_t loop_us, bool deferred);
+
+    struct PendingProperties {
+        uint64_t changed = 0;  // Bit per property
+        uint64_t last_emit_us = 0;
+        bool scheduled = false;
+        EventLoop::TimerId timer = EventLoop::INVALID_TIMER;
     };
-    
-    std::map<MethodKey, MethodHandler> method_handlers_;
-    
-    static DBusHandlerResult message_handler(DBusConnection* connection, 
-                                            DBusMessage* message, void* user_data);
+
+    void flush_properties(const InterfaceInfo& info);
+    void emit_properties_changed(const InterfaceInfo& info, uint64_t changed);
+    void release_timers();
+
+    std::map<const InterfaceInfo*, PendingProperties> pending_properties_;
+    EventLoop::TimerId watchdog_timer_ = EventLoop::INVALID_TIMER;
+
+    uint64_t method_start_us_ = 0;
+    std::shared_ptr<DeferredReply::State> deferring_;  // Deferred by the running handler
+    std::shared_ptr<int> alive_ = std::make_shared<int>(0);  // Outstanding replies check this
+    std::map<std::string, MethodStats> method_stats_;
+
+    class Impl;
+    std::unique_ptr<Impl> impl_;
 };
 
 } // namespace services
@@ -0,0 +1,147 @@
+/**
+ * @file dbus_message.hpp
+ * @brief D-Bus message handle shared by both bus backends
+ */
+
+#ifndef TOUCHDOWN_SERVICES_DBUS_MESSAGE_HPP
+#define TOUCHDOWN_SERVICES_DBUS_MESSAGE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace touchdown {
+namespace services {
+
+/**
+ * @brief Reference to a D-Bus message
+ *
+ * Wraps a libdbus or sd-bus message depending on the backend the library
+ * was built with, so services never touch either API directly. Arguments
+ * are read and appended in order; containers are entered or opened with
+ * their D-Bus type code ('a', 'r', 'v', 'e') and contents signature.
+ */
+class Message {
+public:
+    enum class Type {
+        INVALID,
+        METHOD_CALL,
+        METHOD_RETURN,
+        ERROR,
+        SIGNAL
+    };
+
+    Message();
+    ~Message();
+
+    Message(Message&& other) noexcept;
+    Message& operator=(Message&& other) noexcept;
+    Message(const Message&) = delete;
+    Message& operator=(const Message&) = delete;
+
+    explicit operator bool() const { return raw_ != nullptr; }
+
+    Type get_type() const;
+    bool is_error() const { return get_type() == Type::ERROR; }
+
+    const char* get_sender() const;
+    const char* get_path() const;
+    const char* get_interface() const;
+    const char* get_member() const;
+    const char* get_signature() const;
+    const char* get_error_name() const;
+
+    /**
+     * @brief Create the reply to this method call
+     */
+    Message new_method_return() const;
+
+    /**
+     * @brief Create an error reply to this method call
+     */
+    Message new_error(const char* name, const char* text) const;
+
+    // Reading; each call consumes one argument and fails on a type mismatch
+    bool read(bool& value);
+    bool read(uint8_t& value);
+    bool read(int16_t& value);
+    bool read(uint16_t& value);
+    bool read(int32_t& value);
+    bool read(uint32_t& value);
+    bool read(int64_t& value);
+    bool read(uint64_t& value);
+    bool read(double& value);
+    bool read(std::string& value);
+
+    /**
+     * @brief Read a unix fd; the returned descriptor is owned by the caller
+     */
+    bool read_fd(int& fd);
+
+    bool enter(char type, const char* contents);
+    bool exit();
+
+    /**
+     * @brief Step over the next argument, whatever its type
+     */
+    bool skip();
+
+    /**
+     * @brief True when the current container (or the body) has no more arguments
+     */
+    bool at_end();
+
+    template<typename... Args>
+    bool read_args(Args&... args) {
+        return (read(args) && ...);
+    }
+
+    // Writing
+    bool append(bool value);
+    bool append(uint8_t value);
+    bool append(int16_t value);
+    bool append(uint16_t value);
+    bool append(int32_t value);
+    bool append(uint32_t value);
+    bool append(int64_t value);
+    bool append(uint64_t value);
+    bool append(double value);
+    bool append(const char* value);
+    bool append(const std::string& value) { return append(value.c_str()); }
+
+    /**
+     * @brief Append a unix fd; the message keeps its own duplicate
+     */
+    bool append_fd(int fd);
+
+    bool open(char type, const char* contents);
+    bool close();
+
+    template<typename... Args>
+    bool append_args(const Args&... args) {
+        return (append(args) && ...);
+    }
+
+    /**
+     * @brief Take over a reference the caller already holds (backends only)
+     */
+    static Message adopt(void* raw);
+
+    /**
+     * @brief Take an additional reference (backends only)
+     */
+    static Message ref(void* raw);
+
+    void* get_raw() const { return raw_; }
+
+    struct Iter;  // Backend cursor state
+
+private:
+    void* raw_;
+    std::unique_ptr<Iter> iter_;  // libdbus keeps its cursor outside the message
+};
+
+} // namespace services
+} // namespace touchdown
+
+#endif // TOUCHDOWN_SERVICES_DBUS_MESSAGE_HPP
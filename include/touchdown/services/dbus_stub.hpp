@@ -0,0 +1,57 @@
+/**
+ * @file dbus_stub.hpp
+ * @brief Support code for stubs and proxies generated by td-dbus-codegen
+ */
+
+#ifndef TOUCHDOWN_SERVICES_DBUS_STUB_HPP
+#define TOUCHDOWN_SERVICES_DBUS_STUB_HPP
+
+#include "touchdown/services/dbus_interface.hpp"
+#include <cstdint>
+#include <string_view>
+
+namespace touchdown {
+namespace services {
+
+constexpr const char* DBUS_PROPERTIES_INTERFACE = "org.freedesktop.DBus.Properties";
+constexpr const char* DBUS_ERROR_INVALID_ARGS = "org.freedesktop.DBus.Error.InvalidArgs";
+constexpr const char* DBUS_ERROR_NO_REPLY = "org.freedesktop.DBus.Error.NoReply";
+
+/**
+ * @brief Result of a generated method handler; default constructed is success
+ */
+struct MethodError {
+    const char* name = nullptr;
+    const char* text = nullptr;
+
+    explicit operator bool() const { return name != nullptr; }
+};
+
+/**
+ * @brief Member name hash behind the generated perfect-hash tables
+ *
+ * FNV-1a with a per-interface seed; td-dbus-codegen searches for a seed
+ * that gives every method of the interface its own slot.
+ */
+constexpr uint32_t member_hash(std::string_view name, uint32_t seed) {
+    uint32_t hash = seed;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Error name carried by a proxy reply, or nullptr on success
+ */
+inline const char* reply_error(const Message& reply) {
+    if (!reply) return DBUS_ERROR_NO_REPLY;  // Not sent
+    if (reply.is_error()) return reply.get_error_name();
+    return nullptr;
+}
+
+} // namespace services
+} // namespace touchdown
+
+#endif // TOUCHDOWN_SERVICES_DBUS_STUB_HPP
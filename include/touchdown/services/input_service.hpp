@@ -6,10 +6,15 @@
 #ifndef TOUCHDOWN_SERVICES_INPUT_SERVICE_HPP
 #define TOUCHDOWN_SERVICES_INPUT_SERVICE_HPP
 
-#include "touchdown/services/dbus_interface.hpp"
+#include "touchdown/dbus/input_interface.hpp"
 #include "touchdown/core/types.hpp"
+#include "touchdown/core/event_queue.hpp"
+#include "touchdown/core/input_ring.hpp"
+#include "touchdown/core/activity_page.hpp"
+#include <map>
 #include <memory>
-#include <atomic>
+#include <string>
+#include <vector>
 
 namespace touchdown {
 
@@ -20,7 +25,15 @@ namespace drivers {
 
 namespace services {
 
-class InputService : public DBusInterface {
+/**
+ * @brief Single owner of the touch and button hardware
+ *
+ * Samples the drivers, publishes every event into a shared-memory ring
+ * handed out through OpenEventRing, keeps a shared activity page for the
+ * power service, and mirrors events as D-Bus signals for clients that
+ * don't need low latency.
+ */
+class InputService : public InputStub {
 public:
     InputService();
     ~InputService();
@@ -28,10 +41,18 @@ public:
     /**
      * @brief Initialize input service
      */
-    bool init(drivers::TouchDriver* touch, drivers::ButtonDriver* button);
+    bool init(EventLoop& loop, drivers::TouchDriver* touch, drivers::ButtonDriver* button);
+    
+    /**
+     * @brief How long drag samples are held for one TouchMoved signal
+     *
+     * Defaults to one display frame (33 ms). 0 sends each sample in a
+     * signal of its own, for comparing the cost of batching.
+     */
+    void set_move_batch_interval(uint32_t ms) { move_batch_ms_ = ms; }
     
     /**
-     * @brief Main service loop
+     * @brief Main service loop (runs the event loop)
      */
     void run();
     
@@ -43,14 +64,51 @@ public:
 private:
     void on_touch_event(const TouchPoint& point);
     void on_button_event(const ButtonEvent& event);
+    void on_input_event(const InputEvent& event);
+    void flush_pending_moves();
+    void start_touch_sampling();
+    void update_touch_sampling(bool touch_held);
+    void publish_to_ring(const InputEvent& event);
+    void on_name_owner_changed(Message& msg);
+    void log_statistics() const;
     
-    // D-Bus method handlers
-    DBusMessage* handle_get_last_touch(DBusMessage* msg);
-    DBusMessage* handle_get_last_button(DBusMessage* msg);
+    // org.touchdown.Input
+    MethodError handle_get_last_touch(Message& call, int16_t& x, int16_t& y,
+                                      uint32_t& timestamp_ms) override;
+    MethodError handle_get_last_button(Message& call, uint32_t& type, uint32_t& timestamp_ms,
+                                       uint16_t& duration_ms) override;
+    MethodError handle_set_touch_power_mode(Message& call, const std::string& mode) override;
+    MethodError handle_open_event_ring(Message& call, int event_fd, int& ring) override;
+    MethodError handle_open_activity_page(Message& call, int wake_fd, int& page) override;
     
     drivers::TouchDriver* touch_;
     drivers::ButtonDriver* button_;
-    std::atomic<bool> running_;
+    EventLoop::TimerId touch_poll_timer_;
+    
+    // Shared event ring and each reader's wakeup eventfd, keyed by bus name
+    InputRing ring_;
+    std::map<std::string, int> ring_consumers_;
+    uint32_t next_trace_id_;
+    
+    // Last-activity page, and eventfds signalled on the first input while
+    // the screen is off (touch controller in wake-on-touch or standby) and
+    // on every touch press or button event
+    ActivityPage activity_;
+    std::map<std::string, int> wake_fds_;
+    bool wake_armed_;
+    
+    // MOVE samples waiting for the next per-frame TouchMoved batch
+    std::vector<TouchPoint> pending_moves_;
+    EventLoop::TimerId move_batch_timer_;
+    uint32_t move_batch_ms_;
+    
+    // Signal rate accounting, reported when the service stops
+    uint64_t signals_sent_;
+    uint64_t touch_samples_;
+    uint64_t start_us_;
+    
+    // Driver callbacks arrive here and are handled on the loop thread
+    InputEventQueue input_queue_;
     
     TouchPoint last_touch_;
     ButtonEvent last_button_;
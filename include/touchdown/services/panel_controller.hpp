@@ -0,0 +1,86 @@
+/**
+ * @file panel_controller.hpp
+ * @brief Display power and backlight for the power service
+ */
+
+#ifndef TOUCHDOWN_SERVICES_PANEL_CONTROLLER_HPP
+#define TOUCHDOWN_SERVICES_PANEL_CONTROLLER_HPP
+
+#include "touchdown/dbus/shell_interface.hpp"
+#include "touchdown/drivers/backlight.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace touchdown {
+namespace services {
+
+/**
+ * @brief Switches the panel without opening the display
+ *
+ * The shell is the only process holding the DRM device, so panel power
+ * (DPMS) is a SetDisplayPower request to it. The backlight is a sysfs
+ * class device written directly. Nothing here maps a framebuffer or
+ * competes for DRM master, so the power service starts without waiting
+ * on the display.
+ *
+ * Switching on, the backlight fades in after the shell's reply so it
+ * never lights a panel that is still off; switching off, it fades out
+ * before the panel is switched off. Brightness changes fade too.
+ */
+class PanelController {
+public:
+    static constexpr uint32_t DEFAULT_FADE_MS = 200;
+
+    explicit PanelController(DBusInterface& bus);
+
+    /**
+     * @brief Fade length and write rate; call before init()
+     */
+    void set_fade(uint32_t fade_ms, uint32_t max_rate_hz);
+
+    /**
+     * @brief Find the first backlight device under root
+     * @return false without one; panel power still works
+     */
+    bool init(EventLoop& loop, const std::string& backlight_root = drivers::Backlight::DEFAULT_ROOT);
+
+    /**
+     * @brief Switch the panel
+     * @param done Called once the switch is complete (the panel is dark
+     *             and off, or on and fading in), or once a switch the
+     *             other way has replaced it
+     */
+    void set_power(bool on, std::function<void()> done = nullptr);
+
+    /**
+     * @brief Backlight level while on (0-255), faded to now if on
+     */
+    void set_brightness(uint8_t brightness);
+
+    /**
+     * @brief Called whenever the backlight level changes, fades included
+     */
+    void set_level_callback(drivers::Backlight::LevelCallback callback);
+
+    bool is_on() const { return on_; }
+    uint8_t get_level() const { return backlight_.get_level(); }
+
+private:
+    void finish_switch(uint64_t id);
+
+    ShellProxy shell_;
+    drivers::Backlight backlight_;
+    uint32_t fade_ms_;
+    uint8_t brightness_;
+    bool on_;
+    bool switching_;
+    uint64_t switch_count_;  // Tells a stale reply from the current switch
+    std::vector<std::function<void()>> switch_waiters_;
+};
+
+} // namespace services
+} // namespace touchdown
+
+#endif // TOUCHDOWN_SERVICES_PANEL_CONTROLLER_HPP
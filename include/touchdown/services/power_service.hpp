@@ -6,32 +6,131 @@
 #ifndef TOUCHDOWN_SERVICES_POWER_SERVICE_HPP
 #define TOUCHDOWN_SERVICES_POWER_SERVICE_HPP
 
-#include "touchdown/services/dbus_interface.hpp"
+#include "touchdown/dbus/power_interface.hpp"
+#include "touchdown/dbus/input_interface.hpp"
+#include "touchdown/services/panel_controller.hpp"
 #include "touchdown/core/types.hpp"
+#include "touchdown/core/activity_page.hpp"
+#include "touchdown/core/worker_pool.hpp"
+#include "touchdown/core/frame_feedback.hpp"
+#include "touchdown/core/thermal_governor.hpp"
+#include "touchdown/drivers/cpufreq.hpp"
+#include "touchdown/drivers/cpu_hotplug.hpp"
+#include "touchdown/drivers/system_sleep.hpp"
+#include "touchdown/drivers/thermal_zones.hpp"
+#include <array>
+#include <functional>
+#include <map>
 #include <memory>
-#include <atomic>
+#include <vector>
 
 namespace touchdown {
-
-// Forward declarations
-namespace drivers {
-    class DisplayDriver;
-}
-
 namespace services {
 
-class PowerService : public DBusInterface {
+/**
+ * @brief What the power service does at a thermal level
+ */
+struct ThermalResponse {
+    bool cpu_boost = true;       // Input boost and frame floor may raise the clock
+    uint32_t app_cpu_quota = 0;  // CPUQuota of the app slice in percent, 0 = none
+};
+
+class PowerService : public PowerStub {
 public:
     PowerService();
     ~PowerService();
     
     /**
      * @brief Initialize power service
+     *
+     * The display is the shell's; the panel is switched through it.
+     */
+    bool init(EventLoop& loop);
+    
+    /**
+     * @brief cpufreq governor and limits for a power state
+     *
+     * Call before init(); the ACTIVE settings are applied there.
+     * Defaults: schedutil when ACTIVE, powersave with the screen off.
+     */
+    void set_cpufreq_settings(PowerState state, const drivers::CpufreqSettings& settings);
+    
+    /**
+     * @brief Raise the CPU frequency floor when an interaction starts
+     * @param khz Floor while boosted, 0 to disable
+     * @param duration_ms How long each boost lasts
+     * @param min_interval_ms Minimum time between the starts of two boosts
      */
-    bool init(drivers::DisplayDriver* display);
+    void set_input_boost(uint32_t khz, uint32_t duration_ms, uint32_t min_interval_ms);
     
     /**
-     * @brief Main service loop
+     * @brief Tune the frequency floor driven by the shell's frame reports
+     *
+     * Disabled while config.max_khz is 0.
+     */
+    void set_frame_floor(const FrameFloorConfig& config);
+    
+    /**
+     * @brief How SUSPENDED suspends the system
+     *
+     * Call before init().
+     * @param sysfs_root /sys, or a fake tree for a dry run
+     * @param state "freeze" (s2idle) or "mem"
+     * @param wakeup_devices Device directories under sysfs_root whose
+     *                       power/wakeup is enabled while suspended
+     */
+    void set_suspend(const std::string& sysfs_root, const std::string& state,
+                     const std::vector<std::string>& wakeup_devices);
+    
+    /**
+     * @brief Which CPUs go offline while the screen is off
+     *
+     * Call before init(). The CPUs are parked once the screen has been off
+     * for delay_ms, so a quick wake does not pay for a hotplug, and they
+     * are back online before the CPU governor is applied on wake.
+     * @param sysfs_root /sys/devices/system/cpu, or a fake tree
+     * @param cpus CPUs to park; empty to keep every CPU online
+     * @param delay_ms Time with the screen off before parking
+     * @param parallel Bring the CPUs back concurrently
+     */
+    void set_core_parking(const std::string& sysfs_root, const std::vector<unsigned>& cpus,
+                          uint32_t delay_ms, bool parallel);
+    
+    /**
+     * @brief Thermal zones to watch and the thresholds between levels
+     *
+     * Call before init(). The zones are polled every poll_ms while the
+     * screen is on; the level is the ThermalLevel D-Bus property.
+     * @param sysfs_root /sys/class/thermal, or a fake tree
+     * @param zone_types Zone types to watch, empty for all
+     * @param app_slice systemd slice of the apps for the CPU quota,
+     *                  empty to leave apps alone
+     */
+    void set_thermal(const ThermalConfig& config, const std::string& sysfs_root,
+                     const std::vector<std::string>& zone_types, uint32_t poll_ms,
+                     const std::string& app_slice);
+    
+    /**
+     * @brief What to do at a thermal level
+     *
+     * Defaults: no CPU boost from HOT, and apps capped to 30% when HOT
+     * and 15% when CRITICAL.
+     */
+    void set_thermal_response(ThermalLevel level, const ThermalResponse& response);
+    
+    /**
+     * @brief Where the backlight is and how it fades
+     *
+     * Call before init().
+     * @param class_root /sys/class/backlight, or a fake tree
+     * @param fade_ms Fade length on screen on/off and brightness changes,
+     *                0 to switch at once
+     * @param max_rate_hz Most backlight writes per second during a fade
+     */
+    void set_backlight(const std::string& class_root, uint32_t fade_ms, uint32_t max_rate_hz);
+    
+    /**
+     * @brief Main service loop (runs the event loop)
      */
     void run();
     
@@ -42,8 +141,9 @@ public:
     
     /**
      * @brief Set power state
+     * @param applied Called on the loop once the state has been applied
      */
-    void set_power_state(PowerState state);
+    void set_power_state(PowerState state, std::function<void()> applied = nullptr);
     
     /**
      * @brief Get current power state
@@ -55,28 +155,130 @@ public:
      */
     void set_screen_timeout(uint32_t timeout_ms);
     
+    /**
+     * @brief Set the backlight level used while the screen is on (0-255)
+     */
+    void set_brightness(uint8_t brightness);
+    
     /**
      * @brief Reset idle timer (called on user activity)
      */
     void reset_idle_timer();
     
 private:
-    void apply_power_state(PowerState state);
-    void apply_cpu_scaling(const std::string& governor);
+    void apply_power_state(PowerState state, std::function<void()> applied);
+    void switch_display_on();
+    void cancel_display_on();
+    void apply_cpu_scaling(PowerState state, std::function<void()> applied = nullptr);
+    void park_cpus();
+    void unpark_cpus();
+    void poll_thermal();
+    void on_thermal_sample(int32_t temp_mc);
+    void apply_thermal_level(ThermalLevel level);
+    void set_app_cpu_quota(uint32_t percent);
+    const ThermalResponse& thermal_response() const;
+    void apply_touch_power_mode(const std::string& mode, std::function<void()> done = nullptr);
+    void enter_suspend(std::function<void()> applied);
+    void on_resumed(const drivers::SleepResult& result);
     void check_idle_timeout();
+    void schedule_idle_check();
+    void refresh_last_activity();
+    void connect_activity_page();
+    void on_input_wake();
+    void on_name_owner_changed(Message& msg);
+    void start_input_boost();
+    void end_input_boost();
+    void update_cpu_floor();
+    void log_statistics(uint64_t start_us, uint64_t start_wakeups) const;
     
-    // D-Bus method handlers
-    DBusMessage* handle_set_power_state(DBusMessage* msg);
-    DBusMessage* handle_get_power_state(DBusMessage* msg);
-    DBusMessage* handle_set_screen_timeout(DBusMessage* msg);
-    DBusMessage* handle_reset_idle_timer(DBusMessage* msg);
+    // org.touchdown.Power
+    void handle_set_power_state(Message& call, const std::string& state,
+                                SetPowerStateDone done) override;
+    MethodError handle_get_power_state(Message& call, std::string& state) override;
+    MethodError handle_set_screen_timeout(Message& call, uint32_t timeout_ms) override;
+    MethodError handle_reset_idle_timer(Message& call) override;
+    MethodError handle_set_brightness(Message& call, uint8_t brightness) override;
+    MethodError handle_frame_ready(Message& call) override;
+    MethodError handle_report_frame_stats(Message& call, uint32_t frames, uint32_t missed,
+                                          uint32_t busy_us, uint32_t max_us,
+                                          uint32_t window_us) override;
     
-    drivers::DisplayDriver* display_;
+    InputProxy input_;
+    PanelController panel_;
+    std::string backlight_root_;
     PowerState power_state_;
-    std::atomic<bool> running_;
+    uint8_t brightness_;
+    
+    // On wake the display stays off until the shell has redrawn
+    bool display_on_pending_;
+    EventLoop::TimerId display_timer_;
     
     uint32_t screen_timeout_ms_;
-    uint32_t last_activity_time_;
+    uint64_t last_activity_us_;
+    
+    // Input activity shared by the input service, read when the idle timer
+    // fires; the eventfd is signalled on the first input with the screen off
+    ActivityPageReader activity_;
+    int wake_fd_;
+    
+    EventLoop::TimerId idle_timer_;
+    
+    // Input boost: a cpufreq floor from the start of a touch
+    uint32_t boost_khz_;
+    uint32_t boost_ms_;
+    uint32_t boost_interval_ms_;
+    bool boosting_;
+    uint64_t boost_start_us_;
+    uint64_t boost_count_;
+    uint64_t boost_time_us_;
+    EventLoop::TimerId boost_timer_;
+    
+    // Frame feedback: a cpufreq floor that keeps the shell's frames in time
+    FrameFloorController frame_floor_;
+    uint64_t frames_reported_;
+    uint64_t frames_missed_;
+    
+    // Floor last handed to the worker, the higher of boost and frame floor
+    uint32_t cpu_floor_khz_;
+    
+    // Suspend: wake time of the last resume until display and touch are back
+    std::string sleep_root_;
+    std::string sleep_state_;
+    uint64_t resumed_us_;
+    uint64_t suspend_count_;
+    
+    // Core parking: secondary CPUs offline after a while with the screen off
+    std::string hotplug_root_;
+    uint32_t park_delay_ms_;
+    EventLoop::TimerId park_timer_;
+    uint64_t park_count_;
+    uint64_t unpark_max_us_;
+    
+    // Thermal levels from the hottest zone, polled while the screen is on
+    ThermalGovernor thermal_;
+    std::array<ThermalResponse, THERMAL_LEVEL_COUNT> thermal_responses_;
+    std::string thermal_root_;
+    std::vector<std::string> thermal_types_;
+    uint32_t thermal_poll_ms_;
+    EventLoop::TimerId thermal_timer_;
+    bool thermal_reading_;  // A read is queued on the worker
+    int32_t thermal_max_mc_;
+    std::string app_slice_;
+    uint32_t app_cpu_quota_;  // Last quota handed to systemd
+    
+    // Only touched from the worker once init() has returned
+    drivers::CpufreqManager cpufreq_;
+    drivers::CpuHotplug hotplug_;
+    drivers::ThermalZones thermal_zones_;
+    drivers::SystemSleep sleep_;
+    std::map<PowerState, drivers::CpufreqSettings> cpufreq_settings_;
+    
+    // sysfs writes and poweroff; one thread so they land in request order
+    WorkerPool workers_;
+    
+    // systemctl set-property waits on systemd, which can take hundreds of
+    // milliseconds; kept apart so boosts and unparks never queue behind it
+    WorkerPool quota_workers_;
 };
 
 } // namespace services
@@ -7,13 +7,18 @@
 #define TOUCHDOWN_SHELL_SHELL_HPP
 
 #include "touchdown/drivers/display_driver.hpp"
-#include "touchdown/drivers/touch_driver.hpp"
-#include "touchdown/drivers/button_driver.hpp"
 #include "touchdown/shell/home_screen.hpp"
 #include "touchdown/shell/app_launcher.hpp"
+#include "touchdown/shell/shell_service.hpp"
 #include "touchdown/services/app_manager.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/core/input_ring.hpp"
+#include "touchdown/core/frame_feedback.hpp"
+#include "touchdown/core/thermal_governor.hpp"
+#include <array>
+#include <deque>
+#include <fstream>
 #include <memory>
-#include <atomic>
 
 namespace touchdown {
 namespace shell {
@@ -30,12 +35,12 @@ public:
     ~Shell();
     
     /**
-     * @brief Initialize shell
+     * @brief Initialize shell on the given event loop
      */
-    bool init();
+    bool init(EventLoop& loop);
     
     /**
-     * @brief Main shell loop
+     * @brief Main shell loop (runs the event loop)
      */
     void run();
     
@@ -60,16 +65,56 @@ public:
     void launch_app(const std::string& app_id);
     
 private:
-    void setup_input_handlers();
+    struct PointerSample {
+        int16_t x;
+        int16_t y;
+        bool pressed;
+        uint32_t trace_id;  // Latency trace of the event it came from
+    };
+    
+    // How the UI renders at a thermal level
+    struct ThermalStyle {
+        uint32_t refresh_ms;
+        bool effects;
+    };
+    
+    bool setup_input();
+    void connect_input_ring();
+    void on_input_ring_ready();
+    size_t drain_input_ring();
+    bool queue_pointer_sample(const TouchPoint& point, uint32_t trace_id);
+    static void pointer_read_cb(lv_indev_t* indev, lv_indev_data_t* data);
     void on_touch(const TouchPoint& point);
     void on_button(const ButtonEvent& event);
     void change_state(ShellState new_state);
     void update_time();
+    void on_lvgl_timer();
+    void record_frame(uint64_t start_us, uint64_t render_us);
+    void on_power_state_changed(const std::string& state);
+    void load_thermal_styles();
+    void on_thermal_level_changed(const std::string& name);
+    void park_rendering();
+    void resume_rendering();
+    static uint64_t cpu_time_us();
+    void on_input_event(const InputEvent& event);
     
-    // Hardware drivers
+    // Hardware drivers; touch and button belong to the input service
     std::unique_ptr<drivers::DisplayDriver> display_;
-    std::unique_ptr<drivers::TouchDriver> touch_;
-    std::unique_ptr<drivers::ButtonDriver> button_;
+    
+    // Input arrives through the input service's shared event ring
+    std::unique_ptr<ShellService> shell_service_;
+    InputRingReader input_ring_;
+    int input_wake_fd_;
+    lv_indev_t* pointer_indev_;
+    std::deque<PointerSample> pointer_samples_;
+    PointerSample pointer_state_;
+    uint64_t input_events_;
+    uint64_t input_max_delay_us_;
+    uint64_t input_total_delay_us_;
+    
+    // Render times, reported to the power service and optionally traced
+    FrameStats frame_stats_;
+    std::ofstream frame_trace_;
     
     // UI components
     lv_obj_t* screen_;
@@ -80,10 +125,24 @@ private:
     // Services
     std::unique_ptr<services::AppManager> app_manager_;
     
+    // Event loop
+    EventLoop* loop_;
+    EventLoop::TimerId lvgl_timer_;
+    EventLoop::TimerId clock_timer_;
+    EventLoop::TimerId watchdog_timer_;
+    
+    // No LVGL, clock or app updates while the screen is off
+    bool parked_;
+    uint64_t parked_since_us_;
+    uint64_t parked_cpu_us_;
+    uint64_t resumed_us_;  // Wake time until the first frame after it
+    
+    // Refresh rate and effects follow the power service's thermal level
+    std::array<ThermalStyle, THERMAL_LEVEL_COUNT> thermal_styles_;
+    ThermalLevel thermal_level_;
+    
     // State
     ShellState state_;
-    std::atomic<bool> running_;
-    uint32_t last_time_update_;
     uint32_t last_update_ms_;
 };
 
@@ -0,0 +1,63 @@
+/**
+ * @file shell_service.hpp
+ * @brief Shell's D-Bus presence (org.touchdown.Shell)
+ */
+
+#ifndef TOUCHDOWN_SHELL_SHELL_SERVICE_HPP
+#define TOUCHDOWN_SHELL_SHELL_SERVICE_HPP
+
+#include "touchdown/dbus/shell_interface.hpp"
+#include "touchdown/dbus/input_interface.hpp"
+#include <functional>
+
+namespace touchdown {
+namespace shell {
+
+/**
+ * @brief Owns the shell's bus name and talks to the system services
+ */
+class ShellService : public services::ShellStub {
+public:
+    using RingCallback = std::function<void(int ring_fd)>;
+    using DisplayPowerCallback = std::function<void(bool on)>;
+
+    ShellService();
+    ~ShellService();
+
+    /**
+     * @brief Connect to the bus on the shell's event loop
+     */
+    bool init(EventLoop& loop);
+
+    /**
+     * @brief Ask the input service for its event ring
+     * @param event_fd eventfd the input service signals on new events
+     * @param callback Receives the ring fd (owned by the callee), or -1
+     */
+    void open_input_ring(int event_fd, RingCallback callback);
+
+    /**
+     * @brief Called when org.touchdown.Input (re)appears on the bus
+     */
+    void set_input_service_callback(std::function<void()> callback);
+
+    /**
+     * @brief Called for SetDisplayPower from the power service
+     */
+    void set_display_power_callback(DisplayPowerCallback callback);
+
+private:
+    void on_name_owner_changed(services::Message& msg);
+
+    // org.touchdown.Shell
+    services::MethodError handle_set_display_power(services::Message& call, bool on) override;
+
+    services::InputProxy input_;
+    std::function<void()> input_service_callback_;
+    DisplayPowerCallback display_power_callback_;
+};
+
+} // namespace shell
+} // namespace touchdown
+
+#endif // TOUCHDOWN_SHELL_SHELL_SERVICE_HPP
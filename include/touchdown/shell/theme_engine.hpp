@@ -68,6 +68,22 @@ public:
     lv_style_t create_button_style();
     lv_style_t create_text_style(bool secondary = false);
     
+    /**
+     * @brief Shadow of raised elements; empty while effects are off
+     */
+    lv_style_t* get_shadow_style() { return &shadow_style_; }
+    
+    /**
+     * @brief Turn shadows and animations on or off
+     *
+     * Shadows are blurred on every redraw of what they surround, and
+     * animations redraw the whole area they cover each frame; both are
+     * the first to go when the device runs hot. Objects using the shadow
+     * style update at once.
+     */
+    void set_effects(bool enabled);
+    bool get_effects() const { return effects_; }
+    
     /**
      * @brief Smooth transition between themes
      */
@@ -82,6 +98,8 @@ private:
     ThemeMode current_mode_;
     ColorPalette current_palette_;
     lv_theme_t* lvgl_theme_;
+    lv_style_t shadow_style_;
+    bool effects_;
 };
 
 } // namespace shell
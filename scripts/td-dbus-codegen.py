@@ -0,0 +1,801 @@
+#!/usr/bin/env python3
+"""
+D-Bus stub and proxy generator for TouchdownOS
+
+Reads D-Bus introspection XML and writes a header with, per interface:
+  <Name>Stub   DBusInterface subclass that exports the interface; calls are
+               resolved with a constexpr perfect hash and unpacked into
+               typed handle_*() virtuals (completed later through a
+               callback for methods annotated org.touchdown.Method.Async),
+               signals go out through emit_*(),
+               read-only properties are cached and announced through
+               PropertiesChanged by set_*_property()
+  <Name>Proxy  typed asynchronous calls, signal subscriptions and a
+               property mirror for clients, built on any DBusInterface
+               connection
+
+Usage: td-dbus-codegen.py --output <header.hpp> <interface.xml>...
+"""
+
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+FNV_PRIME = 16777619
+FNV_OFFSET = 2166136261
+
+BASIC_TYPES = {
+    'y': 'uint8_t',
+    'b': 'bool',
+    'n': 'int16_t',
+    'q': 'uint16_t',
+    'i': 'int32_t',
+    'u': 'uint32_t',
+    'x': 'int64_t',
+    't': 'uint64_t',
+    'd': 'double',
+    's': 'std::string',
+    'h': 'int',
+}
+
+
+# Names the generated code uses for its own parameters and locals
+RESERVED_NAMES = {'msg', 'call', 'reply', 'error', 'done', 'handler', 'method', 'call_timeout_ms'}
+
+# <annotation name="org.touchdown.Method.Async" value="true"/> on a method:
+# its handler gets a completion callback and may answer after returning
+ASYNC_ANNOTATION = 'org.touchdown.Method.Async'
+
+# One bit per property in the pending PropertiesChanged mask
+MAX_PROPERTIES = 64
+
+
+class CodegenError(Exception):
+    pass
+
+
+# ---------------------------------------------------------------------------
+# Signatures
+# ---------------------------------------------------------------------------
+
+def split_signature(sig):
+    """Split a signature into its complete types"""
+    types = []
+    i = 0
+    while i < len(sig):
+        end = complete_type_end(sig, i)
+        types.append(sig[i:end])
+        i = end
+    return types
+
+
+def complete_type_end(sig, i):
+    c = sig[i]
+    if c in BASIC_TYPES:
+        return i + 1
+    if c == 'a':
+        if i + 1 >= len(sig):
+            raise CodegenError("array without element type in '%s'" % sig)
+        if sig[i + 1] == '{':
+            raise CodegenError("dictionaries are not supported ('%s')" % sig)
+        return complete_type_end(sig, i + 1)
+    if c == '(':
+        depth = 0
+        for j in range(i, len(sig)):
+            if sig[j] == '(':
+                depth += 1
+            elif sig[j] == ')':
+                depth -= 1
+                if depth == 0:
+                    return j + 1
+        raise CodegenError("unterminated struct in '%s'" % sig)
+    raise CodegenError("type '%s' is not supported ('%s')" % (c, sig))
+
+
+def cpp_type(t):
+    if t in BASIC_TYPES:
+        return BASIC_TYPES[t]
+    if t[0] == 'a':
+        return 'std::vector<%s>' % cpp_type(t[1:])
+    if t[0] == '(':
+        return 'std::tuple<%s>' % ', '.join(cpp_type(f) for f in split_signature(t[1:-1]))
+    raise CodegenError("type '%s' is not supported" % t)
+
+
+def is_scalar(t):
+    return t in BASIC_TYPES and t != 's'
+
+
+def in_param(t, name):
+    if is_scalar(t):
+        return '%s %s' % (cpp_type(t), name)
+    return 'const %s& %s' % (cpp_type(t), name)
+
+
+def out_param(t, name):
+    return '%s& %s' % (cpp_type(t), name)
+
+
+def local_decl(t, name):
+    if t == 'h':
+        return 'int %s = -1;' % name
+    return '%s %s{};' % (cpp_type(t), name)
+
+
+def read_code(t, lvalue, depth=0):
+    """Statements reading one value of type t from msg, returning false on failure"""
+    if t == 'h':
+        return ['if (!msg.read_fd(%s)) return false;' % lvalue]
+    if t in BASIC_TYPES:
+        return ['if (!msg.read(%s)) return false;' % lvalue]
+    if t[0] == '(':
+        lines = ['if (!msg.enter(\'r\', "%s")) return false;' % t[1:-1]]
+        for i, field in enumerate(split_signature(t[1:-1])):
+            lines += read_code(field, 'std::get<%d>(%s)' % (i, lvalue), depth + 1)
+        lines.append('if (!msg.exit()) return false;')
+        return lines
+    lines = ['if (!msg.enter(\'a\', "%s")) return false;' % t[1:],
+             'while (!msg.at_end()) {',
+             '    %s.emplace_back();' % lvalue]
+    lines += indent(read_code(t[1:], '%s.back()' % lvalue, depth + 1), 1)
+    lines += ['}', 'if (!msg.exit()) return false;']
+    return lines
+
+
+def append_code(t, expr, depth=0):
+    """Statements appending one value of type t to msg"""
+    if t == 'h':
+        return ['msg.append_fd(%s);' % expr]
+    if t in BASIC_TYPES:
+        return ['msg.append(%s);' % expr]
+    if t[0] == '(':
+        lines = ['msg.open(\'r\', "%s");' % t[1:-1]]
+        for i, field in enumerate(split_signature(t[1:-1])):
+            lines += append_code(field, 'std::get<%d>(%s)' % (i, expr), depth + 1)
+        lines.append('msg.close();')
+        return lines
+    element = 'e%d' % depth
+    lines = ['msg.open(\'a\', "%s");' % t[1:],
+             'for (const auto& %s : %s) {' % (element, expr)]
+    lines += indent(append_code(t[1:], element, depth + 1), 1)
+    lines += ['}', 'msg.close();']
+    return lines
+
+
+# ---------------------------------------------------------------------------
+# Interface model
+# ---------------------------------------------------------------------------
+
+def snake_case(name):
+    name = re.sub(r'([A-Z]+)([A-Z][a-z])', r'\1_\2', name)
+    name = re.sub(r'([a-z0-9])([A-Z])', r'\1_\2', name)
+    return name.lower()
+
+
+class Arg:
+    def __init__(self, element, index):
+        self.type = element.get('type')
+        self.name = element.get('name') or 'arg%d' % index
+        if self.name in RESERVED_NAMES:
+            self.name += '_'
+        self.direction = element.get('direction', 'in')
+        if not self.type or len(split_signature(self.type)) != 1:
+            raise CodegenError("argument '%s' needs a single complete type" % self.name)
+        cpp_type(self.type)
+
+
+class Member:
+    def __init__(self, element, is_signal):
+        self.name = element.get('name')
+        self.snake = snake_case(self.name)
+        args = [Arg(a, i) for i, a in enumerate(element.findall('arg'))]
+        if is_signal:
+            self.in_args = args
+            self.out_args = []
+        else:
+            self.in_args = [a for a in args if a.direction == 'in']
+            self.out_args = [a for a in args if a.direction == 'out']
+        self.signature = ''.join(a.type for a in self.in_args)
+        self.result = ''.join(a.type for a in self.out_args)
+        self.is_async = any(a.get('name') == ASYNC_ANNOTATION and a.get('value') == 'true'
+                            for a in element.findall('annotation'))
+        if self.is_async and is_signal:
+            raise CodegenError("signal '%s' cannot be async" % self.name)
+
+
+class Property:
+    def __init__(self, element):
+        self.name = element.get('name')
+        self.snake = snake_case(self.name)
+        self.type = element.get('type')
+        self.member = '%s_property_' % self.snake
+        if not self.type or len(split_signature(self.type)) != 1:
+            raise CodegenError("property '%s' needs a single complete type" % self.name)
+        if 'h' in self.type:
+            raise CodegenError("property '%s': unix fds cannot be properties" % self.name)
+        if element.get('access') != 'read':
+            raise CodegenError("property '%s': only access=\"read\" is supported" % self.name)
+        cpp_type(self.type)
+
+
+class Interface:
+    def __init__(self, element, default_path):
+        self.name = element.get('name')
+        self.short = self.name.rsplit('.', 1)[-1]
+        self.path = default_path or '/' + self.name.replace('.', '/')
+        self.methods = [Member(m, False) for m in element.findall('method')]
+        self.signals = [Member(s, True) for s in element.findall('signal')]
+        self.properties = [Property(p) for p in element.findall('property')]
+        if len(self.properties) > MAX_PROPERTIES:
+            raise CodegenError("%s: more than %d properties" % (self.name, MAX_PROPERTIES))
+
+
+def member_hash(name, seed):
+    h = seed
+    for c in name.encode():
+        h ^= c
+        h = (h * FNV_PRIME) & 0xffffffff
+    return h
+
+
+def perfect_hash(names):
+    """Smallest power-of-two table and a seed that give each name its own slot"""
+    size = 1
+    while size < len(names):
+        size *= 2
+    while True:
+        for seed in range(FNV_OFFSET, FNV_OFFSET + 4096):
+            slots = [-1] * size
+            for index, name in enumerate(names):
+                slot = member_hash(name, seed) & (size - 1)
+                if slots[slot] >= 0:
+                    break
+                slots[slot] = index
+            else:
+                return seed, slots
+        size *= 2
+
+
+def introspection_xml(iface):
+    lines = [' <interface name="%s">' % iface.name]
+    for m in iface.methods:
+        args = [(a, 'in') for a in m.in_args] + [(a, 'out') for a in m.out_args]
+        if not args:
+            lines.append('  <method name="%s"/>' % m.name)
+            continue
+        lines.append('  <method name="%s">' % m.name)
+        for a, direction in args:
+            lines.append('   <arg name="%s" type="%s" direction="%s"/>' % (a.name, a.type, direction))
+        lines.append('  </method>')
+    for s in iface.signals:
+        if not s.in_args:
+            lines.append('  <signal name="%s"/>' % s.name)
+            continue
+        lines.append('  <signal name="%s">' % s.name)
+        for a in s.in_args:
+            lines.append('   <arg name="%s" type="%s"/>' % (a.name, a.type))
+        lines.append('  </signal>')
+    for p in iface.properties:
+        lines.append('  <property name="%s" type="%s" access="read"/>' % (p.name, p.type))
+    lines.append(' </interface>')
+    return lines
+
+
+# ---------------------------------------------------------------------------
+# Output
+# ---------------------------------------------------------------------------
+
+def indent(lines, levels):
+    pad = '    ' * levels
+    return [pad + l if l else l for l in lines]
+
+
+def describe(m):
+    params = ', '.join('%s %s' % (a.type, a.name) for a in m.in_args)
+    if m.out_args:
+        return '%s(%s) -> (%s)' % (m.name, params,
+                                   ', '.join('%s %s' % (a.type, a.name) for a in m.out_args))
+    return '%s(%s)' % (m.name, params)
+
+
+def reader(name, args):
+    """static bool name(Message& msg, T& a, ...)"""
+    params = ', '.join(['Message& msg'] + [out_param(a.type, a.name) for a in args])
+    lines = ['static bool %s(%s) {' % (name, params)]
+    for a in args:
+        lines += indent(read_code(a.type, a.name), 1)
+    lines += ['    return true;', '}']
+    return lines
+
+
+def writer(name, args):
+    """static void name(Message& msg, const T& a, ...)"""
+    params = ', '.join(['Message& msg'] + [in_param(a.type, a.name) for a in args])
+    lines = ['static void %s(%s) {' % (name, params)]
+    for a in args:
+        lines += indent(append_code(a.type, a.name), 1)
+    if not args:
+        lines.append('    (void)msg;')
+    lines.append('}')
+    return lines
+
+
+def value_param(t, name):
+    """Parameter declaration for values handed to callbacks"""
+    if is_scalar(t):
+        return '%s %s' % (cpp_type(t), name)
+    return 'const %s& %s' % (cpp_type(t), name)
+
+
+def property_getter(p):
+    """Accessor for a cached property value"""
+    if is_scalar(p.type):
+        return '%s get_%s_property() const { return %s; }' % (cpp_type(p.type), p.snake, p.member)
+    return 'const %s& get_%s_property() const { return %s; }' % (cpp_type(p.type), p.snake, p.member)
+
+
+def emit_stub(iface):
+    cls = iface.short + 'Stub'
+    names = [m.name for m in iface.methods]
+    out = []
+
+    out += ['/**',
+            ' * @brief Server side of %s' % iface.name,
+            ' *',
+            ' * Calls are dispatched to the handle_*() methods on the event loop. Unix',
+            ' * fds received as arguments belong to the handler; fds returned through',
+            ' * out arguments stay with the handler, the reply carries a duplicate.',
+            ' */',
+            'class %s : public DBusInterface {' % cls,
+            'public:',
+            '    static constexpr const char* INTERFACE = "%s";' % iface.name,
+            '    static constexpr const char* DEFAULT_PATH = "%s";' % iface.path,
+            '']
+
+    if iface.methods:
+        out.append('    static constexpr MethodInfo METHODS[] = {')
+        for m in iface.methods:
+            out.append('        {"%s", "%s", "%s"},' % (m.name, m.signature, m.result))
+        out.append('    };')
+        count = len(iface.methods)
+    else:
+        out.append('    static constexpr MethodInfo METHODS[] = {{nullptr, nullptr, nullptr}};')
+        count = 0
+    out.append('    static constexpr size_t METHOD_COUNT = %d;' % count)
+    out.append('')
+
+    if iface.properties:
+        out.append('    static constexpr PropertyInfo PROPERTIES[] = {')
+        for p in iface.properties:
+            out.append('        {"%s", "%s"},' % (p.name, p.type))
+        out.append('    };')
+    else:
+        out.append('    static constexpr PropertyInfo PROPERTIES[] = {{nullptr, nullptr}};')
+    out.append('    static constexpr size_t PROPERTY_COUNT = %d;' % len(iface.properties))
+    out.append('')
+
+    out += ['    /**',
+            '     * @brief Index of a method in METHODS, or -1',
+            '     */',
+            '    static constexpr int lookup_method(std::string_view member) {']
+    if names:
+        seed, slots = perfect_hash(names)
+        out += ['        constexpr int8_t slots[%d] = {%s};' % (len(slots), ', '.join(str(s) for s in slots)),
+                '        int index = slots[member_hash(member, %du) & %du];' % (seed, len(slots) - 1),
+                '        return index >= 0 && member == METHODS[index].name ? index : -1;']
+    else:
+        out += ['        (void)member;', '        return -1;']
+    out += ['    }', '']
+
+    out += ['    static const InterfaceInfo& get_interface_info() {',
+            '        static const InterfaceInfo info = {',
+            '            INTERFACE, METHODS, METHOD_COUNT, lookup, PROPERTIES, PROPERTY_COUNT,']
+    xml = introspection_xml(iface)
+    for line in xml:
+        out.append('            "%s\\n"' % line.replace('"', '\\"'))
+    out += ['        };',
+            '        return info;',
+            '    }',
+            '']
+
+    for p in iface.properties:
+        out += ['    // %s (%s), last value set' % (p.name, p.type),
+                '    ' + property_getter(p)]
+    if iface.properties:
+        out.append('')
+
+    out += ['protected:',
+            '    %s(const std::string& service_name, const std::string& object_path = DEFAULT_PATH)' % cls,
+            '        : DBusInterface(service_name, object_path) {',
+            '        register_interface(get_interface_info(),']
+    if iface.properties:
+        out += ['            [this](int method, Message& call) { return dispatch(method, call); },',
+                '            [this](int property, Message& msg) { return append_property(property, msg); });']
+    else:
+        out.append('            [this](int method, Message& call) { return dispatch(method, call); });')
+    out += ['    }',
+            '']
+
+    for m in iface.methods:
+        if m.is_async:
+            done_type = '%sDone' % m.name
+            done_params = ', '.join(['MethodError error'] + [value_param(a.type, a.name) for a in m.out_args])
+            params = ', '.join(['Message& call'] + [in_param(a.type, a.name) for a in m.in_args] +
+                               ['%s done' % done_type])
+            if out[-1]:
+                out.append('')
+            out += ['    using %s = std::function<void(%s)>;' % (done_type, done_params),
+                    '',
+                    '    // %s; the reply goes out when done is called, which may be' % describe(m),
+                    '    // after returning (on the event loop)',
+                    '    virtual void handle_%s(%s) = 0;' % (m.snake, params),
+                    '']
+            continue
+        params = ', '.join(['Message& call'] + [in_param(a.type, a.name) for a in m.in_args] +
+                           [out_param(a.type, a.name) for a in m.out_args])
+        out += ['    // %s' % describe(m),
+                '    virtual MethodError handle_%s(%s) = 0;' % (m.snake, params)]
+    if iface.methods and not iface.methods[-1].is_async:
+        out.append('')
+
+    for s in iface.signals:
+        params = ', '.join(in_param(a.type, a.name) for a in s.in_args)
+        args = ', '.join(['msg'] + [a.name for a in s.in_args])
+        out += ['    // %s' % describe(s),
+                '    bool emit_%s(%s) {' % (s.snake, params),
+                '        Message msg = new_signal(INTERFACE, "%s");' % s.name,
+                '        if (!msg) return false;',
+                '        append_%s_args(%s);' % (s.snake, args),
+                '        send_message(std::move(msg));',
+                '        return true;',
+                '    }',
+                '']
+
+    for index, p in enumerate(iface.properties):
+        out += ['    // Caches %s; a change goes out with the next PropertiesChanged' % p.name,
+                '    void set_%s_property(%s) {' % (p.snake, in_param(p.type, 'value')),
+                '        if (value == %s) return;' % p.member,
+                '        %s = value;' % p.member,
+                '        notify_property_changed(get_interface_info(), %d);' % index,
+                '    }',
+                '']
+
+    out += ['private:',
+            '    static int lookup(const char* member) {',
+            '        return lookup_method(member);',
+            '    }',
+            '']
+
+    if iface.properties:
+        out += ['    bool append_property(int property, Message& msg) const {',
+                '        switch (property) {']
+        for index, p in enumerate(iface.properties):
+            out.append('            case %d:' % index)
+            out += indent(append_code(p.type, p.member), 4)
+            out.append('                return true;')
+        out += ['            default:',
+                '                return false;',
+                '        }',
+                '    }',
+                '']
+
+    for m in iface.methods:
+        if m.in_args:
+            out += indent(reader('read_%s_args' % m.snake, m.in_args), 1)
+            out.append('')
+        if m.out_args:
+            out += indent(writer('append_%s_reply' % m.snake, m.out_args), 1)
+            out.append('')
+    for s in iface.signals:
+        out += indent(writer('append_%s_args' % s.snake, s.in_args), 1)
+        out.append('')
+
+    out += ['    Message dispatch(int method, Message& call) {',
+            '        switch (method) {']
+    for index, m in enumerate(iface.methods):
+        out.append('            case %d: {' % index)
+        body = []
+        for a in m.in_args + ([] if m.is_async else m.out_args):
+            body.append(local_decl(a.type, a.name))
+        if m.in_args:
+            body += ['if (!read_%s_args(%s)) {' % (m.snake, ', '.join(['call'] + [a.name for a in m.in_args])),
+                     '    return call.new_error(DBUS_ERROR_INVALID_ARGS, "Malformed arguments");',
+                     '}']
+        if m.is_async:
+            done_params = ', '.join(['MethodError error'] + [value_param(a.type, a.name) for a in m.out_args])
+            body += ['DeferredReply deferred = defer_reply(call);',
+                     'handle_%s(%s,' % (m.snake, ', '.join(['call'] + [a.name for a in m.in_args])),
+                     '    [deferred](%s) mutable {' % done_params,
+                     '        if (error) {',
+                     '            deferred.send_error(error.name, error.text);',
+                     '            return;',
+                     '        }']
+            if m.out_args:
+                body += ['        Message reply = deferred.new_method_return();',
+                         '        if (reply) append_%s_reply(%s);' % (m.snake, ', '.join(['reply'] + [a.name for a in m.out_args])),
+                         '        deferred.send(std::move(reply));']
+            else:
+                body.append('        deferred.send(deferred.new_method_return());')
+            body += ['    });',
+                     'return Message();']
+            out += indent(body, 4)
+            out.append('            }')
+            continue
+        handler_args = ', '.join(['call'] + [a.name for a in m.in_args + m.out_args])
+        body += ['MethodError error = handle_%s(%s);' % (m.snake, handler_args),
+                 'if (error) return call.new_error(error.name, error.text);',
+                 '']
+        if m.out_args:
+            body += ['Message reply = call.new_method_return();',
+                     'if (reply) append_%s_reply(%s);' % (m.snake, ', '.join(['reply'] + [a.name for a in m.out_args])),
+                     'return reply;']
+        else:
+            body.append('return call.new_method_return();')
+        out += indent(body, 4)
+        out.append('            }')
+    out += ['            default:',
+            '                return Message();',
+            '        }',
+            '    }']
+    if iface.properties:
+        out.append('')
+    for p in iface.properties:
+        out.append('    %s' % local_decl(p.type, p.member))
+    out += ['};',
+            '']
+
+    for index, name in enumerate(names):
+        out.append('static_assert(%s::lookup_method("%s") == %d, "perfect hash");' % (cls, name, index))
+    if names:
+        out.append('')
+    return out
+
+
+def emit_proxy(iface):
+    cls = iface.short + 'Proxy'
+    out = ['/**',
+           ' * @brief Client side of %s' % iface.name,
+           ' *',
+           ' * Calls go out on the given connection and complete on its event loop.',
+           ' * Reply callbacks get the error name (nullptr on success) followed by',
+           ' * the out arguments; received unix fds belong to the callback. Without',
+           ' * a callback the call is sent with no reply expected.']
+    if iface.properties:
+        out += [' *',
+                ' * Properties are mirrored locally once watch_properties() is called:',
+                ' * one GetAll, then PropertiesChanged keeps the copy current, so reading',
+                ' * them costs no bus traffic.']
+    out += [' */',
+           'class %s {' % cls,
+           'public:',
+           '    static constexpr const char* INTERFACE = "%s";' % iface.name,
+           '    static constexpr const char* DEFAULT_PATH = "%s";' % iface.path,
+           '',
+           '    explicit %s(DBusInterface& bus, const std::string& destination = INTERFACE,' % cls,
+           '%sconst std::string& path = DEFAULT_PATH)' % (' ' * (len('    explicit (') + len(cls))),
+           '        : bus_(bus)',
+           '        , destination_(destination)',
+           '        , path_(path) {',
+           '    }',
+           '']
+
+    if iface.properties:
+        out += ['    /**',
+                '     * @brief Start mirroring the properties of the remote object',
+                '     * @param changed Called on the event loop after each update',
+                '     */',
+                '    void watch_properties(std::function<void()> changed = nullptr) {',
+                '        properties_changed_ = std::move(changed);',
+                '        bus_.register_signal_handler(DBUS_PROPERTIES_INTERFACE, "PropertiesChanged",',
+                '            [this](Message& msg) {',
+                '                const char* path = msg.get_path();',
+                '                std::string interface;',
+                '                if (!path || path_ != path || !msg.read(interface) || interface != INTERFACE) {',
+                '                    return;',
+                '                }',
+                '                if (read_properties(msg) && properties_changed_) properties_changed_();',
+                '            });',
+                '        refresh_properties();',
+                '    }',
+                '',
+                '    /**',
+                '     * @brief Re-read every property, e.g. after the service restarted',
+                '     */',
+                '    bool refresh_properties() {',
+                '        Message msg = bus_.new_method_call(destination_, path_, DBUS_PROPERTIES_INTERFACE, "GetAll");',
+                '        if (msg) msg.append(INTERFACE);',
+                '        return bus_.call_method_async(std::move(msg), [this](Message& reply) {',
+                '            if (reply_error(reply) || !read_properties(reply)) return;',
+                '            if (properties_changed_) properties_changed_();',
+                '        });',
+                '    }',
+                '']
+        for p in iface.properties:
+            out += ['    // %s (%s), as last received' % (p.name, p.type),
+                    '    ' + property_getter(p)]
+        out.append('')
+
+    for m in iface.methods:
+        cb_types = ', '.join(['const char* error'] + ['%s %s' % (cpp_type(a.type) if is_scalar(a.type)
+                                                                   else 'const %s&' % cpp_type(a.type), a.name)
+                                                      for a in m.out_args])
+        reply_type = '%sReply' % m.name
+        params = ', '.join([in_param(a.type, a.name) for a in m.in_args] +
+                           ['%s done = nullptr' % reply_type, 'int call_timeout_ms = -1'])
+        out += ['    using %s = std::function<void(%s)>;' % (reply_type, cb_types),
+                '',
+                '    // %s' % describe(m),
+                '    bool %s(%s) {' % (m.snake, params),
+                '        Message msg = bus_.new_method_call(destination_, path_, INTERFACE, "%s");' % m.name]
+        if m.in_args:
+            out.append('        if (msg) append_%s_args(%s);' % (m.snake, ', '.join(['msg'] + [a.name for a in m.in_args])))
+        out += ['',
+                '        DBusInterface::ReplyHandler handler;',
+                '        if (done) {',
+                '            handler = [done](Message& reply) {',
+                '                const char* error = reply_error(reply);']
+        body = [local_decl(a.type, a.name) for a in m.out_args]
+        if m.out_args:
+            body += ['if (!error && !read_%s_reply(%s)) {' % (m.snake, ', '.join(['reply'] + [a.name for a in m.out_args])),
+                     '    error = DBUS_ERROR_INVALID_ARGS;',
+                     '}']
+        body.append('done(%s);' % ', '.join(['error'] + [a.name for a in m.out_args]))
+        out += indent(body, 4)
+        out += ['            };',
+                '        }',
+                '        return bus_.call_method_async(std::move(msg), std::move(handler), call_timeout_ms);',
+                '    }',
+                '']
+
+    for s in iface.signals:
+        cb_types = ', '.join('%s %s' % (cpp_type(a.type) if is_scalar(a.type)
+                                        else 'const %s&' % cpp_type(a.type), a.name) for a in s.in_args)
+        handler_type = '%sHandler' % s.name
+        out += ['    using %s = std::function<void(%s)>;' % (handler_type, cb_types),
+                '',
+                '    // %s, from any sender' % describe(s),
+                '    void on_%s(%s handler) {' % (s.snake, handler_type),
+                '        bus_.register_signal_handler(INTERFACE, "%s", [handler](Message& msg) {' % s.name]
+        body = [local_decl(a.type, a.name) for a in s.in_args]
+        if s.in_args:
+            body += ['if (read_%s_args(%s)) {' % (s.snake, ', '.join(['msg'] + [a.name for a in s.in_args])),
+                     '    handler(%s);' % ', '.join(a.name for a in s.in_args),
+                     '}']
+        else:
+            body.append('handler();')
+        out += indent(body, 3)
+        out += ['        });',
+                '    }',
+                '']
+
+    out.append('private:')
+    for m in iface.methods:
+        if m.in_args:
+            out += indent(writer('append_%s_args' % m.snake, m.in_args), 1)
+            out.append('')
+        if m.out_args:
+            out += indent(reader('read_%s_reply' % m.snake, m.out_args), 1)
+            out.append('')
+    for s in iface.signals:
+        if s.in_args:
+            out += indent(reader('read_%s_args' % s.snake, s.in_args), 1)
+            out.append('')
+
+    if iface.properties:
+        out += ['    // Entries of an a{sv}; names this version does not know are skipped',
+                '    bool read_properties(Message& msg) {',
+                '        if (!msg.enter(\'a\', "{sv}")) return false;',
+                '        while (!msg.at_end()) {',
+                '            std::string name;',
+                '            if (!msg.enter(\'e\', "sv") || !msg.read(name)) return false;']
+        for index, p in enumerate(iface.properties):
+            keyword = 'if' if index == 0 else '} else if'
+            out += ['            %s (name == "%s") {' % (keyword, p.name),
+                    '                if (!read_%s_property(msg)) return false;' % p.snake]
+        out += ['            } else if (!msg.skip()) {',
+                '                return false;',
+                '            }',
+                '            if (!msg.exit()) return false;',
+                '        }',
+                '        return msg.exit();',
+                '    }',
+                '']
+        for p in iface.properties:
+            body = [local_decl(p.type, 'value'),
+                    'if (!msg.enter(\'v\', "%s")) return false;' % p.type]
+            body += read_code(p.type, 'value')
+            body += ['if (!msg.exit()) return false;',
+                     '%s = std::move(value);' % p.member,
+                     'return true;']
+            out += ['    bool read_%s_property(Message& msg) {' % p.snake]
+            out += indent(body, 2)
+            out += ['    }', '']
+
+    out += ['    DBusInterface& bus_;',
+            '    std::string destination_;',
+            '    std::string path_;']
+    if iface.properties:
+        out.append('    std::function<void()> properties_changed_;')
+        for p in iface.properties:
+            out.append('    %s' % local_decl(p.type, p.member))
+    out += ['};',
+            '']
+    return out
+
+
+def generate(output, xml_files):
+    interfaces = []
+    for path in xml_files:
+        try:
+            root = ET.parse(path).getroot()
+        except ET.ParseError as e:
+            raise CodegenError('%s: %s' % (path, e))
+        for element in root.findall('interface'):
+            interfaces.append(Interface(element, root.get('name')))
+
+    guard = 'TOUCHDOWN_DBUS_%s' % re.sub(r'[^A-Za-z0-9]', '_', os.path.basename(output)).upper()
+    sources = ', '.join(os.path.basename(p) for p in xml_files)
+
+    out = ['/**',
+           ' * @file %s' % os.path.basename(output),
+           ' * @brief %s stub and proxy' % ', '.join(i.name for i in interfaces),
+           ' *',
+           ' * Generated by td-dbus-codegen from %s. Do not edit.' % sources,
+           ' */',
+           '',
+           '#ifndef %s' % guard,
+           '#define %s' % guard,
+           '',
+           '#include "touchdown/services/dbus_stub.hpp"',
+           '#include <cstdint>',
+           '#include <functional>',
+           '#include <string>',
+           '#include <string_view>',
+           '#include <tuple>',
+           '#include <vector>',
+           '',
+           'namespace touchdown {',
+           'namespace services {',
+           '']
+    for iface in interfaces:
+        out += emit_stub(iface)
+        out += emit_proxy(iface)
+    out += ['} // namespace services',
+            '} // namespace touchdown',
+            '',
+            '#endif // %s' % guard,
+            '']
+
+    text = '\n'.join(out)
+
+    # Leave the file alone when nothing changed so dependents don't rebuild
+    try:
+        with open(output) as f:
+            if f.read() == text:
+                return
+    except OSError:
+        pass
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, 'w') as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate D-Bus stubs and proxies')
+    parser.add_argument('--output', required=True, help='header to write')
+    parser.add_argument('xml', nargs='+', help='introspection XML')
+    args = parser.parse_args()
+
+    try:
+        generate(args.output, args.xml)
+    except CodegenError as e:
+        print('td-dbus-codegen: error: %s' % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -7,6 +7,7 @@
 #include "touchdown/app/app_registry.hpp"
 #include "touchdown/shell/theme_engine.hpp"
 #include "touchdown/shell/circular_layout.hpp"
+#include "touchdown/client/system_client.hpp"
 #include "touchdown/core/logger.hpp"
 #include "touchdown/core/config.hpp"
 
@@ -122,7 +123,21 @@ void SettingsApp::on_brightness_adjust() {
     Config::instance().set_int("display.brightness", new_brightness);
     Config::instance().save("/etc/touchdown/shell.conf");
     
-    // Send D-Bus message to power service to update brightness
+    // The power service owns the backlight; the reply arrives on the UI loop
+    auto* power = client::SystemClient::instance().power();
+    if (!power) {
+        TD_LOG_WARNING("SettingsApp", "No bus connection, brightness only saved");
+        return;
+    }
+    
+    auto on_reply = [new_brightness](const char* error) {
+        if (error) {
+            TD_LOG_ERROR("SettingsApp", "SetBrightness failed: ", error);
+        } else {
+            TD_LOG_DEBUG("SettingsApp", "Brightness applied: ", new_brightness);
+        }
+    };
+    power->set_brightness(static_cast<uint8_t>(new_brightness), guard_.wrap(on_reply));
 }
 
 void SettingsApp::on_about() {
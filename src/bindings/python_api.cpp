@@ -7,8 +7,13 @@
 #include <pybind11/functional.h>
 #include <pybind11/stl.h>
 #include "touchdown/app/app.hpp"
+#include "touchdown/client/system_client.hpp"
+#include "touchdown/core/event_loop.hpp"
 #include "touchdown/core/types.hpp"
 #include "lvgl.h"
+#include <memory>
+#include <string>
+#include <unistd.h>
 
 namespace py = pybind11;
 
@@ -144,6 +149,121 @@ public:
     }
 };
 
+/**
+ * @brief Bus connection of a Python app's own process
+ *
+ * Python apps run outside the shell, so there is no shell connection to
+ * share. The name is per process, as an app may run more than once.
+ */
+class AppConnection : public services::DBusInterface {
+public:
+    AppConnection()
+        : DBusInterface("org.touchdown.App.pid" + std::to_string(getpid()), "/org/touchdown/App") {}
+};
+
+/**
+ * @brief System service calls for Python apps
+ *
+ * connect() opens the process's connection and attaches SystemClient to
+ * it. The app's own loop drives it: watch fileno() and call dispatch()
+ * whenever it is readable. Same rules as SystemClient otherwise: nothing
+ * blocks, callbacks run from dispatch(), and calls fail (return False)
+ * until connected. Callbacks receive the D-Bus error name, or None, first.
+ */
+class SystemServices {
+public:
+    using DoneCallback = std::function<void(const char* error)>;
+    using PowerStateCallback = std::function<void(const char* error, const std::string& state)>;
+    using TouchCallback = std::function<void(const char* error, int16_t x, int16_t y, uint32_t timestamp_ms)>;
+    
+    static bool connect() {
+        std::unique_ptr<Connection>& connection = get_connection();
+        if (connection) return true;
+        
+        auto opened = std::make_unique<Connection>();
+        if (!opened->loop.init() || !opened->bus.init(opened->loop)) {
+            return false;
+        }
+        
+        client::SystemClient::instance().attach(opened->bus);
+        connection = std::move(opened);
+        return true;
+    }
+    
+    static void disconnect() {
+        std::unique_ptr<Connection>& connection = get_connection();
+        if (!connection) return;
+        
+        // Pending callbacks hold Python objects; drop them while Python runs
+        client::SystemClient::instance().detach();
+        connection.reset();
+    }
+    
+    static int fileno() {
+        const std::unique_ptr<Connection>& connection = get_connection();
+        return connection ? connection->loop.get_fd() : -1;
+    }
+    
+    static void dispatch() {
+        const std::unique_ptr<Connection>& connection = get_connection();
+        if (connection) connection->loop.run_once(0);
+    }
+    
+    static bool is_available() {
+        return client::SystemClient::instance().is_attached();
+    }
+    
+    static bool set_brightness(uint8_t brightness, DoneCallback done) {
+        auto* power = client::SystemClient::instance().power();
+        return power && power->set_brightness(brightness, guarded(std::move(done)));
+    }
+    
+    static bool set_power_state(const std::string& state, DoneCallback done) {
+        auto* power = client::SystemClient::instance().power();
+        return power && power->set_power_state(state, guarded(std::move(done)));
+    }
+    
+    static bool get_power_state(PowerStateCallback done) {
+        auto* power = client::SystemClient::instance().power();
+        return power && power->get_power_state(guarded(std::move(done)));
+    }
+    
+    static bool reset_idle_timer() {
+        auto* power = client::SystemClient::instance().power();
+        return power && power->reset_idle_timer();
+    }
+    
+    static bool get_last_touch(TouchCallback done) {
+        auto* input = client::SystemClient::instance().input();
+        return input && input->get_last_touch(guarded(std::move(done)));
+    }
+    
+private:
+    // The bus unregisters from the loop, so it goes first
+    struct Connection {
+        EventLoop loop;
+        AppConnection bus;
+    };
+    
+    static std::unique_ptr<Connection>& get_connection() {
+        static std::unique_ptr<Connection> connection;
+        return connection;
+    }
+    
+    // A Python exception must not unwind through the bus library
+    template <typename... Args>
+    static std::function<void(Args...)> guarded(std::function<void(Args...)> callback) {
+        if (!callback) return nullptr;
+        return [callback](Args... args) {
+            try {
+                callback(args...);
+            } catch (py::error_already_set& e) {
+                e.discard_as_unraisable("touchdown.System callback");
+            }
+        };
+    }
+};
+
 PYBIND11_MODULE(touchdown, m) {
     m.doc() = "TouchdownOS Python API";
     
@@ -228,6 +348,24 @@ PYBIND11_MODULE(touchdown, m) {
         .def_static("set_style_bg_color", &LVGLWidget::set_style_bg_color)
         .def_static("set_style_text_color", &LVGLWidget::set_style_text_color);
     
+    // System services (non-blocking, replies from System.dispatch())
+    py::class_<SystemServices>(m, "System")
+        .def_static("connect", &SystemServices::connect)
+        .def_static("disconnect", &SystemServices::disconnect)
+        .def_static("fileno", &SystemServices::fileno)
+        .def_static("dispatch", &SystemServices::dispatch)
+        .def_static("is_available", &SystemServices::is_available)
+        .def_static("set_brightness", &SystemServices::set_brightness,
+                    py::arg("brightness"), py::arg("done") = nullptr)
+        .def_static("set_power_state", &SystemServices::set_power_state,
+                    py::arg("state"), py::arg("done") = nullptr)
+        .def_static("get_power_state", &SystemServices::get_power_state, py::arg("done"))
+        .def_static("reset_idle_timer", &SystemServices::reset_idle_timer)
+        .def_static("get_last_touch", &SystemServices::get_last_touch, py::arg("done"));
+    
+    // Before the interpreter goes, while the callbacks' objects can be freed
+    py::module::import("atexit").attr("register")(py::cpp_function(&SystemServices::disconnect));
+    
     // LVGL constants
     m.attr("ALIGN_CENTER") = LV_ALIGN_CENTER;
     m.attr("ALIGN_TOP_LEFT") = LV_ALIGN_TOP_LEFT;
@@ -0,0 +1,33 @@
+/**
+ * @file system_client.cpp
+ * @brief Shared proxies for the system services
+ */
+
+#include "touchdown/client/system_client.hpp"
+#include "touchdown/core/logger.hpp"
+
+namespace touchdown {
+namespace client {
+
+SystemClient& SystemClient::instance() {
+    static SystemClient client;
+    return client;
+}
+
+void SystemClient::attach(services::DBusInterface& bus) {
+    bus_ = &bus;
+    power_ = std::make_unique<services::PowerProxy>(bus);
+    input_ = std::make_unique<services::InputProxy>(bus);
+
+    TD_LOG_DEBUG("SystemClient", "Attached to ", services::DBusInterface::get_backend_name(),
+                 " connection");
+}
+
+void SystemClient::detach() {
+    power_.reset();
+    input_.reset();
+    bus_ = nullptr;
+}
+
+} // namespace client
+} // namespace touchdown
@@ -0,0 +1,166 @@
+/**
+ * @file activity_page.cpp
+ * @brief Shared activity page implementation
+ */
+
+#include "touchdown/core/activity_page.hpp"
+#include "touchdown/core/logger.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010  // Linux 5.1
+#endif
+
+namespace touchdown {
+
+constexpr uint32_t PAGE_MAGIC = 0x54444150;  // "TDAP"
+constexpr uint32_t PAGE_VERSION = 1;
+
+// An update is a few stores; a writer still mid-update after this many
+// tries has been frozen or killed, and the reader must not spin on it
+constexpr int READ_ATTEMPTS = 256;
+
+ActivityPage::ActivityPage()
+    : fd_(-1)
+    , size_(0)
+    , page_(nullptr) {
+}
+
+ActivityPage::~ActivityPage() {
+    destroy();
+}
+
+bool ActivityPage::create() {
+    fd_ = memfd_create("touchdown-activity", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd_ < 0) {
+        TD_LOG_ERROR("ActivityPage", "Failed to create memfd");
+        return false;
+    }
+
+    size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if (ftruncate(fd_, size_) < 0) {
+        TD_LOG_ERROR("ActivityPage", "Failed to size page");
+        destroy();
+        return false;
+    }
+
+    void* mem = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mem == MAP_FAILED) {
+        TD_LOG_ERROR("ActivityPage", "Failed to map page");
+        destroy();
+        return false;
+    }
+
+    page_ = static_cast<ActivityPageLayout*>(mem);
+    page_->magic = PAGE_MAGIC;
+    page_->version = PAGE_VERSION;
+    page_->sequence.store(0, std::memory_order_release);
+
+    if (fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE) < 0) {
+        TD_LOG_WARNING("ActivityPage", "Failed to seal page, readers could modify it");
+    }
+
+    return true;
+}
+
+void ActivityPage::destroy() {
+    if (page_) {
+        munmap(page_, size_);
+        page_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+void ActivityPage::record(InputEvent::Kind kind, uint64_t timestamp_us) {
+    if (!page_) return;
+
+    uint32_t seq = page_->sequence.load(std::memory_order_relaxed);
+    page_->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    page_->record.last_activity_us = timestamp_us;
+    if (kind == InputEvent::Kind::TOUCH) {
+        page_->record.touch_count++;
+    } else {
+        page_->record.button_count++;
+    }
+
+    page_->sequence.store(seq + 2, std::memory_order_release);
+}
+
+ActivityPageReader::ActivityPageReader()
+    : fd_(-1)
+    , size_(0)
+    , page_(nullptr) {
+}
+
+ActivityPageReader::~ActivityPageReader() {
+    detach();
+}
+
+bool ActivityPageReader::attach(int fd) {
+    detach();
+    fd_ = fd;
+
+    struct stat st;
+    if (fstat(fd_, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(ActivityPageLayout)) {
+        TD_LOG_ERROR("ActivityPageReader", "Invalid activity page fd");
+        detach();
+        return false;
+    }
+
+    size_ = st.st_size;
+    void* mem = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mem == MAP_FAILED) {
+        TD_LOG_ERROR("ActivityPageReader", "Failed to map activity page");
+        size_ = 0;
+        detach();
+        return false;
+    }
+
+    page_ = static_cast<const ActivityPageLayout*>(mem);
+    if (page_->magic != PAGE_MAGIC || page_->version != PAGE_VERSION) {
+        TD_LOG_ERROR("ActivityPageReader", "Activity page layout mismatch");
+        detach();
+        return false;
+    }
+
+    return true;
+}
+
+void ActivityPageReader::detach() {
+    if (page_) {
+        munmap(const_cast<ActivityPageLayout*>(page_), size_);
+        page_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool ActivityPageReader::read(ActivityRecord& record) const {
+    if (!page_) return false;
+
+    for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+        uint32_t seq = page_->sequence.load(std::memory_order_acquire);
+        if (seq & 1) continue;  // Writer is mid-update, a few stores from done
+
+        std::memcpy(&record, &page_->record, sizeof(record));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (page_->sequence.load(std::memory_order_relaxed) == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace touchdown
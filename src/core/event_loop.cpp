@@ -0,0 +1,282 @@
+/**
+ * @file event_loop.cpp
+ * @brief epoll reactor implementation
+ */
+
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/core/logger.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <csignal>
+#include <cerrno>
+#include <ctime>
+
+namespace touchdown {
+
+constexpr int MAX_EVENTS = 16;
+
+EventLoop::EventLoop()
+    : epoll_fd_(-1)
+    , wake_fd_(-1)
+    , signal_fd_(-1)
+    , running_(false)
+    , wakeups_(0)
+    , next_timer_id_(0) {
+}
+
+EventLoop::~EventLoop() {
+    for (auto& [id, timer] : timers_) {
+        close(timer.fd);
+    }
+
+    if (signal_fd_ >= 0) close(signal_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+}
+
+bool EventLoop::init() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        TD_LOG_ERROR("EventLoop", "Failed to create epoll instance");
+        return false;
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        TD_LOG_ERROR("EventLoop", "Failed to create wakeup eventfd");
+        return false;
+    }
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd_ < 0) {
+        TD_LOG_ERROR("EventLoop", "Failed to create signalfd");
+        return false;
+    }
+
+    add_fd(wake_fd_, EPOLLIN, [this](uint32_t) { handle_wakeup(); });
+    add_fd(signal_fd_, EPOLLIN, [this](uint32_t) { handle_signal(); });
+
+    return true;
+}
+
+void EventLoop::run() {
+    running_ = true;
+
+    while (running_) {
+        run_once(-1);
+    }
+}
+
+void EventLoop::run_once(int timeout_ms) {
+    struct epoll_event events[MAX_EVENTS];
+
+    int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+    wakeups_++;
+
+    if (count < 0) {
+        if (errno != EINTR) {
+            TD_LOG_ERROR("EventLoop", "epoll_wait failed: ", errno);
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        auto it = fd_callbacks_.find(events[i].data.fd);
+        if (it == fd_callbacks_.end()) continue;  // Removed by an earlier callback
+
+        // Hold a reference so the callback may remove itself
+        std::shared_ptr<FdCallback> callback = it->second;
+        (*callback)(events[i].events);
+    }
+}
+
+void EventLoop::stop() {
+    running_ = false;
+
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        // Counter saturated, the loop is already due to wake
+    }
+}
+
+void EventLoop::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        posted_.push_back(std::move(task));
+    }
+
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        // Counter saturated, the loop is already due to wake
+    }
+}
+
+bool EventLoop::add_fd(int fd, uint32_t events, FdCallback callback) {
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        TD_LOG_ERROR("EventLoop", "Failed to watch fd ", fd, ": ", errno);
+        return false;
+    }
+
+    fd_callbacks_[fd] = std::make_shared<FdCallback>(std::move(callback));
+    return true;
+}
+
+bool EventLoop::modify_fd(int fd, uint32_t events) {
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EventLoop::remove_fd(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    fd_callbacks_.erase(fd);
+}
+
+EventLoop::TimerId EventLoop::add_timer(TimerCallback callback) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        TD_LOG_ERROR("EventLoop", "Failed to create timerfd");
+        return INVALID_TIMER;
+    }
+
+    TimerId id = next_timer_id_++;
+    timers_[id] = Timer{fd, std::move(callback)};
+
+    add_fd(fd, EPOLLIN, [this, id, fd](uint32_t) {
+        uint64_t expirations;
+        if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            return;  // Re-armed or disarmed since it fired
+        }
+
+        auto it = timers_.find(id);
+        if (it != timers_.end()) {
+            TimerCallback callback = it->second.callback;
+            callback();
+        }
+    });
+
+    return id;
+}
+
+void EventLoop::arm_timer(TimerId id, uint32_t delay_ms, uint32_t interval_ms) {
+    auto it = timers_.find(id);
+    if (it == timers_.end()) return;
+
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = delay_ms / 1000;
+    spec.it_value.tv_nsec = (delay_ms % 1000) * 1000000L;
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+
+    // A zero it_value disarms the timer, expire immediately instead
+    if (delay_ms == 0) {
+        spec.it_value.tv_nsec = 1;
+    }
+
+    timerfd_settime(it->second.fd, 0, &spec, nullptr);
+}
+
+void EventLoop::arm_timer_at(TimerId id, uint64_t deadline_us) {
+    auto it = timers_.find(id);
+    if (it == timers_.end()) return;
+
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = deadline_us / 1000000;
+    spec.it_value.tv_nsec = (deadline_us % 1000000) * 1000L;
+
+    if (deadline_us == 0) {
+        spec.it_value.tv_nsec = 1;
+    }
+
+    timerfd_settime(it->second.fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void EventLoop::disarm_timer(TimerId id) {
+    auto it = timers_.find(id);
+    if (it == timers_.end()) return;
+
+    struct itimerspec spec = {};
+    timerfd_settime(it->second.fd, 0, &spec, nullptr);
+}
+
+void EventLoop::remove_timer(TimerId id) {
+    auto it = timers_.find(id);
+    if (it == timers_.end()) return;
+
+    remove_fd(it->second.fd);
+    close(it->second.fd);
+    timers_.erase(it);
+}
+
+bool EventLoop::add_signal(int signo, SignalCallback callback) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (const auto& [registered, cb] : signal_callbacks_) {
+        sigaddset(&mask, registered);
+    }
+    sigaddset(&mask, signo);
+
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+        TD_LOG_ERROR("EventLoop", "Failed to block signal: ", signo);
+        return false;
+    }
+
+    if (signalfd(signal_fd_, &mask, 0) < 0) {
+        TD_LOG_ERROR("EventLoop", "Failed to update signalfd for signal: ", signo);
+        return false;
+    }
+
+    signal_callbacks_[signo] = std::move(callback);
+    return true;
+}
+
+uint64_t EventLoop::now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+void EventLoop::handle_wakeup() {
+    uint64_t value;
+    if (read(wake_fd_, &value, sizeof(value)) < 0) {
+        // Spurious wakeup, nothing queued
+    }
+
+    run_posted();
+}
+
+void EventLoop::handle_signal() {
+    struct signalfd_siginfo info;
+
+    while (read(signal_fd_, &info, sizeof(info)) == sizeof(info)) {
+        auto it = signal_callbacks_.find(static_cast<int>(info.ssi_signo));
+        if (it != signal_callbacks_.end()) {
+            it->second(static_cast<int>(info.ssi_signo));
+        }
+    }
+}
+
+void EventLoop::run_posted() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        tasks.swap(posted_);
+    }
+
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+} // namespace touchdown
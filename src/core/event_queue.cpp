@@ -0,0 +1,118 @@
+/**
+ * @file event_queue.cpp
+ * @brief Input event queue implementation
+ */
+
+#include "touchdown/core/event_queue.hpp"
+#include "touchdown/core/logger.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace touchdown {
+
+InputEventQueue::InputEventQueue()
+    : loop_(nullptr)
+    , wake_fd_(-1)
+    , wake_pending_(false)
+    , dropped_(0)
+    , dispatched_(0)
+    , max_delay_us_(0)
+    , total_delay_us_(0) {
+}
+
+InputEventQueue::~InputEventQueue() {
+    if (wake_fd_ >= 0) {
+        if (loop_) loop_->remove_fd(wake_fd_);
+        close(wake_fd_);
+    }
+}
+
+bool InputEventQueue::init(EventLoop& loop, Handler handler) {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        TD_LOG_ERROR("InputEventQueue", "Failed to create eventfd");
+        return false;
+    }
+
+    loop_ = &loop;
+    handler_ = std::move(handler);
+
+    return loop_->add_fd(wake_fd_, EPOLLIN, [this](uint32_t) {
+        uint64_t value;
+        if (read(wake_fd_, &value, sizeof(value)) < 0) {
+            // Already drained at the start of a loop iteration
+        }
+        drain();
+    });
+}
+
+bool InputEventQueue::post(const TouchPoint& point) {
+    InputEvent event = {};
+    event.kind = InputEvent::Kind::TOUCH;
+    event.touch = point;
+    return post(event);
+}
+
+bool InputEventQueue::post(const ButtonEvent& button) {
+    InputEvent event = {};
+    event.kind = InputEvent::Kind::BUTTON;
+    event.button = button;
+    return post(event);
+}
+
+bool InputEventQueue::post(InputEvent& event) {
+    event.posted_us = EventLoop::now_us();
+
+    if (!queue_.push(event)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    wake();
+    return true;
+}
+
+void InputEventQueue::wake() {
+    // Pairs with the fence in drain(): either this exchange sees the
+    // consumer's false, or the consumer's pop sees the event just pushed
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // Only the first producer after a drain pays for the syscall
+    if (wake_pending_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        // Counter saturated, the consumer is already due to wake
+    }
+}
+
+void InputEventQueue::drain() {
+    // Clear before popping: a post racing with the drain re-arms the wakeup
+    wake_pending_.store(false, std::memory_order_release);
+
+    // Without a full fence the store can sit in the store buffer while the
+    // pops below already run (StoreLoad reordering). The queue would then
+    // look empty here while a producer still reads true and skips the
+    // eventfd write, stranding its event until an unrelated post.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    InputEvent event;
+    while (queue_.pop(event)) {
+        uint64_t delay_us = EventLoop::now_us() - event.posted_us;
+        dispatched_++;
+        total_delay_us_ += delay_us;
+        if (delay_us > max_delay_us_) {
+            max_delay_us_ = delay_us;
+            TD_LOG_DEBUG("InputEventQueue", "New max queueing delay: ", delay_us, "us");
+        }
+
+        if (handler_) {
+            handler_(event);
+        }
+    }
+}
+
+} // namespace touchdown
@@ -0,0 +1,110 @@
+/**
+ * @file frame_feedback.cpp
+ * @brief Frame-time reports and frequency floor controller
+ */
+
+#include "touchdown/core/frame_feedback.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace touchdown {
+
+namespace {
+
+uint32_t saturate(uint64_t value) {
+    return static_cast<uint32_t>(std::min<uint64_t>(value, std::numeric_limits<uint32_t>::max()));
+}
+
+} // namespace
+
+FrameStats::FrameStats(uint32_t deadline_us)
+    : deadline_us_(deadline_us)
+    , window_start_us_(0) {
+}
+
+void FrameStats::add(uint64_t start_us, uint64_t render_us) {
+    if (current_.frames == 0) {
+        window_start_us_ = start_us;
+    }
+
+    current_.frames++;
+    if (render_us > deadline_us_) {
+        current_.missed++;
+    }
+    current_.busy_us = saturate(current_.busy_us + render_us);
+    current_.max_us = std::max(current_.max_us, saturate(render_us));
+}
+
+bool FrameStats::take(uint64_t now_us, uint64_t interval_us, FrameReport& report) {
+    if (current_.frames == 0 || now_us - window_start_us_ < interval_us) {
+        return false;
+    }
+
+    current_.window_us = saturate(now_us - window_start_us_);
+    report = current_;
+    current_ = FrameReport();
+    return true;
+}
+
+FrameFloorController::FrameFloorController(const FrameFloorConfig& config)
+    : floor_khz_(0)
+    , quiet_reports_(0)
+    , raises_(0) {
+    configure(config);
+}
+
+void FrameFloorController::configure(const FrameFloorConfig& config) {
+    config_ = config;
+    config_.min_khz = std::min(config_.min_khz, config_.max_khz);
+    reset();
+}
+
+uint32_t FrameFloorController::update(const FrameReport& report) {
+    if (!is_enabled() || report.frames == 0) {
+        return floor_khz_;
+    }
+
+    uint64_t raise_us = static_cast<uint64_t>(config_.deadline_us) * config_.raise_percent / 100;
+    uint64_t lower_us = static_cast<uint64_t>(config_.deadline_us) * config_.lower_percent / 100;
+
+    if (report.missed > 0 || report.max_us > raise_us) {
+        quiet_reports_ = 0;
+        if (floor_khz_ >= config_.max_khz) {
+            return floor_khz_;
+        }
+
+        // A near miss takes one step; each missed frame another
+        uint32_t steps = std::min(std::max(report.missed, 1u), MAX_RAISE_STEPS);
+        uint64_t khz = floor_khz_ == 0
+            ? config_.min_khz + static_cast<uint64_t>(steps - 1) * config_.step_khz
+            : floor_khz_ + static_cast<uint64_t>(steps) * config_.step_khz;
+        floor_khz_ = static_cast<uint32_t>(std::min<uint64_t>(khz, config_.max_khz));
+        raises_++;
+        return floor_khz_;
+    }
+
+    if (report.max_us >= lower_us || floor_khz_ == 0) {
+        // Comfortable: keep the floor where it is
+        quiet_reports_ = 0;
+        return floor_khz_;
+    }
+
+    if (++quiet_reports_ < config_.hold_reports) {
+        return floor_khz_;
+    }
+
+    quiet_reports_ = 0;
+    if (floor_khz_ < config_.min_khz + config_.step_khz) {
+        floor_khz_ = 0;
+    } else {
+        floor_khz_ -= config_.step_khz;
+    }
+    return floor_khz_;
+}
+
+void FrameFloorController::reset() {
+    floor_khz_ = 0;
+    quiet_reports_ = 0;
+}
+
+} // namespace touchdown
@@ -0,0 +1,216 @@
+/**
+ * @file input_ring.cpp
+ * @brief Shared-memory input ring implementation
+ */
+
+#include "touchdown/core/input_ring.hpp"
+#include "touchdown/core/logger.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010  // Linux 5.1
+#endif
+
+namespace touchdown {
+
+constexpr uint32_t RING_MAGIC = 0x54444952;  // "TDIR"
+constexpr uint32_t RING_VERSION = 2;
+
+namespace {
+
+size_t ring_size(uint32_t capacity) {
+    size_t size = sizeof(InputRingHeader) + capacity * sizeof(InputRingSlot);
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return (size + page - 1) & ~(page - 1);
+}
+
+} // namespace
+
+InputRing::InputRing()
+    : fd_(-1)
+    , size_(0)
+    , header_(nullptr)
+    , slots_(nullptr) {
+}
+
+InputRing::~InputRing() {
+    destroy();
+}
+
+bool InputRing::create(uint32_t capacity) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        TD_LOG_ERROR("InputRing", "Capacity must be a power of two: ", capacity);
+        return false;
+    }
+
+    fd_ = memfd_create("touchdown-input-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd_ < 0) {
+        TD_LOG_ERROR("InputRing", "Failed to create memfd");
+        return false;
+    }
+
+    size_ = ring_size(capacity);
+    if (ftruncate(fd_, size_) < 0) {
+        TD_LOG_ERROR("InputRing", "Failed to size ring");
+        destroy();
+        return false;
+    }
+
+    void* mem = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mem == MAP_FAILED) {
+        TD_LOG_ERROR("InputRing", "Failed to map ring");
+        destroy();
+        return false;
+    }
+
+    header_ = static_cast<InputRingHeader*>(mem);
+    slots_ = reinterpret_cast<InputRingSlot*>(header_ + 1);
+
+    // Fresh memfd pages are zero: every slot starts with sequence 0
+    header_->magic = RING_MAGIC;
+    header_->version = RING_VERSION;
+    header_->capacity = capacity;
+    header_->slot_size = sizeof(InputRingSlot);
+    header_->write_index.store(0, std::memory_order_release);
+
+    // Readers must not resize the ring under us or map it writable
+    if (fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE) < 0) {
+        TD_LOG_WARNING("InputRing", "Failed to seal ring, readers could modify it");
+    }
+
+    TD_LOG_INFO("InputRing", "Created input ring: ", capacity, " slots, ", size_, " bytes");
+    return true;
+}
+
+void InputRing::destroy() {
+    if (header_) {
+        munmap(header_, size_);
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+void InputRing::publish(const InputEvent& event) {
+    if (!header_) return;
+
+    uint64_t index = header_->write_index.load(std::memory_order_relaxed);
+    InputRingSlot& slot = slots_[index & (header_->capacity - 1)];
+
+    slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.event = event;
+
+    slot.sequence.store(index * 2 + 2, std::memory_order_release);
+    header_->write_index.store(index + 1, std::memory_order_release);
+}
+
+InputRingReader::InputRingReader()
+    : fd_(-1)
+    , size_(0)
+    , header_(nullptr)
+    , slots_(nullptr)
+    , capacity_(0)
+    , read_index_(0)
+    , lost_(0) {
+}
+
+InputRingReader::~InputRingReader() {
+    detach();
+}
+
+bool InputRingReader::attach(int fd) {
+    detach();
+    fd_ = fd;
+
+    struct stat st;
+    if (fstat(fd_, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(InputRingHeader)) {
+        TD_LOG_ERROR("InputRingReader", "Invalid ring fd");
+        detach();
+        return false;
+    }
+
+    size_ = st.st_size;
+    void* mem = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mem == MAP_FAILED) {
+        TD_LOG_ERROR("InputRingReader", "Failed to map ring");
+        size_ = 0;
+        detach();
+        return false;
+    }
+
+    header_ = static_cast<const InputRingHeader*>(mem);
+
+    if (header_->magic != RING_MAGIC || header_->version != RING_VERSION ||
+        header_->slot_size != sizeof(InputRingSlot) ||
+        ring_size(header_->capacity) > size_) {
+        TD_LOG_ERROR("InputRingReader", "Ring layout mismatch");
+        detach();
+        return false;
+    }
+
+    slots_ = reinterpret_cast<const InputRingSlot*>(header_ + 1);
+    capacity_ = header_->capacity;
+
+    // Only events published after attaching are of interest
+    read_index_ = header_->write_index.load(std::memory_order_acquire);
+    lost_ = 0;
+
+    return true;
+}
+
+void InputRingReader::detach() {
+    if (header_) {
+        munmap(const_cast<InputRingHeader*>(header_), size_);
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool InputRingReader::read(InputEvent& event) {
+    if (!header_) return false;
+
+    for (;;) {
+        uint64_t write_index = header_->write_index.load(std::memory_order_acquire);
+        if (read_index_ >= write_index) {
+            return false;
+        }
+
+        // Lapped by the producer: skip to the oldest event still in the ring
+        if (write_index - read_index_ > capacity_) {
+            lost_ += write_index - capacity_ - read_index_;
+            read_index_ = write_index - capacity_;
+        }
+
+        const InputRingSlot& slot = slots_[read_index_ & (capacity_ - 1)];
+        uint64_t expected = read_index_ * 2 + 2;
+
+        if (slot.sequence.load(std::memory_order_acquire) == expected) {
+            std::memcpy(&event, &slot.event, sizeof(event));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == expected) {
+                read_index_++;
+                return true;
+            }
+        }
+
+        // Overwritten while we were reading it
+        lost_++;
+        read_index_++;
+    }
+}
+
+} // namespace touchdown
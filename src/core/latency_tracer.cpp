@@ -0,0 +1,249 @@
+/**
+ * @file latency_tracer.cpp
+ * @brief Input-to-photon latency tracing implementation
+ */
+
+#include "touchdown/core/latency_tracer.hpp"
+#include "touchdown/core/logger.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace touchdown {
+
+constexpr size_t MAX_OPEN_TRACES = 32;
+constexpr uint64_t TRACE_EXPIRY_US = 1000000;  // Input that never changed a frame
+
+constexpr size_t STAGE_COUNT = static_cast<size_t>(TraceStage::COUNT);
+
+namespace {
+
+const char* stage_name(size_t stage) {
+    static const char* names[STAGE_COUNT] = {
+        "sample", "post", "publish", "dispatch", "consumed", "invalidate", "flush"
+    };
+    return stage < STAGE_COUNT ? names[stage] : "unknown";
+}
+
+constexpr size_t idx(TraceStage stage) {
+    return static_cast<size_t>(stage);
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::add(uint64_t latency_us) {
+    size_t bucket = std::min<uint64_t>(latency_us / BUCKET_US, BUCKETS);
+    buckets_[bucket]++;
+    count_++;
+    max_us_ = std::max(max_us_, latency_us);
+}
+
+void LatencyHistogram::reset() {
+    std::memset(buckets_, 0, sizeof(buckets_));
+    count_ = 0;
+    max_us_ = 0;
+}
+
+uint64_t LatencyHistogram::percentile_us(double percentile) const {
+    if (count_ == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(count_ * percentile / 100.0);
+    uint64_t seen = 0;
+    for (size_t i = 0; i <= BUCKETS; i++) {
+        seen += buckets_[i];
+        if (seen > target) {
+            return i == BUCKETS ? max_us_ : (i + 1) * BUCKET_US;
+        }
+    }
+    return max_us_;
+}
+
+LatencyTracer& LatencyTracer::instance() {
+    static LatencyTracer tracer;
+    return tracer;
+}
+
+LatencyTracer::LatencyTracer()
+    : enabled_(false)
+    , expired_(0) {
+}
+
+void LatencyTracer::enable(const std::string& trace_file) {
+    enabled_ = true;
+    open_.reserve(MAX_OPEN_TRACES);
+
+    if (!trace_file.empty()) {
+        trace_file_.open(trace_file, std::ios::out | std::ios::trunc);
+        if (trace_file_.is_open()) {
+            trace_file_ << "# trace_id";
+            for (size_t i = 0; i < STAGE_COUNT; i++) {
+                trace_file_ << " " << stage_name(i) << "_us";
+            }
+            trace_file_ << "\n";
+        } else {
+            TD_LOG_WARNING("LatencyTracer", "Cannot write trace file: ", trace_file);
+        }
+    }
+
+    TD_LOG_INFO("LatencyTracer", "Input latency tracing enabled");
+}
+
+void LatencyTracer::reset() {
+    open_.clear();
+    for (LatencyHistogram& stage : stages_) {
+        stage.reset();
+    }
+    total_.reset();
+    expired_ = 0;
+}
+
+void LatencyTracer::begin(const InputEvent& event, uint64_t now_us) {
+    if (!enabled_) return;
+
+    expire(now_us);
+    if (open_.size() >= MAX_OPEN_TRACES) {
+        open_.erase(open_.begin());
+        expired_++;
+    }
+
+    Trace trace = {};
+    trace.id = event.trace_id;
+    trace.stamps[idx(TraceStage::SAMPLE)] = event.kind == InputEvent::Kind::TOUCH
+                                            ? event.touch.sample_us : event.button.sample_us;
+    trace.stamps[idx(TraceStage::POST)] = event.posted_us;
+    trace.stamps[idx(TraceStage::PUBLISH)] = event.published_us;
+    trace.stamps[idx(TraceStage::DISPATCH)] = now_us;
+
+    // Drivers without a kernel timestamp start the trace at the post
+    if (trace.stamps[idx(TraceStage::SAMPLE)] == 0) {
+        trace.stamps[idx(TraceStage::SAMPLE)] = event.posted_us;
+    }
+
+    open_.push_back(trace);
+}
+
+void LatencyTracer::mark_consumed(uint32_t trace_id, uint64_t now_us) {
+    if (!enabled_ || trace_id == 0) return;
+
+    for (Trace& trace : open_) {
+        if (trace.id == trace_id && trace.stamps[idx(TraceStage::CONSUMED)] == 0) {
+            trace.stamps[idx(TraceStage::CONSUMED)] = now_us;
+            trace.handling = true;
+            return;
+        }
+    }
+}
+
+void LatencyTracer::cancel(uint32_t trace_id) {
+    if (!enabled_ || trace_id == 0) return;
+
+    open_.erase(std::remove_if(open_.begin(), open_.end(),
+                               [trace_id](const Trace& trace) { return trace.id == trace_id; }),
+                open_.end());
+}
+
+void LatencyTracer::mark_invalidated(uint64_t now_us) {
+    if (!enabled_ || open_.empty()) return;
+
+    for (Trace& trace : open_) {
+        if (trace.handling && trace.stamps[idx(TraceStage::INVALIDATE)] == 0) {
+            trace.stamps[idx(TraceStage::INVALIDATE)] = now_us;
+        }
+    }
+}
+
+void LatencyTracer::end_handling() {
+    if (!enabled_ || open_.empty()) return;
+
+    // Handled without touching the screen: nothing later is its doing
+    auto unchanged = [](const Trace& trace) {
+        return trace.handling && trace.stamps[idx(TraceStage::INVALIDATE)] == 0;
+    };
+
+    size_t before = open_.size();
+    open_.erase(std::remove_if(open_.begin(), open_.end(), unchanged), open_.end());
+    expired_ += before - open_.size();
+
+    for (Trace& trace : open_) {
+        trace.handling = false;
+    }
+}
+
+void LatencyTracer::mark_flushed(uint64_t now_us) {
+    if (!enabled_ || open_.empty()) return;
+
+    auto it = open_.begin();
+    while (it != open_.end()) {
+        if (it->stamps[idx(TraceStage::INVALIDATE)] != 0) {
+            it->stamps[idx(TraceStage::FLUSH)] = now_us;
+            complete(*it);
+            it = open_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void LatencyTracer::complete(const Trace& trace) {
+    for (size_t i = 1; i < STAGE_COUNT; i++) {
+        uint64_t prev = trace.stamps[i - 1];
+        uint64_t cur = trace.stamps[i];
+        stages_[i].add(cur > prev ? cur - prev : 0);
+    }
+
+    uint64_t start = trace.stamps[idx(TraceStage::SAMPLE)];
+    uint64_t end = trace.stamps[idx(TraceStage::FLUSH)];
+    total_.add(end > start ? end - start : 0);
+
+    if (trace_file_.is_open()) {
+        trace_file_ << trace.id;
+        for (size_t i = 0; i < STAGE_COUNT; i++) {
+            trace_file_ << " " << trace.stamps[i];
+        }
+        trace_file_ << "\n";
+    }
+}
+
+void LatencyTracer::expire(uint64_t now_us) {
+    auto stale = [now_us](const Trace& trace) {
+        return now_us - trace.stamps[idx(TraceStage::DISPATCH)] > TRACE_EXPIRY_US;
+    };
+
+    size_t before = open_.size();
+    open_.erase(std::remove_if(open_.begin(), open_.end(), stale), open_.end());
+    expired_ += before - open_.size();
+}
+
+void LatencyTracer::dump() {
+    if (!enabled_) return;
+
+    TD_LOG_INFO("LatencyTracer", "Input-to-flush: n=", total_.count(),
+                " p50=", total_.percentile_us(50), "us p99=", total_.percentile_us(99),
+                "us max=", total_.max_us(), "us, no visible change: ", expired_);
+
+    for (size_t i = 1; i < STAGE_COUNT; i++) {
+        const LatencyHistogram& h = stages_[i];
+        TD_LOG_INFO("LatencyTracer", "  ", stage_name(i - 1), " -> ", stage_name(i),
+                    ": p50=", h.percentile_us(50), "us p99=", h.percentile_us(99),
+                    "us max=", h.max_us(), "us");
+    }
+
+    if (trace_file_.is_open()) {
+        trace_file_ << "# stage count p50_us p90_us p99_us max_us\n";
+        for (size_t i = 1; i < STAGE_COUNT; i++) {
+            const LatencyHistogram& h = stages_[i];
+            trace_file_ << "# " << stage_name(i) << " " << h.count() << " "
+                        << h.percentile_us(50) << " " << h.percentile_us(90) << " "
+                        << h.percentile_us(99) << " " << h.max_us() << "\n";
+        }
+        trace_file_ << "# total " << total_.count() << " "
+                    << total_.percentile_us(50) << " " << total_.percentile_us(90) << " "
+                    << total_.percentile_us(99) << " " << total_.max_us() << "\n";
+        trace_file_.flush();
+    }
+}
+
+} // namespace touchdown
@@ -0,0 +1,60 @@
+/**
+ * @file process.cpp
+ * @brief External program implementation
+ */
+
+#include "touchdown/core/process.hpp"
+#include "touchdown/core/logger.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+namespace touchdown {
+
+pid_t spawn_process(const std::vector<std::string>& argv) {
+    if (argv.empty()) return -1;
+
+    std::vector<char*> args;
+    for (const std::string& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    sigset_t empty;
+    sigset_t all;
+    sigemptyset(&empty);
+    sigfillset(&all);
+
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &empty);
+    posix_spawnattr_setsigdefault(&attr, &all);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid = -1;
+    int error = posix_spawnp(&pid, args[0], nullptr, &attr, args.data(), environ);
+    posix_spawnattr_destroy(&attr);
+
+    if (error != 0) {
+        TD_LOG_ERROR("Process", "Cannot start ", argv[0], ": ", std::strerror(error));
+        return -1;
+    }
+    return pid;
+}
+
+int run_process(const std::vector<std::string>& argv) {
+    pid_t pid = spawn_process(argv);
+    if (pid < 0) return -1;
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+} // namespace touchdown
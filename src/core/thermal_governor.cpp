@@ -0,0 +1,80 @@
+/**
+ * @file thermal_governor.cpp
+ * @brief Thermal level governor
+ */
+
+#include "touchdown/core/thermal_governor.hpp"
+
+namespace touchdown {
+
+namespace {
+
+constexpr const char* LEVEL_NAMES[THERMAL_LEVEL_COUNT] = {"normal", "warm", "hot", "critical"};
+
+} // namespace
+
+const char* thermal_level_name(ThermalLevel level) {
+    size_t index = static_cast<size_t>(level);
+    return index < THERMAL_LEVEL_COUNT ? LEVEL_NAMES[index] : LEVEL_NAMES[0];
+}
+
+bool parse_thermal_level(const std::string& name, ThermalLevel& level) {
+    for (size_t i = 0; i < THERMAL_LEVEL_COUNT; i++) {
+        if (name == LEVEL_NAMES[i]) {
+            level = static_cast<ThermalLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+ThermalGovernor::ThermalGovernor(const ThermalConfig& config)
+    : config_(config)
+    , level_(ThermalLevel::NORMAL)
+    , changes_(0) {
+}
+
+void ThermalGovernor::configure(const ThermalConfig& config) {
+    config_ = config;
+}
+
+void ThermalGovernor::reset() {
+    level_ = ThermalLevel::NORMAL;
+}
+
+int32_t ThermalGovernor::threshold(ThermalLevel level) const {
+    switch (level) {
+        case ThermalLevel::NORMAL: return INT32_MIN;
+        case ThermalLevel::WARM: return config_.warm_mc;
+        case ThermalLevel::HOT: return config_.hot_mc;
+        case ThermalLevel::CRITICAL: return config_.critical_mc;
+    }
+    return INT32_MIN;
+}
+
+ThermalLevel ThermalGovernor::update(int32_t temp_mc) {
+    ThermalLevel level = level_;
+
+    // Up as far as the thresholds reached
+    while (level != ThermalLevel::CRITICAL) {
+        ThermalLevel next = static_cast<ThermalLevel>(static_cast<uint8_t>(level) + 1);
+        if (temp_mc < threshold(next)) break;
+        level = next;
+    }
+
+    // Down only once clearly below, possibly several levels after a gap
+    if (level == level_) {
+        while (level != ThermalLevel::NORMAL &&
+               static_cast<int64_t>(temp_mc) < static_cast<int64_t>(threshold(level)) - config_.hysteresis_mc) {
+            level = static_cast<ThermalLevel>(static_cast<uint8_t>(level) - 1);
+        }
+    }
+
+    if (level != level_) {
+        level_ = level;
+        changes_++;
+    }
+    return level_;
+}
+
+} // namespace touchdown
@@ -0,0 +1,103 @@
+/**
+ * @file worker_pool.cpp
+ * @brief Worker threads with completions posted to the event loop
+ */
+
+#include "touchdown/core/worker_pool.hpp"
+#include "touchdown/core/logger.hpp"
+#include <pthread.h>
+#include <csignal>
+#include <system_error>
+
+namespace touchdown {
+
+WorkerPool::WorkerPool()
+    : loop_(nullptr)
+    , stopping_(false)
+    , pending_(0) {
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+bool WorkerPool::init(EventLoop& loop, size_t threads) {
+    loop_ = &loop;
+    stopping_ = false;
+
+    // Threads inherit the creating thread's mask; block everything so
+    // signals keep going to the loop's signalfd
+    sigset_t all;
+    sigset_t previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+
+    bool ok = true;
+    try {
+        for (size_t i = 0; i < threads; i++) {
+            threads_.emplace_back([this]() { worker(); });
+        }
+    } catch (const std::system_error& e) {
+        TD_LOG_ERROR("WorkerPool", "Failed to start worker thread: ", e.what());
+        ok = false;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+
+    if (!ok) {
+        shutdown();
+    }
+    return ok;
+}
+
+void WorkerPool::submit(Job job, Done done) {
+    if (threads_.empty()) {
+        // Not running: keep the caller's ordering guarantees by doing it here
+        job();
+        if (done) done();
+        return;
+    }
+
+    pending_++;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(Entry{std::move(job), std::move(done)});
+    }
+    cond_.notify_one();
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cond_.notify_all();
+
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+}
+
+void WorkerPool::worker() {
+    for (;;) {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;  // Stopping and drained
+
+            entry = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        entry.job();
+        pending_--;
+
+        if (entry.done) {
+            loop_->post(std::move(entry.done));
+        }
+    }
+}
+
+} // namespace touchdown
@@ -0,0 +1,188 @@
+/**
+ * @file backlight.cpp
+ * @brief sysfs backlight implementation
+ */
+
+#include "touchdown/drivers/backlight.hpp"
+#include "touchdown/core/logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+
+namespace touchdown {
+namespace drivers {
+
+namespace {
+
+uint32_t read_number(const std::string& path) {
+    std::ifstream file(path);
+    uint32_t value = 0;
+    file >> value;
+    return value;
+}
+
+} // namespace
+
+Backlight::Backlight()
+    : loop_(nullptr)
+    , max_brightness_(0)
+    , curve_{}
+    , written_(0)
+    , writes_(0)
+    , level_(0)
+    , fading_(false)
+    , fade_from_(0)
+    , fade_to_(0)
+    , fade_start_us_(0)
+    , fade_duration_us_(0)
+    , interval_ms_(1000 / DEFAULT_MAX_RATE_HZ)
+    , fade_timer_(EventLoop::INVALID_TIMER) {
+}
+
+Backlight::~Backlight() {
+    if (loop_ && fade_timer_ != EventLoop::INVALID_TIMER) {
+        loop_->remove_timer(fade_timer_);
+    }
+}
+
+bool Backlight::init(EventLoop& loop, const std::string& root) {
+    loop_ = &loop;
+    fade_timer_ = loop.add_timer([this]() { on_fade_timer(); });
+
+    DIR* dir = opendir(root.c_str());
+    if (!dir) {
+        TD_LOG_WARNING("Backlight", "No backlight class: ", root);
+        return false;
+    }
+
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string& name : names) {
+        std::string base = root + "/" + name + "/";
+        uint32_t max_brightness = read_number(base + "max_brightness");
+        if (max_brightness == 0) continue;
+
+        if (!brightness_.open(base + "brightness", O_WRONLY)) {
+            TD_LOG_WARNING("Backlight", "Cannot open ", name, " brightness: ", std::strerror(errno));
+            continue;
+        }
+
+        max_brightness_ = max_brightness;
+        build_curve();
+
+        // Start from whatever the bootloader or the last run left
+        written_ = std::min(read_number(base + "brightness"), max_brightness_);
+        level_ = static_cast<uint8_t>(std::lower_bound(curve_.begin(), curve_.end(), written_) -
+                                      curve_.begin());
+
+        TD_LOG_INFO("Backlight", "Using ", name, ", max ", max_brightness_, ", level ",
+                    static_cast<int>(level_));
+        return true;
+    }
+
+    TD_LOG_WARNING("Backlight", "No usable backlight in ", root);
+    return false;
+}
+
+void Backlight::build_curve() {
+    for (size_t level = 0; level < curve_.size(); level++) {
+        // CIE 1931: relative luminance for lightness L* = level / 255 * 100
+        double lightness = level * 100.0 / 255.0;
+        double luminance = lightness <= 8.0
+            ? lightness / 903.3
+            : std::pow((lightness + 16.0) / 116.0, 3.0);
+
+        uint32_t raw = static_cast<uint32_t>(std::lround(luminance * max_brightness_));
+        curve_[level] = level > 0 ? std::max(raw, 1u) : 0;
+    }
+}
+
+void Backlight::set_max_rate(uint32_t hz) {
+    interval_ms_ = std::max(1000 / std::max(hz, 1u), 1u);
+}
+
+void Backlight::set_level(uint8_t level) {
+    stop_fade();
+    apply(level);
+}
+
+void Backlight::fade_to(uint8_t level, uint32_t duration_ms, std::function<void()> done) {
+    stop_fade();
+
+    if (level == level_ || duration_ms == 0 || !loop_ || !brightness_.is_open()) {
+        apply(level);
+        if (done) done();
+        return;
+    }
+
+    fading_ = true;
+    fade_from_ = level_;
+    fade_to_ = level;
+    fade_start_us_ = EventLoop::now_us();
+    fade_duration_us_ = duration_ms * 1000ULL;
+    fade_done_ = std::move(done);
+    loop_->arm_timer(fade_timer_, interval_ms_, interval_ms_);
+}
+
+void Backlight::on_fade_timer() {
+    if (!fading_) return;
+
+    uint64_t elapsed_us = EventLoop::now_us() - fade_start_us_;
+    if (elapsed_us >= fade_duration_us_) {
+        uint8_t target = fade_to_;
+        std::function<void()> done = std::move(fade_done_);
+        stop_fade();
+        apply(target);
+        if (done) done();
+        return;
+    }
+
+    int delta = static_cast<int>(fade_to_) - static_cast<int>(fade_from_);
+    int level = fade_from_ + static_cast<int>(delta * static_cast<int64_t>(elapsed_us) /
+                                              static_cast<int64_t>(fade_duration_us_));
+    apply(static_cast<uint8_t>(level));
+}
+
+void Backlight::stop_fade() {
+    if (!fading_) return;
+
+    fading_ = false;
+    fade_done_ = nullptr;
+    loop_->disarm_timer(fade_timer_);
+}
+
+void Backlight::apply(uint8_t level) {
+    bool changed = level != level_;
+    level_ = level;
+
+    uint32_t raw = curve_[level];
+    if (brightness_.is_open() && raw != written_) {
+        std::string value = std::to_string(raw);
+        writes_++;
+        if (!brightness_.write(value)) {
+            TD_LOG_WARNING("Backlight", "Write of ", value, " failed: ", std::strerror(errno));
+        } else {
+            written_ = raw;
+        }
+    }
+
+    if (changed && level_callback_) {
+        level_callback_(level_);
+    }
+}
+
+} // namespace drivers
+} // namespace touchdown
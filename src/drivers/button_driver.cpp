@@ -4,13 +4,14 @@
  */
 
 #include "touchdown/drivers/button_driver.hpp"
+#include "touchdown/drivers/input_device_monitor.hpp"
 #include "touchdown/core/logger.hpp"
-#include "touchdown/core/utils.hpp"
+#include "touchdown/core/event_loop.hpp"
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
 #include <linux/input.h>
-#include <thread>
-#include <chrono>
 
 namespace touchdown {
 namespace drivers {
@@ -19,14 +20,21 @@ class ButtonDriver::Impl {
 public:
     int event_fd = -1;
     int gpio_pin = 23;
+    std::string device_name;  // Empty: any KEY_POWER device
+    std::string device_node;
+    
+    // The monitor thread blocks in its own loop until the device, a
+    // hotplug notification or the double-press timer is ready
+    EventLoop loop;
+    EventLoop::TimerId double_press_timer = EventLoop::INVALID_TIMER;
+    InputDeviceMonitor devices;
 };
 
 ButtonDriver::ButtonDriver()
     : impl_(std::make_unique<Impl>())
-    , running_(false)
     , last_state_(false)
-    , press_start_time_(0)
-    , last_press_time_(0)
+    , press_start_us_(0)
+    , last_press_us_(0)
     , waiting_for_double_(false)
     , debounce_ms_(50)
     , double_press_window_ms_(300)
@@ -42,34 +50,45 @@ bool ButtonDriver::init(int gpio_pin) {
     
     impl_->gpio_pin = gpio_pin;
     
-    // Open event device for button (configured via device tree)
-    // Look for the power button event
-    for (int i = 0; i < 10; i++) {
-        std::string device = "/dev/input/event" + std::to_string(i);
-        int fd = open(device.c_str(), O_RDONLY | O_NONBLOCK);
-        
-        if (fd >= 0) {
-            char name[256] = {0};
-            if (ioctl(fd, EVIOCGNAME(sizeof(name)), name) >= 0) {
-                std::string device_name(name);
-                if (device_name.find("Power Button") != std::string::npos ||
-                    device_name.find("touchdown-button") != std::string::npos) {
-                    impl_->event_fd = fd;
-                    TD_LOG_INFO("ButtonDriver", "Found button device: ", device_name);
-                    break;
-                }
-            }
-            close(fd);
-        }
+    if (!impl_->loop.init()) {
+        TD_LOG_ERROR("ButtonDriver", "Failed to initialize event loop");
+        return false;
     }
     
-    if (impl_->event_fd < 0) {
-        TD_LOG_ERROR("ButtonDriver", "Failed to find button event device");
+    impl_->double_press_timer = impl_->loop.add_timer([this]() { on_double_press_timeout(); });
+    
+    // Find the power button (configured via device tree) by capability,
+    // without opening every evdev node
+    impl_->devices.set_device_added_callback([this](const InputDeviceInfo& info) {
+        if (impl_->event_fd < 0 && is_button(info)) {
+            open_device(info);
+        }
+    });
+    impl_->devices.set_device_removed_callback([this](const InputDeviceInfo& info) {
+        if (info.node == impl_->device_node) {
+            TD_LOG_WARNING("ButtonDriver", "Button device removed: ", info.node);
+            close_device();
+        }
+    });
+    
+    if (!impl_->devices.init(impl_->loop)) {
+        TD_LOG_ERROR("ButtonDriver", "Failed to start input device monitor");
         return false;
     }
     
+    bool opened = false;
+    for (const InputDeviceInfo& info : impl_->devices.get_devices()) {
+        if (is_button(info) && open_device(info)) {
+            opened = true;
+            break;
+        }
+    }
+    if (!opened) {
+        // Not fatal: the device is opened as soon as it shows up
+        TD_LOG_WARNING("ButtonDriver", "Button device not present yet, waiting for hotplug");
+    }
+    
     // Start monitoring thread
-    running_ = true;
     monitor_thread_ = std::thread(&ButtonDriver::monitor_thread, this);
     
     TD_LOG_INFO("ButtonDriver", "Button driver initialized");
@@ -77,101 +96,144 @@ bool ButtonDriver::init(int gpio_pin) {
 }
 
 void ButtonDriver::deinit() {
-    running_ = false;
-    
     if (monitor_thread_.joinable()) {
+        impl_->loop.stop();
         monitor_thread_.join();
     }
     
-    if (impl_->event_fd >= 0) {
-        close(impl_->event_fd);
-        impl_->event_fd = -1;
-    }
+    close_device();
+    impl_->devices.deinit();
     
     TD_LOG_INFO("ButtonDriver", "Button driver deinitialized");
 }
 
+void ButtonDriver::set_device_name(const std::string& name) {
+    impl_->device_name = name;
+}
+
+bool ButtonDriver::is_button(const InputDeviceInfo& info) const {
+    if (!info.has_key(KEY_POWER)) return false;
+    return impl_->device_name.empty() || info.name == impl_->device_name;
+}
+
+bool ButtonDriver::open_device(const InputDeviceInfo& info) {
+    int fd = open(info.node.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        TD_LOG_ERROR("ButtonDriver", "Failed to open button device: ", info.node);
+        return false;
+    }
+    
+    // Stamp events with the same clock as our timers so durations and
+    // deadlines can be computed from kernel timestamps directly
+    int clock_id = CLOCK_MONOTONIC;
+    if (ioctl(fd, EVIOCSCLOCKID, &clock_id) < 0) {
+        TD_LOG_WARNING("ButtonDriver", "Failed to set event clock to CLOCK_MONOTONIC");
+    }
+    
+    impl_->event_fd = fd;
+    impl_->device_node = info.node;
+    impl_->loop.add_fd(fd, EPOLLIN, [this](uint32_t) { read_events(); });
+    
+    TD_LOG_INFO("ButtonDriver", "Found button device: ", info.name, " at ", info.node);
+    return true;
+}
+
+void ButtonDriver::close_device() {
+    if (impl_->event_fd < 0) return;
+    
+    impl_->loop.remove_fd(impl_->event_fd);
+    close(impl_->event_fd);
+    impl_->event_fd = -1;
+    impl_->device_node.clear();
+    
+    // A release will never arrive for a press in progress
+    last_state_ = false;
+}
+
 void ButtonDriver::monitor_thread() {
+    impl_->loop.run();
+}
+
+void ButtonDriver::read_events() {
     struct input_event ev;
-    fd_set fds;
-    struct timeval tv;
     
-    while (running_) {
-        FD_ZERO(&fds);
-        FD_SET(impl_->event_fd, &fds);
-        
-        tv.tv_sec = 0;
-        tv.tv_usec = 100000;  // 100ms timeout
-        
-        int ret = select(impl_->event_fd + 1, &fds, nullptr, nullptr, &tv);
-        
-        if (ret > 0 && FD_ISSET(impl_->event_fd, &fds)) {
-            if (read(impl_->event_fd, &ev, sizeof(ev)) == sizeof(ev)) {
-                if (ev.type == EV_KEY && ev.code == KEY_POWER) {
-                    bool pressed = (ev.value == 1);
-                    process_button_event(pressed);
-                }
-            }
-        }
-        
-        // Check for double-press timeout
-        if (waiting_for_double_) {
-            uint32_t now = Utils::get_timestamp_ms();
-            if (now - last_press_time_ > double_press_window_ms_) {
-                // Timeout - emit single press
-                ButtonEvent event = {ButtonEventType::SINGLE_PRESS, last_press_time_, 0};
-                if (button_callback_) {
-                    button_callback_(event);
-                }
-                waiting_for_double_ = false;
-            }
+    while (read(impl_->event_fd, &ev, sizeof(ev)) == sizeof(ev)) {
+        if (ev.type == EV_KEY && ev.code == KEY_POWER) {
+            bool pressed = (ev.value == 1);
+            uint64_t timestamp_us = static_cast<uint64_t>(ev.input_event_sec) * 1000000 +
+                                    ev.input_event_usec;
+            process_button_event(pressed, timestamp_us);
         }
     }
 }
 
-void ButtonDriver::process_button_event(bool pressed) {
-    uint32_t now = Utils::get_timestamp_ms();
+void ButtonDriver::on_double_press_timeout() {
+    // A second press that landed before the deadline may be queued behind
+    // the timer in the same epoll batch; consume it first
+    read_events();
+    
+    if (!waiting_for_double_) return;
+    
+    // Timeout - emit single press
+    ButtonEvent event = {ButtonEventType::SINGLE_PRESS,
+                         static_cast<uint32_t>(last_press_us_ / 1000), 0, last_press_us_};
+    if (button_callback_) {
+        button_callback_(event);
+    }
+    waiting_for_double_ = false;
+}
+
+void ButtonDriver::process_button_event(bool pressed, uint64_t timestamp_us) {
+    uint32_t now = static_cast<uint32_t>(timestamp_us / 1000);
     
     if (pressed && !last_state_) {
         // Button pressed
-        press_start_time_ = now;
+        press_start_us_ = timestamp_us;
         last_state_ = true;
         
         TD_LOG_DEBUG("ButtonDriver", "Button pressed");
         
     } else if (!pressed && last_state_) {
         // Button released
-        uint32_t duration = now - press_start_time_;
+        uint32_t duration = static_cast<uint32_t>((timestamp_us - press_start_us_) / 1000);
         last_state_ = false;
         
         TD_LOG_DEBUG("ButtonDriver", "Button released, duration: ", duration, "ms");
         
         if (duration >= long_press_threshold_ms_) {
             // Long press
-            ButtonEvent event = {ButtonEventType::LONG_PRESS, now, static_cast<uint16_t>(duration)};
+            ButtonEvent event = {ButtonEventType::LONG_PRESS, now, static_cast<uint16_t>(duration),
+                                 timestamp_us};
             if (button_callback_) {
                 button_callback_(event);
             }
+            impl_->loop.disarm_timer(impl_->double_press_timer);
             waiting_for_double_ = false;
             
         } else {
             // Short press - check for double press
-            if (waiting_for_double_ && (now - last_press_time_) < double_press_window_ms_) {
+            if (waiting_for_double_ &&
+                (timestamp_us - last_press_us_) < double_press_window_ms_ * 1000ULL) {
                 // Double press detected
-                ButtonEvent event = {ButtonEventType::DOUBLE_PRESS, now, 0};
+                impl_->loop.disarm_timer(impl_->double_press_timer);
+                ButtonEvent event = {ButtonEventType::DOUBLE_PRESS, now, 0, timestamp_us};
                 if (button_callback_) {
                     button_callback_(event);
                 }
                 waiting_for_double_ = false;
             } else {
-                // Wait for potential double press
-                last_press_time_ = now;
+                // Wait for potential double press; the timer fires exactly at
+                // the end of the window measured from the kernel timestamp
+                last_press_us_ = timestamp_us;
                 waiting_for_double_ = true;
+                impl_->loop.arm_timer_at(impl_->double_press_timer,
+                                         timestamp_us + double_press_window_ms_ * 1000ULL);
             }
         }
         
         // Release event
-        ButtonEvent event = {ButtonEventType::RELEASE, now, static_cast<uint16_t>(duration)};
+        ButtonEvent event = {ButtonEventType::RELEASE, now, static_cast<uint16_t>(duration),
+                             timestamp_us};
         if (button_callback_) {
             button_callback_(event);
         }
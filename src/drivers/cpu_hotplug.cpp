@@ -0,0 +1,216 @@
+/**
+ * @file cpu_hotplug.cpp
+ * @brief CPU hotplug implementation
+ */
+
+#include "touchdown/drivers/cpu_hotplug.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/core/logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+
+namespace touchdown {
+namespace drivers {
+
+namespace {
+
+bool is_number(const char* name) {
+    if (!*name) return false;
+    for (const char* c = name; *c; c++) {
+        if (*c < '0' || *c > '9') return false;
+    }
+    return true;
+}
+
+// Calls fn(tid) for every thread in the system
+template <typename Fn>
+void for_each_thread(Fn fn) {
+    DIR* proc = opendir("/proc");
+    if (!proc) return;
+
+    while (struct dirent* process = readdir(proc)) {
+        if (!is_number(process->d_name)) continue;
+
+        std::string tasks = std::string("/proc/") + process->d_name + "/task";
+        DIR* dir = opendir(tasks.c_str());
+        if (!dir) continue;  // Exited
+
+        while (struct dirent* task = readdir(dir)) {
+            if (is_number(task->d_name)) {
+                fn(static_cast<pid_t>(std::atoi(task->d_name)));
+            }
+        }
+        closedir(dir);
+    }
+    closedir(proc);
+}
+
+} // namespace
+
+CpuHotplug::CpuHotplug()
+    : parallel_(true)
+    , dry_run_(false) {
+}
+
+CpuHotplug::~CpuHotplug() {
+}
+
+bool CpuHotplug::init(const std::string& root) {
+    for (unsigned id : requested_) {
+        std::string path = root + "/cpu" + std::to_string(id) + "/online";
+
+        Cpu cpu;
+        cpu.id = id;
+        if (!cpu.file.open(path, O_RDWR)) {
+            TD_LOG_WARNING("CpuHotplug", "cpu", id, " cannot be switched: ", std::strerror(errno));
+            continue;
+        }
+
+        std::string state;
+        cpu.online = !cpu.file.read(state) || state != "0";
+        cpus_.push_back(std::move(cpu));
+    }
+
+    if (cpus_.empty()) {
+        return false;
+    }
+
+    // A single real CPU among fake ones still switches hardware
+    dry_run_ = std::all_of(cpus_.begin(), cpus_.end(), [](const Cpu& cpu) { return cpu.file.is_fake(); });
+
+    if (dry_run_) {
+        TD_LOG_INFO("CpuHotplug", "Dry run: parking ", cpus_.size(), " CPUs only writes to ", root);
+    } else {
+        TD_LOG_INFO("CpuHotplug", cpus_.size(), " CPUs can be parked");
+    }
+    return true;
+}
+
+bool CpuHotplug::is_parkable(unsigned cpu) const {
+    return std::any_of(cpus_.begin(), cpus_.end(), [cpu](const Cpu& c) { return c.id == cpu; });
+}
+
+bool CpuHotplug::park(HotplugResult& result) {
+    result = HotplugResult();
+
+    // Must run while the CPUs are still up: afterwards the masks are gone
+    save_pinned_threads();
+
+    // Nothing waits on parking, so one CPU at a time is fine
+    uint64_t start_us = EventLoop::now_us();
+    for (Cpu& cpu : cpus_) {
+        if (!cpu.online) continue;
+
+        result.cpus++;
+        if (!write_online(cpu, false)) {
+            result.failed++;
+        }
+        result.slowest_us = std::max(result.slowest_us, cpu.write_us);
+    }
+    result.elapsed_us = EventLoop::now_us() - start_us;
+    return result.failed == 0;
+}
+
+bool CpuHotplug::unpark(HotplugResult& result) {
+    result = HotplugResult();
+
+    std::vector<Cpu*> offline;
+    for (Cpu& cpu : cpus_) {
+        if (!cpu.online) offline.push_back(&cpu);
+    }
+
+    uint64_t start_us = EventLoop::now_us();
+    if (parallel_ && offline.size() > 1) {
+        // The kernel serialises parts of each bring-up, but the waits for
+        // the secondary core to boot and report in overlap
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < offline.size(); i++) {
+            Cpu* cpu = offline[i];
+            threads.emplace_back([this, cpu]() { write_online(*cpu, true); });
+        }
+        write_online(*offline[0], true);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    } else {
+        for (Cpu* cpu : offline) {
+            write_online(*cpu, true);
+        }
+    }
+    result.elapsed_us = EventLoop::now_us() - start_us;
+
+    for (Cpu* cpu : offline) {
+        result.cpus++;
+        if (!cpu->write_ok) result.failed++;
+        result.slowest_us = std::max(result.slowest_us, cpu->write_us);
+    }
+
+    result.rehomed = restore_pinned_threads();
+    return result.failed == 0;
+}
+
+bool CpuHotplug::write_online(Cpu& cpu, bool online) {
+    uint64_t start_us = EventLoop::now_us();
+    cpu.write_ok = cpu.file.write(online ? "1" : "0");
+    int error = errno;
+    cpu.write_us = EventLoop::now_us() - start_us;
+
+    if (!cpu.write_ok) {
+        TD_LOG_WARNING("CpuHotplug", "cpu", cpu.id, online ? " online" : " offline",
+                       " failed: ", std::strerror(error));
+        return false;
+    }
+    cpu.online = online;
+    return true;
+}
+
+void CpuHotplug::save_pinned_threads() {
+    pinned_.clear();
+
+    for_each_thread([this](pid_t tid) {
+        PinnedThread thread;
+        thread.tid = tid;
+        CPU_ZERO(&thread.mask);
+        if (sched_getaffinity(tid, sizeof(thread.mask), &thread.mask) != 0) return;
+
+        // Only threads left with no online CPU lose their mask. Per-CPU
+        // kernel threads are parked by the kernel and keep theirs.
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &thread.mask) && !is_parkable(cpu)) return;
+        }
+        pinned_.push_back(thread);
+    });
+
+    if (!pinned_.empty()) {
+        TD_LOG_DEBUG("CpuHotplug", pinned_.size(), " threads pinned to CPUs being parked");
+    }
+}
+
+size_t CpuHotplug::restore_pinned_threads() {
+    size_t restored = 0;
+
+    for (const PinnedThread& thread : pinned_) {
+        cpu_set_t current;
+        CPU_ZERO(&current);
+        if (sched_getaffinity(thread.tid, sizeof(current), &current) != 0) continue;  // Exited
+        if (CPU_EQUAL(&current, &thread.mask)) continue;
+
+        if (sched_setaffinity(thread.tid, sizeof(thread.mask), &thread.mask) == 0) {
+            restored++;
+        } else {
+            TD_LOG_WARNING("CpuHotplug", "Cannot re-pin thread ", thread.tid, ": ",
+                           std::strerror(errno));
+        }
+    }
+
+    pinned_.clear();
+    return restored;
+}
+
+} // namespace drivers
+} // namespace touchdown
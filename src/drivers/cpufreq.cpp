@@ -0,0 +1,192 @@
+/**
+ * @file cpufreq.cpp
+ * @brief cpufreq sysfs policy control implementation
+ */
+
+#include "touchdown/drivers/cpufreq.hpp"
+#include "touchdown/core/logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <fcntl.h>
+
+namespace touchdown {
+namespace drivers {
+
+namespace {
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    std::getline(file, value);
+    value.erase(value.find_last_not_of(" \n") + 1);
+    return value;
+}
+
+uint32_t read_khz(const std::string& path) {
+    std::string value = read_file(path);
+    return value.empty() ? 0 : static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+}
+
+} // namespace
+
+CpufreqManager::CpufreqManager()
+    : floor_khz_(0)
+    , writes_(0) {
+}
+
+CpufreqManager::~CpufreqManager() {
+    close();
+}
+
+bool CpufreqManager::init(const std::string& root) {
+    close();
+
+    DIR* dir = opendir(root.c_str());
+    if (!dir) {
+        TD_LOG_WARNING("Cpufreq", "No cpufreq directory: ", root);
+        return false;
+    }
+
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "policy", 6) == 0) {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string& name : names) {
+        std::string base = root + "/" + name + "/";
+
+        Policy policy;
+        policy.name = name;
+        bool opened = open_attribute(base + "scaling_governor", policy.governor);
+        opened = open_attribute(base + "scaling_min_freq", policy.min_khz) && opened;
+        opened = open_attribute(base + "scaling_max_freq", policy.max_khz) && opened;
+        if (!opened) {
+            TD_LOG_WARNING("Cpufreq", "Cannot open ", name, " attributes");
+            continue;
+        }
+
+        policy.cpuinfo_min_khz = read_khz(base + "cpuinfo_min_freq");
+        policy.cpuinfo_max_khz = read_khz(base + "cpuinfo_max_freq");
+        policy.initial_min_khz = static_cast<uint32_t>(std::strtoul(policy.min_khz.value.c_str(), nullptr, 10));
+        policy.initial_max_khz = static_cast<uint32_t>(std::strtoul(policy.max_khz.value.c_str(), nullptr, 10));
+        policy.base_min_khz = policy.initial_min_khz;
+        policy.base_max_khz = policy.initial_max_khz;
+
+        std::istringstream governors(read_file(base + "scaling_available_governors"));
+        std::string governor;
+        while (governors >> governor) {
+            policy.governors.push_back(governor);
+        }
+
+        TD_LOG_DEBUG("Cpufreq", name, ": ", policy.governor.value, " ", policy.min_khz.value,
+                     "-", policy.max_khz.value, " kHz");
+        policies_.push_back(std::move(policy));
+    }
+
+    TD_LOG_INFO("Cpufreq", "Found ", policies_.size(), " cpufreq policies");
+    return !policies_.empty();
+}
+
+void CpufreqManager::close() {
+    policies_.clear();
+}
+
+bool CpufreqManager::apply(const CpufreqSettings& settings) {
+    bool ok = true;
+
+    for (Policy& policy : policies_) {
+        if (!settings.governor.empty()) {
+            const auto& available = policy.governors;
+            if (!available.empty() &&
+                std::find(available.begin(), available.end(), settings.governor) == available.end()) {
+                TD_LOG_WARNING("Cpufreq", policy.name, " has no governor ", settings.governor);
+                ok = false;
+            } else {
+                ok = write_attribute(policy, policy.governor, settings.governor) && ok;
+            }
+        }
+
+        policy.base_min_khz = settings.min_khz > 0 ? clamp(policy, settings.min_khz) : policy.initial_min_khz;
+        policy.base_max_khz = settings.max_khz > 0 ? clamp(policy, settings.max_khz) : policy.initial_max_khz;
+        ok = write_limits(policy) && ok;
+    }
+
+    return ok;
+}
+
+bool CpufreqManager::set_floor(uint32_t khz) {
+    floor_khz_ = khz;
+
+    bool ok = true;
+    for (Policy& policy : policies_) {
+        ok = write_limits(policy) && ok;
+    }
+    return ok;
+}
+
+bool CpufreqManager::write_limits(Policy& policy) {
+    uint32_t max_khz = policy.base_max_khz;
+    uint32_t min_khz = std::max(policy.base_min_khz, floor_khz_ > 0 ? clamp(policy, floor_khz_) : 0);
+    if (max_khz > 0) min_khz = std::min(min_khz, max_khz);
+
+    // The kernel rejects min above max, so raise max before min and lower
+    // min before max
+    uint32_t current_max = static_cast<uint32_t>(std::strtoul(policy.max_khz.value.c_str(), nullptr, 10));
+    bool max_first = min_khz > current_max;
+
+    bool ok = true;
+    if (max_first && max_khz > 0) {
+        ok = write_attribute(policy, policy.max_khz, std::to_string(max_khz)) && ok;
+    }
+    if (min_khz > 0) {
+        ok = write_attribute(policy, policy.min_khz, std::to_string(min_khz)) && ok;
+    }
+    if (!max_first && max_khz > 0) {
+        ok = write_attribute(policy, policy.max_khz, std::to_string(max_khz)) && ok;
+    }
+    return ok;
+}
+
+uint32_t CpufreqManager::clamp(const Policy& policy, uint32_t khz) {
+    if (policy.cpuinfo_min_khz > 0) khz = std::max(khz, policy.cpuinfo_min_khz);
+    if (policy.cpuinfo_max_khz > 0) khz = std::min(khz, policy.cpuinfo_max_khz);
+    return khz;
+}
+
+bool CpufreqManager::open_attribute(const std::string& path, Attribute& attribute) {
+    if (!attribute.file.open(path, O_RDWR)) {
+        return false;
+    }
+
+    attribute.file.read(attribute.value);
+    return true;
+}
+
+bool CpufreqManager::write_attribute(Policy& policy, Attribute& attribute, const std::string& value) {
+    if (attribute.value == value) {
+        return true;
+    }
+
+    writes_++;
+    if (!attribute.file.write(value)) {
+        TD_LOG_ERROR("Cpufreq", "Write of ", value, " to ", policy.name, " failed: ", std::strerror(errno));
+        // The kernel may have clamped or kept the old value; trust the file
+        attribute.file.read(attribute.value);
+        return false;
+    }
+
+    attribute.value = value;
+    TD_LOG_DEBUG("Cpufreq", policy.name, ": ", value);
+    return true;
+}
+
+} // namespace drivers
+} // namespace touchdown
@@ -6,17 +6,24 @@
 #include "touchdown/drivers/display_driver.hpp"
 #include "touchdown/core/logger.hpp"
 #include "touchdown/core/utils.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/core/latency_tracer.hpp"
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <drm_fourcc.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <cerrno>
 #include <cstring>
+#include <algorithm>
+#include <vector>
 
 namespace touchdown {
 namespace drivers {
 
+constexpr size_t MAX_DAMAGE_CLIPS = 16;
+
 class DisplayDriver::Impl {
 public:
     int drm_fd = -1;
@@ -31,6 +38,12 @@ public:
     
     drmModeModeInfo mode;
     drmModeCrtc* saved_crtc = nullptr;
+    
+    // Areas flushed in the current frame, handed to the kernel on the last one
+    std::vector<drmModeClip> damage;
+    bool dirty_fb_supported = true;
+    
+    uint64_t frames = 0;
 };
 
 DisplayDriver::DisplayDriver() : impl_(std::make_unique<Impl>()), display_(nullptr) {
@@ -159,6 +172,10 @@ bool DisplayDriver::init(const std::string& device) {
     lv_display_set_flush_cb(display_, flush_cb);
     lv_display_set_user_data(display_, this);
     
+    if (LatencyTracer::instance().is_enabled()) {
+        lv_display_add_event_cb(display_, invalidate_cb, LV_EVENT_INVALIDATE_AREA, nullptr);
+    }
+    
     // Clear framebuffer
     std::memset(impl_->fb_base, 0, impl_->fb_size);
     
@@ -211,14 +228,46 @@ void DisplayDriver::flush_display(const lv_area_t* area, unsigned char* color_p)
         std::memcpy(&fb[fb_offset], &src[y * width], width * sizeof(uint16_t));
     }
     
+    if (impl_->damage.size() < MAX_DAMAGE_CLIPS) {
+        impl_->damage.push_back({static_cast<uint16_t>(area->x1), static_cast<uint16_t>(area->y1),
+                                 static_cast<uint16_t>(area->x2 + 1), static_cast<uint16_t>(area->y2 + 1)});
+    } else {
+        drmModeClip& last = impl_->damage.back();
+        last.x1 = std::min<uint16_t>(last.x1, area->x1);
+        last.y1 = std::min<uint16_t>(last.y1, area->y1);
+        last.x2 = std::max<uint16_t>(last.x2, area->x2 + 1);
+        last.y2 = std::max<uint16_t>(last.y2, area->y2 + 1);
+    }
+    
+    if (lv_display_flush_is_last(display_)) {
+        commit_frame();
+    }
+    
     lv_display_flush_ready(display_);
 }
 
-void DisplayDriver::set_brightness(uint8_t brightness) {
-    // Brightness control via backlight sysfs
-    std::string path = "/sys/class/backlight/";
-    // Implementation depends on specific backlight device
-    TD_LOG_DEBUG("DisplayDriver", "Set brightness: ", (int)brightness);
+void DisplayDriver::commit_frame() {
+    // Panels without continuous scanout (SPI/DBI) only update on dirty-fb;
+    // for the rest the write to the mapped buffer is already visible
+    if (impl_->dirty_fb_supported && !impl_->damage.empty()) {
+        if (drmModeDirtyFB(impl_->drm_fd, impl_->fb_id, impl_->damage.data(),
+                           impl_->damage.size()) < 0 && errno == ENOSYS) {
+            impl_->dirty_fb_supported = false;
+        }
+    }
+    impl_->damage.clear();
+    impl_->frames++;
+    
+    LatencyTracer::instance().mark_flushed(EventLoop::now_us());
+}
+
+uint64_t DisplayDriver::get_frame_count() const {
+    return impl_->frames;
+}
+
+void DisplayDriver::invalidate_cb(lv_event_t* e) {
+    (void)e;
+    LatencyTracer::instance().mark_invalidated(EventLoop::now_us());
 }
 
 void DisplayDriver::set_power(bool on) {
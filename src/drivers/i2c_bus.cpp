@@ -0,0 +1,61 @@
+/**
+ * @file i2c_bus.cpp
+ * @brief Linux i2c-dev bus implementation
+ */
+
+#include "touchdown/drivers/i2c_bus.hpp"
+#include "touchdown/core/logger.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+
+namespace touchdown {
+namespace drivers {
+
+LinuxI2CBus::LinuxI2CBus() : fd_(-1) {
+}
+
+LinuxI2CBus::~LinuxI2CBus() {
+    close();
+}
+
+bool LinuxI2CBus::open(const std::string& device, uint8_t address) {
+    fd_ = ::open(device.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ < 0) {
+        TD_LOG_ERROR("I2CBus", "Failed to open I2C device: ", device);
+        return false;
+    }
+
+    if (ioctl(fd_, I2C_SLAVE, address) < 0) {
+        TD_LOG_ERROR("I2CBus", "Failed to set I2C slave address: ", (int)address);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void LinuxI2CBus::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool LinuxI2CBus::write_register(uint8_t reg, uint8_t value) {
+    if (fd_ < 0) return false;
+
+    uint8_t buf[2] = {reg, value};
+    return write(fd_, buf, sizeof(buf)) == sizeof(buf);
+}
+
+bool LinuxI2CBus::read_registers(uint8_t reg, uint8_t* buf, size_t len) {
+    if (fd_ < 0) return false;
+
+    if (write(fd_, &reg, 1) != 1) return false;
+    return read(fd_, buf, len) == static_cast<ssize_t>(len);
+}
+
+} // namespace drivers
+} // namespace touchdown
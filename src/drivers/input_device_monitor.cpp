@@ -0,0 +1,230 @@
+/**
+ * @file input_device_monitor.cpp
+ * @brief evdev discovery via sysfs and inotify
+ */
+
+#include "touchdown/drivers/input_device_monitor.hpp"
+#include "touchdown/core/logger.hpp"
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/utsname.h>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+namespace touchdown {
+namespace drivers {
+
+constexpr const char* SYSFS_INPUT_DIR = "/sys/class/input";
+constexpr const char* DEV_INPUT_DIR = "/dev/input";
+
+namespace {
+
+bool is_event_node(const char* name) {
+    return std::strncmp(name, "event", 5) == 0;
+}
+
+// Width of the words the kernel prints in capability bitmaps; a 64-bit
+// kernel may run a 32-bit userland, so ask the kernel instead of sizeof(long)
+unsigned int kernel_long_bits() {
+    struct utsname uts;
+    if (uname(&uts) == 0 && std::strstr(uts.machine, "64") != nullptr) {
+        return 64;
+    }
+    return sizeof(long) * 8;
+}
+
+std::vector<uint64_t> parse_bitmap(const std::string& text) {
+    static const unsigned int word_bits = kernel_long_bits();
+
+    // Words are printed most significant first
+    std::vector<std::string> words;
+    std::istringstream iss(text);
+    std::string word;
+    while (iss >> word) {
+        words.push_back(word);
+    }
+
+    std::vector<uint64_t> bits;
+    unsigned int bit_offset = 0;
+    for (auto it = words.rbegin(); it != words.rend(); ++it) {
+        uint64_t value = std::stoull(*it, nullptr, 16);
+        size_t index = bit_offset / 64;
+        if (bits.size() <= index) bits.resize(index + 1, 0);
+        bits[index] |= value << (bit_offset % 64);
+        bit_offset += word_bits;
+    }
+
+    return bits;
+}
+
+} // namespace
+
+bool InputDeviceInfo::has_key(unsigned int code) const {
+    size_t index = code / 64;
+    if (index >= key_bits.size()) return false;
+    return (key_bits[index] >> (code % 64)) & 1;
+}
+
+InputDeviceMonitor::InputDeviceMonitor()
+    : loop_(nullptr)
+    , inotify_fd_(-1) {
+}
+
+InputDeviceMonitor::~InputDeviceMonitor() {
+    deinit();
+}
+
+bool InputDeviceMonitor::init(EventLoop& loop) {
+    loop_ = &loop;
+
+    // Watch before enumerating so a device appearing in between isn't missed
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+        TD_LOG_ERROR("InputDeviceMonitor", "Failed to create inotify instance");
+        return false;
+    }
+
+    // IN_ATTRIB catches udev fixing up permissions after the node appears
+    if (inotify_add_watch(inotify_fd_, DEV_INPUT_DIR, IN_CREATE | IN_DELETE | IN_ATTRIB) < 0) {
+        TD_LOG_ERROR("InputDeviceMonitor", "Failed to watch ", DEV_INPUT_DIR);
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+        return false;
+    }
+
+    loop_->add_fd(inotify_fd_, EPOLLIN, [this](uint32_t) { handle_inotify(); });
+
+    enumerate();
+
+    TD_LOG_INFO("InputDeviceMonitor", "Found ", devices_.size(), " input devices");
+    return true;
+}
+
+void InputDeviceMonitor::deinit() {
+    if (inotify_fd_ >= 0) {
+        if (loop_) loop_->remove_fd(inotify_fd_);
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+    }
+
+    devices_.clear();
+}
+
+const InputDeviceInfo* InputDeviceMonitor::find_by_key(unsigned int code) const {
+    for (const auto& [event_name, info] : devices_) {
+        if (info.has_key(code)) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<InputDeviceInfo> InputDeviceMonitor::get_devices() const {
+    std::vector<InputDeviceInfo> devices;
+    for (const auto& [event_name, info] : devices_) {
+        devices.push_back(info);
+    }
+    return devices;
+}
+
+void InputDeviceMonitor::set_device_added_callback(DeviceCallback callback) {
+    added_callback_ = callback;
+}
+
+void InputDeviceMonitor::set_device_removed_callback(DeviceCallback callback) {
+    removed_callback_ = callback;
+}
+
+void InputDeviceMonitor::enumerate() {
+    DIR* dir = opendir(SYSFS_INPUT_DIR);
+    if (!dir) {
+        TD_LOG_WARNING("InputDeviceMonitor", "Cannot read ", SYSFS_INPUT_DIR);
+        return;
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+        if (!is_event_node(entry->d_name)) continue;
+
+        // Inaccessible nodes are picked up by IN_ATTRIB once udev is done
+        InputDeviceInfo info;
+        if (probe(entry->d_name, info) && access(info.node.c_str(), R_OK) == 0) {
+            devices_[entry->d_name] = info;
+        }
+    }
+
+    closedir(dir);
+}
+
+bool InputDeviceMonitor::probe(const std::string& event_name, InputDeviceInfo& info) const {
+    std::string sysfs = std::string(SYSFS_INPUT_DIR) + "/" + event_name + "/device/";
+
+    std::ifstream name_file(sysfs + "name");
+    if (!name_file.is_open()) return false;
+    std::getline(name_file, info.name);
+
+    std::ifstream key_file(sysfs + "capabilities/key");
+    if (key_file.is_open()) {
+        std::string bitmap;
+        std::getline(key_file, bitmap);
+        info.key_bits = parse_bitmap(bitmap);
+    }
+
+    info.node = std::string(DEV_INPUT_DIR) + "/" + event_name;
+    return true;
+}
+
+void InputDeviceMonitor::handle_inotify() {
+    alignas(struct inotify_event) char buf[4096];
+
+    ssize_t len;
+    while ((len = read(inotify_fd_, buf, sizeof(buf))) > 0) {
+        for (char* ptr = buf; ptr < buf + len;) {
+            auto* event = reinterpret_cast<struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0 || !is_event_node(event->name)) continue;
+
+            if (event->mask & IN_DELETE) {
+                on_node_removed(event->name);
+            } else if (event->mask & (IN_CREATE | IN_ATTRIB)) {
+                on_node_added(event->name);
+            }
+        }
+    }
+}
+
+void InputDeviceMonitor::on_node_added(const std::string& event_name) {
+    if (devices_.count(event_name)) return;
+
+    InputDeviceInfo info;
+    if (!probe(event_name, info)) return;
+
+    // The node may not be accessible yet; a later IN_ATTRIB retries
+    if (access(info.node.c_str(), R_OK) != 0) return;
+
+    devices_[event_name] = info;
+
+    TD_LOG_INFO("InputDeviceMonitor", "Device added: ", info.node, " (", info.name, ")");
+    if (added_callback_) {
+        added_callback_(info);
+    }
+}
+
+void InputDeviceMonitor::on_node_removed(const std::string& event_name) {
+    auto it = devices_.find(event_name);
+    if (it == devices_.end()) return;
+
+    InputDeviceInfo info = it->second;
+    devices_.erase(it);
+
+    TD_LOG_INFO("InputDeviceMonitor", "Device removed: ", info.node);
+    if (removed_callback_) {
+        removed_callback_(info);
+    }
+}
+
+} // namespace drivers
+} // namespace touchdown
@@ -0,0 +1,101 @@
+/**
+ * @file sysfs_attribute.cpp
+ * @brief sysfs attribute file implementation
+ */
+
+#include "touchdown/drivers/sysfs_attribute.hpp"
+#include "touchdown/core/logger.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/magic.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace touchdown {
+namespace drivers {
+
+SysfsAttribute::SysfsAttribute()
+    : fd_(-1)
+    , fake_(false) {
+}
+
+SysfsAttribute::~SysfsAttribute() {
+    close();
+}
+
+SysfsAttribute::SysfsAttribute(SysfsAttribute&& other) noexcept
+    : fd_(other.fd_)
+    , fake_(other.fake_) {
+    other.fd_ = -1;
+}
+
+SysfsAttribute& SysfsAttribute::operator=(SysfsAttribute&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd_ = other.fd_;
+        fake_ = other.fake_;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+bool SysfsAttribute::open(const std::string& path, int flags) {
+    close();
+
+    fd_ = ::open(path.c_str(), flags | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    struct statfs fs;
+    fake_ = fstatfs(fd_, &fs) == 0 && fs.f_type != SYSFS_MAGIC;
+    return true;
+}
+
+void SysfsAttribute::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    fake_ = false;
+}
+
+bool SysfsAttribute::read(std::string& value) const {
+    char buf[256];
+    ssize_t n = pread(fd_, buf, sizeof(buf) - 1, 0);
+    if (n < 0) {
+        value.clear();
+        return false;
+    }
+
+    value.assign(buf, static_cast<size_t>(n));
+    value.erase(value.find_last_not_of(" \n") + 1);
+    return true;
+}
+
+bool SysfsAttribute::write(const std::string& value) {
+    ssize_t n = pwrite(fd_, value.data(), value.size(), 0);
+    if (n != static_cast<ssize_t>(value.size())) {
+        if (n >= 0) errno = EIO;
+        return false;
+    }
+
+    // The value is in place either way; a longer old one would trail it
+    if (fake_ && ftruncate(fd_, static_cast<off_t>(value.size())) < 0) {
+        TD_LOG_WARNING("SysfsAttribute", "Cannot truncate fake attribute");
+    }
+    return true;
+}
+
+bool SysfsAttribute::read_file(const std::string& path, std::string& value) {
+    SysfsAttribute attribute;
+    return attribute.open(path, O_RDONLY) && attribute.read(value);
+}
+
+bool SysfsAttribute::write_file(const std::string& path, const std::string& value) {
+    SysfsAttribute attribute;
+    return attribute.open(path, O_WRONLY) && attribute.write(value);
+}
+
+} // namespace drivers
+} // namespace touchdown
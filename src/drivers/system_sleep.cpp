@@ -0,0 +1,149 @@
+/**
+ * @file system_sleep.cpp
+ * @brief System suspend implementation
+ */
+
+#include "touchdown/drivers/system_sleep.hpp"
+#include "touchdown/core/logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <fcntl.h>
+
+namespace touchdown {
+namespace drivers {
+
+namespace {
+
+uint64_t clock_us(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+} // namespace
+
+SystemSleep::SystemSleep() {
+}
+
+SystemSleep::~SystemSleep() {
+}
+
+bool SystemSleep::init(const std::string& root, const std::string& state) {
+    root_ = root;
+    state_ = state;
+
+    std::string supported;
+    if (!SysfsAttribute::read_file(root_ + "/power/state", supported)) {
+        TD_LOG_WARNING("SystemSleep", "No ", root_, "/power/state");
+        return false;
+    }
+
+    std::istringstream states(supported);
+    std::string name;
+    bool found = false;
+    while (states >> name) {
+        found = found || name == state_;
+    }
+    if (!found) {
+        TD_LOG_WARNING("SystemSleep", "Sleep state ", state_, " not supported (", supported, ")");
+        return false;
+    }
+
+    if (!state_file_.open(root_ + "/power/state", O_WRONLY)) {
+        TD_LOG_WARNING("SystemSleep", "Cannot open power/state: ", std::strerror(errno));
+        return false;
+    }
+
+    if (state_file_.is_fake()) {
+        TD_LOG_INFO("SystemSleep", "Dry run: suspend to ", state_, " only writes to ", root_);
+    } else {
+        TD_LOG_INFO("SystemSleep", "Suspend to ", state_);
+    }
+    return true;
+}
+
+void SystemSleep::set_wakeup_devices(const std::vector<std::string>& devices) {
+    wakeup_devices_ = devices;
+}
+
+bool SystemSleep::suspend(SleepResult& result) {
+    result = SleepResult();
+    if (!state_file_.is_open()) return false;
+
+    std::vector<std::string> previous;
+    if (!enable_wakeups(previous)) {
+        TD_LOG_WARNING("SystemSleep", "Not every wake source could be enabled");
+    }
+
+    if (claim_wakeup_count()) {
+        uint64_t boot_before = clock_us(CLOCK_BOOTTIME);
+        uint64_t mono_before = clock_us(CLOCK_MONOTONIC);
+
+        // Returns after resume, or at once with EBUSY if a wake event raced us
+        bool written = state_file_.write(state_);
+        int error = errno;
+
+        result.resumed_us = clock_us(CLOCK_MONOTONIC);
+        uint64_t boot_elapsed = clock_us(CLOCK_BOOTTIME) - boot_before;
+        uint64_t mono_elapsed = result.resumed_us - mono_before;
+        result.slept_us = boot_elapsed > mono_elapsed ? boot_elapsed - mono_elapsed : 0;
+
+        if (!written) {
+            TD_LOG_WARNING("SystemSleep", "Suspend refused: ", std::strerror(error));
+        } else {
+            result.ok = true;
+        }
+    } else {
+        TD_LOG_INFO("SystemSleep", "Wake event pending, not suspending");
+        result.resumed_us = clock_us(CLOCK_MONOTONIC);
+    }
+
+    restore_wakeups(previous);
+    return result.ok;
+}
+
+bool SystemSleep::enable_wakeups(std::vector<std::string>& previous) {
+    bool ok = true;
+    previous.clear();
+
+    for (const std::string& device : wakeup_devices_) {
+        std::string path = root_ + "/" + device + "/power/wakeup";
+        std::string value;
+        if (!SysfsAttribute::read_file(path, value)) {
+            TD_LOG_WARNING("SystemSleep", "No wakeup control for ", device);
+            previous.emplace_back();
+            ok = false;
+            continue;
+        }
+
+        previous.push_back(value);
+        if (value != "enabled" && !SysfsAttribute::write_file(path, "enabled")) {
+            TD_LOG_WARNING("SystemSleep", "Cannot enable wakeup for ", device);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void SystemSleep::restore_wakeups(const std::vector<std::string>& previous) {
+    for (size_t i = 0; i < previous.size() && i < wakeup_devices_.size(); i++) {
+        if (previous[i].empty() || previous[i] == "enabled") continue;
+        SysfsAttribute::write_file(root_ + "/" + wakeup_devices_[i] + "/power/wakeup", previous[i]);
+    }
+}
+
+bool SystemSleep::claim_wakeup_count() {
+    // Writing back the count just read fails if a wake event has been
+    // registered in between; kernels without the file skip the check
+    std::string path = root_ + "/power/wakeup_count";
+    std::string count;
+    if (!SysfsAttribute::read_file(path, count)) {
+        return true;
+    }
+    return SysfsAttribute::write_file(path, count);
+}
+
+} // namespace drivers
+} // namespace touchdown
@@ -0,0 +1,87 @@
+/**
+ * @file thermal_zones.cpp
+ * @brief Thermal zone implementation
+ */
+
+#include "touchdown/drivers/thermal_zones.hpp"
+#include "touchdown/core/logger.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace touchdown {
+namespace drivers {
+
+ThermalZones::ThermalZones() {
+}
+
+ThermalZones::~ThermalZones() {
+    for (Zone& zone : zones_) {
+        close(zone.fd);
+    }
+}
+
+bool ThermalZones::init(const std::string& root, const std::vector<std::string>& types) {
+    DIR* dir = opendir(root.c_str());
+    if (!dir) {
+        TD_LOG_WARNING("ThermalZones", "No thermal class: ", root);
+        return false;
+    }
+
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dir)) {
+        if (std::string(entry->d_name).compare(0, 12, "thermal_zone") == 0) {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string& name : names) {
+        std::string base = root + "/" + name + "/";
+
+        std::string type;
+        std::ifstream type_file(base + "type");
+        type_file >> type;
+        if (!types.empty() && std::find(types.begin(), types.end(), type) == types.end()) {
+            continue;
+        }
+
+        Zone zone;
+        zone.name = name + " (" + type + ")";
+        zone.fd = open((base + "temp").c_str(), O_RDONLY | O_CLOEXEC);
+        if (zone.fd < 0) {
+            TD_LOG_WARNING("ThermalZones", "Cannot open ", zone.name, " temp");
+            continue;
+        }
+
+        TD_LOG_INFO("ThermalZones", "Watching ", zone.name);
+        zones_.push_back(zone);
+    }
+
+    return !zones_.empty();
+}
+
+bool ThermalZones::read(int32_t& temp_mc) {
+    bool found = false;
+
+    for (Zone& zone : zones_) {
+        char buf[16];
+        ssize_t n = pread(zone.fd, buf, sizeof(buf) - 1, 0);
+        if (n <= 0) continue;  // Sensor not ready, e.g. right after resume
+        buf[n] = '\0';
+
+        int32_t value = static_cast<int32_t>(std::strtol(buf, nullptr, 10));
+        if (!found || value > temp_mc) {
+            temp_mc = value;
+        }
+        found = true;
+    }
+    return found;
+}
+
+} // namespace drivers
+} // namespace touchdown
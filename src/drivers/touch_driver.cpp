@@ -4,13 +4,17 @@
  */
 
 #include "touchdown/drivers/touch_driver.hpp"
+#include "touchdown/drivers/i2c_bus.hpp"
 #include "touchdown/core/logger.hpp"
 #include "touchdown/core/utils.hpp"
+#include "touchdown/core/event_loop.hpp"
 #include <fcntl.h>
 #include <unistd.h>
-#include <linux/i2c-dev.h>
+#include <linux/gpio.h>
 #include <sys/ioctl.h>
 #include <cstring>
+#include <thread>
+#include <chrono>
 
 namespace touchdown {
 namespace drivers {
@@ -23,14 +27,32 @@ constexpr uint8_t REG_XPOS_L = 0x04;
 constexpr uint8_t REG_YPOS_H = 0x05;
 constexpr uint8_t REG_YPOS_L = 0x06;
 
+// CST816S power management registers
+constexpr uint8_t REG_SLEEP_MODE = 0xE5;
+constexpr uint8_t REG_AUTO_SLEEP_TIME = 0xF9;
+constexpr uint8_t REG_IRQ_CTL = 0xFA;
+constexpr uint8_t REG_DIS_AUTO_SLEEP = 0xFE;
+
+constexpr uint8_t SLEEP_MODE_DEEP = 0x03;
+constexpr uint8_t IRQ_EN_TOUCH = 0x40;
+constexpr uint8_t IRQ_EN_CHANGE = 0x20;
+
+constexpr uint8_t DEFAULT_AUTO_SLEEP_S = 5;
+
 constexpr uint32_t LONG_PRESS_THRESHOLD_MS = 500;
 constexpr float SWIPE_THRESHOLD = 50.0f;
 
 class TouchDriver::Impl {
 public:
-    int i2c_fd = -1;
+    std::unique_ptr<I2CBus> bus;
     uint8_t address = 0x15;
     
+    std::string reset_chip;
+    uint32_t reset_line = 0;
+    
+    int irq_fd = -1;
+    uint64_t irq_timestamp_us = 0;  // Edge that triggered the pending sample
+    
     int16_t last_x = 0;
     int16_t last_y = 0;
     bool touched = false;
@@ -40,7 +62,10 @@ TouchDriver::TouchDriver()
     : impl_(std::make_unique<Impl>())
     , indev_(nullptr)
     , touch_active_(false)
-    , press_start_time_(0) {
+    , press_start_time_(0)
+    , power_mode_(TouchPowerMode::ACTIVE)
+    , power_mode_programmed_(false)
+    , auto_sleep_timeout_s_(DEFAULT_AUTO_SLEEP_S) {
 }
 
 TouchDriver::~TouchDriver() {
@@ -50,40 +75,110 @@ TouchDriver::~TouchDriver() {
 bool TouchDriver::init(const std::string& device, uint8_t address) {
     TD_LOG_INFO("TouchDriver", "Initializing touch controller: ", device);
     
-    impl_->i2c_fd = open(device.c_str(), O_RDWR);
-    if (impl_->i2c_fd < 0) {
-        TD_LOG_ERROR("TouchDriver", "Failed to open I2C device: ", device);
+    auto bus = std::make_unique<LinuxI2CBus>();
+    if (!bus->open(device, address)) {
         return false;
     }
     
-    if (ioctl(impl_->i2c_fd, I2C_SLAVE, address) < 0) {
-        TD_LOG_ERROR("TouchDriver", "Failed to set I2C slave address: ", (int)address);
-        close(impl_->i2c_fd);
+    impl_->address = address;
+    
+    if (!init(std::move(bus))) {
         return false;
     }
     
-    impl_->address = address;
-    
-    // Initialize LVGL input device
+    TD_LOG_INFO("TouchDriver", "Touch controller initialized");
+    return true;
+}
+
+bool TouchDriver::create_input_device() {
     indev_ = lv_indev_create();
     if (!indev_) {
         TD_LOG_ERROR("TouchDriver", "Failed to create LVGL input device");
-        close(impl_->i2c_fd);
         return false;
     }
     
     lv_indev_set_type(indev_, LV_INDEV_TYPE_POINTER);
     lv_indev_set_read_cb(indev_, read_cb);
     lv_indev_set_user_data(indev_, this);
+    return true;
+}
+
+bool TouchDriver::enable_irq(const std::string& chip, uint32_t line) {
+    int chip_fd = open(chip.c_str(), O_RDWR | O_CLOEXEC);
+    if (chip_fd < 0) {
+        TD_LOG_ERROR("TouchDriver", "Failed to open GPIO chip: ", chip);
+        return false;
+    }
+    
+    // The controller pulls its IRQ line low to report a touch or a change
+    struct gpio_v2_line_request req = {};
+    req.offsets[0] = line;
+    req.num_lines = 1;
+    req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    std::strncpy(req.consumer, "touchdown-touch-irq", sizeof(req.consumer) - 1);
+    
+    int ret = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req);
+    close(chip_fd);
+    
+    if (ret < 0) {
+        TD_LOG_ERROR("TouchDriver", "Failed to request IRQ line: ", line);
+        return false;
+    }
+    
+    fcntl(req.fd, F_SETFL, fcntl(req.fd, F_GETFL) | O_NONBLOCK);
+    
+    if (impl_->irq_fd >= 0) close(impl_->irq_fd);
+    impl_->irq_fd = req.fd;
+    
+    TD_LOG_INFO("TouchDriver", "Touch IRQ on ", chip, " line ", line);
+    return true;
+}
+
+int TouchDriver::get_irq_fd() const {
+    return impl_->irq_fd;
+}
+
+bool TouchDriver::handle_irq() {
+    struct gpio_v2_line_event events[16];
+    
+    ssize_t n;
+    
+    // Only the latest edge matters, the registers hold the current state
+    while ((n = read(impl_->irq_fd, events, sizeof(events))) > 0) {
+        size_t count = static_cast<size_t>(n) / sizeof(events[0]);
+        if (count > 0) {
+            impl_->irq_timestamp_us = events[count - 1].timestamp_ns / 1000;
+        }
+    }
+    
+    return sample();
+}
+
+bool TouchDriver::poll() {
+    return sample();
+}
+
+bool TouchDriver::init(std::unique_ptr<I2CBus> bus) {
+    impl_->bus = std::move(bus);
+    
+    // Start in full-rate scanning; the power service moves us to
+    // a low-power mode once the power state machine says so. On failure
+    // the mode stays unprogrammed, so the next switch writes it in full.
+    power_mode_ = TouchPowerMode::ACTIVE;
+    power_mode_programmed_ = write_power_registers(power_mode_);
+    if (!power_mode_programmed_) {
+        TD_LOG_WARNING("TouchDriver", "Failed to program power registers");
+    }
     
-    TD_LOG_INFO("TouchDriver", "Touch controller initialized");
     return true;
 }
 
 void TouchDriver::deinit() {
-    if (impl_->i2c_fd >= 0) {
-        close(impl_->i2c_fd);
-        impl_->i2c_fd = -1;
+    impl_->bus.reset();
+    
+    if (impl_->irq_fd >= 0) {
+        close(impl_->irq_fd);
+        impl_->irq_fd = -1;
     }
     
     TD_LOG_INFO("TouchDriver", "Touch controller deinitialized");
@@ -95,23 +190,33 @@ void TouchDriver::read_cb(lv_indev_t* indev, lv_indev_data_t* data) {
 }
 
 void TouchDriver::read_touch(lv_indev_data_t* data) {
-    if (impl_->i2c_fd < 0) {
-        data->state = LV_INDEV_STATE_RELEASED;
-        return;
+    bool touched = sample();
+    
+    data->point.x = impl_->last_x;
+    data->point.y = impl_->last_y;
+    data->state = touched ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+bool TouchDriver::sample() {
+    if (!impl_->bus) {
+        return false;
     }
     
     // Read touch data from CST816S
     uint8_t buf[6];
-    uint8_t reg = REG_GESTURE_ID;
     
-    if (write(impl_->i2c_fd, &reg, 1) != 1 || read(impl_->i2c_fd, buf, 6) != 6) {
-        data->state = LV_INDEV_STATE_RELEASED;
+    if (!impl_->bus->read_registers(REG_GESTURE_ID, buf, sizeof(buf))) {
         impl_->touched = false;
-        return;
+        return false;
     }
     
     uint8_t touch_num = buf[1];
     
+    // The IRQ edge is when the controller had the sample ready; polled
+    // reads have no better reference than now
+    uint64_t sample_us = impl_->irq_timestamp_us ? impl_->irq_timestamp_us : EventLoop::now_us();
+    impl_->irq_timestamp_us = 0;
+    
     if (touch_num > 0) {
         // Extract coordinates
         int16_t x = ((buf[2] & 0x0F) << 8) | buf[3];
@@ -130,12 +235,8 @@ void TouchDriver::read_touch(lv_indev_data_t* data) {
         impl_->last_y = y;
         impl_->touched = true;
         
-        data->point.x = x;
-        data->point.y = y;
-        data->state = LV_INDEV_STATE_PRESSED;
-        
         // Gesture detection
-        TouchPoint point = {x, y, TouchEventType::MOVE, Utils::get_timestamp_ms()};
+        TouchPoint point = {x, y, TouchEventType::MOVE, Utils::get_timestamp_ms(), sample_us};
         
         if (!touch_active_) {
             touch_active_ = true;
@@ -150,33 +251,34 @@ void TouchDriver::read_touch(lv_indev_data_t* data) {
         if (touch_callback_) {
             touch_callback_(point);
         }
-    } else {
-        data->point.x = impl_->last_x;
-        data->point.y = impl_->last_y;
-        data->state = LV_INDEV_STATE_RELEASED;
         
-        if (impl_->touched) {
-            // Touch release
-            impl_->touched = false;
+        return true;
+    }
+    
+    if (impl_->touched) {
+        // Touch release
+        impl_->touched = false;
+        
+        if (touch_active_) {
+            TouchPoint point = {impl_->last_x, impl_->last_y, TouchEventType::RELEASE,
+                                Utils::get_timestamp_ms(), sample_us};
+            
+            uint32_t duration = point.timestamp_ms - press_start_time_;
+            if (duration >= LONG_PRESS_THRESHOLD_MS) {
+                point.type = TouchEventType::LONG_PRESS;
+            } else {
+                point.type = TouchEventType::TAP;
+            }
             
-            if (touch_active_) {
-                TouchPoint point = {impl_->last_x, impl_->last_y, TouchEventType::RELEASE, Utils::get_timestamp_ms()};
-                
-                uint32_t duration = point.timestamp_ms - press_start_time_;
-                if (duration >= LONG_PRESS_THRESHOLD_MS) {
-                    point.type = TouchEventType::LONG_PRESS;
-                } else {
-                    point.type = TouchEventType::TAP;
-                }
-                
-                if (touch_callback_) {
-                    touch_callback_(point);
-                }
-                
-                touch_active_ = false;
+            if (touch_callback_) {
+                touch_callback_(point);
             }
+            
+            touch_active_ = false;
         }
     }
+    
+    return false;
 }
 
 void TouchDriver::detect_gestures(const TouchPoint& point) {
@@ -216,5 +318,129 @@ void TouchDriver::set_sensitivity(uint8_t sensitivity) {
     TD_LOG_DEBUG("TouchDriver", "Set sensitivity: ", (int)sensitivity);
 }
 
+bool TouchDriver::set_power_mode(TouchPowerMode mode) {
+    if (mode == power_mode_ && power_mode_programmed_) return true;
+    if (!impl_->bus) return false;
+    
+    TD_LOG_INFO("TouchDriver", "Power mode: ", static_cast<int>(power_mode_),
+                " -> ", static_cast<int>(mode));
+    
+    // Deep sleep ignores I2C traffic, only a reset brings the controller back
+    if (power_mode_ == TouchPowerMode::STANDBY && !reset_controller()) {
+        TD_LOG_ERROR("TouchDriver", "Cannot leave standby without a reset line");
+        return false;
+    }
+    
+    // Keep the old mode on failure so the next call redoes the whole switch
+    if (!write_power_registers(mode)) {
+        TD_LOG_ERROR("TouchDriver", "Failed to program power mode ", static_cast<int>(mode));
+        return false;
+    }
+    power_mode_ = mode;
+    power_mode_programmed_ = true;
+    
+    // Stop LVGL from polling the bus while the controller reports on IRQ only
+    if (indev_) {
+        lv_indev_enable(indev_, mode == TouchPowerMode::ACTIVE || mode == TouchPowerMode::AUTO_SLEEP);
+    }
+    
+    // Drop any half-finished gesture, the release will never be read
+    if (mode == TouchPowerMode::WAKE_ON_TOUCH || mode == TouchPowerMode::STANDBY) {
+        touch_active_ = false;
+        impl_->touched = false;
+    }
+    
+    return true;
+}
+
+bool TouchDriver::set_auto_sleep_timeout_s(uint8_t seconds) {
+    auto_sleep_timeout_s_ = seconds > 0 ? seconds : 1;
+    
+    if (power_mode_ != TouchPowerMode::AUTO_SLEEP || !power_mode_programmed_ || !impl_->bus) {
+        return true;
+    }
+    
+    // Left unprogrammed, the next switch to AUTO_SLEEP writes it again
+    if (!impl_->bus->write_register(REG_AUTO_SLEEP_TIME, auto_sleep_timeout_s_)) {
+        TD_LOG_ERROR("TouchDriver", "Failed to set auto-sleep timeout to ",
+                     static_cast<int>(auto_sleep_timeout_s_), "s");
+        power_mode_programmed_ = false;
+        return false;
+    }
+    return true;
+}
+
+void TouchDriver::set_reset_gpio(const std::string& chip, uint32_t line) {
+    impl_->reset_chip = chip;
+    impl_->reset_line = line;
+}
+
+bool TouchDriver::write_power_registers(TouchPowerMode mode) {
+    I2CBus* bus = impl_->bus.get();
+    bool ok = true;
+    
+    switch (mode) {
+        case TouchPowerMode::ACTIVE:
+            ok &= bus->write_register(REG_DIS_AUTO_SLEEP, 0x01);
+            ok &= bus->write_register(REG_IRQ_CTL, IRQ_EN_TOUCH | IRQ_EN_CHANGE);
+            break;
+            
+        case TouchPowerMode::AUTO_SLEEP:
+            ok &= bus->write_register(REG_AUTO_SLEEP_TIME, auto_sleep_timeout_s_);
+            ok &= bus->write_register(REG_DIS_AUTO_SLEEP, 0x00);
+            ok &= bus->write_register(REG_IRQ_CTL, IRQ_EN_TOUCH | IRQ_EN_CHANGE);
+            break;
+            
+        case TouchPowerMode::WAKE_ON_TOUCH:
+            // Sleep after one idle second and only pulse IRQ on a new touch
+            ok &= bus->write_register(REG_AUTO_SLEEP_TIME, 1);
+            ok &= bus->write_register(REG_DIS_AUTO_SLEEP, 0x00);
+            ok &= bus->write_register(REG_IRQ_CTL, IRQ_EN_TOUCH);
+            break;
+            
+        case TouchPowerMode::STANDBY:
+            ok &= bus->write_register(REG_SLEEP_MODE, SLEEP_MODE_DEEP);
+            break;
+    }
+    
+    return ok;
+}
+
+bool TouchDriver::reset_controller() {
+    if (impl_->reset_chip.empty()) return false;
+    
+    int chip_fd = open(impl_->reset_chip.c_str(), O_RDWR | O_CLOEXEC);
+    if (chip_fd < 0) {
+        TD_LOG_ERROR("TouchDriver", "Failed to open GPIO chip: ", impl_->reset_chip);
+        return false;
+    }
+    
+    struct gpio_v2_line_request req = {};
+    req.offsets[0] = impl_->reset_line;
+    req.num_lines = 1;
+    req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT | GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+    std::strncpy(req.consumer, "touchdown-touch-reset", sizeof(req.consumer) - 1);
+    
+    int ret = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req);
+    close(chip_fd);
+    
+    if (ret < 0) {
+        TD_LOG_ERROR("TouchDriver", "Failed to request reset line: ", impl_->reset_line);
+        return false;
+    }
+    
+    // Assert reset, then give the controller time to boot
+    struct gpio_v2_line_values values = {1, 1};
+    ioctl(req.fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    
+    values.bits = 0;
+    ioctl(req.fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+    close(req.fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    
+    return true;
+}
+
 } // namespace drivers
 } // namespace touchdown
@@ -5,6 +5,7 @@
 
 #include "touchdown/services/app_manager.hpp"
 #include "touchdown/core/logger.hpp"
+#include "touchdown/core/process.hpp"
 #include <unistd.h>
 #include <sys/wait.h>
 #include <signal.h>
@@ -108,23 +109,24 @@ bool AppManager::launch_python_app(const std::string& app_id,
                                   lv_obj_t* /* parent */) {
     TD_LOG_INFO("AppManager", "Launching Python app: ", app_id);
     
-    // Fork and execute Python script
-    pid_t pid = fork();
+    // Not fork(): the child would inherit the loop's blocked SIGTERM,
+    // and terminate_app() could never stop it
+    std::vector<std::string> command = {"/usr/bin/python3", script_path};
+    if (!app_slice_.empty()) {
+        // systemd-run --scope moves itself into the scope and then execs
+        // python, so the pid stays the app's for SIGSTOP and SIGTERM
+        command.insert(command.begin(), {
+            "systemd-run", "--scope", "--quiet", "--collect", "--slice=" + app_slice_,
+            "--description=TouchdownOS app " + app_id, "--"
+        });
+    }
+    pid_t pid = spawn_process(command);
     
     if (pid < 0) {
-        TD_LOG_ERROR("AppManager", "Fork failed for: ", app_id);
+        TD_LOG_ERROR("AppManager", "Failed to start Python app: ", app_id);
         return false;
     }
     
-    if (pid == 0) {
-        // Child process - execute Python app
-        execl("/usr/bin/python3", "python3", script_path.c_str(), nullptr);
-        
-        // If execl returns, it failed
-        TD_LOG_ERROR("AppManager", "Failed to exec Python app: ", app_id);
-        exit(1);
-    }
-    
     // Parent process - track the app
     ManagedApp managed;
     managed.instance = nullptr;  // Python apps are external processes
@@ -190,6 +192,30 @@ bool AppManager::resume_app(const std::string& app_id) {
     return true;
 }
 
+void AppManager::pause_all() {
+    for (auto& [app_id, managed] : apps_) {
+        if (managed.state == AppState::RUNNING && pause_app(app_id)) {
+            parked_apps_.push_back(app_id);
+        }
+    }
+}
+
+void AppManager::resume_all() {
+    // resume_app() makes each app active in turn; keep the one in front
+    std::string active = active_app_id_;
+    
+    for (const auto& app_id : parked_apps_) {
+        if (apps_.count(app_id)) {
+            resume_app(app_id);
+        }
+    }
+    parked_apps_.clear();
+    
+    if (apps_.count(active)) {
+        active_app_id_ = active;
+    }
+}
+
 bool AppManager::terminate_app(const std::string& app_id) {
     auto it = apps_.find(app_id);
     if (it == apps_.end()) {
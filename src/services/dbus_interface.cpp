@@ -1,94 +1,194 @@
 /**
  * @file dbus_interface.cpp
- * @brief D-Bus interface implementation
+ * @brief D-Bus interface helpers common to both backends
  */
 
 #include "touchdown/services/dbus_interface.hpp"
 #include "touchdown/core/logger.hpp"
 #include <systemd/sd-daemon.h>
-#include <cstring>
+#include <algorithm>
 
 namespace touchdown {
 namespace services {
 
-DBusInterface::DBusInterface(const std::string& service_name, const std::string& object_path)
-    : service_name_(service_name)
-    , object_path_(object_path)
-    , connection_(nullptr) {
+constexpr const char* ERROR_FAILED = "org.freedesktop.DBus.Error.Failed";
+
+void DBusInterface::send_signal(const std::string& interface, const std::string& name,
+                                const std::string& arg) {
+    Message msg = new_signal(interface, name);
+    if (!msg) return;
+
+    if (!arg.empty()) {
+        msg.append(arg);
+    }
+
+    send_message(std::move(msg));
 }
 
-DBusInterface::~DBusInterface() {
-    if (connection_) {
-        dbus_connection_unref(connection_);
+void DBusInterface::call_method(const std::string& destination, const std::string& path,
+                                const std::string& interface, const std::string& method,
+                                const std::string& arg) {
+    Message msg = new_method_call(destination, path, interface, method);
+    if (!msg) return;
+
+    if (!arg.empty()) {
+        msg.append(arg);
     }
+
+    // Fire and forget: no reply or error is routed back to us
+    call_method_async(std::move(msg), nullptr);
 }
 
-bool DBusInterface::init() {
-    DBusError error;
-    dbus_error_init(&error);
-    
-    // Connect to system bus
-    connection_ = dbus_bus_get(DBUS_BUS_SYSTEM, &error);
-    if (dbus_error_is_set(&error)) {
-        TD_LOG_ERROR("DBusInterface", "Failed to connect to D-Bus: ", error.message);
-        dbus_error_free(&error);
-        return false;
+void DBusInterface::notify_property_changed(const InterfaceInfo& info, int property) {
+    // Nobody can have read the old value before we are on the bus
+    if (!loop_) return;
+
+    PendingProperties& pending = pending_properties_[&info];
+    pending.changed |= 1ULL << property;
+    if (pending.scheduled) return;
+
+    pending.scheduled = true;
+    uint64_t next_us = pending.last_emit_us + PROPERTIES_CHANGED_INTERVAL_MS * 1000ULL;
+
+    if (EventLoop::now_us() >= next_us) {
+        // Quiet so far: send once the current handler is done, so changes
+        // made together go out together
+        loop_->post([this, &info]() { flush_properties(info); });
+        return;
     }
-    
-    // Request service name
-    int ret = dbus_bus_request_name(connection_, service_name_.c_str(),
-                                     DBUS_NAME_FLAG_REPLACE_EXISTING, &error);
-    
-    if (dbus_error_is_set(&error)) {
-        TD_LOG_ERROR("DBusInterface", "Failed to request name: ", error.message);
-        dbus_error_free(&error);
-        return false;
+
+    if (pending.timer == EventLoop::INVALID_TIMER) {
+        pending.timer = loop_->add_timer([this, &info]() { flush_properties(info); });
     }
-    
-    if (ret != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
-        TD_LOG_ERROR("DBusInterface", "Not primary owner of name: ", service_name_);
-        return false;
+    loop_->arm_timer_at(pending.timer, next_us);
+}
+
+void DBusInterface::flush_properties(const InterfaceInfo& info) {
+    PendingProperties& pending = pending_properties_[&info];
+    pending.scheduled = false;
+    if (pending.changed == 0) return;
+
+    emit_properties_changed(info, pending.changed);
+    pending.changed = 0;
+    pending.last_emit_us = EventLoop::now_us();
+}
+
+void DBusInterface::release_timers() {
+    for (auto& [info, pending] : pending_properties_) {
+        if (loop_ && pending.timer != EventLoop::INVALID_TIMER) {
+            loop_->remove_timer(pending.timer);
+        }
     }
-    
-    // Add message filter
-    dbus_connection_add_filter(connection_, message_handler, this, nullptr);
-    
-    TD_LOG_INFO("DBusInterface", "D-Bus service initialized: ", service_name_);
-    return true;
-}
-
-void DBusInterface::process() {
-    if (!connection_) return;
-    
-    // Process pending messages
-    while (dbus_connection_dispatch(connection_) == DBUS_DISPATCH_DATA_REMAINS) {
-        // Continue processing
+    pending_properties_.clear();
+
+    if (loop_ && watchdog_timer_ != EventLoop::INVALID_TIMER) {
+        loop_->remove_timer(watchdog_timer_);
     }
-    
-    // Read messages without blocking
-    dbus_connection_read_write(connection_, 0);
+    watchdog_timer_ = EventLoop::INVALID_TIMER;
 }
 
-void DBusInterface::send_signal(const std::string& interface, const std::string& name, 
-                                const std::string& arg) {
-    if (!connection_) return;
-    
-    DBusMessage* msg = dbus_message_new_signal(object_path_.c_str(), 
-                                               interface.c_str(), 
-                                               name.c_str());
-    if (!msg) {
-        TD_LOG_ERROR("DBusInterface", "Failed to create signal message");
-        return;
+struct DeferredReply::State {
+    DBusInterface* owner;
+    std::weak_ptr<int> owner_alive;
+    Message call;
+    std::string member;
+    uint64_t start_us;
+    uint64_t loop_us = 0;
+    bool in_handler = true;
+    bool sent = false;
+
+    ~State() {
+        if (!sent && !owner_alive.expired()) {
+            TD_LOG_WARNING("DBusInterface", member, ": deferred reply dropped without an answer");
+            finish(call.new_error(ERROR_FAILED, "Method failed"));
+        }
     }
-    
-    if (!arg.empty()) {
-        const char* str = arg.c_str();
-        dbus_message_append_args(msg, DBUS_TYPE_STRING, &str, DBUS_TYPE_INVALID);
+
+    void finish(Message reply) {
+        sent = true;
+        if (owner_alive.expired()) return;
+
+        uint64_t total_us = EventLoop::now_us() - start_us;
+        owner->record_method(member, total_us, in_handler ? total_us : loop_us, true);
+        if (reply) {
+            owner->send_message(std::move(reply));
+        }
+    }
+};
+
+Message DeferredReply::new_method_return() const {
+    return state_ ? state_->call.new_method_return() : Message();
+}
+
+void DeferredReply::send(Message reply) {
+    if (!state_ || state_->sent) return;
+
+    if (!reply) {
+        reply = state_->call.new_error(ERROR_FAILED, "Method failed");
+    }
+    state_->finish(std::move(reply));
+}
+
+void DeferredReply::send_error(const char* name, const char* text) {
+    if (!state_ || state_->sent) return;
+
+    state_->finish(state_->call.new_error(name, text));
+}
+
+DeferredReply DBusInterface::defer_reply(Message& call) {
+    if (!deferring_) {
+        deferring_ = std::make_shared<DeferredReply::State>();
+        deferring_->owner = this;
+        deferring_->owner_alive = alive_;
+        deferring_->call = Message::ref(call.get_raw());
+        deferring_->member = call.get_member() ? call.get_member() : "";
+        deferring_->start_us = method_start_us_;
+    }
+    return DeferredReply(deferring_);
+}
+
+void DBusInterface::begin_method() {
+    method_start_us_ = EventLoop::now_us();
+    deferring_.reset();
+}
+
+bool DBusInterface::end_method(const char* member) {
+    uint64_t loop_us = EventLoop::now_us() - method_start_us_;
+
+    if (deferring_) {
+        // Counted when the reply goes out, which may have been already
+        deferring_->loop_us = loop_us;
+        deferring_->in_handler = false;
+        deferring_.reset();
+        return true;
+    }
+
+    record_method(member, loop_us, loop_us, false);
+    return false;
+}
+
+void DBusInterface::record_method(const std::string& member, uint64_t total_us, uint64_t loop_us,
+                                  bool deferred) {
+    MethodStats& stats = method_stats_[member];
+    stats.calls++;
+    stats.total_us += total_us;
+    stats.max_us = std::max(stats.max_us, total_us);
+    stats.loop_us += loop_us;
+    stats.loop_max_us = std::max(stats.loop_max_us, loop_us);
+    if (deferred) stats.deferred++;
+
+    if (loop_us >= SLOW_METHOD_MS * 1000ULL) {
+        TD_LOG_WARNING("DBusInterface", member, " blocked the event loop for ", loop_us, "us");
+    }
+}
+
+void DBusInterface::log_method_stats() const {
+    for (const auto& [member, stats] : method_stats_) {
+        TD_LOG_INFO("DBusInterface", member, ": ", stats.calls, " calls, mean ",
+                    stats.total_us / stats.calls, "us, max ", stats.max_us, "us, on loop mean ",
+                    stats.loop_us / stats.calls, "us, max ", stats.loop_max_us, "us, ",
+                    stats.deferred, " deferred");
     }
-    
-    dbus_connection_send(connection_, msg, nullptr);
-    dbus_connection_flush(connection_);
-    dbus_message_unref(msg);
 }
 
 void DBusInterface::notify_ready() {
@@ -100,43 +200,22 @@ void DBusInterface::send_watchdog() {
     sd_notify(0, "WATCHDOG=1");
 }
 
-void DBusInterface::register_method(const std::string& interface, const std::string& method,
-                                   MethodHandler handler) {
-    MethodKey key{interface, method};
-    method_handlers_[key] = handler;
-}
-
-DBusMessage* DBusInterface::handle_message(DBusMessage* msg) {
-    const char* interface = dbus_message_get_interface(msg);
-    const char* member = dbus_message_get_member(msg);
-    
-    if (!interface || !member) return nullptr;
-    
-    MethodKey key{interface, member};
-    auto it = method_handlers_.find(key);
-    
-    if (it != method_handlers_.end()) {
-        return it->second(msg);
+uint32_t DBusInterface::start_watchdog() {
+    uint64_t timeout_us = 0;
+    if (!loop_ || sd_watchdog_enabled(0, &timeout_us) <= 0 || timeout_us == 0) {
+        TD_LOG_DEBUG("DBusInterface", "Watchdog not enabled");
+        return 0;
     }
-    
-    return nullptr;
-}
 
-DBusHandlerResult DBusInterface::message_handler(DBusConnection* connection,
-                                                DBusMessage* message, void* user_data) {
-    DBusInterface* self = static_cast<DBusInterface*>(user_data);
-    
-    if (dbus_message_get_type(message) == DBUS_MESSAGE_TYPE_METHOD_CALL) {
-        DBusMessage* reply = self->handle_message(message);
-        
-        if (reply) {
-            dbus_connection_send(connection, reply, nullptr);
-            dbus_message_unref(reply);
-            return DBUS_HANDLER_RESULT_HANDLED;
-        }
+    // systemd recommends pinging at half the timeout; one timer, no polling
+    uint32_t interval_ms = static_cast<uint32_t>(std::max<uint64_t>(timeout_us / 2000, 1));
+    if (watchdog_timer_ == EventLoop::INVALID_TIMER) {
+        watchdog_timer_ = loop_->add_timer([this]() { send_watchdog(); });
     }
-    
-    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    loop_->arm_timer(watchdog_timer_, interval_ms, interval_ms);
+
+    TD_LOG_INFO("DBusInterface", "Watchdog ping every ", interval_ms, "ms");
+    return interval_ms;
 }
 
 } // namespace services
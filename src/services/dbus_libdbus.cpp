@@ -0,0 +1,938 @@
+/**
+ * @file dbus_libdbus.cpp
+ * @brief libdbus backend for DBusInterface and Message
+ */
+
+#include "touchdown/services/dbus_interface.hpp"
+#include "touchdown/core/logger.hpp"
+#include <dbus/dbus.h>
+#include <sys/epoll.h>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace touchdown {
+namespace services {
+
+// ---------------------------------------------------------------------------
+// Message
+// ---------------------------------------------------------------------------
+
+struct Message::Iter {
+    bool appending = false;
+    std::vector<DBusMessageIter> stack;
+};
+
+namespace {
+
+DBusMessage* raw_message(void* raw) {
+    return static_cast<DBusMessage*>(raw);
+}
+
+constexpr const char* INTROSPECTABLE_XML =
+    " <interface name=\"org.freedesktop.DBus.Introspectable\">\n"
+    "  <method name=\"Introspect\">\n"
+    "   <arg name=\"xml_data\" type=\"s\" direction=\"out\"/>\n"
+    "  </method>\n"
+    " </interface>\n";
+
+constexpr const char* PROPERTIES_XML =
+    " <interface name=\"org.freedesktop.DBus.Properties\">\n"
+    "  <method name=\"Get\">\n"
+    "   <arg name=\"interface_name\" type=\"s\" direction=\"in\"/>\n"
+    "   <arg name=\"property_name\" type=\"s\" direction=\"in\"/>\n"
+    "   <arg name=\"value\" type=\"v\" direction=\"out\"/>\n"
+    "  </method>\n"
+    "  <method name=\"GetAll\">\n"
+    "   <arg name=\"interface_name\" type=\"s\" direction=\"in\"/>\n"
+    "   <arg name=\"props\" type=\"a{sv}\" direction=\"out\"/>\n"
+    "  </method>\n"
+    "  <method name=\"Set\">\n"
+    "   <arg name=\"interface_name\" type=\"s\" direction=\"in\"/>\n"
+    "   <arg name=\"property_name\" type=\"s\" direction=\"in\"/>\n"
+    "   <arg name=\"value\" type=\"v\" direction=\"in\"/>\n"
+    "  </method>\n"
+    "  <signal name=\"PropertiesChanged\">\n"
+    "   <arg name=\"interface_name\" type=\"s\"/>\n"
+    "   <arg name=\"changed_properties\" type=\"a{sv}\"/>\n"
+    "   <arg name=\"invalidated_properties\" type=\"as\"/>\n"
+    "  </signal>\n"
+    " </interface>\n";
+
+} // namespace
+
+Message::Message() : raw_(nullptr) {
+}
+
+Message::~Message() {
+    if (raw_) {
+        dbus_message_unref(raw_message(raw_));
+    }
+}
+
+Message::Message(Message&& other) noexcept
+    : raw_(other.raw_)
+    , iter_(std::move(other.iter_)) {
+    other.raw_ = nullptr;
+}
+
+Message& Message::operator=(Message&& other) noexcept {
+    if (this != &other) {
+        if (raw_) {
+            dbus_message_unref(raw_message(raw_));
+        }
+        raw_ = other.raw_;
+        iter_ = std::move(other.iter_);
+        other.raw_ = nullptr;
+    }
+    return *this;
+}
+
+Message Message::adopt(void* raw) {
+    Message msg;
+    msg.raw_ = raw;
+    return msg;
+}
+
+Message Message::ref(void* raw) {
+    if (raw) {
+        dbus_message_ref(raw_message(raw));
+    }
+    return adopt(raw);
+}
+
+Message::Type Message::get_type() const {
+    if (!raw_) return Type::INVALID;
+
+    switch (dbus_message_get_type(raw_message(raw_))) {
+        case DBUS_MESSAGE_TYPE_METHOD_CALL:   return Type::METHOD_CALL;
+        case DBUS_MESSAGE_TYPE_METHOD_RETURN: return Type::METHOD_RETURN;
+        case DBUS_MESSAGE_TYPE_ERROR:         return Type::ERROR;
+        case DBUS_MESSAGE_TYPE_SIGNAL:        return Type::SIGNAL;
+        default:                              return Type::INVALID;
+    }
+}
+
+const char* Message::get_sender() const {
+    return raw_ ? dbus_message_get_sender(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_path() const {
+    return raw_ ? dbus_message_get_path(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_interface() const {
+    return raw_ ? dbus_message_get_interface(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_member() const {
+    return raw_ ? dbus_message_get_member(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_signature() const {
+    return raw_ ? dbus_message_get_signature(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_error_name() const {
+    return raw_ ? dbus_message_get_error_name(raw_message(raw_)) : nullptr;
+}
+
+Message Message::new_method_return() const {
+    if (!raw_) return Message();
+    return adopt(dbus_message_new_method_return(raw_message(raw_)));
+}
+
+Message Message::new_error(const char* name, const char* text) const {
+    if (!raw_) return Message();
+    return adopt(dbus_message_new_error(raw_message(raw_), name, text));
+}
+
+namespace {
+
+// libdbus reads through an external iterator; keep it next to the message
+DBusMessageIter* reading_iter(void* raw, std::unique_ptr<Message::Iter>& iter) {
+    if (!raw) return nullptr;
+
+    if (!iter) {
+        iter = std::make_unique<Message::Iter>();
+        iter->stack.emplace_back();
+        if (!dbus_message_iter_init(raw_message(raw), &iter->stack.back())) {
+            iter->stack.pop_back();  // No arguments
+        }
+    }
+    if (iter->appending || iter->stack.empty()) return nullptr;
+    return &iter->stack.back();
+}
+
+DBusMessageIter* appending_iter(void* raw, std::unique_ptr<Message::Iter>& iter) {
+    if (!raw) return nullptr;
+
+    if (!iter) {
+        iter = std::make_unique<Message::Iter>();
+        iter->appending = true;
+        iter->stack.emplace_back();
+        dbus_message_iter_init_append(raw_message(raw), &iter->stack.back());
+    }
+    return iter->appending ? &iter->stack.back() : nullptr;
+}
+
+bool read_basic(DBusMessageIter* it, int type, void* value) {
+    if (!it || dbus_message_iter_get_arg_type(it) != type) return false;
+
+    dbus_message_iter_get_basic(it, value);
+    dbus_message_iter_next(it);
+    return true;
+}
+
+bool append_basic(DBusMessageIter* it, int type, const void* value) {
+    return it && dbus_message_iter_append_basic(it, type, value);
+}
+
+} // namespace
+
+bool Message::read(bool& value) {
+    dbus_bool_t b = FALSE;
+    if (!read_basic(reading_iter(raw_, iter_), DBUS_TYPE_BOOLEAN, &b)) return false;
+    value = b;
+    return true;
+}
+
+bool Message::read(uint8_t& value) {
+    return read_basic(reading_iter(raw_, iter_), DBUS_TYPE_BYTE, &value);
+}
+
+bool Message::read(int16_t& value) {
+    return read_basic(reading_iter(raw_, iter_), DBUS_TYPE_INT16, &value);
+}
+
+bool Message::read(uint16_t& value) {
+    return read_basic(reading_iter(raw_, iter_), DBUS_TYPE_UINT16, &value);
+}
+
+bool Message::read(int32_t& value) {
+    return read_basic(reading_iter(raw_, iter_), DBUS_TYPE_INT32, &value);
+}
+
+bool Message::read(uint32_t& value) {
+    return read_basic(reading_iter(raw_, iter_), DBUS_TYPE_UINT32, &value);
+}
+
+bool Message::read(int64_t& value) {
+    dbus_int64_t v = 0;
+    if (!read_basic(reading_iter(raw_, iter_), DBUS_TYPE_INT64, &v)) return false;
+    value = v;
+    return true;
+}
+
+bool Message::read(uint64_t& value) {
+    dbus_uint64_t v = 0;
+    if (!read_basic(reading_iter(raw_, iter_), DBUS_TYPE_UINT64, &v)) return false;
+    value = v;
+    return true;
+}
+
+bool Message::read(double& value) {
+    return read_basic(reading_iter(raw_, iter_), DBUS_TYPE_DOUBLE, &value);
+}
+
+bool Message::read(std::string& value) {
+    DBusMessageIter* it = reading_iter(raw_, iter_);
+    const char* str = nullptr;
+
+    if (!it) return false;
+    int type = dbus_message_iter_get_arg_type(it);
+    if (type != DBUS_TYPE_STRING && type != DBUS_TYPE_OBJECT_PATH && type != DBUS_TYPE_SIGNATURE) {
+        return false;
+    }
+
+    dbus_message_iter_get_basic(it, &str);
+    dbus_message_iter_next(it);
+    value = str;
+    return true;
+}
+
+bool Message::read_fd(int& fd) {
+    // libdbus hands out a duplicate the caller owns
+    return read_basic(reading_iter(raw_, iter_), DBUS_TYPE_UNIX_FD, &fd);
+}
+
+bool Message::enter(char type, const char* /* contents */) {
+    DBusMessageIter* it = reading_iter(raw_, iter_);
+    if (!it || dbus_message_iter_get_arg_type(it) != type) return false;
+
+    DBusMessageIter sub;
+    dbus_message_iter_recurse(it, &sub);
+    iter_->stack.push_back(sub);
+    return true;
+}
+
+bool Message::exit() {
+    if (!iter_ || iter_->appending || iter_->stack.size() < 2) return false;
+
+    iter_->stack.pop_back();
+    dbus_message_iter_next(&iter_->stack.back());
+    return true;
+}
+
+bool Message::skip() {
+    DBusMessageIter* it = reading_iter(raw_, iter_);
+    if (!it || dbus_message_iter_get_arg_type(it) == DBUS_TYPE_INVALID) return false;
+
+    dbus_message_iter_next(it);
+    return true;
+}
+
+bool Message::at_end() {
+    DBusMessageIter* it = reading_iter(raw_, iter_);
+    return !it || dbus_message_iter_get_arg_type(it) == DBUS_TYPE_INVALID;
+}
+
+bool Message::append(bool value) {
+    dbus_bool_t b = value ? TRUE : FALSE;
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_BOOLEAN, &b);
+}
+
+bool Message::append(uint8_t value) {
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_BYTE, &value);
+}
+
+bool Message::append(int16_t value) {
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_INT16, &value);
+}
+
+bool Message::append(uint16_t value) {
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_UINT16, &value);
+}
+
+bool Message::append(int32_t value) {
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_INT32, &value);
+}
+
+bool Message::append(uint32_t value) {
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_UINT32, &value);
+}
+
+bool Message::append(int64_t value) {
+    dbus_int64_t v = value;
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_INT64, &v);
+}
+
+bool Message::append(uint64_t value) {
+    dbus_uint64_t v = value;
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_UINT64, &v);
+}
+
+bool Message::append(double value) {
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_DOUBLE, &value);
+}
+
+bool Message::append(const char* value) {
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_STRING, &value);
+}
+
+bool Message::append_fd(int fd) {
+    return append_basic(appending_iter(raw_, iter_), DBUS_TYPE_UNIX_FD, &fd);
+}
+
+bool Message::open(char type, const char* contents) {
+    DBusMessageIter* it = appending_iter(raw_, iter_);
+    if (!it) return false;
+
+    // libdbus wants the contents signature only for arrays and variants
+    const char* signature = (type == DBUS_TYPE_ARRAY || type == DBUS_TYPE_VARIANT) ? contents : nullptr;
+
+    DBusMessageIter sub;
+    if (!dbus_message_iter_open_container(it, type, signature, &sub)) return false;
+    iter_->stack.push_back(sub);
+    return true;
+}
+
+bool Message::close() {
+    if (!iter_ || !iter_->appending || iter_->stack.size() < 2) return false;
+
+    DBusMessageIter sub = iter_->stack.back();
+    iter_->stack.pop_back();
+    return dbus_message_iter_close_container(&iter_->stack.back(), &sub);
+}
+
+// ---------------------------------------------------------------------------
+// DBusInterface
+// ---------------------------------------------------------------------------
+
+class DBusInterface::Impl {
+public:
+    struct MethodKey {
+        std::string interface;
+        std::string method;
+
+        bool operator<(const MethodKey& other) const {
+            return std::tie(interface, method) < std::tie(other.interface, other.method);
+        }
+    };
+
+    struct MethodEntry {
+        std::string signature;
+        MethodHandler handler;
+    };
+
+    struct ExportedInterface {
+        const InterfaceInfo* info;
+        InterfaceDispatcher dispatcher;
+        PropertyGetter getter;
+    };
+
+    explicit Impl(DBusInterface* owner) : owner(owner) {}
+
+    DBusInterface* owner;
+    DBusConnection* connection = nullptr;
+    EventLoop* loop = nullptr;
+
+    std::map<MethodKey, MethodEntry> method_handlers;
+    std::vector<ExportedInterface> exported;
+    std::map<MethodKey, SignalHandler> signal_handlers;
+
+    // Event loop integration
+    std::map<int, std::vector<DBusWatch*>> watches;
+    std::map<int, uint32_t> watched_fds;
+    std::map<DBusTimeout*, EventLoop::TimerId> timeouts;
+    bool dispatch_scheduled = false;
+
+    void attach_to_loop();
+    void detach_from_loop();
+    void update_watch_fd(int fd);
+    void handle_watch_fd(int fd, uint32_t events);
+    void dispatch();
+
+    const ExportedInterface* find_exported(const char* interface) const;
+    Message introspect(Message& call);
+    Message handle_properties(Message& call, const char* member);
+    static bool append_property(const ExportedInterface& entry, int property, Message& msg);
+    static Message check_signature(Message& call, const char* expected);
+
+    static DBusHandlerResult message_handler(DBusConnection* connection,
+                                             DBusMessage* message, void* user_data);
+    static void pending_call_notify(DBusPendingCall* pending, void* data);
+
+    static dbus_bool_t add_watch(DBusWatch* watch, void* data);
+    static void remove_watch(DBusWatch* watch, void* data);
+    static void toggle_watch(DBusWatch* watch, void* data);
+    static dbus_bool_t add_timeout(DBusTimeout* timeout, void* data);
+    static void remove_timeout(DBusTimeout* timeout, void* data);
+    static void toggle_timeout(DBusTimeout* timeout, void* data);
+    static void dispatch_status_changed(DBusConnection* connection,
+                                        DBusDispatchStatus status, void* data);
+};
+
+DBusInterface::DBusInterface(const std::string& service_name, const std::string& object_path)
+    : service_name_(service_name)
+    , object_path_(object_path)
+    , loop_(nullptr)
+    , impl_(std::make_unique<Impl>(this)) {
+}
+
+DBusInterface::~DBusInterface() {
+    release_timers();
+
+    if (impl_->connection) {
+        impl_->detach_from_loop();
+        dbus_connection_remove_filter(impl_->connection, Impl::message_handler, impl_.get());
+        dbus_connection_unref(impl_->connection);
+    }
+}
+
+const char* DBusInterface::get_backend_name() {
+    return "libdbus";
+}
+
+bool DBusInterface::init(EventLoop& loop) {
+    loop_ = &loop;
+    impl_->loop = &loop;
+
+    DBusError error;
+    dbus_error_init(&error);
+
+    // Connect to system bus
+    impl_->connection = dbus_bus_get(DBUS_BUS_SYSTEM, &error);
+    if (dbus_error_is_set(&error)) {
+        TD_LOG_ERROR("DBusInterface", "Failed to connect to D-Bus: ", error.message);
+        dbus_error_free(&error);
+        return false;
+    }
+
+    // Request service name
+    int ret = dbus_bus_request_name(impl_->connection, service_name_.c_str(),
+                                    DBUS_NAME_FLAG_REPLACE_EXISTING, &error);
+
+    if (dbus_error_is_set(&error)) {
+        TD_LOG_ERROR("DBusInterface", "Failed to request name: ", error.message);
+        dbus_error_free(&error);
+        return false;
+    }
+
+    if (ret != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+        TD_LOG_ERROR("DBusInterface", "Not primary owner of name: ", service_name_);
+        return false;
+    }
+
+    // Add message filter
+    dbus_connection_add_filter(impl_->connection, Impl::message_handler, impl_.get(), nullptr);
+
+    impl_->attach_to_loop();
+
+    TD_LOG_INFO("DBusInterface", "D-Bus service initialized: ", service_name_);
+    return true;
+}
+
+Message DBusInterface::new_signal(const std::string& interface, const std::string& name) {
+    if (!impl_->connection) return Message();
+
+    DBusMessage* msg = dbus_message_new_signal(object_path_.c_str(),
+                                               interface.c_str(),
+                                               name.c_str());
+    if (!msg) {
+        TD_LOG_ERROR("DBusInterface", "Failed to create signal message");
+    }
+    return Message::adopt(msg);
+}
+
+Message DBusInterface::new_method_call(const std::string& destination, const std::string& path,
+                                       const std::string& interface, const std::string& method) {
+    if (!impl_->connection) return Message();
+
+    DBusMessage* msg = dbus_message_new_method_call(destination.c_str(), path.c_str(),
+                                                    interface.c_str(), method.c_str());
+    if (!msg) {
+        TD_LOG_ERROR("DBusInterface", "Failed to create method call message");
+    }
+    return Message::adopt(msg);
+}
+
+void DBusInterface::send_message(Message msg) {
+    if (!impl_->connection || !msg) return;
+
+    // No flush: blocking here would stall the loop behind a slow reader
+    dbus_connection_send(impl_->connection, raw_message(msg.get_raw()), nullptr);
+}
+
+void DBusInterface::register_method(const std::string& interface, const std::string& method,
+                                    const std::string& signature, const std::string& /* result */,
+                                    MethodHandler handler) {
+    Impl::MethodKey key{interface, method};
+    impl_->method_handlers[key] = Impl::MethodEntry{signature, handler};
+}
+
+void DBusInterface::register_signal_handler(const std::string& interface, const std::string& name,
+                                            SignalHandler handler) {
+    Impl::MethodKey key{interface, name};
+    impl_->signal_handlers[key] = handler;
+
+    if (impl_->connection) {
+        std::string rule = "type='signal',interface='" + interface + "',member='" + name + "'";
+        dbus_bus_add_match(impl_->connection, rule.c_str(), nullptr);
+    }
+}
+
+bool DBusInterface::call_method_async(Message msg, ReplyHandler handler, int timeout_ms) {
+    if (!impl_->connection || !msg) {
+        TD_LOG_ERROR("DBusInterface", "Failed to send method call");
+        if (handler) {
+            Message none;
+            handler(none);
+        }
+        return false;
+    }
+
+    DBusMessage* raw = raw_message(msg.get_raw());
+
+    if (!handler) {
+        dbus_message_set_no_reply(raw, TRUE);
+        dbus_connection_send(impl_->connection, raw, nullptr);
+        return true;
+    }
+
+    DBusPendingCall* pending = nullptr;
+    if (!dbus_connection_send_with_reply(impl_->connection, raw, &pending, timeout_ms) || !pending) {
+        TD_LOG_ERROR("DBusInterface", "Failed to send method call");
+        Message none;
+        handler(none);
+        return false;
+    }
+
+    auto* data = new ReplyHandler(std::move(handler));
+    dbus_pending_call_set_notify(pending, Impl::pending_call_notify, data,
+                                 [](void* p) { delete static_cast<ReplyHandler*>(p); });
+    dbus_pending_call_unref(pending);
+    return true;
+}
+
+void DBusInterface::register_interface(const InterfaceInfo& info, InterfaceDispatcher dispatcher,
+                                       PropertyGetter getter) {
+    impl_->exported.push_back(Impl::ExportedInterface{&info, std::move(dispatcher), std::move(getter)});
+}
+
+void DBusInterface::emit_properties_changed(const InterfaceInfo& info, uint64_t changed) {
+    const Impl::ExportedInterface* entry = impl_->find_exported(info.name);
+    if (!entry) return;
+
+    Message msg = new_signal(DBUS_INTERFACE_PROPERTIES, "PropertiesChanged");
+    if (!msg) return;
+
+    msg.append(info.name);
+    msg.open('a', "{sv}");
+    for (size_t i = 0; i < info.property_count; i++) {
+        if (!(changed & (1ULL << i))) continue;
+
+        msg.open('e', "sv");
+        msg.append(info.properties[i].name);
+        Impl::append_property(*entry, static_cast<int>(i), msg);
+        msg.close();
+    }
+    msg.close();
+    msg.open('a', "s");  // Nothing invalidated, values are always sent
+    msg.close();
+
+    send_message(std::move(msg));
+}
+
+bool DBusInterface::Impl::append_property(const ExportedInterface& entry, int property, Message& msg) {
+    if (!entry.getter) return false;
+
+    msg.open('v', entry.info->properties[property].signature);
+    bool ok = entry.getter(property, msg);
+    msg.close();
+    return ok;
+}
+
+Message DBusInterface::Impl::handle_properties(Message& call, const char* member) {
+    std::string interface;
+    std::string name;
+
+    if (std::strcmp(member, "GetAll") == 0) {
+        if (!call.read(interface)) {
+            return call.new_error(DBUS_ERROR_INVALID_ARGS, "Expected an interface name");
+        }
+
+        const ExportedInterface* entry = find_exported(interface.c_str());
+        if (!entry) {
+            return call.new_error(DBUS_ERROR_UNKNOWN_INTERFACE, interface.c_str());
+        }
+
+        Message reply = call.new_method_return();
+        reply.open('a', "{sv}");
+        for (size_t i = 0; i < entry->info->property_count; i++) {
+            reply.open('e', "sv");
+            reply.append(entry->info->properties[i].name);
+            append_property(*entry, static_cast<int>(i), reply);
+            reply.close();
+        }
+        reply.close();
+        return reply;
+    }
+
+    bool get = std::strcmp(member, "Get") == 0;
+    if (!get && std::strcmp(member, "Set") != 0) {
+        return call.new_error(DBUS_ERROR_UNKNOWN_METHOD, member);
+    }
+    if (!call.read_args(interface, name)) {
+        return call.new_error(DBUS_ERROR_INVALID_ARGS, "Expected interface and property names");
+    }
+
+    const ExportedInterface* entry = find_exported(interface.c_str());
+    if (!entry) {
+        return call.new_error(DBUS_ERROR_UNKNOWN_INTERFACE, interface.c_str());
+    }
+
+    for (size_t i = 0; i < entry->info->property_count; i++) {
+        if (name != entry->info->properties[i].name) continue;
+
+        if (!get) {
+            return call.new_error(DBUS_ERROR_PROPERTY_READ_ONLY, name.c_str());
+        }
+
+        Message reply = call.new_method_return();
+        append_property(*entry, static_cast<int>(i), reply);
+        return reply;
+    }
+    return call.new_error(DBUS_ERROR_UNKNOWN_PROPERTY, name.c_str());
+}
+
+const DBusInterface::Impl::ExportedInterface* DBusInterface::Impl::find_exported(const char* interface) const {
+    // A service exports one or two interfaces, a scan beats any map
+    for (const ExportedInterface& entry : exported) {
+        if (std::strcmp(entry.info->name, interface) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+Message DBusInterface::Impl::check_signature(Message& call, const char* expected) {
+    if (std::strcmp(call.get_signature(), expected) == 0) {
+        return Message();
+    }
+    std::string text = std::string("Expected signature ") + expected;
+    return call.new_error(DBUS_ERROR_INVALID_ARGS, text.c_str());
+}
+
+Message DBusInterface::Impl::introspect(Message& call) {
+    // sd-bus builds this from its vtables; here only generated interfaces
+    // carry a description
+    std::string xml = DBUS_INTROSPECT_1_0_XML_DOCTYPE_DECL_NODE;
+    xml += "<node>\n";
+    xml += INTROSPECTABLE_XML;
+    xml += PROPERTIES_XML;
+    for (const ExportedInterface& entry : exported) {
+        xml += entry.info->introspection;
+    }
+    xml += "</node>\n";
+
+    Message reply = call.new_method_return();
+    reply.append(xml);
+    return reply;
+}
+
+void DBusInterface::Impl::pending_call_notify(DBusPendingCall* pending, void* data) {
+    auto* handler = static_cast<ReplyHandler*>(data);
+
+    Message reply = Message::adopt(dbus_pending_call_steal_reply(pending));
+    if (*handler) {
+        (*handler)(reply);
+    }
+}
+
+DBusHandlerResult DBusInterface::Impl::message_handler(DBusConnection* connection,
+                                                       DBusMessage* message, void* user_data) {
+    auto* self = static_cast<Impl*>(user_data);
+
+    const char* interface = dbus_message_get_interface(message);
+    const char* member = dbus_message_get_member(message);
+    if (!interface || !member) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+
+    if (dbus_message_get_type(message) == DBUS_MESSAGE_TYPE_METHOD_CALL) {
+        Message call = Message::ref(message);
+        Message reply;
+
+        const ExportedInterface* exported = self->find_exported(interface);
+        if (exported) {
+            // Generated interfaces resolve the member with their perfect hash
+            int index = exported->info->lookup(member);
+            if (index < 0) {
+                return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+            }
+
+            reply = check_signature(call, exported->info->methods[index].signature);
+            if (!reply) {
+                self->owner->begin_method();
+                reply = exported->dispatcher(index, call);
+                if (self->owner->end_method(member)) {
+                    return DBUS_HANDLER_RESULT_HANDLED;
+                }
+            }
+        } else if (std::strcmp(interface, DBUS_INTERFACE_PROPERTIES) == 0 &&
+                   self->owner->object_path_ == call.get_path()) {
+            reply = self->handle_properties(call, member);
+        } else if (std::strcmp(interface, DBUS_INTERFACE_INTROSPECTABLE) == 0 &&
+                   std::strcmp(member, "Introspect") == 0 &&
+                   self->owner->object_path_ == call.get_path()) {
+            reply = self->introspect(call);
+        } else {
+            auto it = self->method_handlers.find(MethodKey{interface, member});
+            if (it == self->method_handlers.end()) {
+                return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+            }
+
+            reply = check_signature(call, it->second.signature.c_str());
+            if (!reply) {
+                self->owner->begin_method();
+                reply = it->second.handler(call);
+                if (self->owner->end_method(member)) {
+                    return DBUS_HANDLER_RESULT_HANDLED;
+                }
+            }
+        }
+
+        if (!reply) {
+            reply = call.new_error(DBUS_ERROR_FAILED, "Method failed");
+        }
+        if (reply && !dbus_message_get_no_reply(message)) {
+            dbus_connection_send(connection, raw_message(reply.get_raw()), nullptr);
+        }
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+
+    if (dbus_message_get_type(message) == DBUS_MESSAGE_TYPE_SIGNAL) {
+        auto it = self->signal_handlers.find(MethodKey{interface, member});
+        if (it != self->signal_handlers.end()) {
+            Message signal = Message::ref(message);
+            it->second(signal);
+        }
+    }
+
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+void DBusInterface::Impl::attach_to_loop() {
+    dbus_connection_set_watch_functions(connection, add_watch, remove_watch,
+                                        toggle_watch, this, nullptr);
+    dbus_connection_set_timeout_functions(connection, add_timeout, remove_timeout,
+                                          toggle_timeout, this, nullptr);
+    dbus_connection_set_dispatch_status_function(connection, dispatch_status_changed,
+                                                 this, nullptr);
+
+    // Messages may have been queued while requesting the name
+    dispatch_status_changed(connection, dbus_connection_get_dispatch_status(connection), this);
+}
+
+void DBusInterface::Impl::detach_from_loop() {
+    if (!loop) return;
+
+    // Clearing the functions removes every watch and timeout from the loop
+    dbus_connection_set_watch_functions(connection, nullptr, nullptr, nullptr, nullptr, nullptr);
+    dbus_connection_set_timeout_functions(connection, nullptr, nullptr, nullptr, nullptr, nullptr);
+    dbus_connection_set_dispatch_status_function(connection, nullptr, nullptr, nullptr);
+    loop = nullptr;
+}
+
+void DBusInterface::Impl::update_watch_fd(int fd) {
+    // libdbus may hand out separate read and write watches for one socket,
+    // epoll needs a single registration with the union of both
+    uint32_t events = 0;
+    for (DBusWatch* watch : watches[fd]) {
+        if (!dbus_watch_get_enabled(watch)) continue;
+
+        unsigned int flags = dbus_watch_get_flags(watch);
+        if (flags & DBUS_WATCH_READABLE) events |= EPOLLIN;
+        if (flags & DBUS_WATCH_WRITABLE) events |= EPOLLOUT;
+    }
+
+    auto it = watched_fds.find(fd);
+
+    if (events == 0) {
+        if (it != watched_fds.end()) {
+            loop->remove_fd(fd);
+            watched_fds.erase(it);
+        }
+        if (watches[fd].empty()) {
+            watches.erase(fd);
+        }
+    } else if (it == watched_fds.end()) {
+        if (loop->add_fd(fd, events, [this, fd](uint32_t ev) { handle_watch_fd(fd, ev); })) {
+            watched_fds[fd] = events;
+        }
+    } else if (it->second != events) {
+        loop->modify_fd(fd, events);
+        it->second = events;
+    }
+}
+
+void DBusInterface::Impl::handle_watch_fd(int fd, uint32_t events) {
+    // Copy: handling a watch may add or remove watches on this fd
+    std::vector<DBusWatch*> fd_watches = watches[fd];
+
+    for (DBusWatch* watch : fd_watches) {
+        if (!dbus_watch_get_enabled(watch)) continue;
+
+        unsigned int watch_flags = dbus_watch_get_flags(watch);
+        unsigned int flags = 0;
+        if ((events & EPOLLIN) && (watch_flags & DBUS_WATCH_READABLE)) flags |= DBUS_WATCH_READABLE;
+        if ((events & EPOLLOUT) && (watch_flags & DBUS_WATCH_WRITABLE)) flags |= DBUS_WATCH_WRITABLE;
+        if (events & EPOLLERR) flags |= DBUS_WATCH_ERROR;
+        if (events & EPOLLHUP) flags |= DBUS_WATCH_HANGUP;
+
+        if (flags) {
+            dbus_watch_handle(watch, flags);
+        }
+    }
+
+    dispatch();
+}
+
+void DBusInterface::Impl::dispatch() {
+    dispatch_scheduled = false;
+
+    while (dbus_connection_dispatch(connection) == DBUS_DISPATCH_DATA_REMAINS) {
+        // Continue processing
+    }
+}
+
+dbus_bool_t DBusInterface::Impl::add_watch(DBusWatch* watch, void* data) {
+    auto* self = static_cast<Impl*>(data);
+    int fd = dbus_watch_get_unix_fd(watch);
+
+    self->watches[fd].push_back(watch);
+    self->update_watch_fd(fd);
+    return TRUE;
+}
+
+void DBusInterface::Impl::remove_watch(DBusWatch* watch, void* data) {
+    auto* self = static_cast<Impl*>(data);
+    int fd = dbus_watch_get_unix_fd(watch);
+
+    auto& list = self->watches[fd];
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        if (*it == watch) {
+            list.erase(it);
+            break;
+        }
+    }
+    self->update_watch_fd(fd);
+}
+
+void DBusInterface::Impl::toggle_watch(DBusWatch* watch, void* data) {
+    auto* self = static_cast<Impl*>(data);
+    self->update_watch_fd(dbus_watch_get_unix_fd(watch));
+}
+
+dbus_bool_t DBusInterface::Impl::add_timeout(DBusTimeout* timeout, void* data) {
+    auto* self = static_cast<Impl*>(data);
+
+    EventLoop::TimerId id = self->loop->add_timer([timeout]() {
+        dbus_timeout_handle(timeout);
+    });
+    if (id == EventLoop::INVALID_TIMER) return FALSE;
+
+    self->timeouts[timeout] = id;
+    toggle_timeout(timeout, data);
+    return TRUE;
+}
+
+void DBusInterface::Impl::remove_timeout(DBusTimeout* timeout, void* data) {
+    auto* self = static_cast<Impl*>(data);
+
+    auto it = self->timeouts.find(timeout);
+    if (it != self->timeouts.end()) {
+        self->loop->remove_timer(it->second);
+        self->timeouts.erase(it);
+    }
+}
+
+void DBusInterface::Impl::toggle_timeout(DBusTimeout* timeout, void* data) {
+    auto* self = static_cast<Impl*>(data);
+
+    auto it = self->timeouts.find(timeout);
+    if (it == self->timeouts.end()) return;
+
+    if (dbus_timeout_get_enabled(timeout)) {
+        uint32_t interval = dbus_timeout_get_interval(timeout);
+        self->loop->arm_timer(it->second, interval, interval);
+    } else {
+        self->loop->disarm_timer(it->second);
+    }
+}
+
+void DBusInterface::Impl::dispatch_status_changed(DBusConnection* /* connection */,
+                                                  DBusDispatchStatus status, void* data) {
+    auto* self = static_cast<Impl*>(data);
+
+    // libdbus forbids dispatching from inside this callback, defer to the loop
+    if (status == DBUS_DISPATCH_DATA_REMAINS && !self->dispatch_scheduled) {
+        self->dispatch_scheduled = true;
+        self->loop->post([self]() { self->dispatch(); });
+    }
+}
+
+} // namespace services
+} // namespace touchdown
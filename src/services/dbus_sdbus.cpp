@@ -0,0 +1,716 @@
+/**
+ * @file dbus_sdbus.cpp
+ * @brief sd-bus backend for DBusInterface and Message
+ */
+
+#include "touchdown/services/dbus_interface.hpp"
+#include "touchdown/core/logger.hpp"
+#include <systemd/sd-bus.h>
+#include <systemd/sd-event.h>
+#include <sys/epoll.h>
+#include <fcntl.h>
+#include <cstring>
+#include <map>
+#include <vector>
+
+extern "C" {
+sd_bus_vtable td_sdbus_vtable_start(void);
+sd_bus_vtable td_sdbus_vtable_method(const char* member, const char* signature,
+                                     const char* result, sd_bus_message_handler_t handler,
+                                     size_t offset);
+sd_bus_vtable td_sdbus_vtable_property(const char* member, const char* signature,
+                                       sd_bus_property_get_t getter, size_t offset);
+sd_bus_vtable td_sdbus_vtable_end(void);
+}
+
+namespace touchdown {
+namespace services {
+
+// ---------------------------------------------------------------------------
+// Message
+// ---------------------------------------------------------------------------
+
+// sd-bus keeps the read/append cursor inside the message itself
+struct Message::Iter {
+};
+
+namespace {
+
+sd_bus_message* raw_message(void* raw) {
+    return static_cast<sd_bus_message*>(raw);
+}
+
+bool read_basic(void* raw, char type, void* value) {
+    return raw && sd_bus_message_read_basic(raw_message(raw), type, value) > 0;
+}
+
+bool append_basic(void* raw, char type, const void* value) {
+    return raw && sd_bus_message_append_basic(raw_message(raw), type, value) >= 0;
+}
+
+} // namespace
+
+Message::Message() : raw_(nullptr) {
+}
+
+Message::~Message() {
+    if (raw_) {
+        sd_bus_message_unref(raw_message(raw_));
+    }
+}
+
+Message::Message(Message&& other) noexcept
+    : raw_(other.raw_)
+    , iter_(std::move(other.iter_)) {
+    other.raw_ = nullptr;
+}
+
+Message& Message::operator=(Message&& other) noexcept {
+    if (this != &other) {
+        if (raw_) {
+            sd_bus_message_unref(raw_message(raw_));
+        }
+        raw_ = other.raw_;
+        iter_ = std::move(other.iter_);
+        other.raw_ = nullptr;
+    }
+    return *this;
+}
+
+Message Message::adopt(void* raw) {
+    Message msg;
+    msg.raw_ = raw;
+    return msg;
+}
+
+Message Message::ref(void* raw) {
+    if (raw) {
+        sd_bus_message_ref(raw_message(raw));
+    }
+    return adopt(raw);
+}
+
+Message::Type Message::get_type() const {
+    uint8_t type = 0;
+    if (!raw_ || sd_bus_message_get_type(raw_message(raw_), &type) < 0) return Type::INVALID;
+
+    switch (type) {
+        case SD_BUS_MESSAGE_METHOD_CALL:   return Type::METHOD_CALL;
+        case SD_BUS_MESSAGE_METHOD_RETURN: return Type::METHOD_RETURN;
+        case SD_BUS_MESSAGE_METHOD_ERROR:  return Type::ERROR;
+        case SD_BUS_MESSAGE_SIGNAL:        return Type::SIGNAL;
+        default:                           return Type::INVALID;
+    }
+}
+
+const char* Message::get_sender() const {
+    return raw_ ? sd_bus_message_get_sender(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_path() const {
+    return raw_ ? sd_bus_message_get_path(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_interface() const {
+    return raw_ ? sd_bus_message_get_interface(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_member() const {
+    return raw_ ? sd_bus_message_get_member(raw_message(raw_)) : nullptr;
+}
+
+const char* Message::get_signature() const {
+    return raw_ ? sd_bus_message_get_signature(raw_message(raw_), 1) : nullptr;
+}
+
+const char* Message::get_error_name() const {
+    if (!raw_) return nullptr;
+
+    const sd_bus_error* error = sd_bus_message_get_error(raw_message(raw_));
+    return error ? error->name : nullptr;
+}
+
+Message Message::new_method_return() const {
+    sd_bus_message* reply = nullptr;
+    if (!raw_ || sd_bus_message_new_method_return(raw_message(raw_), &reply) < 0) {
+        return Message();
+    }
+    return adopt(reply);
+}
+
+Message Message::new_error(const char* name, const char* text) const {
+    sd_bus_error error = {};
+    sd_bus_message* reply = nullptr;
+
+    sd_bus_error_set_const(&error, name, text);
+    if (!raw_ || sd_bus_message_new_method_error(raw_message(raw_), &reply, &error) < 0) {
+        return Message();
+    }
+    return adopt(reply);
+}
+
+bool Message::read(bool& value) {
+    int b = 0;
+    if (!read_basic(raw_, 'b', &b)) return false;
+    value = b != 0;
+    return true;
+}
+
+bool Message::read(uint8_t& value) {
+    return read_basic(raw_, 'y', &value);
+}
+
+bool Message::read(int16_t& value) {
+    return read_basic(raw_, 'n', &value);
+}
+
+bool Message::read(uint16_t& value) {
+    return read_basic(raw_, 'q', &value);
+}
+
+bool Message::read(int32_t& value) {
+    return read_basic(raw_, 'i', &value);
+}
+
+bool Message::read(uint32_t& value) {
+    return read_basic(raw_, 'u', &value);
+}
+
+bool Message::read(int64_t& value) {
+    return read_basic(raw_, 'x', &value);
+}
+
+bool Message::read(uint64_t& value) {
+    return read_basic(raw_, 't', &value);
+}
+
+bool Message::read(double& value) {
+    return read_basic(raw_, 'd', &value);
+}
+
+bool Message::read(std::string& value) {
+    char type = 0;
+    const char* str = nullptr;
+
+    if (!raw_ || sd_bus_message_peek_type(raw_message(raw_), &type, nullptr) <= 0) return false;
+    if (type != 's' && type != 'o' && type != 'g') return false;
+    if (!read_basic(raw_, type, &str)) return false;
+
+    value = str;
+    return true;
+}
+
+bool Message::read_fd(int& fd) {
+    int borrowed = -1;
+    if (!read_basic(raw_, 'h', &borrowed)) return false;
+
+    // sd-bus keeps ownership of the received fd, hand out our own like libdbus
+    fd = fcntl(borrowed, F_DUPFD_CLOEXEC, 3);
+    return fd >= 0;
+}
+
+bool Message::enter(char type, const char* contents) {
+    return raw_ && sd_bus_message_enter_container(raw_message(raw_), type, contents) > 0;
+}
+
+bool Message::exit() {
+    return raw_ && sd_bus_message_exit_container(raw_message(raw_)) >= 0;
+}
+
+bool Message::skip() {
+    return raw_ && sd_bus_message_skip(raw_message(raw_), nullptr) > 0;
+}
+
+bool Message::at_end() {
+    return !raw_ || sd_bus_message_at_end(raw_message(raw_), 0) > 0;
+}
+
+bool Message::append(bool value) {
+    int b = value ? 1 : 0;
+    return append_basic(raw_, 'b', &b);
+}
+
+bool Message::append(uint8_t value) {
+    return append_basic(raw_, 'y', &value);
+}
+
+bool Message::append(int16_t value) {
+    return append_basic(raw_, 'n', &value);
+}
+
+bool Message::append(uint16_t value) {
+    return append_basic(raw_, 'q', &value);
+}
+
+bool Message::append(int32_t value) {
+    return append_basic(raw_, 'i', &value);
+}
+
+bool Message::append(uint32_t value) {
+    return append_basic(raw_, 'u', &value);
+}
+
+bool Message::append(int64_t value) {
+    return append_basic(raw_, 'x', &value);
+}
+
+bool Message::append(uint64_t value) {
+    return append_basic(raw_, 't', &value);
+}
+
+bool Message::append(double value) {
+    return append_basic(raw_, 'd', &value);
+}
+
+bool Message::append(const char* value) {
+    return append_basic(raw_, 's', value);
+}
+
+bool Message::append_fd(int fd) {
+    return append_basic(raw_, 'h', &fd);
+}
+
+bool Message::open(char type, const char* contents) {
+    return raw_ && sd_bus_message_open_container(raw_message(raw_), type, contents) >= 0;
+}
+
+bool Message::close() {
+    return raw_ && sd_bus_message_close_container(raw_message(raw_)) >= 0;
+}
+
+// ---------------------------------------------------------------------------
+// DBusInterface
+// ---------------------------------------------------------------------------
+
+class DBusInterface::Impl {
+public:
+    // A property when getter is set; result and handler are then unused
+    struct MethodEntry {
+        DBusInterface* owner;
+        std::string member;
+        std::string signature;
+        std::string result;
+        MethodHandler handler;
+        int property = -1;
+        PropertyGetter getter;
+    };
+
+    // One vtable per interface. The vtable's userdata is the entry array and
+    // each member's offset selects its entry, so sd-bus hands the callback
+    // its handler directly instead of us looking it up by name.
+    struct ObjectInterface {
+        std::vector<MethodEntry> methods;
+        std::vector<sd_bus_vtable> vtable;
+        sd_bus_slot* slot = nullptr;
+    };
+
+    struct SignalEntry {
+        std::string interface;
+        std::string member;
+        SignalHandler handler;
+        sd_bus_slot* slot = nullptr;
+    };
+
+    sd_bus* bus = nullptr;
+    sd_event* event = nullptr;
+    int event_fd = -1;
+    EventLoop* loop = nullptr;
+    bool run_scheduled = false;
+
+    std::string service_name;
+    std::string object_path;
+    std::map<std::string, std::unique_ptr<ObjectInterface>> interfaces;
+    std::vector<std::unique_ptr<SignalEntry>> signals;
+
+    bool publish(const std::string& interface, ObjectInterface& object);
+    bool subscribe(SignalEntry& entry);
+    void run();
+    void schedule_run();
+
+    static int method_callback(sd_bus_message* m, void* userdata, sd_bus_error* error);
+    static int property_callback(sd_bus* bus, const char* path, const char* interface,
+                                 const char* property, sd_bus_message* reply, void* userdata,
+                                 sd_bus_error* error);
+    static int signal_callback(sd_bus_message* m, void* userdata, sd_bus_error* error);
+    static int reply_callback(sd_bus_message* m, void* userdata, sd_bus_error* error);
+    static int name_callback(sd_bus_message* m, void* userdata, sd_bus_error* error);
+};
+
+DBusInterface::DBusInterface(const std::string& service_name, const std::string& object_path)
+    : service_name_(service_name)
+    , object_path_(object_path)
+    , loop_(nullptr)
+    , impl_(std::make_unique<Impl>()) {
+    impl_->object_path = object_path;
+}
+
+DBusInterface::~DBusInterface() {
+    release_timers();
+
+    for (auto& [name, object] : impl_->interfaces) {
+        sd_bus_slot_unref(object->slot);
+    }
+    for (auto& entry : impl_->signals) {
+        sd_bus_slot_unref(entry->slot);
+    }
+
+    if (impl_->loop && impl_->event_fd >= 0) {
+        impl_->loop->remove_fd(impl_->event_fd);
+    }
+    if (impl_->bus) {
+        sd_bus_detach_event(impl_->bus);
+        sd_bus_flush_close_unref(impl_->bus);
+    }
+    if (impl_->event) {
+        sd_event_unref(impl_->event);
+    }
+}
+
+const char* DBusInterface::get_backend_name() {
+    return "sd-bus";
+}
+
+bool DBusInterface::init(EventLoop& loop) {
+    loop_ = &loop;
+    impl_->loop = &loop;
+    impl_->service_name = service_name_;
+
+    // Connecting does not wait for the bus: Hello goes out with the first message
+    int r = sd_bus_open_system_with_description(&impl_->bus, service_name_.c_str());
+    if (r < 0) {
+        TD_LOG_ERROR("DBusInterface", "Failed to connect to D-Bus: ", std::strerror(-r));
+        return false;
+    }
+
+    // Neither does the name: the request is queued behind Hello and its
+    // reply only logged. Type=dbus units are started once the name shows
+    // up, and clients follow NameOwnerChanged, so nothing needs it sooner.
+    r = sd_bus_request_name_async(impl_->bus, nullptr, service_name_.c_str(),
+                                  SD_BUS_NAME_REPLACE_EXISTING, Impl::name_callback, impl_.get());
+    if (r < 0) {
+        TD_LOG_ERROR("DBusInterface", "Failed to request name ", service_name_, ": ",
+                     std::strerror(-r));
+        return false;
+    }
+
+    // sd-bus runs on a private sd-event loop nested in ours: its epoll fd
+    // becomes readable whenever the bus socket or a call timeout needs service
+    if (sd_event_new(&impl_->event) < 0 ||
+        sd_bus_attach_event(impl_->bus, impl_->event, SD_EVENT_PRIORITY_NORMAL) < 0) {
+        TD_LOG_ERROR("DBusInterface", "Failed to attach bus to sd-event");
+        return false;
+    }
+
+    impl_->event_fd = sd_event_get_fd(impl_->event);
+    if (!loop.add_fd(impl_->event_fd, EPOLLIN, [this](uint32_t) { impl_->run(); })) {
+        TD_LOG_ERROR("DBusInterface", "Failed to add sd-event fd to loop");
+        return false;
+    }
+
+    // Anything registered before the connection existed
+    for (auto& [name, object] : impl_->interfaces) {
+        impl_->publish(name, *object);
+    }
+    for (auto& entry : impl_->signals) {
+        impl_->subscribe(*entry);
+    }
+
+    impl_->schedule_run();
+
+    TD_LOG_INFO("DBusInterface", "D-Bus service initialized: ", service_name_);
+    return true;
+}
+
+Message DBusInterface::new_signal(const std::string& interface, const std::string& name) {
+    sd_bus_message* msg = nullptr;
+
+    if (!impl_->bus) return Message();
+    if (sd_bus_message_new_signal(impl_->bus, &msg, object_path_.c_str(),
+                                  interface.c_str(), name.c_str()) < 0) {
+        TD_LOG_ERROR("DBusInterface", "Failed to create signal message");
+        return Message();
+    }
+    return Message::adopt(msg);
+}
+
+Message DBusInterface::new_method_call(const std::string& destination, const std::string& path,
+                                       const std::string& interface, const std::string& method) {
+    sd_bus_message* msg = nullptr;
+
+    if (!impl_->bus) return Message();
+    if (sd_bus_message_new_method_call(impl_->bus, &msg, destination.c_str(), path.c_str(),
+                                       interface.c_str(), method.c_str()) < 0) {
+        TD_LOG_ERROR("DBusInterface", "Failed to create method call message");
+        return Message();
+    }
+    return Message::adopt(msg);
+}
+
+void DBusInterface::send_message(Message msg) {
+    if (!impl_->bus || !msg) return;
+
+    // Written immediately when the socket has room; no synchronous flush
+    sd_bus_send(impl_->bus, raw_message(msg.get_raw()), nullptr);
+    impl_->schedule_run();
+}
+
+void DBusInterface::register_method(const std::string& interface, const std::string& method,
+                                    const std::string& signature, const std::string& result,
+                                    MethodHandler handler) {
+    std::unique_ptr<Impl::ObjectInterface>& current = impl_->interfaces[interface];
+
+    // The vtable points into the entry array, so rebuild both and swap
+    auto next = std::make_unique<Impl::ObjectInterface>();
+    if (current) {
+        next->methods = current->methods;
+        sd_bus_slot_unref(current->slot);
+        current->slot = nullptr;
+    }
+    next->methods.push_back(Impl::MethodEntry{this, method, signature, result, handler, -1, nullptr});
+
+    if (impl_->bus) {
+        impl_->publish(interface, *next);
+    }
+    current = std::move(next);
+}
+
+void DBusInterface::register_interface(const InterfaceInfo& info, InterfaceDispatcher dispatcher,
+                                       PropertyGetter getter) {
+    // sd-bus resolves the member through the vtable and builds Introspect
+    // and org.freedesktop.DBus.Properties from it, so the generated lookup
+    // and XML are not needed here
+    auto object = std::make_unique<Impl::ObjectInterface>();
+    for (size_t i = 0; i < info.method_count; i++) {
+        const MethodInfo& method = info.methods[i];
+        int index = static_cast<int>(i);
+        object->methods.push_back(Impl::MethodEntry{this, method.name, method.signature, method.result,
+            [dispatcher, index](Message& call) { return dispatcher(index, call); }, -1, nullptr});
+    }
+    if (getter) {
+        for (size_t i = 0; i < info.property_count; i++) {
+            Impl::MethodEntry entry;
+            entry.owner = this;
+            entry.member = info.properties[i].name;
+            entry.signature = info.properties[i].signature;
+            entry.property = static_cast<int>(i);
+            entry.getter = getter;
+            object->methods.push_back(std::move(entry));
+        }
+    }
+
+    std::unique_ptr<Impl::ObjectInterface>& current = impl_->interfaces[info.name];
+    if (current) {
+        sd_bus_slot_unref(current->slot);
+    }
+    if (impl_->bus) {
+        impl_->publish(info.name, *object);
+    }
+    current = std::move(object);
+}
+
+bool DBusInterface::Impl::publish(const std::string& interface, ObjectInterface& object) {
+    object.vtable.clear();
+    object.vtable.push_back(td_sdbus_vtable_start());
+    for (size_t i = 0; i < object.methods.size(); i++) {
+        const MethodEntry& entry = object.methods[i];
+        if (entry.getter) {
+            object.vtable.push_back(td_sdbus_vtable_property(entry.member.c_str(), entry.signature.c_str(),
+                                                             property_callback, i * sizeof(MethodEntry)));
+            continue;
+        }
+        object.vtable.push_back(td_sdbus_vtable_method(entry.member.c_str(), entry.signature.c_str(),
+                                                       entry.result.c_str(), method_callback,
+                                                       i * sizeof(MethodEntry)));
+    }
+    object.vtable.push_back(td_sdbus_vtable_end());
+
+    int r = sd_bus_add_object_vtable(bus, &object.slot, object_path.c_str(), interface.c_str(),
+                                     object.vtable.data(), object.methods.data());
+    if (r < 0) {
+        TD_LOG_ERROR("DBusInterface", "Failed to export ", interface, ": ", std::strerror(-r));
+        object.slot = nullptr;
+        return false;
+    }
+    return true;
+}
+
+int DBusInterface::Impl::method_callback(sd_bus_message* m, void* userdata, sd_bus_error* /* error */) {
+    auto* entry = static_cast<MethodEntry*>(userdata);
+
+    Message call = Message::ref(m);
+    entry->owner->begin_method();
+    Message reply = entry->handler(call);
+    if (entry->owner->end_method(entry->member.c_str())) {
+        return 1;  // Answered later through a DeferredReply
+    }
+    if (!reply) {
+        return sd_bus_reply_method_errorf(m, SD_BUS_ERROR_FAILED, "Method failed");
+    }
+    if (!sd_bus_message_get_expect_reply(m)) {
+        return 1;
+    }
+
+    int r = sd_bus_send(nullptr, raw_message(reply.get_raw()), nullptr);
+    return r < 0 ? r : 1;
+}
+
+int DBusInterface::Impl::property_callback(sd_bus* /* bus */, const char* /* path */,
+                                           const char* /* interface */, const char* property,
+                                           sd_bus_message* reply, void* userdata,
+                                           sd_bus_error* error) {
+    auto* entry = static_cast<MethodEntry*>(userdata);
+
+    // sd-bus has already opened the variant
+    Message msg = Message::ref(reply);
+    if (!entry->getter(entry->property, msg)) {
+        return sd_bus_error_set_const(error, SD_BUS_ERROR_FAILED, property);
+    }
+    return 1;
+}
+
+void DBusInterface::emit_properties_changed(const InterfaceInfo& info, uint64_t changed) {
+    if (!impl_->bus) return;
+
+    // sd-bus reads the values back through the vtable getters
+    std::vector<char*> names;
+    for (size_t i = 0; i < info.property_count; i++) {
+        if (changed & (1ULL << i)) {
+            names.push_back(const_cast<char*>(info.properties[i].name));
+        }
+    }
+    names.push_back(nullptr);
+
+    int r = sd_bus_emit_properties_changed_strv(impl_->bus, object_path_.c_str(), info.name,
+                                                names.data());
+    if (r < 0) {
+        TD_LOG_WARNING("DBusInterface", "Failed to emit PropertiesChanged: ", std::strerror(-r));
+    }
+    impl_->schedule_run();
+}
+
+void DBusInterface::register_signal_handler(const std::string& interface, const std::string& name,
+                                            SignalHandler handler) {
+    auto entry = std::make_unique<Impl::SignalEntry>();
+    entry->interface = interface;
+    entry->member = name;
+    entry->handler = handler;
+
+    if (impl_->bus) {
+        impl_->subscribe(*entry);
+    }
+    impl_->signals.push_back(std::move(entry));
+}
+
+bool DBusInterface::Impl::subscribe(SignalEntry& entry) {
+    // Async: the match is installed without a round trip to the bus
+    int r = sd_bus_match_signal_async(bus, &entry.slot, nullptr, nullptr,
+                                      entry.interface.c_str(), entry.member.c_str(),
+                                      signal_callback, nullptr, &entry);
+    if (r < 0) {
+        TD_LOG_ERROR("DBusInterface", "Failed to match ", entry.interface, ".", entry.member);
+        entry.slot = nullptr;
+        return false;
+    }
+    schedule_run();
+    return true;
+}
+
+int DBusInterface::Impl::signal_callback(sd_bus_message* m, void* userdata, sd_bus_error* /* error */) {
+    auto* entry = static_cast<SignalEntry*>(userdata);
+
+    Message signal = Message::ref(m);
+    entry->handler(signal);
+    return 0;
+}
+
+bool DBusInterface::call_method_async(Message msg, ReplyHandler handler, int timeout_ms) {
+    if (!impl_->bus || !msg) {
+        TD_LOG_ERROR("DBusInterface", "Failed to send method call");
+        if (handler) {
+            Message none;
+            handler(none);
+        }
+        return false;
+    }
+
+    sd_bus_message* raw = raw_message(msg.get_raw());
+
+    if (!handler) {
+        sd_bus_message_set_expect_reply(raw, 0);
+        sd_bus_send(impl_->bus, raw, nullptr);
+        impl_->schedule_run();
+        return true;
+    }
+
+    auto* data = new ReplyHandler(std::move(handler));
+    uint64_t timeout_us = timeout_ms < 0 ? 0 : static_cast<uint64_t>(timeout_ms) * 1000;
+    sd_bus_slot* slot = nullptr;
+
+    int r = sd_bus_call_async(impl_->bus, &slot, raw, Impl::reply_callback, data, timeout_us);
+    if (r < 0) {
+        TD_LOG_ERROR("DBusInterface", "Failed to send method call: ", std::strerror(-r));
+        Message none;
+        (*data)(none);
+        delete data;
+        return false;
+    }
+
+    // The bus owns the slot from here and frees the handler with it, whether
+    // the call is answered, times out or the connection goes away
+    sd_bus_slot_set_destroy_callback(slot, [](void* p) { delete static_cast<ReplyHandler*>(p); });
+    sd_bus_slot_set_floating(slot, 1);
+    sd_bus_slot_unref(slot);
+
+    impl_->schedule_run();
+    return true;
+}
+
+int DBusInterface::Impl::reply_callback(sd_bus_message* m, void* userdata, sd_bus_error* /* error */) {
+    auto* handler = static_cast<ReplyHandler*>(userdata);
+
+    Message reply = Message::ref(m);
+    (*handler)(reply);
+    return 0;
+}
+
+int DBusInterface::Impl::name_callback(sd_bus_message* m, void* userdata, sd_bus_error* /* error */) {
+    auto* impl = static_cast<Impl*>(userdata);
+
+    const sd_bus_error* error = sd_bus_message_get_error(m);
+    if (error) {
+        TD_LOG_ERROR("DBusInterface", "Failed to request name ", impl->service_name, ": ",
+                     error->message ? error->message : error->name);
+        return 0;
+    }
+
+    // 1: primary owner, 2: queued, 3: exists, 4: already owner
+    uint32_t result = 0;
+    if (sd_bus_message_read_basic(m, 'u', &result) >= 0 && result != 1 && result != 4) {
+        TD_LOG_ERROR("DBusInterface", "Name ", impl->service_name, " is owned by another process");
+        return 0;
+    }
+
+    TD_LOG_DEBUG("DBusInterface", "Acquired name ", impl->service_name);
+    return 0;
+}
+
+void DBusInterface::Impl::run() {
+    // Dispatch everything that is ready without blocking our loop
+    while (sd_event_run(event, 0) > 0) {
+    }
+}
+
+void DBusInterface::Impl::schedule_run() {
+    // sd-bus only updates its socket interest and timeouts when sd-event
+    // prepares, so give it a pass after anything queued from outside it
+    if (run_scheduled || !loop) return;
+
+    run_scheduled = true;
+    loop->post([this]() {
+        run_scheduled = false;
+        run();
+    });
+}
+
+} // namespace services
+} // namespace touchdown
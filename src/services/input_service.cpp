@@ -7,51 +7,119 @@
 #include "touchdown/drivers/touch_driver.hpp"
 #include "touchdown/drivers/button_driver.hpp"
 #include "touchdown/core/logger.hpp"
-#include <thread>
-#include <chrono>
-#include <cstring>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
 namespace touchdown {
 namespace services {
 
-constexpr const char* DBUS_INTERFACE = "org.touchdown.Input";
-constexpr const char* DBUS_OBJECT_PATH = "/org/touchdown/Input";
+constexpr uint32_t MOVE_BATCH_INTERVAL_MS = 33;  // One display frame at 30 FPS
+
+constexpr uint32_t TOUCH_HELD_POLL_MS = 10;      // 100 Hz while a finger is down
+constexpr uint32_t TOUCH_IDLE_POLL_MS = 33;      // Waiting for a touch without an IRQ line
+constexpr uint32_t TOUCH_WAKE_POLL_MS = 100;     // Same, with the controller in wake-on-touch
+
+constexpr size_t MAX_RING_CONSUMERS = 8;
+
+namespace {
+
+const char* touch_event_name(TouchEventType type) {
+    switch (type) {
+        case TouchEventType::PRESS: return "press";
+        case TouchEventType::RELEASE: return "release";
+        case TouchEventType::MOVE: return "move";
+        case TouchEventType::TAP: return "tap";
+        case TouchEventType::LONG_PRESS: return "long_press";
+        case TouchEventType::SWIPE_UP: return "swipe_up";
+        case TouchEventType::SWIPE_DOWN: return "swipe_down";
+        case TouchEventType::SWIPE_LEFT: return "swipe_left";
+        case TouchEventType::SWIPE_RIGHT: return "swipe_right";
+    }
+    return "unknown";
+}
+
+const char* button_event_name(ButtonEventType type) {
+    switch (type) {
+        case ButtonEventType::SINGLE_PRESS: return "single_press";
+        case ButtonEventType::DOUBLE_PRESS: return "double_press";
+        case ButtonEventType::LONG_PRESS: return "long_press";
+        case ButtonEventType::RELEASE: return "release";
+    }
+    return "unknown";
+}
+
+// Wire format of a touch sample: (type, x, y, timestamp_ms)
+std::tuple<std::string, int16_t, int16_t, uint32_t> touch_sample(const TouchPoint& point) {
+    return {touch_event_name(point.type), point.x, point.y, point.timestamp_ms};
+}
+
+} // namespace
 
 InputService::InputService()
-    : DBusInterface("org.touchdown.Input", DBUS_OBJECT_PATH)
+    : InputStub("org.touchdown.Input")
     , touch_(nullptr)
     , button_(nullptr)
-    , running_(false)
+    , touch_poll_timer_(EventLoop::INVALID_TIMER)
+    , next_trace_id_(0)
+    , wake_armed_(false)
+    , move_batch_timer_(EventLoop::INVALID_TIMER)
+    , move_batch_ms_(MOVE_BATCH_INTERVAL_MS)
+    , signals_sent_(0)
+    , touch_samples_(0)
+    , start_us_(0)
     , last_touch_{}
     , last_button_{} {
 }
 
 InputService::~InputService() {
     stop();
+    
+    for (const auto& [name, event_fd] : ring_consumers_) {
+        close(event_fd);
+    }
+    for (const auto& [name, wake_fd] : wake_fds_) {
+        close(wake_fd);
+    }
 }
 
-bool InputService::init(drivers::TouchDriver* touch, drivers::ButtonDriver* button) {
+bool InputService::init(EventLoop& loop, drivers::TouchDriver* touch, drivers::ButtonDriver* button) {
     touch_ = touch;
     button_ = button;
     
-    if (!DBusInterface::init()) {
+    if (!DBusInterface::init(loop)) {
+        return false;
+    }
+    
+    // Drop a reader's eventfd as soon as its connection goes away
+    register_signal_handler("org.freedesktop.DBus", "NameOwnerChanged",
+        [this](Message& msg) { on_name_owner_changed(msg); });
+    
+    if (!ring_.create()) {
+        TD_LOG_ERROR("InputService", "Failed to create input event ring");
+        return false;
+    }
+    
+    if (!activity_.create()) {
+        TD_LOG_ERROR("InputService", "Failed to create activity page");
         return false;
     }
     
-    // Register D-Bus methods
-    register_method(DBUS_INTERFACE, "GetLastTouch",
-        [this](DBusMessage* msg) { return handle_get_last_touch(msg); });
+    if (!input_queue_.init(loop, [this](const InputEvent& e) { on_input_event(e); })) {
+        TD_LOG_ERROR("InputService", "Failed to initialize input event queue");
+        return false;
+    }
     
-    register_method(DBUS_INTERFACE, "GetLastButton",
-        [this](DBusMessage* msg) { return handle_get_last_button(msg); });
+    move_batch_timer_ = loop.add_timer([this]() { flush_pending_moves(); });
     
-    // Register input callbacks
+    // Register input callbacks; these run on driver threads, so only post
     if (touch_) {
-        touch_->set_touch_callback([this](const TouchPoint& p) { on_touch_event(p); });
+        touch_->set_touch_callback([this](const TouchPoint& p) { input_queue_.post(p); });
+        start_touch_sampling();
     }
     
     if (button_) {
-        button_->set_button_callback([this](const ButtonEvent& e) { on_button_event(e); });
+        button_->set_button_callback([this](const ButtonEvent& e) { input_queue_.post(e); });
     }
     
     TD_LOG_INFO("InputService", "Input service initialized");
@@ -59,99 +127,280 @@ bool InputService::init(drivers::TouchDriver* touch, drivers::ButtonDriver* butt
 }
 
 void InputService::run() {
-    running_ = true;
+    if (!loop_) return;
+    
     notify_ready();
+    start_us_ = EventLoop::now_us();
     
-    uint32_t watchdog_count = 0;
+    start_watchdog();
     
-    while (running_) {
-        // Process D-Bus messages
-        process();
-        
-        // Send watchdog keepalive every 10 seconds
-        if (++watchdog_count >= 100) {
-            send_watchdog();
-            watchdog_count = 0;
+    loop_->run();
+    
+    flush_pending_moves();
+    log_statistics();
+}
+
+void InputService::stop() {
+    if (loop_) {
+        loop_->stop();
+    }
+}
+
+void InputService::start_touch_sampling() {
+    touch_poll_timer_ = loop_->add_timer([this]() {
+        update_touch_sampling(touch_->poll());
+    });
+    
+    int irq_fd = touch_->get_irq_fd();
+    if (irq_fd >= 0) {
+        loop_->add_fd(irq_fd, EPOLLIN, [this](uint32_t) {
+            update_touch_sampling(touch_->handle_irq());
+        });
+    }
+    
+    update_touch_sampling(false);
+}
+
+void InputService::update_touch_sampling(bool touch_held) {
+    drivers::TouchPowerMode mode = touch_->get_power_mode();
+    
+    if (mode == drivers::TouchPowerMode::STANDBY) {
+        loop_->disarm_timer(touch_poll_timer_);
+    } else if (touch_held) {
+        // Follow the finger and catch the release, which may not raise an IRQ
+        loop_->arm_timer(touch_poll_timer_, TOUCH_HELD_POLL_MS);
+    } else if (touch_->get_irq_fd() >= 0) {
+        // The controller tells us when to look
+        loop_->disarm_timer(touch_poll_timer_);
+    } else {
+        loop_->arm_timer(touch_poll_timer_, mode == drivers::TouchPowerMode::WAKE_ON_TOUCH
+                                            ? TOUCH_WAKE_POLL_MS : TOUCH_IDLE_POLL_MS);
+    }
+}
+
+void InputService::publish_to_ring(const InputEvent& event) {
+    // Stamp the event so the shell can trace it through to the display
+    InputEvent traced = event;
+    traced.trace_id = ++next_trace_id_;
+    traced.published_us = EventLoop::now_us();
+    ring_.publish(traced);
+    
+    uint64_t one = 1;
+    for (const auto& [name, event_fd] : ring_consumers_) {
+        if (write(event_fd, &one, sizeof(one)) < 0) {
+            // Counter saturated: that reader is already due to wake
         }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 }
 
-void InputService::stop() {
-    running_ = false;
+void InputService::on_input_event(const InputEvent& event) {
+    activity_.record(event.kind, event.posted_us);
+    
+    // Wake the power service directly on the first input with the screen
+    // off, and at the start of each interaction for its input boost; the
+    // samples of a drag in between only update the page
+    bool starts_interaction = event.kind == InputEvent::Kind::BUTTON ||
+                              event.touch.type == TouchEventType::PRESS;
+    if (wake_armed_ || starts_interaction) {
+        wake_armed_ = false;
+        
+        uint64_t one = 1;
+        for (const auto& [name, wake_fd] : wake_fds_) {
+            if (write(wake_fd, &one, sizeof(one)) < 0) {
+                // Counter saturated: already due to wake
+            }
+        }
+    }
+    
+    publish_to_ring(event);
+    
+    switch (event.kind) {
+        case InputEvent::Kind::TOUCH:
+            on_touch_event(event.touch);
+            break;
+        case InputEvent::Kind::BUTTON:
+            on_button_event(event.button);
+            break;
+    }
 }
 
 void InputService::on_touch_event(const TouchPoint& point) {
     last_touch_ = point;
+    touch_samples_++;
+    
+    // Coalesced: a drag updates the property every sample but watchers get
+    // at most one PropertiesChanged per interval with the latest position
+    set_last_touch_property({point.x, point.y, point.timestamp_ms});
     
-    // Send D-Bus signal for touch events
-    std::string event_type;
-    switch (point.type) {
-        case TouchEventType::PRESS: event_type = "press"; break;
-        case TouchEventType::RELEASE: event_type = "release"; break;
-        case TouchEventType::MOVE: event_type = "move"; break;
-        case TouchEventType::TAP: event_type = "tap"; break;
-        case TouchEventType::LONG_PRESS: event_type = "long_press"; break;
-        case TouchEventType::SWIPE_UP: event_type = "swipe_up"; break;
-        case TouchEventType::SWIPE_DOWN: event_type = "swipe_down"; break;
-        case TouchEventType::SWIPE_LEFT: event_type = "swipe_left"; break;
-        case TouchEventType::SWIPE_RIGHT: event_type = "swipe_right"; break;
+    if (point.type == TouchEventType::MOVE) {
+        // Drags produce a sample per controller report; ship them once per frame
+        pending_moves_.push_back(point);
+        if (move_batch_ms_ == 0) {
+            flush_pending_moves();
+        } else if (pending_moves_.size() == 1) {
+            loop_->arm_timer(move_batch_timer_, move_batch_ms_);
+        }
+        return;
+    }
+    
+    // Keep ordering: moves queued before this event go out first
+    flush_pending_moves();
+    
+    if (emit_touch_event(touch_sample(point))) {
+        signals_sent_++;
     }
     
-    char signal_data[128];
-    snprintf(signal_data, sizeof(signal_data), "%s,%d,%d,%u",
-             event_type.c_str(), point.x, point.y, point.timestamp_ms);
+    TD_LOG_DEBUG("InputService", "Touch event: ", touch_event_name(point.type),
+                 " at (", point.x, ",", point.y, ")");
+}
+
+void InputService::flush_pending_moves() {
+    loop_->disarm_timer(move_batch_timer_);
+    if (pending_moves_.empty()) return;
+    
+    std::vector<std::tuple<std::string, int16_t, int16_t, uint32_t>> samples;
+    samples.reserve(pending_moves_.size());
+    for (const TouchPoint& point : pending_moves_) {
+        samples.push_back(touch_sample(point));
+    }
     
-    send_signal(DBUS_INTERFACE, "TouchEvent", signal_data);
+    if (emit_touch_moved(samples)) {
+        signals_sent_++;
+    }
     
-    TD_LOG_DEBUG("InputService", "Touch event: ", event_type, " at (", point.x, ",", point.y, ")");
+    pending_moves_.clear();
 }
 
 void InputService::on_button_event(const ButtonEvent& event) {
     last_button_ = event;
+    set_last_button_property({static_cast<uint32_t>(event.type), event.timestamp_ms, event.duration_ms});
     
-    // Send D-Bus signal for button events
-    std::string event_type;
-    switch (event.type) {
-        case ButtonEventType::SINGLE_PRESS: event_type = "single_press"; break;
-        case ButtonEventType::DOUBLE_PRESS: event_type = "double_press"; break;
-        case ButtonEventType::LONG_PRESS: event_type = "long_press"; break;
-        case ButtonEventType::RELEASE: event_type = "release"; break;
+    const char* event_type = button_event_name(event.type);
+    
+    if (emit_button_event({event_type, event.timestamp_ms, event.duration_ms})) {
+        signals_sent_++;
     }
     
-    char signal_data[128];
-    snprintf(signal_data, sizeof(signal_data), "%s,%u,%u",
-             event_type.c_str(), event.timestamp_ms, event.duration_ms);
+    TD_LOG_INFO("InputService", "Button event: ", event_type);
+}
+
+void InputService::log_statistics() const {
+    uint64_t elapsed_us = EventLoop::now_us() - start_us_;
+    if (elapsed_us == 0) return;
     
-    send_signal(DBUS_INTERFACE, "ButtonEvent", signal_data);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    uint64_t cpu_us = static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+                      usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
     
-    TD_LOG_INFO("InputService", "Button event: ", event_type);
+    TD_LOG_INFO("InputService", "Sent ", signals_sent_, " signals for ", touch_samples_,
+                " touch samples (", signals_sent_ * 1000000 / elapsed_us, " msgs/s), CPU time ",
+                cpu_us / 1000, " ms over ", elapsed_us / 1000, " ms");
+}
+
+MethodError InputService::handle_get_last_touch(Message& /* call */, int16_t& x, int16_t& y,
+                                                uint32_t& timestamp_ms) {
+    x = last_touch_.x;
+    y = last_touch_.y;
+    timestamp_ms = last_touch_.timestamp_ms;
+    return {};
+}
+
+MethodError InputService::handle_get_last_button(Message& /* call */, uint32_t& type,
+                                                 uint32_t& timestamp_ms, uint16_t& duration_ms) {
+    type = static_cast<uint32_t>(last_button_.type);
+    timestamp_ms = last_button_.timestamp_ms;
+    duration_ms = last_button_.duration_ms;
+    return {};
 }
 
-DBusMessage* InputService::handle_get_last_touch(DBusMessage* msg) {
-    DBusMessage* reply = dbus_message_new_method_return(msg);
+MethodError InputService::handle_set_touch_power_mode(Message& /* call */, const std::string& mode_str) {
+    drivers::TouchPowerMode mode;
+    if (mode_str == "active") mode = drivers::TouchPowerMode::ACTIVE;
+    else if (mode_str == "auto_sleep") mode = drivers::TouchPowerMode::AUTO_SLEEP;
+    else if (mode_str == "wake_on_touch") mode = drivers::TouchPowerMode::WAKE_ON_TOUCH;
+    else if (mode_str == "standby") mode = drivers::TouchPowerMode::STANDBY;
+    else return {"org.touchdown.Error", "Invalid touch power mode"};
     
-    dbus_message_append_args(reply,
-        DBUS_TYPE_INT16, &last_touch_.x,
-        DBUS_TYPE_INT16, &last_touch_.y,
-        DBUS_TYPE_UINT32, &last_touch_.timestamp_ms,
-        DBUS_TYPE_INVALID);
+    if (touch_ && !touch_->set_power_mode(mode)) {
+        return {"org.touchdown.Error", "Failed to set touch power mode"};
+    }
+    
+    if (touch_) {
+        update_touch_sampling(false);
+    }
+    
+    // The power service only asks for these while the screen is off
+    wake_armed_ = (mode == drivers::TouchPowerMode::WAKE_ON_TOUCH ||
+                   mode == drivers::TouchPowerMode::STANDBY);
+    return {};
+}
+
+MethodError InputService::handle_open_event_ring(Message& call, int event_fd, int& ring) {
+    std::string sender = call.get_sender();
+    
+    auto it = ring_consumers_.find(sender);
+    if (it != ring_consumers_.end()) {
+        close(it->second);
+        ring_consumers_.erase(it);
+    } else if (ring_consumers_.size() >= MAX_RING_CONSUMERS) {
+        close(event_fd);
+        return {"org.touchdown.Error", "Too many ring readers"};
+    }
     
-    return reply;
+    ring_consumers_[sender] = event_fd;
+    
+    TD_LOG_INFO("InputService", "Event ring reader attached: ", sender);
+    
+    // The reply carries its own duplicate of the fd
+    ring = ring_.get_fd();
+    return {};
 }
 
-DBusMessage* InputService::handle_get_last_button(DBusMessage* msg) {
-    DBusMessage* reply = dbus_message_new_method_return(msg);
+MethodError InputService::handle_open_activity_page(Message& call, int wake_fd, int& page) {
+    std::string sender = call.get_sender();
     
-    uint32_t type = static_cast<uint32_t>(last_button_.type);
-    dbus_message_append_args(reply,
-        DBUS_TYPE_UINT32, &type,
-        DBUS_TYPE_UINT32, &last_button_.timestamp_ms,
-        DBUS_TYPE_UINT16, &last_button_.duration_ms,
-        DBUS_TYPE_INVALID);
+    auto it = wake_fds_.find(sender);
+    if (it != wake_fds_.end()) {
+        close(it->second);
+        wake_fds_.erase(it);
+    } else if (wake_fds_.size() >= MAX_RING_CONSUMERS) {
+        close(wake_fd);
+        return {"org.touchdown.Error", "Too many activity readers"};
+    }
     
-    return reply;
+    wake_fds_[sender] = wake_fd;
+    
+    TD_LOG_INFO("InputService", "Activity page reader attached: ", sender);
+    
+    page = activity_.get_fd();
+    return {};
+}
+
+void InputService::on_name_owner_changed(Message& msg) {
+    std::string name;
+    std::string old_owner;
+    std::string new_owner;
+    
+    if (!msg.read_args(name, old_owner, new_owner)) {
+        return;
+    }
+    
+    if (!new_owner.empty()) return;
+    
+    auto it = ring_consumers_.find(name);
+    if (it != ring_consumers_.end()) {
+        close(it->second);
+        ring_consumers_.erase(it);
+        TD_LOG_INFO("InputService", "Event ring reader detached: ", name);
+    }
+    
+    auto wake_it = wake_fds_.find(name);
+    if (wake_it != wake_fds_.end()) {
+        close(wake_it->second);
+        wake_fds_.erase(wake_it);
+        TD_LOG_INFO("InputService", "Activity page reader detached: ", name);
+    }
 }
 
 } // namespace services
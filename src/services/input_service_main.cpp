@@ -6,25 +6,37 @@
 #include "touchdown/services/input_service.hpp"
 #include "touchdown/drivers/touch_driver.hpp"
 #include "touchdown/drivers/button_driver.hpp"
+#include "touchdown/core/event_loop.hpp"
 #include "touchdown/core/logger.hpp"
+#include "touchdown/core/config.hpp"
 #include <csignal>
 #include <memory>
-
-static std::unique_ptr<touchdown::services::InputService> g_service;
-
-void signal_handler(int signum) {
-    if (g_service) {
-        TD_LOG_INFO("InputServiceMain", "Received signal: ", signum);
-        g_service->stop();
-    }
-}
+#include <string>
 
 int main(int argc, char* argv[]) {
     TD_LOG_INFO("InputServiceMain", "Starting TouchdownOS Input Service");
+    uint64_t start_us = touchdown::EventLoop::now_us();
     
-    // Setup signal handlers
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    // Setup the event loop first so driver threads inherit the blocked signals
+    touchdown::EventLoop loop;
+    if (!loop.init()) {
+        TD_LOG_ERROR("InputServiceMain", "Failed to initialize event loop");
+        return 1;
+    }
+    
+    auto on_signal = [&loop](int signum) {
+        TD_LOG_INFO("InputServiceMain", "Received signal: ", signum);
+        loop.stop();
+    };
+    loop.add_signal(SIGINT, on_signal);
+    loop.add_signal(SIGTERM, on_signal);
+    
+    auto& config = touchdown::Config::instance();
+    config.load("/etc/touchdown/shell.conf");
+    
+    // Constructed before the drivers so it outlives their threads, which
+    // post into the service's event queue until they are joined
+    auto service = std::make_unique<touchdown::services::InputService>();
     
     // Create driver instances
     auto touch = std::make_unique<touchdown::drivers::TouchDriver>();
@@ -33,21 +45,35 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    touch->set_auto_sleep_timeout_s(config.get_int("input.touch_auto_sleep_s", 5));
+    std::string gpiochip = config.get_string("input.touch_reset_gpiochip", "/dev/gpiochip0");
+    touch->set_reset_gpio(gpiochip, config.get_int("input.touch_reset_gpio", 24));
+    
+    // Without the IRQ line the service falls back to polling the controller
+    int irq_line = config.get_int("input.touch_irq_gpio", 17);
+    if (irq_line >= 0 && !touch->enable_irq(gpiochip, irq_line)) {
+        TD_LOG_WARNING("InputServiceMain", "Touch IRQ unavailable, polling instead");
+    }
+    touch->set_power_mode(touchdown::drivers::TouchPowerMode::AUTO_SLEEP);
+    
     auto button = std::make_unique<touchdown::drivers::ButtonDriver>();
+    button->set_device_name(config.get_string("input.button_device_name"));
     if (!button->init()) {
         TD_LOG_ERROR("InputServiceMain", "Failed to initialize button driver");
         return 1;
     }
     
-    // Create and initialize input service
-    g_service = std::make_unique<touchdown::services::InputService>();
-    if (!g_service->init(touch.get(), button.get())) {
+    // Initialize input service
+    if (!service->init(loop, touch.get(), button.get())) {
         TD_LOG_ERROR("InputServiceMain", "Failed to initialize input service");
         return 1;
     }
     
+    TD_LOG_INFO("InputServiceMain", "Startup completed in ",
+                (touchdown::EventLoop::now_us() - start_us) / 1000, " ms");
+    
     // Run service
-    g_service->run();
+    service->run();
     
     TD_LOG_INFO("InputServiceMain", "Input service stopped");
     return 0;
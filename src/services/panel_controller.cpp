@@ -0,0 +1,103 @@
+/**
+ * @file panel_controller.cpp
+ * @brief Display power through the shell, backlight through sysfs
+ */
+
+#include "touchdown/services/panel_controller.hpp"
+#include "touchdown/core/logger.hpp"
+
+namespace touchdown {
+namespace services {
+
+constexpr const char* SHELL_SERVICE_NAME = "org.touchdown.Shell";
+
+// DPMS is one ioctl in the shell; don't leave the backlight waiting long
+constexpr int DISPLAY_POWER_TIMEOUT_MS = 500;
+
+PanelController::PanelController(DBusInterface& bus)
+    : shell_(bus, SHELL_SERVICE_NAME)
+    , fade_ms_(DEFAULT_FADE_MS)
+    , brightness_(255)
+    , on_(true)
+    , switching_(false)
+    , switch_count_(0) {
+}
+
+void PanelController::set_fade(uint32_t fade_ms, uint32_t max_rate_hz) {
+    fade_ms_ = fade_ms;
+    backlight_.set_max_rate(max_rate_hz);
+}
+
+bool PanelController::init(EventLoop& loop, const std::string& backlight_root) {
+    return backlight_.init(loop, backlight_root);
+}
+
+void PanelController::set_level_callback(drivers::Backlight::LevelCallback callback) {
+    backlight_.set_level_callback(std::move(callback));
+}
+
+void PanelController::set_power(bool on, std::function<void()> done) {
+    if (on == on_) {
+        if (!done) return;
+        if (switching_) {
+            switch_waiters_.push_back(std::move(done));
+        } else {
+            done();
+        }
+        return;
+    }
+
+    // Whoever waited on the switch the other way is done waiting
+    std::vector<std::function<void()>> superseded;
+    superseded.swap(switch_waiters_);
+
+    on_ = on;
+    switching_ = true;
+    uint64_t id = ++switch_count_;
+    if (done) switch_waiters_.push_back(std::move(done));
+
+    if (!on) {
+        backlight_.fade_to(0, fade_ms_, [this, id]() {
+            if (id != switch_count_) return;
+            shell_.set_display_power(false, [this, id](const char* error) {
+                if (error) TD_LOG_WARNING("PanelController", "Display off failed: ", error);
+                finish_switch(id);
+            }, DISPLAY_POWER_TIMEOUT_MS);
+        });
+    } else {
+        // A fade out still running carries on until the reply replaces it
+        shell_.set_display_power(true, [this, id](const char* error) {
+            if (error) TD_LOG_WARNING("PanelController", "Display on failed: ", error);
+
+            // Switched again while the shell was answering
+            if (id != switch_count_) return;
+            backlight_.fade_to(brightness_, fade_ms_);
+            finish_switch(id);
+        }, DISPLAY_POWER_TIMEOUT_MS);
+    }
+
+    for (auto& waiter : superseded) {
+        waiter();
+    }
+}
+
+void PanelController::finish_switch(uint64_t id) {
+    if (id != switch_count_) return;
+
+    switching_ = false;
+    std::vector<std::function<void()>> waiters;
+    waiters.swap(switch_waiters_);
+    for (auto& waiter : waiters) {
+        waiter();
+    }
+}
+
+void PanelController::set_brightness(uint8_t brightness) {
+    brightness_ = brightness;
+    if (on_) {
+        backlight_.fade_to(brightness_, fade_ms_);
+    }
+}
+
+} // namespace services
+} // namespace touchdown
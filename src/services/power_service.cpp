@@ -4,225 +4,765 @@
  */
 
 #include "touchdown/services/power_service.hpp"
-#include "touchdown/drivers/display_driver.hpp"
 #include "touchdown/core/logger.hpp"
-#include "touchdown/core/utils.hpp"
-#include <fstream>
-#include <thread>
-#include <chrono>
+#include "touchdown/core/process.hpp"
+#include <algorithm>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace touchdown {
 namespace services {
 
-constexpr const char* DBUS_INTERFACE = "org.touchdown.Power";
-constexpr const char* DBUS_OBJECT_PATH = "/org/touchdown/Power";
+constexpr const char* INPUT_SERVICE_NAME = "org.touchdown.Input";
 
 constexpr uint32_t DEFAULT_SCREEN_TIMEOUT_MS = 30000;  // 30 seconds
+constexpr uint8_t DEFAULT_BRIGHTNESS = 255;
+
+// Longest wait for the shell's redraw before the display comes on anyway
+constexpr uint32_t DISPLAY_ON_TIMEOUT_MS = 100;
+
+// The input service answers at once; don't hold a suspend for long without it
+constexpr int TOUCH_MODE_TIMEOUT_MS = 500;
+
+constexpr uint32_t DEFAULT_THERMAL_POLL_MS = 2000;
+
+namespace {
+
+const char* power_state_name(PowerState state) {
+    switch (state) {
+        case PowerState::ACTIVE: return "active";
+        case PowerState::SCREEN_OFF: return "screen_off";
+        case PowerState::SUSPENDED: return "suspended";
+        case PowerState::SHUTDOWN: return "shutdown";
+    }
+    return "active";
+}
+
+} // namespace
 
 PowerService::PowerService()
-    : DBusInterface("org.touchdown.Power", DBUS_OBJECT_PATH)
-    , display_(nullptr)
+    : PowerStub("org.touchdown.Power")
+    , input_(*this, INPUT_SERVICE_NAME)
+    , panel_(*this)
+    , backlight_root_(drivers::Backlight::DEFAULT_ROOT)
     , power_state_(PowerState::ACTIVE)
-    , running_(false)
+    , brightness_(DEFAULT_BRIGHTNESS)
+    , display_on_pending_(false)
+    , display_timer_(EventLoop::INVALID_TIMER)
     , screen_timeout_ms_(DEFAULT_SCREEN_TIMEOUT_MS)
-    , last_activity_time_(0) {
+    , last_activity_us_(0)
+    , wake_fd_(-1)
+    , idle_timer_(EventLoop::INVALID_TIMER)
+    , boost_khz_(0)
+    , boost_ms_(0)
+    , boost_interval_ms_(0)
+    , boosting_(false)
+    , boost_start_us_(0)
+    , boost_count_(0)
+    , boost_time_us_(0)
+    , boost_timer_(EventLoop::INVALID_TIMER)
+    , frames_reported_(0)
+    , frames_missed_(0)
+    , cpu_floor_khz_(0)
+    , sleep_root_(drivers::SystemSleep::DEFAULT_ROOT)
+    , sleep_state_("freeze")
+    , resumed_us_(0)
+    , suspend_count_(0)
+    , hotplug_root_(drivers::CpuHotplug::DEFAULT_ROOT)
+    , park_delay_ms_(0)
+    , park_timer_(EventLoop::INVALID_TIMER)
+    , park_count_(0)
+    , unpark_max_us_(0)
+    , thermal_root_(drivers::ThermalZones::DEFAULT_ROOT)
+    , thermal_poll_ms_(DEFAULT_THERMAL_POLL_MS)
+    , thermal_timer_(EventLoop::INVALID_TIMER)
+    , thermal_reading_(false)
+    , thermal_max_mc_(INT32_MIN)
+    , app_cpu_quota_(0) {
+    set_power_state_property(power_state_name(power_state_));
+    set_thermal_level_property(thermal_level_name(thermal_.get_level()));
+    
+    cpufreq_settings_[PowerState::ACTIVE].governor = "schedutil";
+    cpufreq_settings_[PowerState::SCREEN_OFF].governor = "powersave";
+    
+    thermal_responses_[static_cast<size_t>(ThermalLevel::HOT)] = {false, 30};
+    thermal_responses_[static_cast<size_t>(ThermalLevel::CRITICAL)] = {false, 15};
 }
 
 PowerService::~PowerService() {
     stop();
+    workers_.shutdown();
+    quota_workers_.shutdown();
+    
+    if (wake_fd_ >= 0) {
+        if (loop_) loop_->remove_fd(wake_fd_);
+        close(wake_fd_);
+    }
 }
 
-bool PowerService::init(drivers::DisplayDriver* display) {
-    display_ = display;
+bool PowerService::init(EventLoop& loop) {
+    if (!DBusInterface::init(loop)) {
+        return false;
+    }
+    
+    // Without a backlight only panel power (via the shell) is switched
+    panel_.set_level_callback([this](uint8_t level) { set_brightness_property(level); });
+    panel_.init(loop, backlight_root_);
+    set_brightness_property(panel_.get_level());
+    panel_.set_brightness(brightness_);
+    
+    // Re-attach to the activity page whenever the input service restarts
+    register_signal_handler("org.freedesktop.DBus", "NameOwnerChanged",
+        [this](Message& msg) { on_name_owner_changed(msg); });
     
-    if (!DBusInterface::init()) {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        TD_LOG_ERROR("PowerService", "Failed to create wake eventfd");
         return false;
     }
+    loop.add_fd(wake_fd_, EPOLLIN, [this](uint32_t) { on_input_wake(); });
+    connect_activity_page();
     
-    // Register D-Bus methods
-    register_method(DBUS_INTERFACE, "SetPowerState",
-        [this](DBusMessage* msg) { return handle_set_power_state(msg); });
+    if (!workers_.init(loop) || !quota_workers_.init(loop)) {
+        return false;
+    }
     
-    register_method(DBUS_INTERFACE, "GetPowerState",
-        [this](DBusMessage* msg) { return handle_get_power_state(msg); });
+    // Without cpufreq (e.g. in a container) the governor requests are no-ops
+    if (!cpufreq_.init()) {
+        TD_LOG_WARNING("PowerService", "CPU frequency scaling unavailable");
+    }
+    
+    // SUSPENDED falls back to screen off when the kernel cannot suspend
+    if (!sleep_.init(sleep_root_, sleep_state_)) {
+        TD_LOG_WARNING("PowerService", "System suspend unavailable");
+    }
     
-    register_method(DBUS_INTERFACE, "SetScreenTimeout",
-        [this](DBusMessage* msg) { return handle_set_screen_timeout(msg); });
+    // Without zones the level stays normal
+    if (!thermal_zones_.init(thermal_root_, thermal_types_)) {
+        TD_LOG_WARNING("PowerService", "No thermal zone to watch");
+    }
     
-    register_method(DBUS_INTERFACE, "ResetIdleTimer",
-        [this](DBusMessage* msg) { return handle_reset_idle_timer(msg); });
+    // Off without configured CPUs; a previous run may have left them parked
+    if (hotplug_.init(hotplug_root_)) {
+        unpark_cpus();
+    }
     
     // Set initial CPU governor
-    apply_cpu_scaling("schedutil");
+    apply_cpu_scaling(PowerState::ACTIVE);
+    
+    last_activity_us_ = EventLoop::now_us();
     
-    last_activity_time_ = Utils::get_timestamp_ms();
+    // The only timers: nothing runs periodically but the thermal poll
+    // while the screen is on and the watchdog pings systemd asks for; the
+    // idle timer fires once per screen timeout, the boost timer once per
+    // boost and the display timer once per wake
+    idle_timer_ = loop.add_timer([this]() { check_idle_timeout(); });
+    boost_timer_ = loop.add_timer([this]() { end_input_boost(); });
+    park_timer_ = loop.add_timer([this]() { park_cpus(); });
+    thermal_timer_ = loop.add_timer([this]() { poll_thermal(); });
+    display_timer_ = loop.add_timer([this]() {
+        TD_LOG_WARNING("PowerService", "No frame from the shell, switching the display on");
+        switch_display_on();
+    });
     
     TD_LOG_INFO("PowerService", "Power service initialized");
     return true;
 }
 
 void PowerService::run() {
-    running_ = true;
+    if (!loop_) return;
+    
     notify_ready();
     
-    uint32_t watchdog_count = 0;
+    start_watchdog();
+    schedule_idle_check();
+    if (thermal_zones_.get_zone_count() > 0) {
+        loop_->arm_timer(thermal_timer_, 0, thermal_poll_ms_);
+    }
     
-    while (running_) {
-        // Process D-Bus messages
-        process();
-        
-        // Check idle timeout
-        check_idle_timeout();
-        
-        // Send watchdog keepalive every 10 seconds
-        if (++watchdog_count >= 100) {  // 100 * 100ms = 10s
-            send_watchdog();
-            watchdog_count = 0;
-        }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uint64_t start_us = EventLoop::now_us();
+    uint64_t start_wakeups = loop_->wakeup_count();
+    
+    loop_->run();
+    
+    end_input_boost();
+    frame_floor_.reset();
+    update_cpu_floor();
+    unpark_cpus();
+    set_app_cpu_quota(0);
+    
+    log_method_stats();
+    log_statistics(start_us, start_wakeups);
+}
+
+void PowerService::log_statistics(uint64_t start_us, uint64_t start_wakeups) const {
+    uint64_t elapsed_us = EventLoop::now_us() - start_us;
+    if (elapsed_us == 0) return;
+    
+    uint64_t wakeups = loop_->wakeup_count() - start_wakeups;
+    TD_LOG_INFO("PowerService", wakeups, " loop wakeups in ", elapsed_us / 1000, " ms (",
+                wakeups * 1000000.0 / elapsed_us, "/s)");
+    TD_LOG_INFO("PowerService", boost_count_, " input boosts, ", boost_time_us_ / 1000,
+                " ms at boost (", boost_time_us_ * 100.0 / elapsed_us, "% of the time)");
+    if (suspend_count_ > 0) {
+        TD_LOG_INFO("PowerService", suspend_count_, " suspends");
+    }
+    if (thermal_max_mc_ != INT32_MIN) {
+        TD_LOG_INFO("PowerService", "Thermal level changed ", thermal_.get_change_count(),
+                    " times, hottest ", thermal_max_mc_ / 1000.0, " C");
+    }
+    if (park_count_ > 0) {
+        TD_LOG_INFO("PowerService", "CPUs parked ", park_count_, " times, slowest return ",
+                    unpark_max_us_, "us");
+    }
+    if (frame_floor_.is_enabled() && frames_reported_ > 0) {
+        TD_LOG_INFO("PowerService", frames_reported_, " frames reported, ", frames_missed_,
+                    " missed (", frames_missed_ * 100.0 / frames_reported_, "%), frame floor raised ",
+                    frame_floor_.get_raise_count(), " times");
     }
 }
 
 void PowerService::stop() {
-    running_ = false;
+    if (loop_) {
+        loop_->stop();
+    }
 }
 
-void PowerService::set_power_state(PowerState state) {
-    if (power_state_ == state) return;
+void PowerService::set_power_state(PowerState state, std::function<void()> applied) {
+    if (power_state_ == state) {
+        if (applied) applied();
+        return;
+    }
     
     TD_LOG_INFO("PowerService", "Changing power state: ", static_cast<int>(power_state_), 
              " -> ", static_cast<int>(state));
     
+    if (state != PowerState::ACTIVE) {
+        end_input_boost();
+        frame_floor_.reset();
+        update_cpu_floor();
+        // The level is not sampled until the screen is back; apps are
+        // paused meanwhile and must not wake up to a stale cap
+        set_app_cpu_quota(0);
+    }
+    
     power_state_ = state;
-    apply_power_state(state);
+    apply_power_state(state, std::move(applied));
+    schedule_idle_check();
     
-    // Notify via D-Bus signal
-    std::string state_str;
-    switch (state) {
-        case PowerState::ACTIVE: state_str = "active"; break;
-        case PowerState::SCREEN_OFF: state_str = "screen_off"; break;
-        case PowerState::SUSPENDED: state_str = "suspended"; break;
-        case PowerState::SHUTDOWN: state_str = "shutdown"; break;
-    }
-    send_signal(DBUS_INTERFACE, "PowerStateChanged", state_str);
+    // Notify via D-Bus signal and the PowerState property
+    const char* state_str = power_state_name(state);
+    emit_power_state_changed(state_str);
+    set_power_state_property(state_str);
 }
 
-void PowerService::apply_power_state(PowerState state) {
+void PowerService::apply_power_state(PowerState state, std::function<void()> applied) {
+    // Display and touch requests are quick; anything that can block on the
+    // kernel or another process goes to the worker, and applied follows it
+    loop_->disarm_timer(park_timer_);
+    loop_->disarm_timer(thermal_timer_);
     switch (state) {
-        case PowerState::ACTIVE:
-            if (display_) {
-                display_->set_power(true);
-                display_->set_brightness(255);
+        case PowerState::ACTIVE: {
+            // The input service reprograms touch while the shell redraws
+            uint64_t woke_us = resumed_us_;
+            apply_touch_power_mode("auto_sleep", [woke_us]() {
+                if (woke_us == 0) return;
+                TD_LOG_INFO("PowerService", "Touch restored ", EventLoop::now_us() - woke_us,
+                            "us after wake");
+            });
+            
+            // The shell parked while the screen was off; let it draw a
+            // fresh frame so the panel never shows the one from before
+            display_on_pending_ = true;
+            loop_->arm_timer(display_timer_, DISPLAY_ON_TIMEOUT_MS);
+            
+            // Per-CPU cpufreq policies only exist while their CPU is online
+            unpark_cpus();
+            apply_cpu_scaling(state, std::move(applied));
+            
+            // The level is as old as the screen-off period; sample at once
+            if (thermal_zones_.get_zone_count() > 0) {
+                loop_->arm_timer(thermal_timer_, 0, thermal_poll_ms_);
             }
-            apply_cpu_scaling("schedutil");
             break;
+        }
             
         case PowerState::SCREEN_OFF:
-            if (display_) {
-                display_->set_power(false);
+            cancel_display_on();
+            panel_.set_power(false);
+            apply_touch_power_mode("wake_on_touch");
+            apply_cpu_scaling(state, std::move(applied));
+            if (hotplug_.is_available()) {
+                loop_->arm_timer(park_timer_, park_delay_ms_);
             }
-            apply_cpu_scaling("powersave");
             break;
             
         case PowerState::SUSPENDED:
-            // Full system suspend (not implemented yet)
-            TD_LOG_WARNING("PowerService", "System suspend not yet implemented");
+            // A backlight left mid-fade would stay lit through the suspend
+            cancel_display_on();
+            panel_.set_power(false, [this, applied]() {
+                if (power_state_ == PowerState::SUSPENDED) {
+                    enter_suspend(applied);
+                } else if (applied) {
+                    applied();
+                }
+            });
             break;
             
         case PowerState::SHUTDOWN:
             TD_LOG_INFO("PowerService", "Initiating system shutdown");
-            // Trigger systemd shutdown
-            system("systemctl poweroff");
+            // Trigger systemd shutdown; systemctl waits for the job to be queued
+            workers_.submit([]() { run_process({"systemctl", "poweroff"}); }, std::move(applied));
             break;
     }
 }
 
-void PowerService::apply_cpu_scaling(const std::string& governor) {
-    // Apply CPU frequency governor to all cores
-    for (int cpu = 0; cpu < 4; cpu++) {  // Pi Zero 2 W has 4 cores
-        std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + 
-                          "/cpufreq/scaling_governor";
-        std::ofstream file(path);
-        if (file.is_open()) {
-            file << governor;
-            file.close();
-            TD_LOG_DEBUG("PowerService", "Set CPU", cpu, " governor: ", governor);
+void PowerService::switch_display_on() {
+    if (!display_on_pending_) return;
+    
+    cancel_display_on();
+    panel_.set_power(true);
+    
+    if (resumed_us_ != 0) {
+        TD_LOG_INFO("PowerService", "Display restored ", EventLoop::now_us() - resumed_us_,
+                    "us after wake");
+        resumed_us_ = 0;
+    }
+}
+
+void PowerService::cancel_display_on() {
+    display_on_pending_ = false;
+    if (loop_) loop_->disarm_timer(display_timer_);
+}
+
+void PowerService::apply_cpu_scaling(PowerState state, std::function<void()> applied) {
+    // Governor switches stop and start kernel threads and can take tens of
+    // milliseconds per policy, so they run on the worker
+    drivers::CpufreqSettings settings = cpufreq_settings_[state];
+    workers_.submit([this, settings]() {
+        cpufreq_.apply(settings);
+    }, std::move(applied));
+}
+
+void PowerService::park_cpus() {
+    if (power_state_ != PowerState::SCREEN_OFF) return;
+    
+    auto result = std::make_shared<drivers::HotplugResult>();
+    workers_.submit([this, result]() { hotplug_.park(*result); }, [this, result]() {
+        if (result->cpus == 0) return;
+        park_count_++;
+        TD_LOG_INFO("PowerService", "Parked ", result->cpus - result->failed, " of ",
+                    result->cpus, " CPUs in ", result->elapsed_us, "us");
+    });
+}
+
+void PowerService::unpark_cpus() {
+    if (!hotplug_.is_available()) return;
+    
+    // Queued behind at most a park, so the CPUs are back before any
+    // cpufreq write that follows
+    uint64_t start_us = EventLoop::now_us();
+    auto result = std::make_shared<drivers::HotplugResult>();
+    workers_.submit([this, result]() { hotplug_.unpark(*result); }, [this, start_us, result]() {
+        if (result->cpus == 0) return;
+        uint64_t wake_us = EventLoop::now_us() - start_us;
+        unpark_max_us_ = std::max(unpark_max_us_, result->elapsed_us);
+        TD_LOG_INFO("PowerService", result->cpus - result->failed, " of ", result->cpus,
+                    " CPUs back online in ", result->elapsed_us, "us (slowest ",
+                    result->slowest_us, "us, ", wake_us, "us from the request), ",
+                    result->rehomed, " threads re-pinned");
+    });
+}
+
+void PowerService::poll_thermal() {
+    if (thermal_reading_) return;
+    
+    // Some sensors are sampled on read, which can take a few milliseconds
+    thermal_reading_ = true;
+    auto sample = std::make_shared<std::pair<bool, int32_t>>(false, 0);
+    workers_.submit([this, sample]() { sample->first = thermal_zones_.read(sample->second); },
+                    [this, sample]() {
+        thermal_reading_ = false;
+        if (sample->first && power_state_ == PowerState::ACTIVE) {
+            on_thermal_sample(sample->second);
         }
+    });
+}
+
+void PowerService::on_thermal_sample(int32_t temp_mc) {
+    thermal_max_mc_ = std::max(thermal_max_mc_, temp_mc);
+    
+    ThermalLevel previous = thermal_.get_level();
+    ThermalLevel level = thermal_.update(temp_mc);
+    if (level == previous) {
+        // The cap was lifted with the screen off; back once the level is fresh
+        set_app_cpu_quota(thermal_response().app_cpu_quota);
+        return;
     }
+    
+    TD_LOG_INFO("PowerService", "Thermal level ", thermal_level_name(previous), " -> ",
+                thermal_level_name(level), " at ", temp_mc / 1000.0, " C");
+    apply_thermal_level(level);
+}
+
+void PowerService::apply_thermal_level(ThermalLevel level) {
+    // The shell lowers its refresh rate and drops effects on the change
+    set_thermal_level_property(thermal_level_name(level));
+    
+    const ThermalResponse& response = thermal_response();
+    if (!response.cpu_boost) {
+        end_input_boost();
+        frame_floor_.reset();
+        update_cpu_floor();
+    }
+    set_app_cpu_quota(response.app_cpu_quota);
+}
+
+const ThermalResponse& PowerService::thermal_response() const {
+    return thermal_responses_[static_cast<size_t>(thermal_.get_level())];
+}
+
+void PowerService::set_app_cpu_quota(uint32_t percent) {
+    if (app_slice_.empty() || percent == app_cpu_quota_) return;
+    app_cpu_quota_ = percent;
+    
+    // systemd owns the cgroup; --runtime so a reboot starts unlimited.
+    // An empty CPUQuota= removes the limit.
+    std::vector<std::string> command = {
+        "systemctl", "set-property", "--runtime", app_slice_,
+        "CPUQuota=" + (percent > 0 ? std::to_string(percent) + "%" : std::string())
+    };
+    quota_workers_.submit([command]() {
+        if (run_process(command) != 0) {
+            TD_LOG_WARNING("PowerService", "Failed: systemctl set-property ", command[3], " ", command[4]);
+        }
+    });
+    TD_LOG_INFO("PowerService", "App CPU quota ", percent > 0 ? std::to_string(percent) + "%" : "removed");
+}
+
+void PowerService::apply_touch_power_mode(const std::string& mode, std::function<void()> done) {
+    // The input service owns the touch controller
+    InputProxy::SetTouchPowerModeReply reply;
+    if (done) {
+        reply = [mode, done](const char* error) {
+            if (error) {
+                TD_LOG_WARNING("PowerService", "Touch power mode ", mode, " failed: ", error);
+            }
+            done();
+        };
+    }
+    input_.set_touch_power_mode(mode, std::move(reply), TOUCH_MODE_TIMEOUT_MS);
+    TD_LOG_DEBUG("PowerService", "Requested touch power mode: ", mode);
+}
+
+void PowerService::enter_suspend(std::function<void()> applied) {
+    // The shell parks its render loop on PowerStateChanged. Touch keeps
+    // raising its IRQ, so it must be in wake-on-touch mode before the
+    // kernel freezes the input service.
+    apply_touch_power_mode("wake_on_touch", [this, applied]() {
+        // Answer now: after resume the caller has no use for the reply
+        if (applied) applied();
+        
+        // Woken or moved on while the input service was answering
+        if (power_state_ != PowerState::SUSPENDED) return;
+        
+        if (!sleep_.is_available()) {
+            // As SCREEN_OFF, input wakes it again
+            TD_LOG_WARNING("PowerService", "Cannot suspend, turning the screen off instead");
+            set_power_state(PowerState::SCREEN_OFF);
+            return;
+        }
+        
+        auto result = std::make_shared<drivers::SleepResult>();
+        workers_.submit([this, result]() { sleep_.suspend(*result); },
+                        [this, result]() { on_resumed(*result); });
+    });
+}
+
+void PowerService::on_resumed(const drivers::SleepResult& result) {
+    if (result.ok) {
+        suspend_count_++;
+        TD_LOG_INFO("PowerService", "Resumed after ", result.slept_us / 1000, " ms suspended, ",
+                    EventLoop::now_us() - result.resumed_us, "us to reach the loop");
+        resumed_us_ = result.resumed_us;
+        emit_resumed(result.resumed_us);
+    }
+    
+    if (power_state_ != PowerState::SUSPENDED) return;
+    
+    // Whatever woke us, or refused the suspend, was user input
+    last_activity_us_ = EventLoop::now_us();
+    set_power_state(PowerState::ACTIVE);
 }
 
 void PowerService::check_idle_timeout() {
     if (screen_timeout_ms_ == 0) return;  // Timeout disabled
     if (power_state_ != PowerState::ACTIVE) return;  // Already in power saving
     
-    uint32_t now = Utils::get_timestamp_ms();
-    uint32_t idle_time = now - last_activity_time_;
+    // Input activity is only looked at now, never pushed to us per event
+    refresh_last_activity();
+    
+    uint64_t idle_us = EventLoop::now_us() - last_activity_us_;
     
-    if (idle_time >= screen_timeout_ms_) {
+    if (idle_us >= screen_timeout_ms_ * 1000ULL) {
         TD_LOG_INFO("PowerService", "Screen timeout reached, turning off display");
         set_power_state(PowerState::SCREEN_OFF);
+    } else {
+        // Activity since the timer was armed, sleep until the new deadline
+        schedule_idle_check();
+    }
+}
+
+void PowerService::schedule_idle_check() {
+    if (!loop_ || idle_timer_ == EventLoop::INVALID_TIMER) return;
+    
+    if (screen_timeout_ms_ == 0 || power_state_ != PowerState::ACTIVE) {
+        loop_->disarm_timer(idle_timer_);
+        return;
+    }
+    
+    loop_->arm_timer_at(idle_timer_, last_activity_us_ + screen_timeout_ms_ * 1000ULL);
+}
+
+void PowerService::refresh_last_activity() {
+    ActivityRecord record;
+    if (activity_.read(record) && record.last_activity_us > last_activity_us_) {
+        last_activity_us_ = record.last_activity_us;
+    }
+}
+
+void PowerService::connect_activity_page() {
+    input_.open_activity_page(wake_fd_, [this](const char* error, int page_fd) {
+        if (error) {
+            // Retried when the input service appears on the bus
+            TD_LOG_WARNING("PowerService", "Activity page unavailable, waiting for input service");
+            return;
+        }
+        
+        if (activity_.attach(page_fd)) {
+            TD_LOG_INFO("PowerService", "Attached to input activity page");
+        }
+    });
+}
+
+void PowerService::on_input_wake() {
+    uint64_t value;
+    if (read(wake_fd_, &value, sizeof(value)) < 0) {
+        return;
+    }
+    
+    refresh_last_activity();
+    
+    if (power_state_ == PowerState::SCREEN_OFF) {
+        set_power_state(PowerState::ACTIVE);
+        TD_LOG_INFO("PowerService", "Woke on input, ",
+                    EventLoop::now_us() - last_activity_us_, "us after the event");
+    }
+    
+    // Signalled at the start of each touch, not per sample
+    start_input_boost();
+}
+
+void PowerService::start_input_boost() {
+    if (boost_khz_ == 0 || boosting_ || power_state_ != PowerState::ACTIVE) return;
+    if (!thermal_response().cpu_boost) return;
+    
+    // One boost per interaction start, and not back to back: rapid taps
+    // and long drags are left to the governor's own ramp
+    uint64_t now = EventLoop::now_us();
+    if (boost_count_ > 0 && now - boost_start_us_ < boost_interval_ms_ * 1000ULL) return;
+    
+    boosting_ = true;
+    boost_start_us_ = now;
+    boost_count_++;
+    
+    update_cpu_floor();
+    loop_->arm_timer(boost_timer_, boost_ms_);
+}
+
+void PowerService::end_input_boost() {
+    if (!boosting_) return;
+    
+    boosting_ = false;
+    boost_time_us_ += EventLoop::now_us() - boost_start_us_;
+    loop_->disarm_timer(boost_timer_);
+    
+    // Only the floor goes; schedutil brings the clock down from there
+    update_cpu_floor();
+}
+
+void PowerService::update_cpu_floor() {
+    uint32_t khz = std::max(boosting_ ? boost_khz_ : 0, frame_floor_.get_floor_khz());
+    if (khz == cpu_floor_khz_) return;
+    
+    cpu_floor_khz_ = khz;
+    workers_.submit([this, khz]() { cpufreq_.set_floor(khz); });
+}
+
+void PowerService::on_name_owner_changed(Message& msg) {
+    std::string name;
+    std::string old_owner;
+    std::string new_owner;
+    
+    if (!msg.read_args(name, old_owner, new_owner)) {
+        return;
+    }
+    
+    if (name == INPUT_SERVICE_NAME && !new_owner.empty()) {
+        connect_activity_page();
     }
 }
 
+void PowerService::set_cpufreq_settings(PowerState state, const drivers::CpufreqSettings& settings) {
+    cpufreq_settings_[state] = settings;
+}
+
+void PowerService::set_input_boost(uint32_t khz, uint32_t duration_ms, uint32_t min_interval_ms) {
+    boost_khz_ = duration_ms > 0 ? khz : 0;
+    boost_ms_ = duration_ms;
+    boost_interval_ms_ = std::max(min_interval_ms, duration_ms);
+}
+
+void PowerService::set_frame_floor(const FrameFloorConfig& config) {
+    frame_floor_.configure(config);
+}
+
+void PowerService::set_suspend(const std::string& sysfs_root, const std::string& state,
+                               const std::vector<std::string>& wakeup_devices) {
+    sleep_root_ = sysfs_root;
+    sleep_state_ = state;
+    sleep_.set_wakeup_devices(wakeup_devices);
+}
+
+void PowerService::set_core_parking(const std::string& sysfs_root,
+                                    const std::vector<unsigned>& cpus, uint32_t delay_ms,
+                                    bool parallel) {
+    hotplug_root_ = sysfs_root;
+    park_delay_ms_ = delay_ms;
+    hotplug_.set_cpus(cpus);
+    hotplug_.set_parallel(parallel);
+}
+
+void PowerService::set_thermal(const ThermalConfig& config, const std::string& sysfs_root,
+                               const std::vector<std::string>& zone_types, uint32_t poll_ms,
+                               const std::string& app_slice) {
+    thermal_.configure(config);
+    thermal_root_ = sysfs_root;
+    thermal_types_ = zone_types;
+    thermal_poll_ms_ = std::max(poll_ms, 100u);
+    app_slice_ = app_slice;
+}
+
+void PowerService::set_thermal_response(ThermalLevel level, const ThermalResponse& response) {
+    thermal_responses_[static_cast<size_t>(level)] = response;
+}
+
+void PowerService::set_backlight(const std::string& class_root, uint32_t fade_ms,
+                                 uint32_t max_rate_hz) {
+    backlight_root_ = class_root;
+    panel_.set_fade(fade_ms, max_rate_hz);
+}
+
 void PowerService::set_screen_timeout(uint32_t timeout_ms) {
     screen_timeout_ms_ = timeout_ms;
+    schedule_idle_check();
     TD_LOG_INFO("PowerService", "Screen timeout set to: ", timeout_ms, "ms");
 }
 
+void PowerService::set_brightness(uint8_t brightness) {
+    brightness_ = brightness;
+    
+    // Faded to now, or on the next wake if the screen is off
+    panel_.set_brightness(brightness_);
+    TD_LOG_DEBUG("PowerService", "Brightness set to: ", static_cast<int>(brightness));
+}
+
 void PowerService::reset_idle_timer() {
-    last_activity_time_ = Utils::get_timestamp_ms();
+    last_activity_us_ = EventLoop::now_us();
     
     // Wake screen if it was off
     if (power_state_ == PowerState::SCREEN_OFF) {
         set_power_state(PowerState::ACTIVE);
+    } else {
+        // Move the deadline now rather than waking at the stale one
+        schedule_idle_check();
     }
 }
 
-DBusMessage* PowerService::handle_set_power_state(DBusMessage* msg) {
-    const char* state_str = nullptr;
-    dbus_message_get_args(msg, nullptr, DBUS_TYPE_STRING, &state_str, DBUS_TYPE_INVALID);
-    
-    if (state_str) {
-        PowerState state;
-        if (strcmp(state_str, "active") == 0) state = PowerState::ACTIVE;
-        else if (strcmp(state_str, "screen_off") == 0) state = PowerState::SCREEN_OFF;
-        else if (strcmp(state_str, "suspended") == 0) state = PowerState::SUSPENDED;
-        else if (strcmp(state_str, "shutdown") == 0) state = PowerState::SHUTDOWN;
-        else return dbus_message_new_error(msg, "org.touchdown.Error", "Invalid state");
-        
-        set_power_state(state);
+void PowerService::handle_set_power_state(Message& /* call */, const std::string& state_str,
+                                          SetPowerStateDone done) {
+    PowerState state;
+    if (state_str == "active") state = PowerState::ACTIVE;
+    else if (state_str == "screen_off") state = PowerState::SCREEN_OFF;
+    else if (state_str == "suspended") state = PowerState::SUSPENDED;
+    else if (state_str == "shutdown") state = PowerState::SHUTDOWN;
+    else {
+        done({"org.touchdown.Error", "Invalid state"});
+        return;
     }
     
-    return dbus_message_new_method_return(msg);
+    // Answered once the governor write or poweroff request has finished
+    set_power_state(state, [done]() { done({}); });
 }
 
-DBusMessage* PowerService::handle_get_power_state(DBusMessage* msg) {
-    DBusMessage* reply = dbus_message_new_method_return(msg);
-    
-    const char* state_str;
-    switch (power_state_) {
-        case PowerState::ACTIVE: state_str = "active"; break;
-        case PowerState::SCREEN_OFF: state_str = "screen_off"; break;
-        case PowerState::SUSPENDED: state_str = "suspended"; break;
-        case PowerState::SHUTDOWN: state_str = "shutdown"; break;
-    }
-    
-    dbus_message_append_args(reply, DBUS_TYPE_STRING, &state_str, DBUS_TYPE_INVALID);
-    return reply;
+MethodError PowerService::handle_get_power_state(Message& /* call */, std::string& state_str) {
+    state_str = power_state_name(power_state_);
+    return {};
 }
 
-DBusMessage* PowerService::handle_set_screen_timeout(DBusMessage* msg) {
-    uint32_t timeout_ms = 0;
-    dbus_message_get_args(msg, nullptr, DBUS_TYPE_UINT32, &timeout_ms, DBUS_TYPE_INVALID);
-    
+MethodError PowerService::handle_set_screen_timeout(Message& /* call */, uint32_t timeout_ms) {
     set_screen_timeout(timeout_ms);
-    return dbus_message_new_method_return(msg);
+    return {};
 }
 
-DBusMessage* PowerService::handle_reset_idle_timer(DBusMessage* msg) {
+MethodError PowerService::handle_reset_idle_timer(Message& /* call */) {
     reset_idle_timer();
-    return dbus_message_new_method_return(msg);
+    return {};
+}
+
+MethodError PowerService::handle_set_brightness(Message& /* call */, uint8_t brightness) {
+    set_brightness(brightness);
+    return {};
+}
+
+MethodError PowerService::handle_frame_ready(Message& /* call */) {
+    // Late or repeated frames are harmless; only the first one after a wake counts
+    if (power_state_ == PowerState::ACTIVE) {
+        switch_display_on();
+    }
+    return {};
+}
+
+MethodError PowerService::handle_report_frame_stats(Message& /* call */, uint32_t frames,
+                                                    uint32_t missed, uint32_t busy_us,
+                                                    uint32_t max_us, uint32_t window_us) {
+    // A report can still arrive just after the screen went off; when hot
+    // the clock is left to the governor
+    if (!frame_floor_.is_enabled() || power_state_ != PowerState::ACTIVE ||
+        !thermal_response().cpu_boost) {
+        return {};
+    }
+    
+    FrameReport report;
+    report.frames = frames;
+    report.missed = missed;
+    report.busy_us = busy_us;
+    report.max_us = max_us;
+    report.window_us = window_us;
+    
+    frames_reported_ += frames;
+    frames_missed_ += missed;
+    
+    uint32_t previous_khz = frame_floor_.get_floor_khz();
+    uint32_t khz = frame_floor_.update(report);
+    if (khz != previous_khz) {
+        TD_LOG_DEBUG("PowerService", "Frame floor ", previous_khz, " -> ", khz, " kHz (",
+                     missed, "/", frames, " missed, slowest ", max_us, "us, render ",
+                     window_us > 0 ? busy_us * 100.0 / window_us : 0.0, "%)");
+        update_cpu_floor();
+    }
+    return {};
 }
 
 } // namespace services
@@ -4,43 +4,161 @@
  */
 
 #include "touchdown/services/power_service.hpp"
-#include "touchdown/drivers/display_driver.hpp"
+#include "touchdown/core/event_loop.hpp"
+#include "touchdown/core/config.hpp"
 #include "touchdown/core/logger.hpp"
 #include <csignal>
 #include <memory>
+#include <sstream>
+#include <vector>
 
-static std::unique_ptr<touchdown::services::PowerService> g_service;
+namespace {
 
-void signal_handler(int signum) {
-    if (g_service) {
-        TD_LOG_INFO("PowerServiceMain", "Received signal: ", signum);
-        g_service->stop();
+// power.<state>.cpu_governor, .cpu_min_khz and .cpu_max_khz
+touchdown::drivers::CpufreqSettings load_cpufreq_settings(touchdown::Config& config,
+                                                          const std::string& state,
+                                                          const std::string& default_governor) {
+    std::string prefix = "power." + state + ".";
+    
+    touchdown::drivers::CpufreqSettings settings;
+    settings.governor = config.get_string(prefix + "cpu_governor", default_governor);
+    settings.min_khz = static_cast<uint32_t>(config.get_int(prefix + "cpu_min_khz", 0));
+    settings.max_khz = static_cast<uint32_t>(config.get_int(prefix + "cpu_max_khz", 0));
+    return settings;
+}
+
+// thermal.<level>.cpu_boost and .app_cpu_quota
+touchdown::services::ThermalResponse load_thermal_response(touchdown::Config& config,
+                                                           touchdown::ThermalLevel level,
+                                                           bool default_boost,
+                                                           uint32_t default_quota) {
+    std::string prefix = std::string("thermal.") + touchdown::thermal_level_name(level) + ".";
+    
+    touchdown::services::ThermalResponse response;
+    response.cpu_boost = config.get_bool(prefix + "cpu_boost", default_boost);
+    response.app_cpu_quota = static_cast<uint32_t>(config.get_int(prefix + "app_cpu_quota",
+                                                                  static_cast<int>(default_quota)));
+    return response;
+}
+
+// Comma-separated list, blanks ignored
+std::vector<std::string> split_list(const std::string& value) {
+    std::vector<std::string> items;
+    std::istringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (!item.empty()) items.push_back(item);
     }
+    return items;
 }
 
+// CPU list as in sysfs: "1-3" or "1,2,3"; bad entries are skipped
+std::vector<unsigned> parse_cpu_list(const std::string& value) {
+    std::vector<unsigned> cpus;
+    for (const std::string& item : split_list(value)) {
+        unsigned first = 0;
+        unsigned last = 0;
+        char dash = 0;
+        std::istringstream range(item);
+        if (!(range >> first)) continue;
+        last = first;
+        if (range >> dash && !(dash == '-' && range >> last)) continue;
+        for (unsigned cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
     TD_LOG_INFO("PowerServiceMain", "Starting TouchdownOS Power Service");
     
-    // Setup signal handlers
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
-    
-    // Create display driver instance (for power control)
-    auto display = std::make_unique<touchdown::drivers::DisplayDriver>();
-    if (!display->init()) {
-        TD_LOG_ERROR("PowerServiceMain", "Failed to initialize display driver");
+    // Setup the event loop and route signals through it
+    touchdown::EventLoop loop;
+    if (!loop.init()) {
+        TD_LOG_ERROR("PowerServiceMain", "Failed to initialize event loop");
         return 1;
     }
     
+    auto on_signal = [&loop](int signum) {
+        TD_LOG_INFO("PowerServiceMain", "Received signal: ", signum);
+        loop.stop();
+    };
+    loop.add_signal(SIGINT, on_signal);
+    loop.add_signal(SIGTERM, on_signal);
+    
+    auto& config = touchdown::Config::instance();
+    config.load("/etc/touchdown/shell.conf");
+    
     // Create and initialize power service
-    g_service = std::make_unique<touchdown::services::PowerService>();
-    if (!g_service->init(display.get())) {
+    auto service = std::make_unique<touchdown::services::PowerService>();
+    
+    // power.cpu_governor predates the per-state keys and still sets ACTIVE
+    std::string active_governor = config.get_string("power.cpu_governor", "schedutil");
+    service->set_cpufreq_settings(touchdown::PowerState::ACTIVE,
+        load_cpufreq_settings(config, "active", active_governor));
+    service->set_cpufreq_settings(touchdown::PowerState::SCREEN_OFF,
+        load_cpufreq_settings(config, "screen_off", "powersave"));
+    service->set_input_boost(
+        static_cast<uint32_t>(config.get_int("power.input_boost_khz", 0)),
+        static_cast<uint32_t>(config.get_int("power.input_boost_ms", 200)),
+        static_cast<uint32_t>(config.get_int("power.input_boost_interval_ms", 500)));
+    
+    // Off unless power.frame_floor_max_khz is set
+    touchdown::FrameFloorConfig frame_floor;
+    frame_floor.min_khz = static_cast<uint32_t>(config.get_int("power.frame_floor_min_khz", 0));
+    frame_floor.max_khz = static_cast<uint32_t>(config.get_int("power.frame_floor_max_khz", 0));
+    frame_floor.step_khz = static_cast<uint32_t>(config.get_int("power.frame_floor_step_khz", 100000));
+    service->set_frame_floor(frame_floor);
+    
+    // A sysfs_root other than /sys is a dry run against a fake tree
+    service->set_suspend(
+        config.get_string("power.suspend.sysfs_root", "/sys"),
+        config.get_string("power.suspend.state", "freeze"),
+        split_list(config.get_string("power.suspend.wakeup_devices")));
+    
+    touchdown::ThermalConfig thermal;
+    thermal.warm_mc = config.get_int("thermal.warm_mc", thermal.warm_mc);
+    thermal.hot_mc = config.get_int("thermal.hot_mc", thermal.hot_mc);
+    thermal.critical_mc = config.get_int("thermal.critical_mc", thermal.critical_mc);
+    thermal.hysteresis_mc = config.get_int("thermal.hysteresis_mc", thermal.hysteresis_mc);
+    service->set_thermal(thermal,
+        config.get_string("thermal.sysfs_root", "/sys/class/thermal"),
+        split_list(config.get_string("thermal.zone_types")),
+        static_cast<uint32_t>(config.get_int("thermal.poll_ms", 2000)),
+        config.get_string("thermal.app_slice", "touchdown-apps.slice"));
+    service->set_thermal_response(touchdown::ThermalLevel::NORMAL,
+        load_thermal_response(config, touchdown::ThermalLevel::NORMAL, true, 0));
+    service->set_thermal_response(touchdown::ThermalLevel::WARM,
+        load_thermal_response(config, touchdown::ThermalLevel::WARM, true, 0));
+    service->set_thermal_response(touchdown::ThermalLevel::HOT,
+        load_thermal_response(config, touchdown::ThermalLevel::HOT, false, 30));
+    service->set_thermal_response(touchdown::ThermalLevel::CRITICAL,
+        load_thermal_response(config, touchdown::ThermalLevel::CRITICAL, false, 15));
+    
+    // Empty power.core_parking.cpus keeps every CPU online
+    service->set_core_parking(
+        config.get_string("power.core_parking.sysfs_root", "/sys/devices/system/cpu"),
+        parse_cpu_list(config.get_string("power.core_parking.cpus")),
+        static_cast<uint32_t>(config.get_int("power.core_parking.delay_ms", 10000)),
+        config.get_bool("power.core_parking.parallel", true));
+    
+    service->set_backlight(
+        config.get_string("power.backlight.class_root", "/sys/class/backlight"),
+        static_cast<uint32_t>(config.get_int("power.backlight.fade_ms", 200)),
+        static_cast<uint32_t>(config.get_int("power.backlight.max_rate_hz", 60)));
+    
+    if (!service->init(loop)) {
         TD_LOG_ERROR("PowerServiceMain", "Failed to initialize power service");
         return 1;
     }
     
     // Run service
-    g_service->run();
+    service->run();
     
     TD_LOG_INFO("PowerServiceMain", "Power service stopped");
     return 0;
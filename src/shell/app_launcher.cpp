@@ -88,9 +88,7 @@ void AppLauncher::create_app_button(const AppInfo& app, int16_t x, int16_t y) {
     
     lv_obj_set_style_radius(btn, APP_BUTTON_SIZE / 2, 0);  // Circular
     lv_obj_set_style_bg_color(btn, app.color, 0);
-    lv_obj_set_style_shadow_width(btn, 8, 0);
-    lv_obj_set_style_shadow_color(btn, lv_color_black(), 0);
-    lv_obj_set_style_shadow_opa(btn, LV_OPA_30, 0);
+    lv_obj_add_style(btn, theme.get_shadow_style(), 0);
     
     // Add icon/label
     lv_obj_t* label = lv_label_create(btn);
@@ -139,6 +137,14 @@ void AppLauncher::hide() {
 void AppLauncher::animate_show(uint32_t duration_ms) {
     if (!container_) return;
     
+    if (!ThemeEngine::instance().get_effects()) {
+        // An earlier fade out leaves the container transparent
+        lv_anim_del(container_, nullptr);
+        lv_obj_set_style_opa(container_, LV_OPA_COVER, 0);
+        show();
+        return;
+    }
+    
     lv_obj_clear_flag(container_, LV_OBJ_FLAG_HIDDEN);
     
     // Fade in animation
@@ -169,6 +175,12 @@ void AppLauncher::animate_show(uint32_t duration_ms) {
 void AppLauncher::animate_hide(uint32_t duration_ms) {
     if (!container_) return;
     
+    if (!ThemeEngine::instance().get_effects()) {
+        lv_anim_del(container_, nullptr);
+        hide();
+        return;
+    }
+    
     // Fade out animation
     lv_anim_t anim;
     lv_anim_init(&anim);
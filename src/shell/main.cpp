@@ -4,36 +4,38 @@
  */
 
 #include "touchdown/shell/shell.hpp"
+#include "touchdown/core/event_loop.hpp"
 #include "touchdown/core/logger.hpp"
 #include <csignal>
 #include <memory>
 
-static std::unique_ptr<touchdown::shell::Shell> g_shell;
-
-void signal_handler(int signum) {
-    if (g_shell) {
-        TD_LOG_INFO("ShellMain", "Received signal: ", signum);
-        g_shell->stop();
-    }
-}
-
 int main(int argc, char* argv[]) {
     TD_LOG_INFO("ShellMain", "Starting TouchdownOS Shell");
     TD_LOG_INFO("ShellMain", "Version: 0.1.0");
     
-    // Setup signal handlers
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    // Setup the event loop first so driver threads inherit the blocked signals
+    touchdown::EventLoop loop;
+    if (!loop.init()) {
+        TD_LOG_ERROR("ShellMain", "Failed to initialize event loop");
+        return 1;
+    }
+    
+    auto on_signal = [&loop](int signum) {
+        TD_LOG_INFO("ShellMain", "Received signal: ", signum);
+        loop.stop();
+    };
+    loop.add_signal(SIGINT, on_signal);
+    loop.add_signal(SIGTERM, on_signal);
     
     // Create and initialize shell
-    g_shell = std::make_unique<touchdown::shell::Shell>();
-    if (!g_shell->init()) {
+    auto shell = std::make_unique<touchdown::shell::Shell>();
+    if (!shell->init(loop)) {
         TD_LOG_ERROR("ShellMain", "Failed to initialize shell");
         return 1;
     }
     
     // Run shell
-    g_shell->run();
+    shell->run();
     
     TD_LOG_INFO("ShellMain", "Shell stopped gracefully");
     return 0;
@@ -6,36 +6,88 @@
 #include "touchdown/shell/shell.hpp"
 #include "touchdown/shell/theme_engine.hpp"
 #include "touchdown/shell/circular_layout.hpp"
+#include "touchdown/client/system_client.hpp"
 #include "touchdown/core/logger.hpp"
 #include "touchdown/core/utils.hpp"
 #include "touchdown/core/config.hpp"
+#include "touchdown/core/latency_tracer.hpp"
+#include <algorithm>
 #include <systemd/sd-daemon.h>
-#include <thread>
-#include <chrono>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
 namespace touchdown {
 namespace shell {
 
 constexpr uint32_t TIME_UPDATE_INTERVAL_MS = 1000;  // Update time every second
+constexpr uint32_t WATCHDOG_INTERVAL_MS = 10000;
+constexpr size_t MAX_POINTER_SAMPLES = 32;
+constexpr uint32_t FRAME_DEADLINE_US = LV_DISP_DEF_REFR_PERIOD * 1000;
+constexpr uint64_t FRAME_REPORT_INTERVAL_US = 1000000;
 
 Shell::Shell()
     : screen_(nullptr)
     , app_container_(nullptr)
+    , input_wake_fd_(-1)
+    , pointer_indev_(nullptr)
+    , pointer_state_{0, 0, false, 0}
+    , input_events_(0)
+    , input_max_delay_us_(0)
+    , input_total_delay_us_(0)
+    , frame_stats_(FRAME_DEADLINE_US)
+    , loop_(nullptr)
+    , lvgl_timer_(EventLoop::INVALID_TIMER)
+    , clock_timer_(EventLoop::INVALID_TIMER)
+    , watchdog_timer_(EventLoop::INVALID_TIMER)
+    , parked_(false)
+    , parked_since_us_(0)
+    , parked_cpu_us_(0)
+    , resumed_us_(0)
+    , thermal_level_(ThermalLevel::NORMAL)
     , state_(ShellState::HOME)
-    , running_(false)
-    , last_time_update_(0)
     , last_update_ms_(0) {
 }
 
 Shell::~Shell() {
     stop();
+    
+    // Apps share the shell's connection, which goes away with us
+    client::SystemClient::instance().detach();
+    
+    if (input_wake_fd_ >= 0) {
+        loop_->remove_fd(input_wake_fd_);
+        close(input_wake_fd_);
+    }
 }
 
-bool Shell::init() {
+bool Shell::init(EventLoop& loop) {
     TD_LOG_INFO("Shell", "Initializing TouchdownOS Shell");
     
+    loop_ = &loop;
+    
     Config::instance().load("/etc/touchdown/shell.conf");
+    if (Config::instance().get_bool("debug.latency_trace", false)) {
+        LatencyTracer::instance().enable(Config::instance().get_string("debug.latency_trace_file"));
+    }
+    
+    // Input for touchdown-frame-floor-sim; record at a fixed CPU clock
+    std::string frame_trace_file = Config::instance().get_string("debug.frame_trace_file");
+    if (!frame_trace_file.empty()) {
+        frame_trace_.open(frame_trace_file, std::ios::trunc);
+        if (frame_trace_) {
+            frame_trace_ << "# start_us render_us, deadline " << FRAME_DEADLINE_US
+                         << " us; press posted_us per interaction start\n";
+        } else {
+            TD_LOG_WARNING("Shell", "Cannot write frame trace: ", frame_trace_file);
+        }
+    }
+    
+    load_thermal_styles();
+    
     lv_init();
+    lv_tick_set_cb(Utils::get_timestamp_ms);
     
     display_ = std::make_unique<drivers::DisplayDriver>();
     if (!display_->init()) {
@@ -43,17 +95,32 @@ bool Shell::init() {
         return false;
     }
     
-    touch_ = std::make_unique<drivers::TouchDriver>();
-    if (!touch_->init()) {
-        TD_LOG_ERROR("Shell", "Failed to initialize touch");
+    shell_service_ = std::make_unique<ShellService>();
+    if (!shell_service_->init(*loop_)) {
+        TD_LOG_ERROR("Shell", "Failed to initialize shell D-Bus service");
         return false;
     }
+    client::SystemClient::instance().attach(*shell_service_);
     
-    button_ = std::make_unique<drivers::ButtonDriver>();
-    if (!button_->init()) {
-        TD_LOG_ERROR("Shell", "Failed to initialize button");
-        return false;
-    }
+    // The power service decides, but only this process holds the DRM device
+    shell_service_->set_display_power_callback([this](bool on) { display_->set_power(on); });
+    
+    auto* power = client::SystemClient::instance().power();
+    power->on_power_state_changed([this](const std::string& state) { on_power_state_changed(state); });
+    power->on_resumed([this](uint64_t resumed_us) {
+        resumed_us_ = resumed_us;
+        resume_rendering();
+    });
+    
+    // The power service may have turned the screen off before we started
+    power->get_power_state([this](const char* error, const std::string& state) {
+        if (!error) on_power_state_changed(state);
+    });
+    
+    // Starts with the current level, then follows PropertiesChanged
+    power->watch_properties([this, power]() {
+        on_thermal_level_changed(power->get_thermal_level_property());
+    });
     
     ThemeEngine::instance().init();
     
@@ -67,6 +134,7 @@ bool Shell::init() {
     lv_obj_add_flag(app_container_, LV_OBJ_FLAG_HIDDEN);
     
     app_manager_ = std::make_unique<services::AppManager>();
+    app_manager_->set_app_slice(Config::instance().get_string("thermal.app_slice", "touchdown-apps.slice"));
     if (!app_manager_->init()) {
         TD_LOG_ERROR("Shell", "Failed to initialize app manager");
         return false;
@@ -86,61 +154,250 @@ bool Shell::init() {
     app_launcher_->add_app({"info", "Info", LV_SYMBOL_LIST, lv_color_hex(0x00AA88)});
     app_launcher_->add_app({"power", "Power", LV_SYMBOL_POWER, lv_color_hex(0xCC0044)});
     
-    setup_input_handlers();
+    if (!setup_input()) {
+        TD_LOG_ERROR("Shell", "Failed to set up input");
+        return false;
+    }
+    
     go_home();
     
+    lvgl_timer_ = loop_->add_timer([this]() { on_lvgl_timer(); });
+    clock_timer_ = loop_->add_timer([this]() { update_time(); });
+    watchdog_timer_ = loop_->add_timer([]() { sd_notify(0, "WATCHDOG=1"); });
+    
     TD_LOG_INFO("Shell", "Shell initialized successfully");
     return true;
 }
 
-void Shell::setup_input_handlers() {
-    touch_->set_touch_callback([this](const TouchPoint& p) {
-        on_touch(p);
-    });
+bool Shell::setup_input() {
+    // The input service signals this eventfd whenever it publishes events
+    input_wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (input_wake_fd_ < 0) {
+        return false;
+    }
     
-    button_->set_button_callback([this](const ButtonEvent& e) {
-        on_button(e);
+    loop_->add_fd(input_wake_fd_, EPOLLIN, [this](uint32_t) { on_input_ring_ready(); });
+    
+    // LVGL sees touches through a pointer device fed from the ring
+    pointer_indev_ = lv_indev_create();
+    if (!pointer_indev_) {
+        return false;
+    }
+    lv_indev_set_type(pointer_indev_, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(pointer_indev_, pointer_read_cb);
+    lv_indev_set_user_data(pointer_indev_, this);
+    
+    shell_service_->set_input_service_callback([this]() { connect_input_ring(); });
+    connect_input_ring();
+    return true;
+}
+
+void Shell::connect_input_ring() {
+    shell_service_->open_input_ring(input_wake_fd_, [this](int ring_fd) {
+        if (ring_fd < 0) {
+            // Retried when the input service (re)appears on the bus
+            TD_LOG_WARNING("Shell", "Input ring unavailable, waiting for input service");
+            return;
+        }
+        
+        if (input_ring_.attach(ring_fd)) {
+            TD_LOG_INFO("Shell", "Attached to input event ring");
+        }
     });
 }
 
+void Shell::on_input_ring_ready() {
+    uint64_t value;
+    if (read(input_wake_fd_, &value, sizeof(value)) < 0) {
+        // Already drained at the start of a loop iteration
+    }
+    
+    size_t handled = drain_input_ring();
+    
+    // Have LVGL read the pointer and render now rather than on its next tick;
+    // this also ends the handling window of events the shell took itself
+    if (handled > 0 && !parked_) {
+        if (!pointer_samples_.empty()) {
+            lv_timer_ready(lv_indev_get_read_timer(pointer_indev_));
+        }
+        loop_->arm_timer(lvgl_timer_, 0);
+    }
+}
+
+size_t Shell::drain_input_ring() {
+    size_t handled = 0;
+    InputEvent event;
+    while (input_ring_.read(event)) {
+        uint64_t now = EventLoop::now_us();
+        uint64_t delay_us = now - event.posted_us;
+        input_events_++;
+        input_total_delay_us_ += delay_us;
+        if (delay_us > input_max_delay_us_) {
+            input_max_delay_us_ = delay_us;
+        }
+        
+        // Input that wakes the screen is not meant for whatever was on it
+        if (parked_) continue;
+        
+        LatencyTracer::instance().begin(event, now);
+        on_input_event(event);
+        handled++;
+    }
+    return handled;
+}
+
+bool Shell::queue_pointer_sample(const TouchPoint& point, uint32_t trace_id) {
+    PointerSample sample = {point.x, point.y, false, trace_id};
+    
+    switch (point.type) {
+        case TouchEventType::PRESS:
+        case TouchEventType::MOVE:
+            sample.pressed = true;
+            break;
+        case TouchEventType::RELEASE:
+        case TouchEventType::TAP:
+        case TouchEventType::LONG_PRESS:
+            break;
+        default:
+            // Gestures are handled by the shell, not by LVGL
+            return false;
+    }
+    
+    // Only the latest position of a drag matters, keep presses and releases
+    if (!pointer_samples_.empty() && pointer_samples_.back().pressed && sample.pressed &&
+        point.type == TouchEventType::MOVE) {
+        // The replaced position never reaches LVGL, so it has no latency
+        LatencyTracer::instance().cancel(pointer_samples_.back().trace_id);
+        pointer_samples_.back() = sample;
+    } else if (pointer_samples_.size() < MAX_POINTER_SAMPLES) {
+        pointer_samples_.push_back(sample);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Shell::pointer_read_cb(lv_indev_t* indev, lv_indev_data_t* data) {
+    Shell* shell = static_cast<Shell*>(lv_indev_get_user_data(indev));
+    
+    if (!shell->pointer_samples_.empty()) {
+        shell->pointer_state_ = shell->pointer_samples_.front();
+        shell->pointer_samples_.pop_front();
+        
+        // LVGL runs the widget and app handlers for it right after this returns
+        LatencyTracer::instance().mark_consumed(shell->pointer_state_.trace_id, EventLoop::now_us());
+    }
+    
+    data->point.x = shell->pointer_state_.x;
+    data->point.y = shell->pointer_state_.y;
+    data->state = shell->pointer_state_.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    
+    // A press and release between two reads must both reach LVGL
+    data->continue_reading = !shell->pointer_samples_.empty();
+}
+
+void Shell::on_input_event(const InputEvent& event) {
+    // The same interaction starts the power service boosts on
+    if (frame_trace_.is_open() && (event.kind == InputEvent::Kind::BUTTON ||
+                                   event.touch.type == TouchEventType::PRESS)) {
+        frame_trace_ << "press " << event.posted_us << '\n';
+    }
+    
+    switch (event.kind) {
+        case InputEvent::Kind::TOUCH:
+            // Samples for LVGL count as consumed when its pointer read takes
+            // them; gestures are the shell's alone
+            if (!queue_pointer_sample(event.touch, event.trace_id)) {
+                LatencyTracer::instance().mark_consumed(event.trace_id, EventLoop::now_us());
+            }
+            on_touch(event.touch);
+            break;
+        case InputEvent::Kind::BUTTON:
+            LatencyTracer::instance().mark_consumed(event.trace_id, EventLoop::now_us());
+            on_button(event.button);
+            break;
+    }
+}
+
 void Shell::run() {
-    running_ = true;
+    if (!loop_) return;
+    
     sd_notify(0, "READY=1");
     TD_LOG_INFO("Shell", "Shell running");
 
-    last_time_update_ = Utils::get_timestamp_ms();
-    last_update_ms_ = last_time_update_;
+    last_update_ms_ = Utils::get_timestamp_ms();
 
-    uint32_t watchdog_count = 0;
+    loop_->arm_timer(lvgl_timer_, 0);
+    loop_->arm_timer(clock_timer_, TIME_UPDATE_INTERVAL_MS, TIME_UPDATE_INTERVAL_MS);
+    loop_->arm_timer(watchdog_timer_, WATCHDOG_INTERVAL_MS, WATCHDOG_INTERVAL_MS);
     
-    while (running_) {
-        uint32_t sleep_ms = lv_timer_handler();
+    loop_->run();
+}
 
-        uint32_t now = Utils::get_timestamp_ms();
-        uint32_t delta_ms = now - last_update_ms_;
-        last_update_ms_ = now;
+void Shell::stop() {
+    if (loop_) {
+        loop_->stop();
+    }
+    
+    if (input_events_ > 0) {
+        TD_LOG_INFO("Shell", "Input ring: ", input_events_, " events, avg delay ",
+                    input_total_delay_us_ / input_events_, "us, max ",
+                    input_max_delay_us_, "us, lost ", input_ring_.get_lost_count());
+    }
+    LatencyTracer::instance().dump();
+    TD_LOG_INFO("Shell", "Shell stopping");
+}
 
-        if (now - last_time_update_ >= TIME_UPDATE_INTERVAL_MS) {
-            update_time();
-            last_time_update_ = now;
-        }
+void Shell::on_lvgl_timer() {
+    // Deliver input before LVGL runs so this frame reflects it
+    drain_input_ring();
+    
+    // Only handler runs that flushed a frame count as rendering
+    uint64_t frames = display_->get_frame_count();
+    uint64_t start_us = EventLoop::now_us();
+    uint32_t sleep_ms = lv_timer_handler();
+    if (display_->get_frame_count() != frames) {
+        record_frame(start_us, EventLoop::now_us() - start_us);
+    }
+    
+    // Input handled in this run that invalidated nothing changed nothing;
+    // later clock ticks and animations are not its doing
+    LatencyTracer::instance().end_handling();
 
-        if (app_manager_) {
-            app_manager_->update(delta_ms);
-        }
+    uint32_t now = Utils::get_timestamp_ms();
+    uint32_t delta_ms = now - last_update_ms_;
+    last_update_ms_ = now;
 
-        if (++watchdog_count >= 100) {
-            sd_notify(0, "WATCHDOG=1");
-            watchdog_count = 0;
-        }
+    if (app_manager_) {
+        app_manager_->update(delta_ms);
+    }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms < 100 ? sleep_ms : 100));
+    // Sleep exactly until LVGL's next timer is due, or until an fd wakes us
+    if (sleep_ms == LV_NO_TIMER_READY) {
+        loop_->disarm_timer(lvgl_timer_);
+    } else {
+        loop_->arm_timer(lvgl_timer_, sleep_ms);
     }
 }
 
-void Shell::stop() {
-    running_ = false;
-    TD_LOG_INFO("Shell", "Shell stopping");
+void Shell::record_frame(uint64_t start_us, uint64_t render_us) {
+    frame_stats_.add(start_us, render_us);
+    
+    if (frame_trace_.is_open()) {
+        frame_trace_ << start_us << ' ' << render_us << '\n';
+    }
+    
+    // Piggybacks on rendering: no frames, no timer and no messages
+    FrameReport report;
+    if (!frame_stats_.take(start_us + render_us, FRAME_REPORT_INTERVAL_US, report)) {
+        return;
+    }
+    
+    if (auto* power = client::SystemClient::instance().power()) {
+        // No reply wanted; the power service cannot hold up a frame
+        power->report_frame_stats(report.frames, report.missed, report.busy_us,
+                                  report.max_us, report.window_us);
+    }
 }
 
 void Shell::on_touch(const TouchPoint& point) {
@@ -263,6 +520,105 @@ void Shell::launch_app(const std::string& app_id) {
     }
 }
 
+void Shell::on_power_state_changed(const std::string& state) {
+    if (state == "screen_off" || state == "suspended") {
+        park_rendering();
+    } else if (state == "active") {
+        // Also covers a suspend the kernel refused, which sends no Resumed
+        resume_rendering();
+    }
+}
+
+void Shell::load_thermal_styles() {
+    // Defaults step down from LV_DISP_DEF_REFR_PERIOD; effects go first
+    static constexpr ThermalStyle DEFAULTS[THERMAL_LEVEL_COUNT] = {
+        {LV_DISP_DEF_REFR_PERIOD, true},
+        {LV_DISP_DEF_REFR_PERIOD, false},
+        {50, false},
+        {100, false},
+    };
+    
+    auto& config = Config::instance();
+    for (size_t i = 0; i < THERMAL_LEVEL_COUNT; i++) {
+        std::string prefix = std::string("thermal.") +
+                             thermal_level_name(static_cast<ThermalLevel>(i)) + ".";
+        int refresh_ms = config.get_int(prefix + "refresh_ms", static_cast<int>(DEFAULTS[i].refresh_ms));
+        thermal_styles_[i].refresh_ms = static_cast<uint32_t>(std::max(refresh_ms, 1));
+        thermal_styles_[i].effects = config.get_bool(prefix + "effects", DEFAULTS[i].effects);
+    }
+}
+
+void Shell::on_thermal_level_changed(const std::string& name) {
+    ThermalLevel level;
+    if (!parse_thermal_level(name, level) || level == thermal_level_) return;
+    
+    // Cheaper frames before the firmware makes every frame slower
+    const ThermalStyle& style = thermal_styles_[static_cast<size_t>(level)];
+    lv_timer_set_period(lv_display_get_refr_timer(display_->get_display()), style.refresh_ms);
+    ThemeEngine::instance().set_effects(style.effects);
+    
+    TD_LOG_INFO("Shell", "Thermal level ", thermal_level_name(thermal_level_), " -> ", name,
+                ": refresh every ", style.refresh_ms, " ms, effects ", style.effects ? "on" : "off");
+    thermal_level_ = level;
+}
+
+uint64_t Shell::cpu_time_us() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+void Shell::park_rendering() {
+    if (parked_) return;
+    
+    // Nobody sees the pixels: no LVGL timers (so no animations or
+    // flushes), no clock and no app updates until the screen is back
+    parked_ = true;
+    loop_->disarm_timer(lvgl_timer_);
+    loop_->disarm_timer(clock_timer_);
+    if (app_manager_) {
+        app_manager_->pause_all();
+    }
+    
+    parked_since_us_ = EventLoop::now_us();
+    parked_cpu_us_ = cpu_time_us();
+    TD_LOG_DEBUG("Shell", "Rendering parked");
+}
+
+void Shell::resume_rendering() {
+    if (!parked_) return;
+    
+    parked_ = false;
+    
+    uint64_t parked_us = EventLoop::now_us() - parked_since_us_;
+    uint64_t cpu_us = cpu_time_us() - parked_cpu_us_;
+    TD_LOG_INFO("Shell", "Parked for ", parked_us / 1000, " ms, ", cpu_us / 1000, " ms CPU (",
+                parked_us > 0 ? cpu_us * 60000.0 / parked_us : 0.0, " ms/min)");
+    
+    if (app_manager_) {
+        app_manager_->resume_all();
+    }
+    last_update_ms_ = Utils::get_timestamp_ms();
+    update_time();
+    
+    // One full frame now, before the power service switches the display
+    // back on; the panel must not show what was there when it went off
+    lv_obj_invalidate(screen_);
+    lv_refr_now(nullptr);
+    if (auto* power = client::SystemClient::instance().power()) {
+        power->frame_ready();
+    }
+    
+    if (resumed_us_ != 0) {
+        TD_LOG_INFO("Shell", "First frame ", EventLoop::now_us() - resumed_us_, "us after wake");
+        resumed_us_ = 0;
+    }
+    
+    loop_->arm_timer(lvgl_timer_, 0);
+    loop_->arm_timer(clock_timer_, TIME_UPDATE_INTERVAL_MS, TIME_UPDATE_INTERVAL_MS);
+}
+
 void Shell::change_state(ShellState new_state) {
     state_ = new_state;
 }
@@ -0,0 +1,83 @@
+/**
+ * @file shell_service.cpp
+ * @brief Shell D-Bus service implementation
+ */
+
+#include "touchdown/shell/shell_service.hpp"
+#include "touchdown/core/logger.hpp"
+
+namespace touchdown {
+namespace shell {
+
+constexpr const char* INPUT_SERVICE = "org.touchdown.Input";
+
+constexpr int OPEN_RING_TIMEOUT_MS = 1000;
+
+ShellService::ShellService()
+    : ShellStub("org.touchdown.Shell")
+    , input_(*this, INPUT_SERVICE) {
+}
+
+ShellService::~ShellService() {
+}
+
+bool ShellService::init(EventLoop& loop) {
+    if (!DBusInterface::init(loop)) {
+        return false;
+    }
+
+    register_signal_handler("org.freedesktop.DBus", "NameOwnerChanged",
+        [this](services::Message& msg) { on_name_owner_changed(msg); });
+
+    TD_LOG_INFO("ShellService", "Shell service initialized");
+    return true;
+}
+
+void ShellService::open_input_ring(int event_fd, RingCallback callback) {
+    input_.open_event_ring(event_fd, [callback](const char* error, int ring_fd) {
+        if (error) {
+            TD_LOG_ERROR("ShellService", "OpenEventRing failed: ", error);
+            ring_fd = -1;
+        }
+
+        callback(ring_fd);
+    }, OPEN_RING_TIMEOUT_MS);
+}
+
+void ShellService::set_input_service_callback(std::function<void()> callback) {
+    input_service_callback_ = callback;
+}
+
+void ShellService::set_display_power_callback(DisplayPowerCallback callback) {
+    display_power_callback_ = callback;
+}
+
+services::MethodError ShellService::handle_set_display_power(services::Message& /* call */, bool on) {
+    if (!display_power_callback_) {
+        return {"org.touchdown.Error", "No display"};
+    }
+
+    display_power_callback_(on);
+    return {};
+}
+
+void ShellService::on_name_owner_changed(services::Message& msg) {
+    std::string name;
+    std::string old_owner;
+    std::string new_owner;
+
+    if (!msg.read_args(name, old_owner, new_owner)) {
+        return;
+    }
+
+    // A restarted input service has a fresh ring and no record of us
+    if (name == INPUT_SERVICE && !new_owner.empty()) {
+        TD_LOG_INFO("ShellService", "Input service appeared: ", new_owner);
+        if (input_service_callback_) {
+            input_service_callback_();
+        }
+    }
+}
+
+} // namespace shell
+} // namespace touchdown
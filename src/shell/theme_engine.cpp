@@ -9,6 +9,8 @@
 namespace touchdown {
 namespace shell {
 
+constexpr int32_t SHADOW_WIDTH = 8;
+
 ThemeEngine& ThemeEngine::instance() {
     static ThemeEngine engine;
     return engine;
@@ -19,6 +21,12 @@ void ThemeEngine::init() {
     load_dark_palette();
     apply_theme();
     
+    effects_ = true;
+    lv_style_init(&shadow_style_);
+    lv_style_set_shadow_width(&shadow_style_, SHADOW_WIDTH);
+    lv_style_set_shadow_color(&shadow_style_, lv_color_black());
+    lv_style_set_shadow_opa(&shadow_style_, LV_OPA_30);
+    
     TD_LOG_INFO("ThemeEngine", "Theme engine initialized");
 }
 
@@ -90,6 +98,16 @@ void ThemeEngine::apply_theme() {
     TD_LOG_INFO("ThemeEngine", "Theme applied");
 }
 
+void ThemeEngine::set_effects(bool enabled) {
+    if (enabled == effects_) return;
+    
+    effects_ = enabled;
+    lv_style_set_shadow_width(&shadow_style_, enabled ? SHADOW_WIDTH : 0);
+    lv_obj_report_style_change(&shadow_style_);
+    
+    TD_LOG_INFO("ThemeEngine", "Effects ", enabled ? "on" : "off");
+}
+
 lv_style_t ThemeEngine::create_card_style() {
     lv_style_t style;
     lv_style_init(&style);
@@ -99,7 +117,7 @@ lv_style_t ThemeEngine::create_card_style() {
     lv_style_set_border_width(&style, 0);
     lv_style_set_radius(&style, 12);
     lv_style_set_pad_all(&style, 16);
-    lv_style_set_shadow_width(&style, 8);
+    lv_style_set_shadow_width(&style, effects_ ? SHADOW_WIDTH : 0);
     lv_style_set_shadow_color(&style, lv_color_black());
     lv_style_set_shadow_opa(&style, LV_OPA_20);
     